@@ -5,77 +5,155 @@
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
 ../src/ErrorID.c \
-../src/KbhitGetch.c 
+../src/KbhitGetch.c \
+../src/LinuxUARTBaudRate.c 
 
 CPP_SRCS += \
+../src/AsyncLog.cpp \
+../src/Benchmark.cpp \
+../src/ByteOrder.cpp \
 ../src/CRC32.cpp \
 ../src/CommandBase.cpp \
 ../src/CommandFileStream.cpp \
+../src/EndToEndBenchmark.cpp \
+../src/EventLoop.cpp \
+../src/FramePool.cpp \
+../src/FrameStream.cpp \
 ../src/GPINCommand.cpp \
 ../src/GPRMCommand.cpp \
 ../src/GSC2Command.cpp \
+../src/GSC2Session.cpp \
 ../src/GSCNCommand.cpp \
 ../src/GVERCommand.cpp \
+../src/LatencyHistogram.cpp \
 ../src/LinuxClientSocket.cpp \
 ../src/LinuxClientUART.cpp \
+../src/LinuxDatagram.cpp \
+../src/LinuxPseudoTerminal.cpp \
+../src/LinuxServerSocket.cpp \
+../src/MonotonicClock.cpp \
 ../src/PSDemoProgram.cpp \
+../src/PointAvg.cpp \
 ../src/ProgramVersion.cpp \
+../src/RelayServer.cpp \
+../src/ReplayStream.cpp \
 ../src/SCANCommand.cpp \
 ../src/SPRMCommand.cpp \
 ../src/Scan2Print.cpp \
 ../src/Scan2Sequence.cpp \
+../src/ScanAcquisition.cpp \
+../src/ScanData.cpp \
+../src/ScanPipeline.cpp \
 ../src/ScanPrint.cpp \
+../src/ScanRecorder.cpp \
 ../src/ScanSequence.cpp \
+../src/ScanTiming.cpp \
+../src/ScanView.cpp \
+../src/SensorSimulator.cpp \
+../src/SimulatorServer.cpp \
+../src/UARTFramer.cpp \
 ../src/WinClientSocket.cpp \
 ../src/WinClientUART.cpp 
 
 OBJS += \
+./src/AsyncLog.o \
+./src/Benchmark.o \
+./src/ByteOrder.o \
 ./src/CRC32.o \
 ./src/CommandBase.o \
 ./src/CommandFileStream.o \
+./src/EndToEndBenchmark.o \
 ./src/ErrorID.o \
+./src/EventLoop.o \
+./src/FramePool.o \
+./src/FrameStream.o \
 ./src/GPINCommand.o \
 ./src/GPRMCommand.o \
 ./src/GSC2Command.o \
+./src/GSC2Session.o \
 ./src/GSCNCommand.o \
 ./src/GVERCommand.o \
 ./src/KbhitGetch.o \
+./src/LatencyHistogram.o \
 ./src/LinuxClientSocket.o \
 ./src/LinuxClientUART.o \
+./src/LinuxDatagram.o \
+./src/LinuxPseudoTerminal.o \
+./src/LinuxServerSocket.o \
+./src/LinuxUARTBaudRate.o \
+./src/MonotonicClock.o \
 ./src/PSDemoProgram.o \
+./src/PointAvg.o \
 ./src/ProgramVersion.o \
+./src/RelayServer.o \
+./src/ReplayStream.o \
 ./src/SCANCommand.o \
 ./src/SPRMCommand.o \
 ./src/Scan2Print.o \
 ./src/Scan2Sequence.o \
+./src/ScanAcquisition.o \
+./src/ScanData.o \
+./src/ScanPipeline.o \
 ./src/ScanPrint.o \
+./src/ScanRecorder.o \
 ./src/ScanSequence.o \
+./src/ScanTiming.o \
+./src/ScanView.o \
+./src/SensorSimulator.o \
+./src/SimulatorServer.o \
+./src/UARTFramer.o \
 ./src/WinClientSocket.o \
 ./src/WinClientUART.o 
 
 C_DEPS += \
 ./src/ErrorID.d \
-./src/KbhitGetch.d 
+./src/KbhitGetch.d \
+./src/LinuxUARTBaudRate.d 
 
 CPP_DEPS += \
+./src/AsyncLog.d \
+./src/Benchmark.d \
+./src/ByteOrder.d \
 ./src/CRC32.d \
 ./src/CommandBase.d \
 ./src/CommandFileStream.d \
+./src/EndToEndBenchmark.d \
+./src/EventLoop.d \
+./src/FramePool.d \
+./src/FrameStream.d \
 ./src/GPINCommand.d \
 ./src/GPRMCommand.d \
 ./src/GSC2Command.d \
+./src/GSC2Session.d \
 ./src/GSCNCommand.d \
 ./src/GVERCommand.d \
+./src/LatencyHistogram.d \
 ./src/LinuxClientSocket.d \
 ./src/LinuxClientUART.d \
+./src/LinuxDatagram.d \
+./src/LinuxPseudoTerminal.d \
+./src/LinuxServerSocket.d \
+./src/MonotonicClock.d \
 ./src/PSDemoProgram.d \
+./src/PointAvg.d \
 ./src/ProgramVersion.d \
+./src/RelayServer.d \
+./src/ReplayStream.d \
 ./src/SCANCommand.d \
 ./src/SPRMCommand.d \
 ./src/Scan2Print.d \
 ./src/Scan2Sequence.d \
+./src/ScanAcquisition.d \
+./src/ScanData.d \
+./src/ScanPipeline.d \
 ./src/ScanPrint.d \
+./src/ScanRecorder.d \
 ./src/ScanSequence.d \
+./src/ScanTiming.d \
+./src/ScanView.d \
+./src/SensorSimulator.d \
+./src/SimulatorServer.d \
+./src/UARTFramer.d \
 ./src/WinClientSocket.d \
 ./src/WinClientUART.d 
 
@@ -0,0 +1,274 @@
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       AsyncLog.cpp
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ *
+ ****************************************************************************
+ */
+
+#include <chrono>
+#include <cstdarg>
+#include <cstring>
+
+#include "AsyncLog.hpp"
+
+/*
+ * Standard constructor.
+ */
+AsyncLog::AsyncLog() :
+        mRingPtr(new BlockRing_t), //
+        mOpenBlockPtr(0), //
+        mConsoleBatchPtr(new char[BATCH_SIZE]), //
+        mFileBatchPtr(new char[BATCH_SIZE]), //
+        mLogFile(0), //
+        mDroppedLines(0), //
+        mRunning(false), //
+        mThread()
+{
+    // nothing more to do.
+}
+
+/*
+ * Standard destructor.
+ */
+AsyncLog::~AsyncLog()
+{
+    stop();
+    delete[] mFileBatchPtr;
+    delete[] mConsoleBatchPtr;
+    delete mRingPtr;
+}
+
+/*
+ * Defines the log file.
+ */
+void
+AsyncLog::setLogFile(FILE* theLogFile)
+{
+    mLogFile = theLogFile;
+}
+
+/*
+ * Writes a text to the console and the log file at once.
+ */
+void
+AsyncLog::writeNow(const char* theText, int32_t theLength, uint32_t theFlags)
+{
+    if (0 != (theFlags & LOG_CONSOLE))
+    {
+        fwrite(theText, 1, theLength, stdout);
+    }
+    if ((0 != (theFlags & LOG_FILE)) && (0 != mLogFile))
+    {
+        fwrite(theText, 1, theLength, mLogFile);
+    }
+}
+
+/*
+ * Writes the blocks waiting in the ring, collected to one write per target.
+ */
+void
+AsyncLog::writeBlocks()
+{
+    const bool lIsCongested = (CONGESTION_LEVEL < mRingPtr->getCount());
+    int32_t lConsoleLength = 0;
+    int32_t lFileLength = 0;
+    Block_t* lBlockPtr;
+
+    while (0 != (lBlockPtr = mRingPtr->getReadSlot()))
+    {
+        // console: optional blocks are skipped while the writer is behind
+        if (0 != (lBlockPtr->mFlags & LOG_CONSOLE))
+        {
+            if (lIsCongested && (0 != (lBlockPtr->mFlags & LOG_OPTIONAL)))
+            {
+                mDroppedLines.fetch_add(lBlockPtr->mNumberOfLines, std::memory_order_relaxed);
+            }
+            else
+            {
+                if (BATCH_SIZE < (lConsoleLength + lBlockPtr->mLength))
+                {
+                    writeNow(mConsoleBatchPtr, lConsoleLength, LOG_CONSOLE);
+                    lConsoleLength = 0;
+                }
+                memcpy(&mConsoleBatchPtr[lConsoleLength], lBlockPtr->mText, lBlockPtr->mLength);
+                lConsoleLength += lBlockPtr->mLength;
+            }
+        }
+
+        // log file: all blocks
+        if ((0 != (lBlockPtr->mFlags & LOG_FILE)) && (0 != mLogFile))
+        {
+            if (BATCH_SIZE < (lFileLength + lBlockPtr->mLength))
+            {
+                writeNow(mFileBatchPtr, lFileLength, LOG_FILE);
+                lFileLength = 0;
+            }
+            memcpy(&mFileBatchPtr[lFileLength], lBlockPtr->mText, lBlockPtr->mLength);
+            lFileLength += lBlockPtr->mLength;
+        }
+        mRingPtr->pop();
+    }
+
+    if (0 != lConsoleLength)
+    {
+        writeNow(mConsoleBatchPtr, lConsoleLength, LOG_CONSOLE);
+    }
+    if (0 != lFileLength)
+    {
+        writeNow(mFileBatchPtr, lFileLength, LOG_FILE);
+        fflush(mLogFile);
+    }
+}
+
+/*
+ * Thread function: writes the lines until stop() is called.
+ */
+void
+AsyncLog::run()
+{
+    bool lIsRunning = true;
+
+    // the blocks handed over before stop() are written by the last pass
+    while (lIsRunning)
+    {
+        lIsRunning = mRunning.load(std::memory_order_acquire);
+        writeBlocks();
+        if (lIsRunning)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(WRITE_INTERVAL));
+        }
+    }
+}
+
+/*
+ * Starts the writer thread.
+ */
+void
+AsyncLog::start()
+{
+    stop();
+    fflush(stdout);
+    mDroppedLines = 0;
+
+    mRunning = true;
+    mThread = std::thread(&AsyncLog::run, this);
+}
+
+/*
+ * Stops the writer thread.
+ */
+void
+AsyncLog::stop()
+{
+    flush();
+    mRunning = false;
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+}
+
+/*
+ * Writes a line.
+ */
+void
+AsyncLog::write(const char* theText, uint32_t theFlags)
+{
+    print(theFlags, "%s", theText);
+}
+
+/*
+ * Formats a line into the open block, or writes it at once if the writer
+ * does not run.
+ */
+void
+AsyncLog::print(uint32_t theFlags, const char* theFormat, ...)
+{
+    va_list lArguments;
+
+    va_start(lArguments, theFormat);
+    if (false == mRunning.load(std::memory_order_relaxed))
+    {
+        char lText[BLOCK_SIZE];
+        const int lResult = vsnprintf(lText, sizeof(lText), theFormat, lArguments);
+        if (0 < lResult)
+        {
+            writeNow(lText, (BLOCK_SIZE > lResult) ? lResult : BLOCK_SIZE - 1, theFlags);
+        }
+        va_end(lArguments);
+        return;
+    }
+
+    // the lines of a block go to the same targets
+    if ((0 != mOpenBlockPtr) && (theFlags != mOpenBlockPtr->mFlags))
+    {
+        flush();
+    }
+
+    // at most two tries: the open block, and a new one if the line did not fit
+    for (int32_t lTry = 0; lTry < 2; lTry++)
+    {
+        if (0 == mOpenBlockPtr)
+        {
+            // the ring is full: drop the line, the scan loop must not wait
+            mOpenBlockPtr = mRingPtr->getWriteSlot();
+            if (0 == mOpenBlockPtr)
+            {
+                mDroppedLines.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
+            mOpenBlockPtr->mFlags = theFlags;
+            mOpenBlockPtr->mLength = 0;
+            mOpenBlockPtr->mNumberOfLines = 0;
+        }
+
+        va_list lCopy;
+        va_copy(lCopy, lArguments);
+        const int32_t lRoom = BLOCK_SIZE - mOpenBlockPtr->mLength;
+        const int lResult = vsnprintf(&mOpenBlockPtr->mText[mOpenBlockPtr->mLength], lRoom, theFormat, lCopy);
+        va_end(lCopy);
+
+        // fits, or does not fit into an empty block either: cut
+        if ((lResult < lRoom) || (0 == mOpenBlockPtr->mLength))
+        {
+            if (0 < lResult)
+            {
+                mOpenBlockPtr->mLength += (lResult < lRoom) ? lResult : lRoom - 1;
+                mOpenBlockPtr->mNumberOfLines++;
+            }
+            break;
+        }
+
+        // hand the full block over and start a new one
+        flush();
+    }
+    va_end(lArguments);
+}
+
+/*
+ * Hands the open block to the writer.
+ */
+void
+AsyncLog::flush()
+{
+    if (0 != mOpenBlockPtr)
+    {
+        mRingPtr->push();
+        mOpenBlockPtr = 0;
+    }
+}
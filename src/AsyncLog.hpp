@@ -0,0 +1,247 @@
+#ifndef ASYNCLOG_HPP_
+#define ASYNCLOG_HPP_
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       AsyncLog.hpp - Writes the terminal output on a thread of its own.
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ ****************************************************************************
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include "Global.hpp"
+#include "SpscRing.hpp"
+
+/**
+ * Class AsyncLog - terminal output which does not stall the scan loop.
+ * <p>&nbsp;<p>
+ * stdout is unbuffered, so each printf() of a scan loop is a system call
+ * and a slow console delays the processing of the next scan. While the
+ * log runs, the scan loop formats the lines directly into the blocks of a
+ * pre-allocated lock-free ring. Lines with the same flags are packed into
+ * one block, which is handed to the writer when it is full or by flush().
+ * A writer thread collects the blocks every WRITE_INTERVAL ms and writes
+ * them with one call to the console and one to the log file.
+ * <p>
+ * The log never waits for the writer:
+ * <ul>
+ * <li>if more than CONGESTION_LEVEL blocks are waiting, the writer skips
+ * the blocks marked LOG_OPTIONAL on the console; they are still written
+ * to the log file.
+ * <li>if the ring is full, new lines are dropped.
+ * </ul>
+ * getDroppedLines() counts both.
+ * <p>
+ * Before start() and after stop() the lines are written at once, so
+ * messages and prompts around a scan sequence keep their order.
+ * write(), print() and flush() must be called by one thread only.
+ */
+class AsyncLog
+{
+    public:
+
+        /** class constants */
+        enum AsyncLogConstants_t
+        {
+            /** number of blocks in the ring; a power of two */
+            NUMBER_OF_BLOCKS = 256,
+
+            /** size of a block; a line is cut to BLOCK_SIZE - 1 characters */
+            BLOCK_SIZE = 4096,
+
+            /** size of the buffers of the writer in bytes */
+            BATCH_SIZE = 64 * 1024,
+
+            /** ms between two writes */
+            WRITE_INTERVAL = 10,
+
+            /** number of waiting blocks above which optional blocks are skipped */
+            CONGESTION_LEVEL = NUMBER_OF_BLOCKS / 2
+        };
+
+        /** where a line goes; or-ed */
+        enum AsyncLogFlags_t
+        {
+            /** write to the console */
+            LOG_CONSOLE = 1,
+
+            /** write to the log file */
+            LOG_FILE = 2,
+
+            /** write to the console and the log file */
+            LOG_ALL = LOG_CONSOLE | LOG_FILE,
+
+            /** the console may skip the line when the writer falls behind */
+            LOG_OPTIONAL = 4
+        };
+
+    private:
+
+        /** lines waiting for the writer */
+        struct Block_t
+        {
+                /** AsyncLogFlags_t of all lines */
+                uint32_t mFlags;
+
+                /** number of characters in mText */
+                int32_t mLength;
+
+                /** number of lines in mText */
+                int32_t mNumberOfLines;
+
+                /** the lines */
+                char mText[BLOCK_SIZE];
+        };
+
+        /** the ring of blocks */
+        typedef SpscRing<Block_t, NUMBER_OF_BLOCKS> BlockRing_t;
+
+        /** the ring between the threads; allocated once */
+        BlockRing_t* mRingPtr;
+
+        /** the block being filled, not yet handed to the writer, or 0 */
+        Block_t* mOpenBlockPtr;
+
+        /** the lines for the console, collected by the writer */
+        char* mConsoleBatchPtr;
+
+        /** the lines for the log file, collected by the writer */
+        char* mFileBatchPtr;
+
+        /** the log file, or 0 */
+        FILE* mLogFile;
+
+        /** number of lines dropped or skipped */
+        std::atomic<uint32_t> mDroppedLines;
+
+        /** cleared to stop the writer thread */
+        std::atomic<bool> mRunning;
+
+        /** the writer thread */
+        std::thread mThread;
+
+        /**
+         * Writes a text to the console and the log file at once.
+         */
+        void
+        writeNow(const char* theText, int32_t theLength, uint32_t theFlags);
+
+        /**
+         * Writer: writes the blocks waiting in the ring.
+         */
+        void
+        writeBlocks();
+
+        /**
+         * Thread function: writes the lines until stop() is called.
+         */
+        void
+        run();
+
+        /* private assignment constructor to avoid misuse */
+        explicit
+        AsyncLog(const AsyncLog& src);
+
+        /* private assignment operator to avoid misuse */
+        AsyncLog&
+        operator =(const AsyncLog& src);
+
+    public:
+
+        /**
+         * Standard constructor. The log writes at once until start().
+         */
+        AsyncLog();
+
+        /**
+         * Destructor. Stops the writer; the waiting lines are written.
+         */
+        virtual
+        ~AsyncLog();
+
+        /**
+         * Defines the log file. Must not be called while the log runs.
+         *
+         * @param theLogFile
+         *      the terminal log file, or 0.
+         */
+        void
+        setLogFile(FILE* theLogFile);
+
+        /**
+         * Returns the log file, or 0.
+         */
+        FILE*
+        getLogFile() const
+        {
+            return mLogFile;
+        }
+
+        /**
+         * Resets the dropped lines and starts the writer thread.
+         */
+        void
+        start();
+
+        /**
+         * Stops the writer thread after all lines are written.
+         */
+        void
+        stop();
+
+        /**
+         * Writes a line.
+         *
+         * @param theText
+         *      the text; longer texts are cut to BLOCK_SIZE - 1 characters.
+         * @param theFlags
+         *      AsyncLogFlags_t.
+         */
+        void
+        write(const char* theText, uint32_t theFlags = LOG_ALL);
+
+        /**
+         * Formats a line like printf() directly into the ring.
+         *
+         * @param theFlags
+         *      AsyncLogFlags_t.
+         * @param theFormat
+         *      the printf() format; longer texts are cut to BLOCK_SIZE - 1
+         *      characters.
+         */
+        void
+        print(uint32_t theFlags, const char* theFormat, ...);
+
+        /**
+         * Hands the lines written so far to the writer.
+         */
+        void
+        flush();
+
+        /**
+         * Returns the number of lines dropped because the ring was full,
+         * or skipped on the console because the writer fell behind.
+         */
+        uint32_t
+        getDroppedLines() const
+        {
+            return mDroppedLines.load(std::memory_order_relaxed);
+        }
+};
+
+#endif /* ASYNCLOG_HPP_ */
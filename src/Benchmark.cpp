@@ -0,0 +1,552 @@
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       Benchmark.cpp
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ *
+ ****************************************************************************
+ */
+#include <cstring>
+#include <sys/time.h>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "ByteOrder.hpp"
+#include "CommandBase.hpp"
+#include "CRC32.hpp"
+#include "GSCNCommand.hpp"
+#include "PointAvg.hpp"
+
+// needed for htonl
+#if defined(__WIN32__) || (defined(__CYGWIN__) && !defined(_WIN32))
+	#include <winsock2.h>
+#elif defined(__linux__)
+	#include <arpa/inet.h>
+#else
+	#error "This program requires Linux or Win32."
+#endif
+
+/*
+ * Standard constructor.
+ */
+Benchmark::Benchmark(FILE* theTerminalLogFile) :
+        mTerminalLogFile(theTerminalLogFile), //
+        mFrameSize(0), //
+        mFrame(), //
+        mWork(), //
+        mReference(), //
+        mRelayFrames(RELAY_FRAMES * GSC2Session::MAX_FRAME_SIZE / sizeof(uint32_t)), //
+        mRelayFrameSize(0), //
+        mRelayFrameIndex(0), //
+        mFrameStream(), //
+        mGSCNCommand(mFrameStream), //
+        mGSC2Command(mFrameStream), //
+        mGSCNScan(1), //
+        mGSC2Scan(1), //
+        mSession()
+{
+    // nothing more to do.
+}
+
+/*
+ * Standard destructor.
+ */
+Benchmark::~Benchmark()
+{
+    // nothing to be done.
+}
+
+/*
+ * Returns the current system time in us.
+ */
+uint64_t
+Benchmark::getMicroseconds()
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL); // get current time
+    return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+
+/*
+ * Builds a GSCN response: command ID, length, parameters, number of points,
+ * distance and, except for content 4, pulse width of each echo and the CRC.
+ */
+int32_t
+Benchmark::buildScanFrame(uint32_t* theFramePtr, int32_t theNumberOfPoints, int32_t theNumberOfEchoes,
+        int32_t theDataContent, int32_t theScanNumber)
+{
+    const cast_ptr_t lFramePtr = { theFramePtr };
+    const bool lHasPulseWidth = (GSCNCommand::DATABLOCK_WITH_DISTANCES != theDataContent);
+    int32_t lIndex = 0;
+
+    memcpy(lFramePtr.asCharPtr, "GSCN", 4);
+    lIndex = 2; // the length is filled in below
+
+    theFramePtr[lIndex++] = htonl(GSCNCommand::NUMBER_OF_SCAN_PARAMETER);
+    for (int32_t l = 0; l < GSCNCommand::NUMBER_OF_SCAN_PARAMETER; l++)
+    {
+        uint32_t lValue = l;
+        if (GSCNCommand::PARAMETER_SCAN_NUMBER == l)
+        {
+            lValue = theScanNumber;
+        }
+        else if (GSCNCommand::PARAMETER_NUMBER_OF_ECHOES == l)
+        {
+            lValue = theNumberOfEchoes;
+        }
+        else if (GSCNCommand::PARAMETER_DATA_CONTENT == l)
+        {
+            lValue = theDataContent;
+        }
+        theFramePtr[lIndex++] = htonl(lValue);
+    }
+
+    theFramePtr[lIndex++] = htonl(theNumberOfPoints);
+    for (int32_t l = 0; l < theNumberOfPoints * theNumberOfEchoes; l++)
+    {
+        theFramePtr[lIndex++] = htonl(10000 + ((l + theScanNumber) % 50000)); // distance
+        if (lHasPulseWidth)
+        {
+            theFramePtr[lIndex++] = htonl(200 + (l % 100)); // pulse width
+        }
+    }
+
+    const int32_t lFrameSize = (lIndex + 1) * sizeof(uint32_t);
+    theFramePtr[1] = htonl(lFrameSize - 3 * sizeof(uint32_t));
+
+    CRC32 lCRC;
+    theFramePtr[lIndex] = htonl(lCRC.get(theFramePtr, lFrameSize - 4));
+    return lFrameSize;
+}
+
+/*
+ * Writes a line of text to the console and the log file.
+ */
+void
+Benchmark::log(const char* theTextLine)
+{
+    // write to file
+    if (0 != mTerminalLogFile)
+    {
+        fputs(theTextLine, mTerminalLogFile);
+    }
+
+    // write to console
+    fputs(theTextLine, stdout);
+}
+
+/*
+ * Computes the CRC of the test frame with each engine, the way the
+ * commands check a response.
+ */
+ErrorID_t
+Benchmark::runCRC()
+{
+    string128_t lTextLine;
+    const CRC32::CRC32Engine_t lSelected = CRC32::getEngine();
+    ErrorID_t result = ERR_SUCCESS;
+    CRC32 lCRC;
+
+    // reference result of the bytewise loop
+    CRC32::setEngine(CRC32::ENGINE_BYTEWISE);
+    const uint32_t lReference = lCRC.get(mFrame, mFrameSize);
+
+    sprintf(lTextLine, "\r\nCRC, %d bytes, selected engine: %s\r\n", //
+            mFrameSize, CRC32::getEngineName(lSelected));
+    log(lTextLine);
+    sprintf(lTextLine, "%12s; %12s; %12s; %8s\r\n", "Engine", "us/scan", "MB/s", "Result");
+    log(lTextLine);
+
+    for (int32_t lEngine = CRC32::ENGINE_BYTEWISE; lEngine < CRC32::NUMBER_OF_ENGINES; lEngine++)
+    {
+        const CRC32::CRC32Engine_t lID = static_cast<CRC32::CRC32Engine_t>(lEngine);
+        if (!CRC32::isEngineSupported(lID) || (ERR_SUCCESS != CRC32::setEngine(lID)))
+        {
+            continue;
+        }
+
+        // correctness
+        const bool lIsEqual = (lReference == lCRC.get(mFrame, mFrameSize));
+        if (!lIsEqual)
+        {
+            result = ERR_CRC;
+        }
+
+        // speed
+        int64_t lRepetitions = 0;
+        const uint64_t lStartTime = getMicroseconds();
+        uint64_t lElapsed = 0;
+        do
+        {
+            for (int32_t l = 0; l < 100; l++)
+            {
+                lCRC.get(mFrame, mFrameSize);
+            }
+            lRepetitions += 100;
+            lElapsed = getMicroseconds() - lStartTime;
+        } while (lElapsed < MIN_MEASURE_TIME);
+
+        const double lMicrosecondsPerScan = static_cast<double>(lElapsed) / lRepetitions;
+        sprintf(lTextLine, "%12s; %12.3f; %12.1f; %8s\r\n", CRC32::getEngineName(lID), //
+                lMicrosecondsPerScan, mFrameSize / lMicrosecondsPerScan,
+                lIsEqual ? "OK" : "FAILED");
+        log(lTextLine);
+    }
+
+    // restore the selection of the program start
+    CRC32::setEngine(lSelected);
+    return result;
+}
+
+/*
+ * Converts the test frame to host byte order with each engine, the way
+ * CommandBase::convertNetworkToHost() does it in the scan loops.
+ */
+ErrorID_t
+Benchmark::runByteOrder()
+{
+    string128_t lTextLine;
+    const ByteOrder::ByteOrderEngine_t lSelected = ByteOrder::getEngine();
+    ErrorID_t result = ERR_SUCCESS;
+
+    // reference result of the scalar loop
+    memcpy(mWork, mFrame, mFrameSize);
+    ByteOrder::setEngine(ByteOrder::ENGINE_SCALAR);
+    CommandBase::convertNetworkToHost(mWork, mFrameSize);
+    memcpy(mReference, mWork, mFrameSize);
+
+    sprintf(lTextLine, "\r\nByte order conversion, %d bytes, selected engine: %s\r\n", //
+            mFrameSize, ByteOrder::getEngineName(lSelected));
+    log(lTextLine);
+    sprintf(lTextLine, "%12s; %12s; %12s; %8s\r\n", "Engine", "us/scan", "MB/s", "Result");
+    log(lTextLine);
+
+    for (int32_t lEngine = ByteOrder::ENGINE_SCALAR; lEngine < ByteOrder::NUMBER_OF_ENGINES; lEngine++)
+    {
+        const ByteOrder::ByteOrderEngine_t lID = static_cast<ByteOrder::ByteOrderEngine_t>(lEngine);
+        if (ERR_SUCCESS != ByteOrder::setEngine(lID))
+        {
+            continue;
+        }
+
+        // correctness: one conversion of the original frame
+        memcpy(mWork, mFrame, mFrameSize);
+        CommandBase::convertNetworkToHost(mWork, mFrameSize);
+        const bool lIsEqual = (0 == memcmp(mWork, mReference, mFrameSize));
+        if (!lIsEqual)
+        {
+            result = ERR_CRC;
+        }
+
+        // speed: convert back and forth, the data stay in the cache like in the scan loop
+        int64_t lRepetitions = 0;
+        const uint64_t lStartTime = getMicroseconds();
+        uint64_t lElapsed = 0;
+        do
+        {
+            for (int32_t l = 0; l < 100; l++)
+            {
+                CommandBase::convertNetworkToHost(mWork, mFrameSize);
+            }
+            lRepetitions += 100;
+            lElapsed = getMicroseconds() - lStartTime;
+        } while (lElapsed < MIN_MEASURE_TIME);
+
+        const double lMicrosecondsPerScan = static_cast<double>(lElapsed) / lRepetitions;
+        sprintf(lTextLine, "%12s; %12.3f; %12.1f; %8s\r\n", ByteOrder::getEngineName(lID), //
+                lMicrosecondsPerScan, mFrameSize / lMicrosecondsPerScan, lIsEqual ? "OK" : "FAILED");
+        log(lTextLine);
+    }
+
+    // restore the selection of the program start
+    ByteOrder::setEngine(lSelected);
+    return result;
+}
+
+/*
+ * Averages groups of distances of the test scan with each engine, the way
+ * the relay and ScanPrint decimate a scan.
+ */
+ErrorID_t
+Benchmark::runPointAvg()
+{
+    static const int32_t sGroupSizes[] = { 2, 4, 10 };
+    string128_t lTextLine;
+    const PointAvg::PointAvgEngine_t lSelected = PointAvg::getEngine();
+    const int32_t lNumberOfValues = BENCH_POINTS * BENCH_ECHOES;
+    std::vector<int32_t> lDistances(lNumberOfValues);
+    std::vector<int32_t> lAverages(lNumberOfValues);
+    std::vector<int32_t> lCounts(lNumberOfValues);
+    std::vector<int32_t> lReferenceAverages(lNumberOfValues);
+    std::vector<int32_t> lReferenceCounts(lNumberOfValues);
+    ErrorID_t result = ERR_SUCCESS;
+
+    // the distances of the test scan, some without echo or with noise
+    for (int32_t l = 0; l < lNumberOfValues; l++)
+    {
+        lDistances[l] = 10000 + (l % 50000);
+        if (0 == (l % 17))
+        {
+            lDistances[l] = PointAvg::NO_ECHO;
+        }
+        else if (0 == (l % 23))
+        {
+            lDistances[l] = PointAvg::NOISE;
+        }
+    }
+
+    sprintf(lTextLine, "\r\nPoint averaging, %d distances, selected engine: %s\r\n", //
+            lNumberOfValues, PointAvg::getEngineName(lSelected));
+    log(lTextLine);
+    sprintf(lTextLine, "%12s; %8s; %12s; %8s\r\n", "Engine", "Points", "us/scan", "Result");
+    log(lTextLine);
+
+    for (uint32_t lSize = 0; lSize < sizeof(sGroupSizes) / sizeof(sGroupSizes[0]); lSize++)
+    {
+        const int32_t lGroupSize = sGroupSizes[lSize];
+
+        // reference result of the scalar loop
+        PointAvg::setEngine(PointAvg::ENGINE_SCALAR);
+        const int32_t lNumberOfGroups = PointAvg::average(lDistances.data(), lNumberOfValues, lGroupSize,
+                lReferenceAverages.data(), lReferenceCounts.data());
+
+        for (int32_t lEngine = PointAvg::ENGINE_SCALAR; lEngine < PointAvg::NUMBER_OF_ENGINES; lEngine++)
+        {
+            const PointAvg::PointAvgEngine_t lID = static_cast<PointAvg::PointAvgEngine_t>(lEngine);
+            if (ERR_SUCCESS != PointAvg::setEngine(lID))
+            {
+                continue;
+            }
+
+            // correctness
+            PointAvg::average(lDistances.data(), lNumberOfValues, lGroupSize, lAverages.data(), lCounts.data());
+            const bool lIsEqual = (0 == memcmp(lAverages.data(), lReferenceAverages.data(),
+                    lNumberOfGroups * sizeof(int32_t)))
+                    && (0 == memcmp(lCounts.data(), lReferenceCounts.data(), lNumberOfGroups * sizeof(int32_t)));
+            if (!lIsEqual)
+            {
+                result = ERR_CRC;
+            }
+
+            // speed
+            int64_t lRepetitions = 0;
+            const uint64_t lStartTime = getMicroseconds();
+            uint64_t lElapsed = 0;
+            do
+            {
+                for (int32_t l = 0; l < 100; l++)
+                {
+                    PointAvg::average(lDistances.data(), lNumberOfValues, lGroupSize, lAverages.data(),
+                            lCounts.data());
+                }
+                lRepetitions += 100;
+                lElapsed = getMicroseconds() - lStartTime;
+            } while (lElapsed < MIN_MEASURE_TIME);
+
+            sprintf(lTextLine, "%12s; %8d; %12.3f; %8s\r\n", PointAvg::getEngineName(lID), lGroupSize, //
+                    static_cast<double>(lElapsed) / lRepetitions, lIsEqual ? "OK" : "FAILED");
+            log(lTextLine);
+        }
+    }
+
+    // restore the selection of the program start
+    PointAvg::setEngine(lSelected);
+    return result;
+}
+
+/*
+ * Runs a kernel of the scan loops once.
+ */
+ErrorID_t
+Benchmark::runKernel(Kernel_t theKernel)
+{
+    const cast_ptr_t lWorkPtr = { mWork };
+    CRC32 lCRC;
+    int32_t lLength = 0;
+
+    switch (theKernel)
+    {
+        case KERNEL_MEMCPY:
+            memcpy(mWork, mFrame, mFrameSize);
+            return ERR_SUCCESS;
+
+        case KERNEL_CRC:
+            return (lCRC.get(mFrame, mFrameSize - 4) == ntohl(mFrame[mFrameSize / sizeof(uint32_t) - 1])) ?
+                    ERR_SUCCESS : ERR_CRC;
+
+        case KERNEL_BYTE_ORDER:
+            CommandBase::convertNetworkToHost(mWork, mFrameSize);
+            return ERR_SUCCESS;
+
+        case KERNEL_GSCN_PARSE:
+            return mGSCNCommand.performCommand(0, mGSCNScan[0], 0);
+
+        case KERNEL_GSC2_PARSE:
+            return mGSC2Command.performCommand(MATRIX_SCAN_AVG_NUMBER, MATRIX_POINT_AVG_NUMBER, mGSC2Scan[0], 0);
+
+        case KERNEL_RELAY_AVG:
+            // the relay receives the next scan and collects it in the window
+            memcpy(mWork, &mRelayFrames[mRelayFrameIndex * GSC2Session::MAX_FRAME_SIZE / sizeof(uint32_t)],
+                    mRelayFrameSize);
+            mRelayFrameIndex = (mRelayFrameIndex + 1) % RELAY_FRAMES;
+            mSession.convertResponse(lWorkPtr.asCharPtr, mRelayFrameSize, &lLength);
+            return ERR_SUCCESS;
+
+        default:
+            return ERR_INVALID_PARAMETER;
+    }
+}
+
+/*
+ * Repeats a kernel until the measurement takes MATRIX_MEASURE_TIME.
+ */
+double
+Benchmark::measureKernel(Kernel_t theKernel)
+{
+    int64_t lRepetitions = 0;
+    const uint64_t lStartTime = getMicroseconds();
+    uint64_t lElapsed = 0;
+
+    do
+    {
+        for (int32_t l = 0; l < 10; l++)
+        {
+            runKernel(theKernel);
+        }
+        lRepetitions += 10;
+        lElapsed = getMicroseconds() - lStartTime;
+    } while (lElapsed < MATRIX_MEASURE_TIME);
+
+    return lElapsed * 1000.0 / lRepetitions;
+}
+
+/*
+ * Measures the kernels with the selected engines for each scan format
+ * which fits into a response. The relay averages frames up to the frame
+ * size of its GSC2 session only.
+ */
+ErrorID_t
+Benchmark::runMatrix()
+{
+    static const char* const sKernelNames[NUMBER_OF_KERNELS] = { "memcpy", "CRC", "ByteOrder", "GSCN parse",
+            "GSC2 parse", "Relay avg" };
+    static const int32_t sPoints[] = { 100, 500, 1000, 2000, 4000 };
+    static const int32_t sDataContents[] = { GSCNCommand::DATABLOCK_WITH_DISTANCES,
+            GSCNCommand::DATABLOCK_WITH_DISTANCES_PW_INCLUDES_ECHO, GSCNCommand::DATABLOCK_WITH_DISTANCES_PW };
+    const cast_ptr_t lRequestPtr = { mReference };
+    string128_t lTextLine;
+    ErrorID_t result = ERR_SUCCESS;
+    CRC32 lCRC;
+
+    sprintf(lTextLine, "\r\nKernels, CRC engine: %s, byte order engine: %s\r\n", //
+            CRC32::getEngineName(CRC32::getEngine()), ByteOrder::getEngineName(ByteOrder::getEngine()));
+    log(lTextLine);
+    sprintf(lTextLine, "%10s; %6s; %6s; %7s; %7s; %10s; %8s; %8s; %8s\r\n", "Kernel", "Points", "Echoes",
+            "Content", "Bytes", "ns/scan", "ns/byte", "ns/point", "Result");
+    log(lTextLine);
+
+    for (uint32_t lContent = 0; lContent < sizeof(sDataContents) / sizeof(sDataContents[0]); lContent++)
+    {
+        const int32_t lDataContent = sDataContents[lContent];
+        const int32_t lIntegersPerEcho = (GSCNCommand::DATABLOCK_WITH_DISTANCES == lDataContent) ? 1 : 2;
+
+        for (int32_t lEchoes = 1; lEchoes <= GSCNCommand::MAX_NUMBER_OF_ECHOS; lEchoes++)
+        {
+            for (uint32_t lPoint = 0; lPoint < sizeof(sPoints) / sizeof(sPoints[0]); lPoint++)
+            {
+                const int32_t lPoints = sPoints[lPoint];
+
+                // command ID, length, number of parameters, parameters, number of points, data, CRC
+                const int32_t lFrameSize = (3 + GSCNCommand::NUMBER_OF_SCAN_PARAMETER + 1
+                        + lPoints * lEchoes * lIntegersPerEcho + 1) * sizeof(uint32_t);
+                if (MAX_FRAME_SIZE < lFrameSize)
+                {
+                    continue;
+                }
+                mFrameSize = buildScanFrame(mFrame, lPoints, lEchoes, lDataContent, 1);
+                memcpy(mWork, mFrame, mFrameSize);
+                mFrameStream.setFrame(mFrame, mFrameSize);
+
+                // frames with consecutive scan numbers, and a GSC2 request to start the averaging
+                mRelayFrameSize = 0;
+                if (GSC2Session::MAX_FRAME_SIZE >= lFrameSize)
+                {
+                    for (int32_t l = 0; l < RELAY_FRAMES; l++)
+                    {
+                        mRelayFrameSize = buildScanFrame(
+                                &mRelayFrames[l * GSC2Session::MAX_FRAME_SIZE / sizeof(uint32_t)], lPoints, lEchoes,
+                                lDataContent, l + 1);
+                    }
+                    mRelayFrameIndex = 0;
+                    memcpy(lRequestPtr.asCharPtr, "GSC2", 4);
+                    mReference[1] = htonl(8);
+                    mReference[2] = htonl(MATRIX_SCAN_AVG_NUMBER);
+                    mReference[3] = htonl(MATRIX_POINT_AVG_NUMBER);
+                    mReference[4] = htonl(lCRC.get(mReference, 16));
+                    int32_t lLength = 0;
+                    mSession.convertRequest(lRequestPtr.asCharPtr, 20, &lLength);
+                }
+
+                for (int32_t lKernel = 0; lKernel < NUMBER_OF_KERNELS; lKernel++)
+                {
+                    const Kernel_t lID = static_cast<Kernel_t>(lKernel);
+                    if ((KERNEL_RELAY_AVG == lID) && (0 == mRelayFrameSize))
+                    {
+                        continue;
+                    }
+
+                    // correctness: the kernel accepts the frame
+                    const bool lIsOK = (ERR_SUCCESS == runKernel(lID));
+                    if (!lIsOK)
+                    {
+                        result = ERR_CRC;
+                    }
+
+                    const double lNanosecondsPerScan = measureKernel(lID);
+                    sprintf(lTextLine, "%10s; %6d; %6d; %7d; %7d; %10.0f; %8.3f; %8.2f; %8s\r\n",
+                            sKernelNames[lKernel], lPoints, lEchoes, lDataContent, mFrameSize, lNanosecondsPerScan,
+                            lNanosecondsPerScan / mFrameSize, lNanosecondsPerScan / lPoints, lIsOK ? "OK" : "FAILED");
+                    log(lTextLine);
+                }
+            }
+        }
+    }
+    return result;
+}
+
+/*
+ * Runs all benchmarks.
+ */
+ErrorID_t
+Benchmark::run()
+{
+    string128_t lTextLine;
+
+    mFrameSize = buildScanFrame(mFrame, BENCH_POINTS, BENCH_ECHOES, GSCNCommand::DATABLOCK_WITH_DISTANCES_PW, 1);
+    sprintf(lTextLine, "Test scan: %d points, %d echoes, %d bytes\r\n", BENCH_POINTS, BENCH_ECHOES, mFrameSize);
+    log(lTextLine);
+
+    const ErrorID_t lResults[] = { runCRC(), runByteOrder(), runPointAvg(), runMatrix() };
+    for (uint32_t l = 0; l < sizeof(lResults) / sizeof(lResults[0]); l++)
+    {
+        if (ERR_SUCCESS != lResults[l])
+        {
+            return lResults[l];
+        }
+    }
+    return ERR_SUCCESS;
+}
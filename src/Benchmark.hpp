@@ -0,0 +1,262 @@
+#ifndef BENCHMARK_HPP_
+#define BENCHMARK_HPP_
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       Benchmark.hpp - Measures the per scan processing cost.
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ ****************************************************************************
+ */
+
+#include <cstdio>
+#include <vector>
+#include "Global.hpp"
+#include "ErrorID.h"
+#include "FrameStream.hpp"
+#include "GSC2Command.hpp"
+#include "GSC2Session.hpp"
+#include "GSCNCommand.hpp"
+
+/**
+ * Class Benchmark - measures the processing cost of a scan without sensor.
+ * <p>&nbsp;<p>
+ * The benchmark builds a GSCN response of the largest scan the sensor
+ * sends (4000 points, 2 echoes, distance and pulse width) and compares
+ * the engines of the CRC, the byte order conversion and the point
+ * averaging on it. Each engine is repeated until the measurement takes
+ * at least MIN_MEASURE_TIME.
+ * <p>
+ * Then the kernels of the scan loops run with the selected engines on
+ * responses of each scan format: 100 to 4000 points, 1 to 4 echoes and
+ * data content 4, 7 and 8. The kernels are the CRC, the byte order
+ * conversion, the parsing of GSCNCommand and GSC2Command, and the GSC2
+ * averaging of the relay. The parsers and the relay get the response by
+ * a FrameStream, so their times include the copy of the received frame;
+ * the copy alone is measured as kernel "memcpy". The results are given
+ * in ns per scan, per byte and per point.
+ * <p>
+ * Started by "PSDemoProgram BENCH".
+ */
+class Benchmark
+{
+        /** class constants */
+        enum BenchmarkConstants_t
+        {
+            /** size of the frame buffer, same as the receiver buffer of the commands */
+            MAX_FRAME_SIZE = 64 * 1024,
+
+            /** points of the test scan */
+            BENCH_POINTS = 4000,
+
+            /** echoes of the test scan */
+            BENCH_ECHOES = 2,
+
+            /** minimum time of a measurement in us */
+            MIN_MEASURE_TIME = 200000,
+
+            /** minimum time of a measurement of the kernel matrix in us */
+            MATRIX_MEASURE_TIME = 20000,
+
+            /** scans in the window of the GSC2 averaging */
+            MATRIX_SCAN_AVG_NUMBER = 4,
+
+            /** points averaged by GSC2 */
+            MATRIX_POINT_AVG_NUMBER = 2,
+
+            /** number of relay frames with consecutive scan numbers */
+            RELAY_FRAMES = 64
+        };
+
+        /** the kernels of the matrix */
+        enum Kernel_t
+        {
+            KERNEL_MEMCPY, //
+            KERNEL_CRC, //
+            KERNEL_BYTE_ORDER, //
+            KERNEL_GSCN_PARSE, //
+            KERNEL_GSC2_PARSE, //
+            KERNEL_RELAY_AVG, //
+            NUMBER_OF_KERNELS
+        };
+
+        /** file to log the results, or 0 */
+        FILE* mTerminalLogFile;
+
+        /** number of bytes in the frame */
+        int32_t mFrameSize;
+
+        /** the test frame, integer aligned */
+        uint32_t mFrame[MAX_FRAME_SIZE / sizeof(uint32_t)];
+
+        /** a copy of the frame to work on */
+        uint32_t mWork[MAX_FRAME_SIZE / sizeof(uint32_t)];
+
+        /** the frame converted by the scalar loop, to check the other engines */
+        uint32_t mReference[MAX_FRAME_SIZE / sizeof(uint32_t)];
+
+        /** frames with consecutive scan numbers for the relay averaging */
+        std::vector<uint32_t> mRelayFrames;
+
+        /** size of each relay frame in bytes, or 0 if the scan is too large */
+        int32_t mRelayFrameSize;
+
+        /** the next relay frame */
+        int32_t mRelayFrameIndex;
+
+        /** returns mFrame to the parsers */
+        FrameStream mFrameStream;
+
+        /** the GSCN parser */
+        GSCNCommand mGSCNCommand;
+
+        /** the GSC2 parser */
+        GSC2Command mGSC2Command;
+
+        /** the scan parsed by GSCNCommand; allocated once */
+        std::vector<GSCNCommand::Scan_t> mGSCNScan;
+
+        /** the scan parsed by GSC2Command; allocated once */
+        std::vector<GSC2Command::Scan_t> mGSC2Scan;
+
+        /** the GSC2 averaging of the relay */
+        GSC2Session mSession;
+
+        /**
+         * Returns the current system time in us.
+         */
+        static uint64_t
+        getMicroseconds();
+
+        /**
+         * Builds a GSCN response with CRC in network byte order.
+         *
+         * @param theFramePtr
+         *      the buffer of MAX_FRAME_SIZE bytes.
+         * @param theNumberOfPoints
+         *      number of points of the scan.
+         * @param theNumberOfEchoes
+         *      number of echoes per point.
+         * @param theDataContent
+         *      4 (distances), 7 or 8 (distances and pulse widths).
+         * @param theScanNumber
+         *      the scan number.
+         * @return
+         *      the size of the frame in bytes.
+         */
+        static int32_t
+        buildScanFrame(uint32_t* theFramePtr, int32_t theNumberOfPoints, int32_t theNumberOfEchoes,
+                int32_t theDataContent, int32_t theScanNumber);
+
+        /**
+         * Runs a kernel of the matrix once on mFrame.
+         *
+         * @return
+         *      ERR_SUCCESS if OK, otherwise a negative error code.
+         */
+        ErrorID_t
+        runKernel(Kernel_t theKernel);
+
+        /**
+         * Repeats a kernel until the measurement takes MATRIX_MEASURE_TIME.
+         *
+         * @return
+         *      ns per call.
+         */
+        double
+        measureKernel(Kernel_t theKernel);
+
+        /**
+         * Writes a line of text to the console and the log file.
+         *
+         * @param theTextLine
+         *      the text.
+         */
+        void
+        log(const char* theTextLine);
+
+        /**
+         * Measures the CRC of each engine supported by the CPU.
+         *
+         * @return
+         *      ERR_SUCCESS if OK, otherwise a negative error code.
+         */
+        ErrorID_t
+        runCRC();
+
+        /**
+         * Measures the byte order conversion of each engine supported by the CPU.
+         *
+         * @return
+         *      ERR_SUCCESS if OK, otherwise a negative error code.
+         */
+        ErrorID_t
+        runByteOrder();
+
+        /**
+         * Measures the point averaging of each engine supported by the CPU
+         * for several group sizes.
+         *
+         * @return
+         *      ERR_SUCCESS if OK, otherwise a negative error code.
+         */
+        ErrorID_t
+        runPointAvg();
+
+        /**
+         * Measures the kernels for each scan format.
+         *
+         * @return
+         *      ERR_SUCCESS if OK, otherwise a negative error code.
+         */
+        ErrorID_t
+        runMatrix();
+
+        /* private assignment constructor to avoid misuse */
+        explicit
+        Benchmark(const Benchmark& src);
+
+        /* private assignment operator to avoid misuse */
+        Benchmark&
+        operator =(const Benchmark& src);
+
+    public:
+
+        /**
+         * Constructor.
+         *
+         * @param theTerminalLogFile
+         *      file to log the results, or 0.
+         */
+        explicit
+        Benchmark(FILE* theTerminalLogFile);
+
+        /**
+         * Destructor.
+         */
+        virtual
+        ~Benchmark();
+
+        /**
+         * Runs all benchmarks and prints the results.
+         *
+         * @return
+         *      ERR_SUCCESS if OK, otherwise a negative error code.
+         */
+        ErrorID_t
+        run();
+};
+
+#endif /* BENCHMARK_HPP_ */
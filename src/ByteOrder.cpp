@@ -0,0 +1,256 @@
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       ByteOrder.cpp
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ *
+ ****************************************************************************
+ */
+
+#include "ByteOrder.hpp"
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    #define BYTEORDER_IS_NETWORK_ORDER 1
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    #include <immintrin.h>
+    #define BYTEORDER_HAVE_X86 1
+#endif
+
+#if defined(__ARM_NEON) && !defined(__ARM_BIG_ENDIAN)
+    #include <arm_neon.h>
+    #define BYTEORDER_HAVE_NEON 1
+#endif
+
+/* the engine used by swap(); the scalar loop until the selection below is done */
+ByteOrder::Engine_t ByteOrder::sEngine = ByteOrder::swapScalar;
+
+/* ID of the engine used by swap() */
+ByteOrder::ByteOrderEngine_t ByteOrder::sEngineID = ByteOrder::ENGINE_SCALAR;
+
+/* selects the fastest engine during static initialization, before any thread is started */
+static const ErrorID_t sEngineSelection = ByteOrder::setEngine(ByteOrder::ENGINE_AUTO);
+
+/*
+ * One integer at a time. Nothing to do on big endian hosts.
+ */
+void
+ByteOrder::swapScalar(uint32_t* theDataPtr, int32_t theNumberOfIntegers)
+{
+#if !BYTEORDER_IS_NETWORK_ORDER
+    for (int32_t l = 0; l < theNumberOfIntegers; l++)
+    {
+        theDataPtr[l] = __builtin_bswap32(theDataPtr[l]);
+    }
+#endif
+}
+
+#if BYTEORDER_HAVE_X86
+/*
+ * Reverses the bytes of each integer by a byte shuffle, 16 bytes per iteration.
+ */
+__attribute__((target("ssse3"))) void
+ByteOrder::swapSSSE3(uint32_t* theDataPtr, int32_t theNumberOfIntegers)
+{
+    const __m128i lShuffle = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+    int32_t l = 0;
+
+    for (; l + 4 <= theNumberOfIntegers; l += 4)
+    {
+        __m128i* lBlockPtr = reinterpret_cast<__m128i*>(&theDataPtr[l]);
+        _mm_storeu_si128(lBlockPtr, _mm_shuffle_epi8(_mm_loadu_si128(lBlockPtr), lShuffle));
+    }
+    swapScalar(&theDataPtr[l], theNumberOfIntegers - l);
+}
+
+/*
+ * Reverses the bytes of each integer by a byte shuffle, 32 bytes per iteration.
+ */
+__attribute__((target("avx2"))) void
+ByteOrder::swapAVX2(uint32_t* theDataPtr, int32_t theNumberOfIntegers)
+{
+    // _mm256_shuffle_epi8 shuffles within each 128 bit lane
+    const __m256i lShuffle = _mm256_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3, //
+            12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+    int32_t l = 0;
+
+    for (; l + 8 <= theNumberOfIntegers; l += 8)
+    {
+        __m256i* lBlockPtr = reinterpret_cast<__m256i*>(&theDataPtr[l]);
+        _mm256_storeu_si256(lBlockPtr, _mm256_shuffle_epi8(_mm256_loadu_si256(lBlockPtr), lShuffle));
+    }
+    swapScalar(&theDataPtr[l], theNumberOfIntegers - l);
+}
+#else
+/* not available on this CPU; never selected */
+void
+ByteOrder::swapSSSE3(uint32_t* theDataPtr, int32_t theNumberOfIntegers)
+{
+    swapScalar(theDataPtr, theNumberOfIntegers);
+}
+
+/* not available on this CPU; never selected */
+void
+ByteOrder::swapAVX2(uint32_t* theDataPtr, int32_t theNumberOfIntegers)
+{
+    swapScalar(theDataPtr, theNumberOfIntegers);
+}
+#endif
+
+/*
+ * Reverses the bytes of each integer by NEON instructions, 16 bytes per iteration.
+ */
+void
+ByteOrder::swapNEON(uint32_t* theDataPtr, int32_t theNumberOfIntegers)
+{
+    int32_t l = 0;
+
+#if BYTEORDER_HAVE_NEON
+    for (; l + 4 <= theNumberOfIntegers; l += 4)
+    {
+        const cast_ptr_t lBlockPtr = { &theDataPtr[l] };
+        const uint8x16_t lBlock = vld1q_u8(reinterpret_cast<const uint8_t*>(lBlockPtr.asCharPtr));
+        vst1q_u8(reinterpret_cast<uint8_t*>(lBlockPtr.asCharPtr), vrev32q_u8(lBlock));
+    }
+#endif
+    swapScalar(&theDataPtr[l], theNumberOfIntegers - l);
+}
+
+/*
+ * Returns the engine currently used by swap().
+ */
+ByteOrder::ByteOrderEngine_t
+ByteOrder::getEngine()
+{
+    return sEngineID;
+}
+
+/*
+ * Returns a printable name of an engine.
+ */
+const char*
+ByteOrder::getEngineName(ByteOrderEngine_t theEngine)
+{
+    switch (theEngine)
+    {
+        case ENGINE_AUTO:
+            return "auto";
+        case ENGINE_SCALAR:
+            return "scalar";
+        case ENGINE_SSSE3:
+            return "x86-ssse3";
+        case ENGINE_AVX2:
+            return "x86-avx2";
+        case ENGINE_NEON:
+            return "arm-neon";
+        default:
+            return "unknown";
+    }
+}
+
+/*
+ * Checks if an engine is compiled in and supported by the CPU.
+ * There is nothing to convert on big endian hosts, so only the scalar loop is offered.
+ */
+bool
+ByteOrder::isEngineSupported(ByteOrderEngine_t theEngine)
+{
+    switch (theEngine)
+    {
+        case ENGINE_AUTO:
+        case ENGINE_SCALAR:
+            return true;
+
+        case ENGINE_SSSE3:
+#if BYTEORDER_HAVE_X86
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("ssse3");
+#else
+            return false;
+#endif
+
+        case ENGINE_AVX2:
+#if BYTEORDER_HAVE_X86
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#else
+            return false;
+#endif
+
+        case ENGINE_NEON:
+#if BYTEORDER_HAVE_NEON
+            return true; // compiled for a CPU with NEON
+#else
+            return false;
+#endif
+
+        default:
+            return false;
+    }
+}
+
+/*
+ * Selects the engine used by swap().
+ */
+ErrorID_t
+ByteOrder::setEngine(ByteOrderEngine_t theEngine)
+{
+    // the widest first
+    if (ENGINE_AUTO == theEngine)
+    {
+        if (isEngineSupported(ENGINE_AVX2))
+        {
+            theEngine = ENGINE_AVX2;
+        }
+        else if (isEngineSupported(ENGINE_SSSE3))
+        {
+            theEngine = ENGINE_SSSE3;
+        }
+        else if (isEngineSupported(ENGINE_NEON))
+        {
+            theEngine = ENGINE_NEON;
+        }
+        else
+        {
+            theEngine = ENGINE_SCALAR;
+        }
+    }
+
+    if (false == isEngineSupported(theEngine))
+    {
+        return ERR_UNSUPPORTED_FUNCTION;
+    }
+
+    switch (theEngine)
+    {
+        case ENGINE_SSSE3:
+            sEngine = swapSSSE3;
+            break;
+        case ENGINE_AVX2:
+            sEngine = swapAVX2;
+            break;
+        case ENGINE_NEON:
+            sEngine = swapNEON;
+            break;
+        case ENGINE_SCALAR:
+        default:
+            sEngine = swapScalar;
+            break;
+    }
+    sEngineID = theEngine;
+    return ERR_SUCCESS;
+}
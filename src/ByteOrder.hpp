@@ -0,0 +1,167 @@
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       ByteOrder.hpp - Conversion of integer buffers between
+ *              network and host byte order.
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ ****************************************************************************
+ */
+
+#ifndef BYTEORDER_HPP_
+#define BYTEORDER_HPP_
+
+extern "C"
+{
+#include "ErrorID.h"
+}
+#include "Global.hpp"
+
+/**
+ * Class ByteOrder - converts arrays of 32 bit integers between network
+ * byte order (big endian) and host byte order.
+ * <p>&nbsp;<p>
+ *
+ * State Information:<br>
+ * The fastest engine supported by the CPU is selected at program start:
+ * AVX2 or SSSE3 byte shuffles on x86 processors, NEON on ARM
+ * processors, or a scalar loop. On big endian hosts (MIPS) the network
+ * byte order is the host byte order and no engine touches the data.
+ *
+ * @ingroup common
+ */
+class ByteOrder
+{
+    public:
+
+        /**
+         * Implementations of the conversion used by swap().
+         * All engines produce identical results; they differ in speed only.
+         */
+        enum ByteOrderEngine_t
+        {
+            /** select the fastest engine supported by the CPU */
+            ENGINE_AUTO, //
+
+            /** one integer at a time */
+            ENGINE_SCALAR, //
+
+            /** x86 SSSE3 byte shuffle, 16 bytes per iteration */
+            ENGINE_SSSE3, //
+
+            /** x86 AVX2 byte shuffle, 32 bytes per iteration */
+            ENGINE_AVX2, //
+
+            /** ARM NEON byte reverse, 16 bytes per iteration */
+            ENGINE_NEON, //
+
+            /** number of engines */
+            NUMBER_OF_ENGINES
+        };
+
+    private:
+
+        /** signature of a conversion engine */
+        typedef void
+        (*Engine_t)(uint32_t* theDataPtr, int32_t theNumberOfIntegers);
+
+        /** the engine used by swap() */
+        static Engine_t sEngine;
+
+        /** ID of the engine used by swap() */
+        static ByteOrderEngine_t sEngineID;
+
+        /** portable engine */
+        static void
+        swapScalar(uint32_t* theDataPtr, int32_t theNumberOfIntegers);
+
+        /** x86 SSSE3 engine */
+        static void
+        swapSSSE3(uint32_t* theDataPtr, int32_t theNumberOfIntegers);
+
+        /** x86 AVX2 engine */
+        static void
+        swapAVX2(uint32_t* theDataPtr, int32_t theNumberOfIntegers);
+
+        /** ARM NEON engine */
+        static void
+        swapNEON(uint32_t* theDataPtr, int32_t theNumberOfIntegers);
+
+        /* not to be instantiated */
+        ByteOrder();
+
+    public:
+
+        /**
+         * Converts an array of integers in place from network byte order
+         * to host byte order and vice versa.
+         * The array needs no special alignment.
+         *
+         * @param theDataPtr
+         *      Pointer at the first integer.
+         * @param theNumberOfIntegers
+         *      Number of integers to convert.
+         */
+        static inline void
+        swap(void* theDataPtr, int32_t theNumberOfIntegers)
+        {
+            if ((0 != theDataPtr) && (0 < theNumberOfIntegers))
+            {
+                const cast_ptr_t lDataPtr = { theDataPtr };
+                sEngine(lDataPtr.asUnsignedPtr, theNumberOfIntegers);
+            }
+        }
+
+        /**
+         * Returns the engine used by swap().
+         */
+        static ByteOrderEngine_t
+        getEngine();
+
+        /**
+         * Returns the name of an engine for log files and benchmarks.
+         *
+         * @param theEngine
+         *      the engine.
+         */
+        static const char*
+        getEngineName(ByteOrderEngine_t theEngine);
+
+        /**
+         * Checks if an engine is compiled in and supported by the CPU.
+         *
+         * @param theEngine
+         *      the engine.
+         * @return
+         *      true if the engine can be selected.
+         */
+        static bool
+        isEngineSupported(ByteOrderEngine_t theEngine);
+
+        /**
+         * Selects the engine used by swap().
+         * Call it before any thread is started; the selection is not thread safe.
+         *
+         * @param theEngine
+         *      the engine, or ENGINE_AUTO for the fastest one.
+         * @return
+         *      ERR_SUCCESS if OK,
+         *      ERR_UNSUPPORTED_FUNCTION if the engine is not available.
+         */
+        static ErrorID_t
+        setEngine(ByteOrderEngine_t theEngine);
+};
+
+#endif /* BYTEORDER_HPP_ */
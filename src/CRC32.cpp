@@ -1,118 +1,518 @@
-/**
- ****************************************************************************
- *
- * Project:     Triple-IN PS Demo Program
-
- * @file:       CRC32.cpp - Cyclic Redundancy Code
- *
- * @author:     CBruelle
- *
- * Date:        $Date: 2015/10/23 12:23:10 $
- * SDK:         GNU gcc 4
- *
- * (c) 2005 Triple-IN GmbH Hamburg, Germany
- *
- * Indicated part of codes:
- * Copyright (c) 1998 by Michael Barr.  This software is placed into
- * the public domain and may be used for any purpose.  However, this
- * notice must not be changed or removed and no warranty is either
- * expressed or implied by its publication or distribution.
- *
- ****************************************************************************
- */
-#include <stdio.h>
-#include "CRC32.hpp"
-
-/*  a local flag indicating if the CRC table was initialized */
-bool CRC32::sCRC32IsInitialized = false;
-
-/*
- * An array containing the pre-computed intermediate result for each
- * possible byte of input.  This is used to speed up the computation.
- */
-uint32_t CRC32::sCRCTable[256];
-
-/*
- * The constructor.
- * Initialize the CRC table.
- */
-CRC32::CRC32() :
-        // no base class constructor.
-        mLength(0), //
-        mRemainder(CRC32_INITIAL_REMAINDER)
-{
-    if (false == sCRC32IsInitialized)
-    {
-        // 256 values representing ASCII character codes.
-        for (int iCodes = 0; iCodes <= 0xFF; iCodes++)
-        {
-            sCRCTable[iCodes] = reflect(iCodes, 8) << (CRC32_WIDTH - 8);
-
-            for (int iPos = 0; iPos < 8; iPos++)
-            {
-                sCRCTable[iCodes] = //
-                        (sCRCTable[iCodes] << 1) ^ (sCRCTable[iCodes] & (1 << 31) ? CRC32_POLYNOMIAL : CRC32_NULL);
-            }
-
-            sCRCTable[iCodes] = reflect(sCRCTable[iCodes], CRC32_WIDTH);
-			//printf("0x%08x, ", sCRCTable[iCodes]);
-        }
-		//printf("\r\n");
-        sCRC32IsInitialized = true;
-    }
-}
-
-/*
- * Destructor.
- */
-CRC32::~CRC32()
-{
-    // has nothing to do.
-}
-
-/*
- * Add some more data to compute a 32 bit CRC of several data.
- */
-uint32_t
-CRC32::add(const void* theDataPtr, int32_t theLength)
-{
-    // setup the pointer
-    const unsigned char* lPtr = static_cast<const unsigned char*>(theDataPtr);
-
-    // check parameter. Return default if there is nothing to do.
-    if (0 == theDataPtr || 0 == theLength)
-    {
-        return 0;
-    }
-
-    // Divide the message by the polynomial, a byte at time.
-    for (int32_t l = 0; l < theLength; l++)
-    {
-        mRemainder = (mRemainder >> 8) ^ sCRCTable[(mRemainder & 0xFF) ^ lPtr[l]];
-    }
-
-    // The final mRemainder is the CRC result.
-    mLength += theLength;
-    return (mRemainder ^ CRC32_FINAL_XOR_VALUE);
-}
-
-/*
- * Performs a reflection on a value.
- */
-uint32_t
-CRC32::reflect(uint32_t value, byte_t theBits)
-{
-    uint32_t result = 0;
-
-    // Swap bit 0 for bit 7 bit 1 For bit 6, etc....
-    for (int32_t bit = 1; bit < (theBits + 1); bit++)
-    {
-        if (value & 1)
-        {
-            result |= 1 << (theBits - bit);
-        }
-        value >>= 1;
-    }
-    return result;
-}
-
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+
+ * @file:       CRC32.cpp - Cyclic Redundancy Code
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2005 Triple-IN GmbH Hamburg, Germany
+ *
+ * Indicated part of codes:
+ * Copyright (c) 1998 by Michael Barr.  This software is placed into
+ * the public domain and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ *
+ ****************************************************************************
+ */
+#include <stdio.h>
+#include <string.h>
+#include "CRC32.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    #include <emmintrin.h>
+    #include <smmintrin.h>
+    #include <wmmintrin.h>
+    #define CRC32_HAVE_PCLMUL 1
+#endif
+
+#if defined(__ARM_FEATURE_CRC32) && !defined(__ARM_BIG_ENDIAN)
+    #include <arm_acle.h>
+    #define CRC32_HAVE_ARMV8 1
+    #if defined(__linux__)
+        #include <sys/auxv.h>
+        #include <asm/hwcap.h>
+    #endif
+#endif
+
+/*
+ * Compile time list of the indices 0..N-1; C++11 lacks std::index_sequence.
+ */
+template<int... I>
+struct IndexList_t
+{
+};
+
+template<int N, int... I>
+struct MakeIndexList : MakeIndexList<N - 1, N - 1, I...>
+{
+};
+
+template<int... I>
+struct MakeIndexList<0, I...>
+{
+        typedef IndexList_t<I...> type;
+};
+
+/*
+ * The lookup tables and the constexpr functions generating them.
+ */
+struct CRC32::Tables
+{
+        /** one lookup table */
+        struct Row_t
+        {
+                uint32_t mValue[256];
+        };
+
+        /** table 0 is the classic byte table, table n is used for slicing-by-n */
+        Row_t mRow[CRC32_TABLES];
+
+        /*
+         * Performs a reflection on a value:
+         * swaps bit 7 with 0, 6 with 1 and so on.
+         */
+        static constexpr uint32_t
+        reflect(uint32_t value, int32_t theBits)
+        {
+            return (0 == theBits) ? 0 : (((value & 1) << (theBits - 1)) | reflect(value >> 1, theBits - 1));
+        }
+
+        /*
+         * Divides a remainder by the reflected polynomial, a bit at a time.
+         */
+        static constexpr uint32_t
+        divide(uint32_t theRemainder, int32_t theBits)
+        {
+            return (0 == theBits) ? theRemainder : divide((theRemainder >> 1) //
+                    ^ ((theRemainder & 1) ? reflect(CRC32_POLYNOMIAL, CRC32_WIDTH) : CRC32_NULL), theBits - 1);
+        }
+
+        /*
+         * Advances a table entry by one zero byte.
+         */
+        static constexpr uint32_t
+        shift(uint32_t theValue)
+        {
+            return (theValue >> 8) ^ divide(theValue & 0xFF, 8);
+        }
+
+        /*
+         * Entry of table theTable for the byte theCode.
+         */
+        static constexpr uint32_t
+        entry(int32_t theTable, uint32_t theCode)
+        {
+            return (0 == theTable) ? divide(theCode, 8) : shift(entry(theTable - 1, theCode));
+        }
+
+        template<int... I>
+        static constexpr Row_t
+        makeRow(int32_t theTable, IndexList_t<I...>)
+        {
+            return Row_t { { entry(theTable, I)... } };
+        }
+
+        template<int... T>
+        static constexpr Tables
+        make(IndexList_t<T...>)
+        {
+            return Tables { { makeRow(T, MakeIndexList<256>::type())... } };
+        }
+};
+
+/*
+ * The lookup tables. The initializer is a constant expression,
+ * so the tables are built by the compiler and stored as constant data.
+ */
+const CRC32::Tables CRC32::sCRCTables = CRC32::Tables::make(MakeIndexList<CRC32_TABLES>::type());
+
+/* the engine used by add(); slicing-by-8 until the selection below is done */
+CRC32::Engine_t CRC32::sEngine = CRC32::addSlicingBy8;
+
+/* ID of the engine used by add() */
+CRC32::CRC32Engine_t CRC32::sEngineID = CRC32::ENGINE_SLICING_BY_8;
+
+/* selects the fastest engine during static initialization, before any thread is started */
+static const ErrorID_t sEngineSelection = CRC32::setEngine(CRC32::ENGINE_AUTO);
+
+/*
+ * Loads 4 bytes in little endian order, independent of the host byte order.
+ * The reflected CRC processes the lowest byte first.
+ */
+static inline uint32_t
+loadLittleEndian(const byte_t* thePtr)
+{
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    uint32_t lValue;
+    memcpy(&lValue, thePtr, sizeof(lValue));
+    return lValue;
+#else
+    return thePtr[0] | (thePtr[1] << 8) | (thePtr[2] << 16) | (static_cast<uint32_t>(thePtr[3]) << 24);
+#endif
+}
+
+#if CRC32_HAVE_PCLMUL
+/*
+ * Folds blocks of 16 bytes by carry-less multiplication and reduces the
+ * result to 32 bits by Barrett reduction.
+ * theLength must be a multiple of 16 and at least 64.
+ *
+ * Reference: "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ
+ * Instruction", V. Gopal et al., Intel 2009. The constants are the
+ * bit-reflected ones given at the end of the paper.
+ */
+__attribute__((target("pclmul,sse4.1"))) static uint32_t
+foldPCLMUL(uint32_t theRemainder, const byte_t* theDataPtr, int32_t theLength)
+{
+    const __m128i lK1K2 = _mm_set_epi64x(0x01c6e41596LL, 0x0154442bd4LL);
+    const __m128i lK3K4 = _mm_set_epi64x(0x00ccaa009eLL, 0x01751997d0LL);
+    const __m128i lK5K0 = _mm_set_epi64x(0x0000000000LL, 0x0163cd6124LL);
+    const __m128i lPoly = _mm_set_epi64x(0x01f7011641LL, 0x01db710641LL);
+    const __m128i lMask = _mm_setr_epi32(~0, 0, ~0, 0);
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+    // there's at least one block of 64
+    x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(theDataPtr + 0x00));
+    x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(theDataPtr + 0x10));
+    x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(theDataPtr + 0x20));
+    x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(theDataPtr + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(theRemainder));
+    theDataPtr += 64;
+    theLength -= 64;
+
+    // parallel fold blocks of 64
+    while (theLength >= 64)
+    {
+        x5 = _mm_clmulepi64_si128(x1, lK1K2, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, lK1K2, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, lK1K2, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, lK1K2, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, lK1K2, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, lK1K2, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, lK1K2, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, lK1K2, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i*>(theDataPtr + 0x00)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i*>(theDataPtr + 0x10)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i*>(theDataPtr + 0x20)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i*>(theDataPtr + 0x30)));
+        theDataPtr += 64;
+        theLength -= 64;
+    }
+
+    // fold into 128 bits
+    x5 = _mm_clmulepi64_si128(x1, lK3K4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, lK3K4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    x5 = _mm_clmulepi64_si128(x1, lK3K4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, lK3K4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+    x5 = _mm_clmulepi64_si128(x1, lK3K4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, lK3K4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    // single fold blocks of 16
+    while (theLength >= 16)
+    {
+        x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(theDataPtr));
+        x5 = _mm_clmulepi64_si128(x1, lK3K4, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, lK3K4, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+        theDataPtr += 16;
+        theLength -= 16;
+    }
+
+    // fold 128 bits to 64 bits
+    x2 = _mm_clmulepi64_si128(x1, lK3K4, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, lMask);
+    x1 = _mm_clmulepi64_si128(x1, lK5K0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Barrett reduction to 32 bits
+    x0 = _mm_and_si128(x1, lMask);
+    x0 = _mm_clmulepi64_si128(x0, lPoly, 0x10);
+    x0 = _mm_and_si128(x0, lMask);
+    x0 = _mm_clmulepi64_si128(x0, lPoly, 0x00);
+    x1 = _mm_xor_si128(x1, x0);
+
+    return _mm_extract_epi32(x1, 1);
+}
+#endif
+
+#if CRC32_HAVE_ARMV8
+/*
+ * Engine ENGINE_ARMV8_CRC32: the CRC32 instructions of ARMv8 implement
+ * exactly the reflected CRC-32-IEEE 802.3 polynomial.
+ */
+static uint32_t
+addARMv8(uint32_t theRemainder, const byte_t* theDataPtr, int32_t theLength)
+{
+    // align the pointer
+    while ((0 < theLength) && (0 != (reinterpret_cast<uintptr_t>(theDataPtr) & 7)))
+    {
+        theRemainder = __crc32b(theRemainder, *theDataPtr++);
+        theLength--;
+    }
+
+#if defined(__aarch64__)
+    while (theLength >= 8)
+    {
+        uint64_t lValue;
+        memcpy(&lValue, theDataPtr, sizeof(lValue));
+        theRemainder = __crc32d(theRemainder, lValue);
+        theDataPtr += 8;
+        theLength -= 8;
+    }
+#endif
+    while (theLength >= 4)
+    {
+        theRemainder = __crc32w(theRemainder, loadLittleEndian(theDataPtr));
+        theDataPtr += 4;
+        theLength -= 4;
+    }
+    while (0 < theLength--)
+    {
+        theRemainder = __crc32b(theRemainder, *theDataPtr++);
+    }
+    return theRemainder;
+}
+#endif
+
+/*
+ * Add some more data to compute a 32 bit CRC of several data.
+ */
+uint32_t
+CRC32::add(const void* theDataPtr, int32_t theLength)
+{
+    // check parameter. Return default if there is nothing to do.
+    if (0 == theDataPtr || 0 == theLength)
+    {
+        return 0;
+    }
+
+    // Divide the message by the polynomial.
+    mRemainder = sEngine(mRemainder, static_cast<const byte_t*>(theDataPtr), theLength);
+
+    // The final mRemainder is the CRC result.
+    mLength += theLength;
+    return (mRemainder ^ CRC32_FINAL_XOR_VALUE);
+}
+
+/*
+ * Engine ENGINE_BYTEWISE: divide the message by the polynomial, a byte at time.
+ */
+uint32_t
+CRC32::addBytewise(uint32_t theRemainder, const byte_t* theDataPtr, int32_t theLength)
+{
+    const Tables::Row_t* const lTable = sCRCTables.mRow;
+
+    for (int32_t l = 0; l < theLength; l++)
+    {
+        theRemainder = (theRemainder >> 8) ^ lTable[0].mValue[(theRemainder & 0xFF) ^ theDataPtr[l]];
+    }
+    return theRemainder;
+}
+
+/*
+ * Engine ENGINE_SLICING_BY_8: 8 bytes per iteration by 8 independent lookups.
+ */
+uint32_t
+CRC32::addSlicingBy8(uint32_t theRemainder, const byte_t* theDataPtr, int32_t theLength)
+{
+    const Tables::Row_t* const lTable = sCRCTables.mRow;
+
+    while (theLength >= 8)
+    {
+        const uint32_t lOne = loadLittleEndian(theDataPtr) ^ theRemainder;
+        const uint32_t lTwo = loadLittleEndian(theDataPtr + 4);
+
+        theRemainder = lTable[7].mValue[lOne & 0xFF] ^ lTable[6].mValue[(lOne >> 8) & 0xFF] //
+                ^ lTable[5].mValue[(lOne >> 16) & 0xFF] ^ lTable[4].mValue[lOne >> 24] //
+                ^ lTable[3].mValue[lTwo & 0xFF] ^ lTable[2].mValue[(lTwo >> 8) & 0xFF] //
+                ^ lTable[1].mValue[(lTwo >> 16) & 0xFF] ^ lTable[0].mValue[lTwo >> 24];
+        theDataPtr += 8;
+        theLength -= 8;
+    }
+    return addBytewise(theRemainder, theDataPtr, theLength);
+}
+
+/*
+ * Engine ENGINE_SLICING_BY_16: 16 bytes per iteration by 16 independent lookups.
+ */
+uint32_t
+CRC32::addSlicingBy16(uint32_t theRemainder, const byte_t* theDataPtr, int32_t theLength)
+{
+    const Tables::Row_t* const lTable = sCRCTables.mRow;
+
+    while (theLength >= 16)
+    {
+        const uint32_t lOne = loadLittleEndian(theDataPtr) ^ theRemainder;
+        const uint32_t lTwo = loadLittleEndian(theDataPtr + 4);
+        const uint32_t lThree = loadLittleEndian(theDataPtr + 8);
+        const uint32_t lFour = loadLittleEndian(theDataPtr + 12);
+
+        theRemainder = lTable[15].mValue[lOne & 0xFF] ^ lTable[14].mValue[(lOne >> 8) & 0xFF] //
+                ^ lTable[13].mValue[(lOne >> 16) & 0xFF] ^ lTable[12].mValue[lOne >> 24] //
+                ^ lTable[11].mValue[lTwo & 0xFF] ^ lTable[10].mValue[(lTwo >> 8) & 0xFF] //
+                ^ lTable[9].mValue[(lTwo >> 16) & 0xFF] ^ lTable[8].mValue[lTwo >> 24] //
+                ^ lTable[7].mValue[lThree & 0xFF] ^ lTable[6].mValue[(lThree >> 8) & 0xFF] //
+                ^ lTable[5].mValue[(lThree >> 16) & 0xFF] ^ lTable[4].mValue[lThree >> 24] //
+                ^ lTable[3].mValue[lFour & 0xFF] ^ lTable[2].mValue[(lFour >> 8) & 0xFF] //
+                ^ lTable[1].mValue[(lFour >> 16) & 0xFF] ^ lTable[0].mValue[lFour >> 24];
+        theDataPtr += 16;
+        theLength -= 16;
+    }
+    return addBytewise(theRemainder, theDataPtr, theLength);
+}
+
+/*
+ * Engine ENGINE_X86_PCLMUL: folds multiples of 16 bytes, the tail is
+ * handled by slicing-by-8.
+ */
+uint32_t
+CRC32::addPCLMUL(uint32_t theRemainder, const byte_t* theDataPtr, int32_t theLength)
+{
+#if CRC32_HAVE_PCLMUL
+    if (theLength >= 64)
+    {
+        const int32_t lFoldLength = theLength & ~15;
+        theRemainder = foldPCLMUL(theRemainder, theDataPtr, lFoldLength);
+        theDataPtr += lFoldLength;
+        theLength -= lFoldLength;
+    }
+#endif
+    return addSlicingBy8(theRemainder, theDataPtr, theLength);
+}
+
+/*
+ * Returns the engine currently used by add().
+ */
+CRC32::CRC32Engine_t
+CRC32::getEngine()
+{
+    return sEngineID;
+}
+
+/*
+ * Returns a printable name of an engine.
+ */
+const char*
+CRC32::getEngineName(CRC32Engine_t theEngine)
+{
+    switch (theEngine)
+    {
+        case ENGINE_AUTO:
+            return "auto";
+        case ENGINE_BYTEWISE:
+            return "bytewise";
+        case ENGINE_SLICING_BY_8:
+            return "slicing-by-8";
+        case ENGINE_SLICING_BY_16:
+            return "slicing-by-16";
+        case ENGINE_ARMV8_CRC32:
+            return "armv8-crc32";
+        case ENGINE_X86_PCLMUL:
+            return "x86-pclmul";
+        default:
+            return "unknown";
+    }
+}
+
+/*
+ * Checks if an engine is compiled in and supported by the CPU.
+ */
+bool
+CRC32::isEngineSupported(CRC32Engine_t theEngine)
+{
+    switch (theEngine)
+    {
+        case ENGINE_AUTO:
+        case ENGINE_BYTEWISE:
+        case ENGINE_SLICING_BY_8:
+        case ENGINE_SLICING_BY_16:
+            return true;
+
+        case ENGINE_ARMV8_CRC32:
+#if CRC32_HAVE_ARMV8 && defined(__linux__) && defined(__aarch64__)
+            return (0 != (getauxval(AT_HWCAP) & HWCAP_CRC32));
+#elif CRC32_HAVE_ARMV8 && defined(__linux__)
+            return (0 != (getauxval(AT_HWCAP2) & HWCAP2_CRC32));
+#elif CRC32_HAVE_ARMV8
+            return true; // compiled for a CPU with CRC32 instructions
+#else
+            return false;
+#endif
+
+        case ENGINE_X86_PCLMUL:
+#if CRC32_HAVE_PCLMUL
+            __builtin_cpu_init();
+            return (__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1"));
+#else
+            return false;
+#endif
+
+        default:
+            return false;
+    }
+}
+
+/*
+ * Selects the engine used by add() of all CRC32 objects.
+ */
+ErrorID_t
+CRC32::setEngine(CRC32Engine_t theEngine)
+{
+    // the fastest first. Slicing-by-8 is the portable fallback: the 16 tables
+    // of slicing-by-16 do not fit into the small data caches of our MIPS targets.
+    if (ENGINE_AUTO == theEngine)
+    {
+        if (isEngineSupported(ENGINE_X86_PCLMUL))
+        {
+            theEngine = ENGINE_X86_PCLMUL;
+        }
+        else if (isEngineSupported(ENGINE_ARMV8_CRC32))
+        {
+            theEngine = ENGINE_ARMV8_CRC32;
+        }
+        else
+        {
+            theEngine = ENGINE_SLICING_BY_8;
+        }
+    }
+
+    if (false == isEngineSupported(theEngine))
+    {
+        return ERR_UNSUPPORTED_FUNCTION;
+    }
+
+    switch (theEngine)
+    {
+        case ENGINE_BYTEWISE:
+            sEngine = addBytewise;
+            break;
+        case ENGINE_SLICING_BY_16:
+            sEngine = addSlicingBy16;
+            break;
+#if CRC32_HAVE_ARMV8
+        case ENGINE_ARMV8_CRC32:
+            sEngine = addARMv8;
+            break;
+#endif
+        case ENGINE_X86_PCLMUL:
+            sEngine = addPCLMUL;
+            break;
+        case ENGINE_SLICING_BY_8:
+        default:
+            sEngine = addSlicingBy8;
+            break;
+    }
+    sEngineID = theEngine;
+    return ERR_SUCCESS;
+}
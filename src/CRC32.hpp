@@ -1,172 +1,267 @@
-#ifndef CRC32_HPP_
-#define CRC32_HPP_
-/**
- ****************************************************************************
- *
- * Project:     Triple-IN PS Demo Program
- *
- * @file:       CRC32.hpp - 32 bit Cyclic Redundancy Code
- *
- * @author:     CBruelle
- *
- * Date:        $Date: 2015/10/23 12:23:10 $
- * SDK:         GNU gcc 4
- *
- * (c) 2005-2012 Triple-IN GmbH Hamburg, Germany
- *
- * Copyright (c) 1998 by Michael Barr.  This software is placed into
- * the public domain and may be used for any purpose.  However, this
- * notice must not be changed or removed and no warranty is either
- * expressed or implied by its publication or distribution.
- ****************************************************************************
- * Last changes:
- * 21.05.2013 CBD:
- * - Changed: conform to T-I coding style
- * - Changed: get() will not reset the CRC
- * - New: add typedefs to get CRC example code for customers.
- */
-
-#include "Global.hpp"
-
-/**
- * Class CRC32 - Cyclic Redundancy Code,
- * A table-driven implementation of 32 bit CRC-checksums that
- * conforms to the CRC-32-IEEE 802.3 Ethernet Standard.
- * <p>&nbsp;<p>
- *
- * Summary:<br>
- * A CRC is a specific checksum algorithm that is designed to detect most
- * common data errors. The theory behind the CRC is described in a number
- * of publications.<p>
- * Implements the official polynomial used by CRC-32 in
- * PKZip, WinZip and Ethernet.
- * <p>&nbsp;<p>
- *
- * State Information:<br>
- * The constructor checks if the CRC lookup table is initialized and
- * generates a lookup table for each possible byte.
- * <p>&nbsp;<p>
- *
- *
- * References to External Specifications: <br>
- * "Programming embedded Systems" by Michael Barr, O'Reilly, 1st Edition 1999.
- *
- * @ingroup common
- */
-class CRC32
-{
-    private:
-
-        /**
-         * The CRC parameters.  Currently configured for 32 bit CRC
-         * Simply modify these to switch to another CRC standard.
-         */
-        enum
-        {
-            CRC32_POLYNOMIAL = 0x04c11db7, //
-            CRC32_INITIAL_REMAINDER = 0xFFFFFFFF, //
-            CRC32_FINAL_XOR_VALUE = 0xFFFFFFFF, //
-            CRC32_WIDTH = 32, //
-            CRC32_NULL = 0
-
-        };
-
-        /** number of bytes added */
-        uint32_t mLength;
-
-        /** this remainder is used in the add() method. It is reset by getCRC32() */
-        uint32_t mRemainder;
-
-        /**  a static flag indicating if the CRC table is initialized */
-        static bool sCRC32IsInitialized;
-
-        /**
-         * An array containing the pre-computed intermediate result for each
-         * possible byte of input.  This is used to speed up the computation.
-         */
-        static uint32_t sCRCTable[256];
-
-        /**
-         * Performs a reflection on a value:
-         * swaps bit 7 with 0, 6 with 1 and so on.
-         * Reflection is a requirement to conform to the
-         * official CRC-32 standard.
-         *
-         * @param value
-         *      the value to be reflected.
-         * @param theBits
-         *      number of bits to be swapped.
-         * @return
-         *      reflected value.
-         */
-        uint32_t
-        reflect(uint32_t value, byte_t theBits);
-
-    public:
-
-        /**
-         * The constructor.
-         */
-        CRC32();
-
-        /**
-         * Destructor.
-         */
-        ~CRC32();
-
-        /**
-         * Add some more data to compute a 32 bit CRC of several data.
-         * <p>
-         * Note: you should not use this function to add little endian integers
-         * that are transmitted in big endian network byte order.<br>
-         * Use addInt() instead.
-         *
-         * @param theDataPtr -
-         *      a pointer on an array of data to add (null permitted).
-         * @param theLength -
-         *      number of bytes in the data array.
-         *
-         * @return current CRC.
-         */
-        uint32_t
-        add(const void* theDataPtr, int32_t theLength);
-
-        /**
-         * Reset the checksum to initial stage.
-         */
-        inline void
-        clear()
-        {
-            mLength = 0;
-            mRemainder = CRC32_INITIAL_REMAINDER;
-        }
-
-        /**
-         * Compute the 32 bit CRC for data which are previously added by add().
-         *
-         * @return the 32 bit CRC checksum.
-         */
-        inline uint32_t
-        get()
-        {
-            return (mRemainder ^ CRC32_FINAL_XOR_VALUE);
-        }
-
-        /**
-         * Compute a 32 bit CRC for the given data array.
-         *
-         * @param data - a pointer on an array of data.
-         * @param len - number of bytes in the data array.
-         *
-         * @return the 32 bit CRC checksum.
-         */
-        inline uint32_t
-        get(const void* data, int32_t len)
-        {
-            clear();
-            return add(data, len);
-        }
-
-};
-
-#endif /*CRC32_HPP_*/
+#ifndef CRC32_HPP_
+#define CRC32_HPP_
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       CRC32.hpp - 32 bit Cyclic Redundancy Code
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2005-2012 Triple-IN GmbH Hamburg, Germany
+ *
+ * Copyright (c) 1998 by Michael Barr.  This software is placed into
+ * the public domain and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ ****************************************************************************
+ * Last changes:
+ * 21.05.2013 CBD:
+ * - Changed: conform to T-I coding style
+ * - Changed: get() will not reset the CRC
+ * - New: add typedefs to get CRC example code for customers.
+ */
+
+extern "C"
+{
+#include "ErrorID.h"
+}
+#include "Global.hpp"
+
+/**
+ * Class CRC32 - Cyclic Redundancy Code,
+ * A table-driven implementation of 32 bit CRC-checksums that
+ * conforms to the CRC-32-IEEE 802.3 Ethernet Standard.
+ * <p>&nbsp;<p>
+ *
+ * Summary:<br>
+ * A CRC is a specific checksum algorithm that is designed to detect most
+ * common data errors. The theory behind the CRC is described in a number
+ * of publications.<p>
+ * Implements the official polynomial used by CRC-32 in
+ * PKZip, WinZip and Ethernet.
+ * <p>&nbsp;<p>
+ *
+ * State Information:<br>
+ * The lookup tables for each possible byte are generated at compile time.
+ * The fastest CRC engine supported by the CPU is selected at program
+ * start: slicing-by-8 or slicing-by-16 tables, or the CRC32 instructions
+ * of ARMv8 and the carry-less multiplication of x86 processors, if available.
+ * <p>&nbsp;<p>
+ *
+ *
+ * References to External Specifications: <br>
+ * "Programming embedded Systems" by Michael Barr, O'Reilly, 1st Edition 1999.
+ *
+ * @ingroup common
+ */
+class CRC32
+{
+    public:
+
+        /**
+         * Implementations of the CRC computation used by add().
+         * All engines produce bit-exact results; they differ in speed only.
+         */
+        enum CRC32Engine_t
+        {
+            /** select the fastest engine supported by the CPU */
+            ENGINE_AUTO, //
+
+            /** classic table lookup, one byte at a time */
+            ENGINE_BYTEWISE, //
+
+            /** 8 lookup tables, 8 bytes per iteration */
+            ENGINE_SLICING_BY_8, //
+
+            /** 16 lookup tables, 16 bytes per iteration */
+            ENGINE_SLICING_BY_16, //
+
+            /** ARMv8 CRC32 instructions */
+            ENGINE_ARMV8_CRC32, //
+
+            /** x86 carry-less multiplication (PCLMULQDQ) folding */
+            ENGINE_X86_PCLMUL, //
+
+            NUMBER_OF_ENGINES
+        };
+
+    private:
+
+        /**
+         * The CRC parameters.  Currently configured for 32 bit CRC
+         * Simply modify these to switch to another CRC standard.
+         */
+        enum
+        {
+            CRC32_POLYNOMIAL = 0x04c11db7, //
+            CRC32_INITIAL_REMAINDER = 0xFFFFFFFF, //
+            CRC32_FINAL_XOR_VALUE = 0xFFFFFFFF, //
+            CRC32_WIDTH = 32, //
+            CRC32_NULL = 0, //
+
+            /** number of slicing tables */
+            CRC32_TABLES = 16
+
+        };
+
+        /**
+         * Signature of a CRC engine: divides theLength bytes by the polynomial
+         * and returns the new remainder.
+         */
+        typedef uint32_t
+        (*Engine_t)(uint32_t theRemainder, const byte_t* theDataPtr, int32_t theLength);
+
+        /** number of bytes added */
+        uint32_t mLength;
+
+        /** this remainder is used in the add() method. It is reset by getCRC32() */
+        uint32_t mRemainder;
+
+        /** the engine used by add(); the fastest one is selected at program start */
+        static Engine_t sEngine;
+
+        /** ID of the engine used by add() */
+        static CRC32Engine_t sEngineID;
+
+        /**
+         * The lookup tables, generated at compile time by CRC32.cpp.
+         * Table 0 contains the pre-computed intermediate result for each
+         * possible byte of input, table n advances a byte by n further
+         * zero bytes (slicing-by-n).
+         */
+        struct Tables;
+
+        /** the constant lookup tables; no initialization at runtime */
+        static const Tables sCRCTables;
+
+        /** Engine ENGINE_BYTEWISE. */
+        static uint32_t
+        addBytewise(uint32_t theRemainder, const byte_t* theDataPtr, int32_t theLength);
+
+        /** Engine ENGINE_SLICING_BY_8. */
+        static uint32_t
+        addSlicingBy8(uint32_t theRemainder, const byte_t* theDataPtr, int32_t theLength);
+
+        /** Engine ENGINE_SLICING_BY_16. */
+        static uint32_t
+        addSlicingBy16(uint32_t theRemainder, const byte_t* theDataPtr, int32_t theLength);
+
+        /** Engine ENGINE_X86_PCLMUL; the tail is handled by slicing-by-8. */
+        static uint32_t
+        addPCLMUL(uint32_t theRemainder, const byte_t* theDataPtr, int32_t theLength);
+
+    public:
+
+        /**
+         * The constructor.
+         * Does nothing but reset the remainder; the lookup tables are
+         * constant data, so CRC32 objects may be created by any thread.
+         */
+        inline
+        CRC32() :
+                // no base class constructor.
+                mLength(0), //
+                mRemainder(CRC32_INITIAL_REMAINDER)
+        {
+            // nothing more to do.
+        }
+
+        /**
+         * Add some more data to compute a 32 bit CRC of several data.
+         * <p>
+         * Note: you should not use this function to add little endian integers
+         * that are transmitted in big endian network byte order.<br>
+         * Use addInt() instead.
+         *
+         * @param theDataPtr -
+         *      a pointer on an array of data to add (null permitted).
+         * @param theLength -
+         *      number of bytes in the data array.
+         *
+         * @return current CRC.
+         */
+        uint32_t
+        add(const void* theDataPtr, int32_t theLength);
+
+        /**
+         * Reset the checksum to initial stage.
+         */
+        inline void
+        clear()
+        {
+            mLength = 0;
+            mRemainder = CRC32_INITIAL_REMAINDER;
+        }
+
+        /**
+         * Compute the 32 bit CRC for data which are previously added by add().
+         *
+         * @return the 32 bit CRC checksum.
+         */
+        inline uint32_t
+        get()
+        {
+            return (mRemainder ^ CRC32_FINAL_XOR_VALUE);
+        }
+
+        /**
+         * Compute a 32 bit CRC for the given data array.
+         *
+         * @param data - a pointer on an array of data.
+         * @param len - number of bytes in the data array.
+         *
+         * @return the 32 bit CRC checksum.
+         */
+        inline uint32_t
+        get(const void* data, int32_t len)
+        {
+            clear();
+            return add(data, len);
+        }
+
+        /**
+         * Returns the engine currently used by add().
+         */
+        static CRC32Engine_t
+        getEngine();
+
+        /**
+         * Returns a printable name of an engine.
+         *
+         * @param theEngine
+         *      the engine ID.
+         */
+        static const char*
+        getEngineName(CRC32Engine_t theEngine);
+
+        /**
+         * Checks if an engine is compiled in and supported by the CPU.
+         *
+         * @param theEngine
+         *      the engine ID; ENGINE_AUTO is always supported.
+         */
+        static bool
+        isEngineSupported(CRC32Engine_t theEngine);
+
+        /**
+         * Selects the engine used by add() of all CRC32 objects.
+         * Should be called once before any CRC is computed; mainly used
+         * to compare the engines.
+         *
+         * @param theEngine
+         *      the engine ID; ENGINE_AUTO selects the fastest one.
+         * @return
+         *      ERR_SUCCESS, or ERR_UNSUPPORTED_FUNCTION if the engine
+         *      is not available on this machine.
+         */
+        static ErrorID_t
+        setEngine(CRC32Engine_t theEngine);
+
+};
+
+#endif /*CRC32_HPP_*/
@@ -21,6 +21,8 @@
  */
 
 #include "CommandBase.hpp"
+#include "ByteOrder.hpp"
+#include "MonotonicClock.hpp"
 
 #if defined(__WIN32__) || (defined(__CYGWIN__) && !defined(_WIN32))
 	#include "WinClientSocket.hpp"
@@ -35,6 +37,8 @@ CommandBase::CommandBase(IDataStream & theDataStream) :
         mBuffer(), //
         mBytesReceived(0), //
         mBufferPtr(), //
+        mFirstByteTime(0), //
+        mLastByteTime(0), //
         mDataStream(theDataStream)
 {
     mBufferPtr.asCharPtr = mBuffer;
@@ -76,6 +80,12 @@ CommandBase::checkCRC()
 {
     CRC32 lCRC;
 
+    // too short for command ID, length and CRC
+    if (static_cast<int32_t>(3 * sizeof(int32_t)) > mBytesReceived)
+    {
+        return ERR_CRC;
+    }
+
     // typesafe cast. CRC in network byte order is expected in the last 4 bytes of the buffer
     cast_ptr_t lCRCReceivedPtr = { &mBuffer[mBytesReceived - 4] };
     const uint32_t lCRCExpected = htonl(*lCRCReceivedPtr.asIntegerPtr);
@@ -117,10 +127,7 @@ CommandBase::convertHostToNetwork(void* theBuffer, int32_t theBufferLength)
     const cast_ptr_t lData = { theBuffer };
     const int32_t lIntegerToConvert = (theBufferLength - COMMAND_ID_SIZE) / sizeof(int32_t);
 
-    for (int32_t l = 1; l < lIntegerToConvert; l++)
-    {
-        lData.asIntegerPtr[l] = htonl(lData.asIntegerPtr[l]);
-    }
+    ByteOrder::swap(&lData.asIntegerPtr[1], lIntegerToConvert - 1);
 }
 
 /**
@@ -133,36 +140,54 @@ void
 CommandBase::convertNetworkToHost(void* theBuffer, int32_t theBufferLength)
 {
     // skip command ID ASCII bytes
-    cast_ptr_t lData = { theBuffer };
+    const cast_ptr_t lData = { theBuffer };
     const int32_t lIntegerToConvert = (theBufferLength - COMMAND_ID_SIZE) / sizeof(int32_t);
 
-    for (int32_t l = 1; l < lIntegerToConvert; l++)
+    ByteOrder::swap(&lData.asIntegerPtr[1], lIntegerToConvert - 1);
+}
+
+/*
+ * Transmits a buffer with a command.
+ */
+ErrorID_t
+CommandBase::writeCommand(void* theCommandPtr, int32_t theCommandSize)
+{
+    const int32_t lBytesWritten = mDataStream.write(theCommandPtr, theCommandSize);
+    if (ERR_END_OF_STREAM == lBytesWritten)
     {
-        lData.asIntegerPtr[l] = ntohl(lData.asIntegerPtr[l]);
+        return ERR_END_OF_STREAM;
     }
+    if (0 > lBytesWritten)
+    {
+        return ERR_WRITE;
+    }
+    return ERR_SUCCESS;
 }
 
 /*
- * Transmits a buffer with a command and
- * receives the result.
+ * Receives a response.
  * Checks the data received for CRC errors and ERR responses.
  * Received data are stored in mBuffer.
  */
 ErrorID_t
-CommandBase::sendCommand(void* theCommandPtr, int32_t theCommandSize)
+CommandBase::readResponse()
 {
     ErrorID_t result = ERR_SUCCESS;
 
     try
     {
-        // send command
-        if (0 > mDataStream.write(theCommandPtr, theCommandSize))
-        {
-            throw ERR_WRITE;
-        }
-
         // receive response
         mBytesReceived = mDataStream.read(mBuffer, sizeof(mBuffer));
+        mLastByteTime = MonotonicClock::getNanoseconds();
+        mFirstByteTime = mDataStream.getFirstByteTime();
+        if ((0 == mFirstByteTime) || (mFirstByteTime > mLastByteTime))
+        {
+            mFirstByteTime = mLastByteTime;
+        }
+        if (ERR_END_OF_STREAM == mBytesReceived)
+        {
+            throw ERR_END_OF_STREAM;
+        }
         if (0 > mBytesReceived)
         {
             throw ERR_READ;
@@ -183,3 +208,21 @@ CommandBase::sendCommand(void* theCommandPtr, int32_t theCommandSize)
     }
     return result;
 }
+
+/*
+ * Transmits a buffer with a command and
+ * receives the result.
+ * Checks the data received for CRC errors and ERR responses.
+ * Received data are stored in mBuffer.
+ */
+ErrorID_t
+CommandBase::sendCommand(void* theCommandPtr, int32_t theCommandSize)
+{
+    ErrorID_t result = writeCommand(theCommandPtr, theCommandSize);
+
+    if (ERR_SUCCESS == result)
+    {
+        result = readResponse();
+    }
+    return result;
+}
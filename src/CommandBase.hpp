@@ -67,6 +67,12 @@ class CommandBase
         /** casting pointer on the buffer */
         cast_ptr_t mBufferPtr;
 
+        /** time in ns when the first byte of the response arrived */
+        uint64_t mFirstByteTime;
+
+        /** time in ns when the response was complete */
+        uint64_t mLastByteTime;
+
         /**
          * the data stream to read and write bytes.
          */
@@ -111,6 +117,31 @@ class CommandBase
         virtual ErrorID_t
         checkErrors();
 
+        /**
+         * Transmits a buffer with a command without waiting for the response.
+         *
+         * @param theCommandPtr
+         *      Pointer at a buffer with the command data to be send.
+         * @param theCommandSize
+         *      Size of the command data buffer.
+         *
+         * @return
+         *      ERR_SUCCESS if OK, otherwise a negative error code.
+         */
+        virtual ErrorID_t
+        writeCommand(void* theCommandPtr, int32_t theCommandSize);
+
+        /**
+         * Receives a response of a command sent before.
+         * Checks the data received for CRC errors and ERR responses.
+         * Received data are stored in mBuffer.
+         *
+         * @return
+         *      ERR_SUCCESS if OK, otherwise a negative error code.
+         */
+        virtual ErrorID_t
+        readResponse();
+
         /**
          * Transmits a buffer with a command and
          * receives the result.
@@ -151,11 +182,36 @@ class CommandBase
         virtual
         ~CommandBase();
 
+        /**
+         * Returns the time when the first byte of the last response arrived.
+         * It is the time of the last byte if the data stream does not tell.
+         *
+         * @return
+         *      the time in ns of the MonotonicClock.
+         */
+        uint64_t
+        getFirstByteTime() const
+        {
+            return mFirstByteTime;
+        }
+
+        /**
+         * Returns the time when the last response was complete.
+         *
+         * @return
+         *      the time in ns of the MonotonicClock.
+         */
+        uint64_t
+        getLastByteTime() const
+        {
+            return mLastByteTime;
+        }
+
         /**
          * Converts the integer values of a transmitter buffer
          * from host byte order to network byte order,
          * except of the first 4 bytes. These first ASCII bytes contain
-         * the command ID.
+         * the command ID. Uses the fastest engine of ByteOrder.
          *
          * @param theBuffer
          *      Pointer at the transmitter buffer.
@@ -169,7 +225,7 @@ class CommandBase
          * Converts the integer values of a receiver buffer
          * from network byte order to host byte order,
          * except of the first 4 bytes. These first ASCII bytes contain
-         * the command ID.
+         * the command ID. Uses the fastest engine of ByteOrder.
          *
          * @param theBuffer
          *      Pointer at the receiver buffer.
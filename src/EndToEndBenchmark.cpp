@@ -0,0 +1,465 @@
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       EndToEndBenchmark.cpp
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ *
+ ****************************************************************************
+ */
+
+#if __linux__
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <ctime>
+#include <thread>
+#include <sys/resource.h>
+
+#include "EndToEndBenchmark.hpp"
+#include "GSC2Command.hpp"
+#include "GSCNCommand.hpp"
+#include "LinuxClientSocket.hpp"
+#include "LinuxClientUART.hpp"
+#include "LinuxPseudoTerminal.hpp"
+#include "LinuxServerSocket.hpp"
+#include "ProgramVersion.hpp"
+#include "RelayServer.hpp"
+#include "ScanView.hpp"
+#include "SensorSimulator.hpp"
+#include "SimulatorServer.hpp"
+
+/* the names of the scenarios, in the order of Scenario_t */
+static const char* const sScenarioNames[EndToEndBenchmark::NUMBER_OF_SCENARIOS] = { "NET", "UART", "RELAY", "GSC2" };
+
+/* the columns of the results */
+static const char* const sHeader = "scenario,points,echoes,content,requests,scans,lost,lost_rate,scans_per_s,"
+        "p50_us,p99_us,p999_us,max_us,cpu_us_per_scan,thread_cpu_us_per_scan,version\r\n";
+
+/*
+ * Standard constructor.
+ */
+EndToEndBenchmark::EndToEndBenchmark(SensorSimulator& theSimulator, FILE* theTerminalLogFile) :
+        mSimulator(theSimulator), //
+        mNumberOfRequests(1000), //
+        mResultFile(0), //
+        mTerminalLogFile(theTerminalLogFile), //
+        mBaudRate(115200), //
+        mIsHeaderPrinted(false)
+{
+    mSimulator.setScanRate(0);
+}
+
+/*
+ * Standard destructor.
+ */
+EndToEndBenchmark::~EndToEndBenchmark()
+{
+    // nothing to be done.
+}
+
+/*
+ * Returns the time of the monotonic clock in ns.
+ */
+uint64_t
+EndToEndBenchmark::getNanoseconds()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * Returns the user and system time of the process or of the calling thread.
+ */
+uint64_t
+EndToEndBenchmark::getCPUTime(bool theIsThread)
+{
+    struct rusage lUsage;
+
+    getrusage(theIsThread ? RUSAGE_THREAD : RUSAGE_SELF, &lUsage);
+    return (lUsage.ru_utime.tv_sec + lUsage.ru_stime.tv_sec) * 1000000ULL + lUsage.ru_utime.tv_usec
+            + lUsage.ru_stime.tv_usec;
+}
+
+/*
+ * Returns a percentile of the sorted latencies in us by the nearest rank.
+ */
+double
+EndToEndBenchmark::getPercentile(const std::vector<uint64_t>& theLatencies, double thePercentile)
+{
+    if (theLatencies.empty())
+    {
+        return 0.0;
+    }
+    size_t lRank = static_cast<size_t>(thePercentile * theLatencies.size() / 100.0 + 0.999999);
+    lRank = (1 > lRank) ? 1 : ((theLatencies.size() < lRank) ? theLatencies.size() : lRank);
+    return theLatencies[lRank - 1] / 1000.0;
+}
+
+/*
+ * Writes a line of text to the console and the log file.
+ */
+void
+EndToEndBenchmark::log(const char* theTextLine)
+{
+    // write to file
+    if (0 != mTerminalLogFile)
+    {
+        fputs(theTextLine, mTerminalLogFile);
+    }
+
+    // write to console
+    fputs(theTextLine, stdout);
+}
+
+/*
+ * Finds a scenario by its name.
+ */
+ErrorID_t
+EndToEndBenchmark::findScenario(const char* theName, Scenario_t& theScenario)
+{
+    for (int32_t l = 0; l < NUMBER_OF_SCENARIOS; l++)
+    {
+        if (0 == strcmp(theName, sScenarioNames[l]))
+        {
+            theScenario = static_cast<Scenario_t>(l);
+            return ERR_SUCCESS;
+        }
+    }
+    return ERR_INVALID_PARAMETER;
+}
+
+/*
+ * Defines the number of requests measured per scenario.
+ */
+ErrorID_t
+EndToEndBenchmark::setNumberOfRequests(int32_t theNumberOfRequests)
+{
+    if (1 > theNumberOfRequests)
+    {
+        return ERR_INVALID_PARAMETER;
+    }
+    mNumberOfRequests = theNumberOfRequests;
+    return ERR_SUCCESS;
+}
+
+/*
+ * Defines the baud rate of the UART scenario.
+ */
+ErrorID_t
+EndToEndBenchmark::setBaudRate(uint32_t theBaudRate)
+{
+    if (0 == theBaudRate)
+    {
+        return ERR_INVALID_PARAMETER;
+    }
+    mBaudRate = theBaudRate;
+    return ERR_SUCCESS;
+}
+
+/*
+ * Defines a file to append the results to.
+ */
+void
+EndToEndBenchmark::setResultFile(FILE* theResultFile)
+{
+    mResultFile = theResultFile;
+
+    // a new file gets the header
+    if ((0 != mResultFile) && (0 == fseek(mResultFile, 0, SEEK_END)) && (0 == ftell(mResultFile)))
+    {
+        fputs(sHeader, mResultFile);
+    }
+}
+
+/*
+ * Requests scans one after the other, like the scan loops do, and
+ * measures the time from the request to the verified response.
+ * A request without valid response within REQUEST_TIMEOUT counts as lost.
+ */
+void
+EndToEndBenchmark::measure(IDataStream& theDataStream, bool theIsGSC2, Result_t& theResult)
+{
+    GSCNCommand lGSCNCommand(theDataStream);
+    GSC2Command lGSC2Command(theDataStream);
+    ScanView lScanView;
+
+    theResult.mLatencies.reserve(mNumberOfRequests);
+
+    uint64_t lStartTime = 0;
+    uint64_t lProcessTime = 0;
+    uint64_t lThreadTime = 0;
+    for (int32_t l = -WARM_UP_REQUESTS; l < mNumberOfRequests; l++)
+    {
+        if (0 == l)
+        {
+            lProcessTime = getCPUTime(false);
+            lThreadTime = getCPUTime(true);
+            lStartTime = getNanoseconds();
+        }
+
+        const uint64_t lRequestTime = getNanoseconds();
+        const ErrorID_t result = theIsGSC2 ?
+                lGSC2Command.performCommand(GSC2_SCAN_AVG_NUMBER, GSC2_POINT_AVG_NUMBER, lScanView, 0) :
+                lGSCNCommand.performCommand(0, lScanView, 0);
+        const uint64_t lResponseTime = getNanoseconds();
+
+        if (0 <= l)
+        {
+            theResult.mNumberOfRequests++;
+            if (ERR_SUCCESS == result)
+            {
+                theResult.mNumberOfScans++;
+                theResult.mLatencies.push_back(lResponseTime - lRequestTime);
+                theResult.mWaitTime += theIsGSC2 ?
+                        lGSC2Command.getLastByteTime() - lGSC2Command.getFirstByteTime() :
+                        lGSCNCommand.getLastByteTime() - lGSCNCommand.getFirstByteTime();
+            }
+        }
+    }
+
+    theResult.mElapsed = getNanoseconds() - lStartTime;
+    theResult.mProcessTime = getCPUTime(false) - lProcessTime;
+    theResult.mThreadTime = getCPUTime(true) - lThreadTime;
+}
+
+/*
+ * Runs a scenario. The simulator, and the relay for RELAY and GSC2,
+ * serve on threads of their own until the measurement is done.
+ */
+ErrorID_t
+EndToEndBenchmark::runScenario(Scenario_t theScenario, Result_t& theResult)
+{
+    const bool lIsRelay = (SCENARIO_RELAY == theScenario) || (SCENARIO_GSC2 == theScenario);
+    std::atomic<bool> lIsRunning(true);
+    ServerSocket lSimulatorSocket;
+    PseudoTerminal lTerminal;
+    SimulatorServer lSimulatorServer(lSimulatorSocket, mSimulator);
+    ServerSocket lRelaySocket;
+    ClientSocket lSensorSocket;
+    RelayServer lRelayServer(lRelaySocket, lSensorSocket);
+    ClientSocket lClientSocket;
+    ClientUART lClientUART;
+    ErrorID_t result = ERR_SUCCESS;
+
+    // the simulator
+    lSimulatorSocket.setPort(SIMULATOR_PORT);
+    if (ERR_SUCCESS != lSimulatorSocket.open())
+    {
+        return ERR_IO;
+    }
+    if (SCENARIO_UART == theScenario)
+    {
+        if (ERR_SUCCESS != lTerminal.open())
+        {
+            return ERR_IO;
+        }
+        lSimulatorServer.setTerminal(&lTerminal);
+    }
+    std::thread lSimulatorThread(&SimulatorServer::serve, &lSimulatorServer, std::cref(lIsRunning));
+
+    // the relay in front of the simulator
+    std::thread lRelayThread;
+    if (lIsRelay)
+    {
+        lRelaySocket.setPort(RELAY_PORT);
+        lSensorSocket.setClientIPAddress(0, 0);
+        lSensorSocket.setServerIPAddress("127.0.0.1", SIMULATOR_PORT);
+        lSensorSocket.setTimeout(0);
+        lSensorSocket.setBufferSizes(SOCKET_RECEIVE_BUFFER_SIZE, 0);
+        if ((ERR_SUCCESS != lRelaySocket.open()) || (ERR_SUCCESS != lSensorSocket.open()))
+        {
+            result = ERR_IO;
+        }
+        else
+        {
+            lRelayThread = std::thread(&RelayServer::serve, &lRelayServer, std::cref(lIsRunning));
+        }
+    }
+
+    // the client
+    if (ERR_SUCCESS == result)
+    {
+        if (SCENARIO_UART == theScenario)
+        {
+            result = lClientUART.config(lTerminal.getDeviceName(), mBaudRate, REQUEST_TIMEOUT, 0);
+            if (ERR_SUCCESS == result)
+            {
+                result = lClientUART.open();
+                theResult.mBaudRate = lClientUART.getBaudRate();
+            }
+        }
+        else
+        {
+            lClientSocket.setClientIPAddress(0, 0);
+            lClientSocket.setServerIPAddress("127.0.0.1", lIsRelay ? RELAY_PORT : SIMULATOR_PORT);
+            lClientSocket.setTimeout(REQUEST_TIMEOUT);
+            lClientSocket.setBufferSizes(SOCKET_RECEIVE_BUFFER_SIZE, 0);
+            result = lClientSocket.open();
+        }
+    }
+
+    if (ERR_SUCCESS == result)
+    {
+        if (SCENARIO_UART == theScenario)
+        {
+            measure(lClientUART, false, theResult);
+        }
+        else
+        {
+            measure(lClientSocket, SCENARIO_GSC2 == theScenario, theResult);
+        }
+    }
+
+    // stop the servers; they check the flag at least every WAIT_TIME ms
+    lIsRunning.store(false);
+    if (lRelayThread.joinable())
+    {
+        lRelayThread.join();
+    }
+    lSimulatorThread.join();
+    theResult.mNumberOfDrops = lClientSocket.getNumberOfDrops() + lSensorSocket.getNumberOfDrops();
+
+    if (lClientUART.isOpen())
+    {
+        lClientUART.close();
+    }
+    lClientSocket.close();
+    lSensorSocket.close();
+    lRelaySocket.close();
+    lTerminal.close();
+    lSimulatorSocket.close();
+    return result;
+}
+
+/*
+ * Prints the results of a scenario and appends them to the result file.
+ */
+void
+EndToEndBenchmark::report(Scenario_t theScenario, Result_t& theResult)
+{
+    string1024_t lTextLine;
+    const uint32_t lLost = theResult.mNumberOfRequests - theResult.mNumberOfScans;
+    const double lScans = (0 < theResult.mNumberOfScans) ? theResult.mNumberOfScans : 1;
+
+    std::sort(theResult.mLatencies.begin(), theResult.mLatencies.end());
+    snprintf(lTextLine, sizeof(lTextLine), "%s,%d,%d,%d,%u,%u,%u,%.6f,%.1f,%.1f,%.1f,%.1f,%.1f,%.2f,%.2f,%s%s\r\n",
+            sScenarioNames[theScenario], mSimulator.getNumberOfPoints(), mSimulator.getNumberOfEchoes(),
+            mSimulator.getDataContent(), theResult.mNumberOfRequests, theResult.mNumberOfScans, lLost,
+            static_cast<double>(lLost) / theResult.mNumberOfRequests,
+            theResult.mNumberOfScans * 1e9 / ((0 < theResult.mElapsed) ? theResult.mElapsed : 1),
+            getPercentile(theResult.mLatencies, 50.0), getPercentile(theResult.mLatencies, 99.0),
+            getPercentile(theResult.mLatencies, 99.9), getPercentile(theResult.mLatencies, 100.0),
+            theResult.mProcessTime / lScans, theResult.mThreadTime / lScans, PROGRAM_MAJOR_VERSION,
+            PROGRAM_MINOR_VERSION);
+
+    if (!mIsHeaderPrinted)
+    {
+        log(sHeader);
+        mIsHeaderPrinted = true;
+    }
+    log(lTextLine);
+    if (0 != mResultFile)
+    {
+        fputs(lTextLine, mResultFile);
+        fflush(mResultFile);
+    }
+
+    // the pseudo terminal is not slowed down to the baud rate, a UART is
+    if (0 != theResult.mBaudRate)
+    {
+        const int32_t lBytes = mSimulator.getScanFrameSize() + GSCN_REQUEST_SIZE;
+        const double lLineTime = static_cast<double>(lBytes) * UART_BITS_PER_BYTE / theResult.mBaudRate;
+        snprintf(lTextLine, sizeof(lTextLine), "%s at %u baud: %d bytes per scan take %.2f ms on the line, "
+                "at most %.1f scans/s\r\n", sScenarioNames[theScenario], theResult.mBaudRate, lBytes,
+                lLineTime * 1000.0, 1.0 / lLineTime);
+        log(lTextLine);
+    }
+
+    // the kernel stamps a datagram when it arrives: the time in the socket
+    else
+    {
+        snprintf(lTextLine, sizeof(lTextLine), "%s: responses waited %.1f us in the socket on average, "
+                "%u datagrams dropped by the kernel\r\n", sScenarioNames[theScenario],
+                theResult.mWaitTime / lScans / 1000.0, theResult.mNumberOfDrops);
+        log(lTextLine);
+    }
+}
+
+/*
+ * Runs a scenario and prints the results.
+ */
+ErrorID_t
+EndToEndBenchmark::run(Scenario_t theScenario)
+{
+    string1024_t lTextLine;
+    Result_t lResult = Result_t();
+
+    // the relay and the UART client handle frames up to their frame size only
+    const bool lIsRelay = (SCENARIO_RELAY == theScenario) || (SCENARIO_GSC2 == theScenario);
+    const int32_t lFrameSize = lIsRelay ? static_cast<int32_t>(RelayServer::FRAME_SIZE) :
+            ((SCENARIO_UART == theScenario) ? static_cast<int32_t>(UART_FRAME_SIZE) : 0);
+    if ((0 < lFrameSize) && (lFrameSize < mSimulator.getScanFrameSize()))
+    {
+        snprintf(lTextLine, sizeof(lTextLine), "%s skipped: a scan of %d bytes exceeds the frame size "
+                "of %d bytes\r\n", sScenarioNames[theScenario], mSimulator.getScanFrameSize(), lFrameSize);
+        log(lTextLine);
+        return ERR_SUCCESS;
+    }
+
+    // GSC2 averages the values of all echoes as points but keeps the number of echoes
+    if ((SCENARIO_GSC2 == theScenario) && (1 < mSimulator.getNumberOfEchoes()))
+    {
+        snprintf(lTextLine, sizeof(lTextLine), "%s skipped: the averaging supports scans of one echo only\r\n",
+                sScenarioNames[theScenario]);
+        log(lTextLine);
+        return ERR_SUCCESS;
+    }
+
+    const ErrorID_t result = runScenario(theScenario, lResult);
+    if (ERR_SUCCESS != result)
+    {
+        snprintf(lTextLine, sizeof(lTextLine), "%s failed with error %d\r\n", sScenarioNames[theScenario],
+                static_cast<int32_t>(result));
+        log(lTextLine);
+        return result;
+    }
+    report(theScenario, lResult);
+    return ERR_SUCCESS;
+}
+
+/*
+ * Runs all scenarios.
+ */
+ErrorID_t
+EndToEndBenchmark::runAll()
+{
+    ErrorID_t result = ERR_SUCCESS;
+
+    for (int32_t l = 0; l < NUMBER_OF_SCENARIOS; l++)
+    {
+        const ErrorID_t lScenarioResult = run(static_cast<Scenario_t>(l));
+        if (ERR_SUCCESS == result)
+        {
+            result = lScenarioResult;
+        }
+    }
+    return result;
+}
+
+#endif
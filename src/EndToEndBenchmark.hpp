@@ -0,0 +1,310 @@
+#ifndef ENDTOENDBENCHMARK_HPP_
+#define ENDTOENDBENCHMARK_HPP_
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       EndToEndBenchmark.hpp - Measures scan requests against a local simulator.
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ ****************************************************************************
+ */
+
+#if defined(__linux__)
+
+#include <cstdio>
+#include <vector>
+extern "C"
+{
+#include "ErrorID.h"
+}
+#include "Global.hpp"
+#include "UARTFramer.hpp"
+
+class IDataStream;
+class SensorSimulator;
+
+/**
+ * Class EndToEndBenchmark - measures the scan path from request to parsed scan.
+ * <p>&nbsp;<p>
+ * A SensorSimulator is served on a thread of its own; the benchmark sends
+ * scan requests to it and waits for each response, like the scan loops do.
+ * The scenarios are:
+ * <ul>
+ * <li>NET: GSCN by UDP.
+ * <li>UART: GSCN by the pseudo terminal of the simulator. The baud rate
+ * is set like on a real UART, also above 460800 by termios2. A pseudo
+ * terminal does not slow down to it, so the time a scan would take on
+ * the line at that rate is reported in addition.
+ * <li>RELAY: GSCN by UDP through a RelayServer.
+ * <li>GSC2: GSC2 by UDP through a RelayServer, which averages the scans.
+ * </ul>
+ * The simulator measures a new scan per request, so the rate is limited
+ * by the request path only.
+ * <p>
+ * Each scenario reports the scans per second, the latency percentiles of
+ * the requests in us, the CPU time per scan of the process and of the
+ * requesting thread, and the rate of the requests without valid scan.
+ * The results are written as comma separated values with one line per
+ * scenario, so they can be collected for several scan formats and
+ * program versions.
+ * <p>
+ * Started by "PSDemoProgram E2E".
+ */
+class EndToEndBenchmark
+{
+    public:
+
+        /** class constants */
+        enum EndToEndBenchmarkConstants_t
+        {
+            /** UDP port of the simulator */
+            SIMULATOR_PORT = 41024,
+
+            /** UDP port of the relay */
+            RELAY_PORT = 41025,
+
+            /** largest frame ClientUART receives */
+            UART_FRAME_SIZE = UARTFramer::MAX_FRAME_SIZE,
+
+            /** requests before the measurement */
+            WARM_UP_REQUESTS = 50,
+
+            /** scans averaged by GSC2 */
+            GSC2_SCAN_AVG_NUMBER = 4,
+
+            /** points averaged by GSC2 */
+            GSC2_POINT_AVG_NUMBER = 2,
+
+            /** timeout of a request in s */
+            REQUEST_TIMEOUT = 1,
+
+            /** size of a GSCN request in bytes */
+            GSCN_REQUEST_SIZE = 16,
+
+            /** bits per byte on the UART: start bit, 8 data bits, stop bit */
+            UART_BITS_PER_BYTE = 10,
+
+            /** receive buffer of the sockets in bytes */
+            SOCKET_RECEIVE_BUFFER_SIZE = 1024 * 1024
+        };
+
+        /** the scenarios */
+        enum Scenario_t
+        {
+            SCENARIO_NET, //
+            SCENARIO_UART, //
+            SCENARIO_RELAY, //
+            SCENARIO_GSC2, //
+            NUMBER_OF_SCENARIOS
+        };
+
+    private:
+
+        /** the results of a scenario */
+        struct Result_t
+        {
+                /** number of requests measured */
+                uint32_t mNumberOfRequests;
+
+                /** number of valid scans received */
+                uint32_t mNumberOfScans;
+
+                /** duration of the measurement in ns */
+                uint64_t mElapsed;
+
+                /** CPU time of the process in us */
+                uint64_t mProcessTime;
+
+                /** CPU time of the requesting thread in us */
+                uint64_t mThreadTime;
+
+                /** baud rate applied to the UART, or 0 */
+                uint32_t mBaudRate;
+
+                /** sum of the times in ns from the first byte of a response
+                 *  received to its end: the time in the socket, or on the line */
+                uint64_t mWaitTime;
+
+                /** number of datagrams dropped by the kernel, or 0 */
+                uint32_t mNumberOfDrops;
+
+                /** latency of each answered request in ns */
+                std::vector<uint64_t> mLatencies;
+        };
+
+        /** the simulated sensor */
+        SensorSimulator& mSimulator;
+
+        /** number of requests measured per scenario */
+        int32_t mNumberOfRequests;
+
+        /** file to append the results to, or 0 */
+        FILE* mResultFile;
+
+        /** file to log the console output, or 0 */
+        FILE* mTerminalLogFile;
+
+        /** baud rate of the UART scenario */
+        uint32_t mBaudRate;
+
+        /** true after the header line was printed */
+        bool mIsHeaderPrinted;
+
+        /**
+         * Returns the time of the monotonic clock in ns.
+         */
+        static uint64_t
+        getNanoseconds();
+
+        /**
+         * Returns the CPU time in us of the process or of the calling thread.
+         */
+        static uint64_t
+        getCPUTime(bool theIsThread);
+
+        /**
+         * Returns a percentile of the sorted latencies in us.
+         */
+        static double
+        getPercentile(const std::vector<uint64_t>& theLatencies, double thePercentile);
+
+        /**
+         * Writes a line of text to the console and the log file.
+         */
+        void
+        log(const char* theTextLine);
+
+        /**
+         * Requests scans from a stream and measures each request.
+         *
+         * @param theDataStream
+         *      the connection to the simulator or the relay; must be open.
+         * @param theIsGSC2
+         *      true to request averaged scans by GSC2, false for GSCN.
+         * @param theResult
+         *      the results.
+         */
+        void
+        measure(IDataStream& theDataStream, bool theIsGSC2, Result_t& theResult);
+
+        /**
+         * Runs a scenario: starts the simulator, and the relay if needed,
+         * on threads of their own and measures the requests.
+         *
+         * @return
+         *      ERR_SUCCESS if OK, otherwise a negative error code.
+         */
+        ErrorID_t
+        runScenario(Scenario_t theScenario, Result_t& theResult);
+
+        /**
+         * Prints the results of a scenario and appends them to the result file.
+         */
+        void
+        report(Scenario_t theScenario, Result_t& theResult);
+
+        /* private assignment constructor to avoid misuse */
+        explicit
+        EndToEndBenchmark(const EndToEndBenchmark& src);
+
+        /* private assignment operator to avoid misuse */
+        EndToEndBenchmark&
+        operator =(const EndToEndBenchmark& src);
+
+    public:
+
+        /**
+         * Constructor.
+         *
+         * @param theSimulator
+         *      the simulated sensor; the scan format and the faults are kept,
+         *      the scan rate is set to a new scan per request.
+         * @param theTerminalLogFile
+         *      file to log the console output, or 0.
+         */
+        EndToEndBenchmark(SensorSimulator& theSimulator, FILE* theTerminalLogFile);
+
+        /**
+         * Destructor.
+         */
+        virtual
+        ~EndToEndBenchmark();
+
+        /**
+         * Finds a scenario by its name.
+         *
+         * @param theName
+         *      NET, UART, RELAY or GSC2.
+         * @param theScenario
+         *      the scenario found.
+         * @return
+         *      ERR_SUCCESS if found, ERR_INVALID_PARAMETER otherwise.
+         */
+        static ErrorID_t
+        findScenario(const char* theName, Scenario_t& theScenario);
+
+        /**
+         * Defines the number of requests measured per scenario.
+         *
+         * @param theNumberOfRequests
+         *      the number of requests, at least 1.
+         * @return
+         *      ERR_SUCCESS if OK, ERR_INVALID_PARAMETER otherwise.
+         */
+        ErrorID_t
+        setNumberOfRequests(int32_t theNumberOfRequests);
+
+        /**
+         * Defines the baud rate of the UART scenario.
+         *
+         * @param theBaudRate
+         *      the baud rate, e.g. 115200 or 3000000.
+         * @return
+         *      ERR_SUCCESS if OK, ERR_INVALID_PARAMETER otherwise.
+         */
+        ErrorID_t
+        setBaudRate(uint32_t theBaudRate);
+
+        /**
+         * Defines a file to append the results to as comma separated values.
+         * A header line is written if the file is empty.
+         *
+         * @param theResultFile
+         *      the result file, or 0.
+         */
+        void
+        setResultFile(FILE* theResultFile);
+
+        /**
+         * Runs a scenario and prints the results.
+         *
+         * @return
+         *      ERR_SUCCESS if OK, otherwise a negative error code.
+         */
+        ErrorID_t
+        run(Scenario_t theScenario);
+
+        /**
+         * Runs all scenarios and prints the results.
+         *
+         * @return
+         *      ERR_SUCCESS if all scenarios ran, otherwise the first error code.
+         */
+        ErrorID_t
+        runAll();
+};
+
+#endif /* Linux */
+#endif /* ENDTOENDBENCHMARK_HPP_ */
@@ -30,6 +30,7 @@ intToError(long theErrorID)
 
     ErrorID_t lErrorID[] = { //
             ERR_SUCCESS, /* OK */
+            ERR_END_OF_STREAM, /* no more data, e.g. at the end of a replayed recording */
             ERR_SYSTEM_NOT_READY, /* system not ready */
             ERR_FRONT_SCREEN_NOT_CLEAR, /* front screen dirty or wet */
             ERR_TEMPERATURE_OUT_OF_RANGE, /* temperature out of operating range */
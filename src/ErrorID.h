@@ -70,8 +70,9 @@ typedef enum ErrorID
      * Number negative error codes from tail to top.
      * Last error code is defined in stdlib's errno.h.
      */
-    __ERR_LASTERROR = -__ELASTERROR - 22, /* 22 is the number of codes defined here. */
+    __ERR_LASTERROR = -__ELASTERROR - 23, /* 23 is the number of codes defined here. */
 
+    ERR_END_OF_STREAM, /**< no more data, e.g. at the end of a replayed recording */
     ERR_SYSTEM_NOT_READY, /**< system not ready */
     ERR_FRONT_SCREEN_NOT_CLEAR, /**< front screen dirty or wet */
     ERR_TEMPERATURE_OUT_OF_RANGE, /**< temperature out of operating range */
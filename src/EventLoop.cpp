@@ -0,0 +1,162 @@
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       EventLoop.cpp
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ *
+ ****************************************************************************
+ */
+
+#if defined(__WIN32__) || (defined(__CYGWIN__) && !defined(_WIN32))
+	#include <windows.h>
+#elif defined(__linux__)
+	#include <cerrno>
+	#include <unistd.h>
+#else
+	#error "This program requires Linux or Win32."
+#endif
+
+#include "EventLoop.hpp"
+#include "IDataStream.hpp"
+
+/*
+ * Standard constructor.
+ */
+EventLoop::EventLoop() :
+        mNumberOfSources(0)
+{
+    // nothing more to do.
+}
+
+/*
+ * Standard destructor.
+ */
+EventLoop::~EventLoop()
+{
+    // nothing to be done.
+}
+
+/*
+ * Adds a source.
+ */
+int32_t
+EventLoop::addSource(IDataStream* theStream)
+{
+    if (MAX_SOURCES <= mNumberOfSources)
+    {
+        return ERR_BUFFER_OVERFLOW;
+    }
+    mStreams[mNumberOfSources] = theStream;
+    mReadable[mNumberOfSources] = false;
+    mBuffered[mNumberOfSources] = false;
+    mHungUp[mNumberOfSources] = false;
+    mIgnored[mNumberOfSources] = false;
+    return mNumberOfSources++;
+}
+
+/*
+ * Adds a data stream.
+ */
+int32_t
+EventLoop::addStream(IDataStream& theStream)
+{
+    return addSource(&theStream);
+}
+
+/*
+ * Adds the keyboard.
+ */
+int32_t
+EventLoop::addKeyboard()
+{
+    return addSource(0);
+}
+
+/*
+ * Waits for a source again which hung up.
+ */
+void
+EventLoop::resume(int32_t theSource)
+{
+    if ((0 <= theSource) && (theSource < mNumberOfSources))
+    {
+        mIgnored[theSource] = false;
+    }
+}
+
+/*
+ * Waits until at least one source has data.
+ */
+ErrorID_t
+EventLoop::wait(int32_t theTimeout)
+{
+#if defined(__linux__)
+    bool lHasPolledSource = false;
+    bool lHasBufferedFrame = false;
+
+    // take the handles; sources without handle and hung up sources are ignored by poll()
+    for (int32_t l = 0; l < mNumberOfSources; l++)
+    {
+        mPollHandles[l].fd = mIgnored[l] ? -1 : ((0 != mStreams[l]) ? mStreams[l]->getHandle() : STDIN_FILENO);
+        mPollHandles[l].events = POLLIN;
+        mPollHandles[l].revents = 0;
+        mBuffered[l] = (0 != mStreams[l]) && mStreams[l]->hasBufferedFrame();
+        mHungUp[l] = false;
+        lHasPolledSource = lHasPolledSource || (!mIgnored[l] && (0 > mPollHandles[l].fd));
+        lHasBufferedFrame = lHasBufferedFrame || mBuffered[l];
+    }
+
+    // sleep until data arrive, but not while a frame waits in a buffer
+    int32_t lTimeout = theTimeout;
+    if (lHasBufferedFrame)
+    {
+        lTimeout = 0;
+    }
+    else if (lHasPolledSource && ((0 > lTimeout) || (POLL_INTERVAL < lTimeout)))
+    {
+        lTimeout = POLL_INTERVAL;
+    }
+    const int lReady = poll(mPollHandles, mNumberOfSources, lTimeout);
+    if ((0 > lReady) && (EINTR != errno))
+    {
+        return ERR_IO;
+    }
+
+    // errors are reported as readable, so the reader sees and clears them;
+    // a hang-up stays, so the source is left out until resume()
+    for (int32_t l = 0; l < mNumberOfSources; l++)
+    {
+        const short lEvents = mPollHandles[l].revents;
+
+        mHungUp[l] = (0 == (lEvents & POLLIN)) && (0 != (lEvents & (POLLHUP | POLLNVAL)));
+        mIgnored[l] = mIgnored[l] || mHungUp[l];
+        mReadable[l] = mBuffered[l]
+                || (!mIgnored[l] && ((0 > mPollHandles[l].fd) || (0 != (lEvents & (POLLIN | POLLERR)))));
+    }
+    return ((0 < lReady) || lHasPolledSource || lHasBufferedFrame) ? ERR_SUCCESS : ERR_TIMEOUT;
+#else
+    // no common wait function for sockets, UARTs and the console
+    if (0 != theTimeout)
+    {
+        Sleep(POLL_INTERVAL);
+    }
+    for (int32_t l = 0; l < mNumberOfSources; l++)
+    {
+        mReadable[l] = true;
+    }
+    return (0 < mNumberOfSources) ? ERR_SUCCESS : ERR_TIMEOUT;
+#endif
+}
@@ -0,0 +1,207 @@
+#ifndef EVENTLOOP_HPP_
+#define EVENTLOOP_HPP_
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       EventLoop.hpp - Waits for data on several data streams.
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ ****************************************************************************
+ */
+
+#if defined(__linux__)
+#include <poll.h>
+#endif
+extern "C"
+{
+#include "ErrorID.h"
+}
+#include "Global.hpp"
+
+class IDataStream;
+
+/**
+ * Class EventLoop - waits until one of several sources has data.
+ * <p>&nbsp;<p>
+ * A loop which reads all its sources with timeout 0 keeps a CPU core
+ * busy and adds jitter. EventLoop sleeps in poll() on the handles of the
+ * data streams and the keyboard instead, and wakes up as soon as one of
+ * them has received data.
+ * <p>
+ * A data stream which still buffers a complete frame from an earlier read
+ * (see IDataStream::hasBufferedFrame()) is readable without waiting.
+ * A data stream without handle (see IDataStream::getHandle()) cannot be
+ * waited for. It is reported readable every ms, so the loop reads it as
+ * before, just without spinning. On Windows this applies to all sources.
+ * <p>
+ * A source which hangs up, e.g. an unplugged UART, would wake up every
+ * wait() at once. It is reported by isHungUp() after the wait() which
+ * detected it, and left out of the following waits until resume() is
+ * called. An error without hang-up, e.g. a refused UDP datagram, is
+ * reported as readable: the read returns and clears it.
+ * <p>
+ * Example:
+ * <pre>
+ * EventLoop lEventLoop;
+ * const int32_t lSensor = lEventLoop.addStream(lSensorSocket);
+ * const int32_t lKeyboard = lEventLoop.addKeyboard();
+ * while (ERR_SUCCESS <= lEventLoop.wait(EventLoop::WAIT_FOREVER))
+ * {
+ *     if (lEventLoop.isReadable(lSensor)) ...
+ * }
+ * </pre>
+ */
+class EventLoop
+{
+    public:
+
+        /** class constants */
+        enum EventLoopConstants_t
+        {
+            /** maximum number of sources */
+            MAX_SOURCES = 16,
+
+            /** timeout of wait() to wait until a source has data */
+            WAIT_FOREVER = -1,
+
+            /** ms between two reads of a source without handle */
+            POLL_INTERVAL = 1
+        };
+
+    private:
+
+        /** the data streams; 0 for the keyboard */
+        IDataStream* mStreams[MAX_SOURCES];
+
+        /** true if the source has data after wait() */
+        bool mReadable[MAX_SOURCES];
+
+        /** true if the source has a frame buffered before wait() */
+        bool mBuffered[MAX_SOURCES];
+
+        /** true if the source hung up in the last wait() */
+        bool mHungUp[MAX_SOURCES];
+
+        /** true if the source hung up and is left out of wait() */
+        bool mIgnored[MAX_SOURCES];
+
+#if defined(__linux__)
+        /** the handles passed to poll() */
+        struct pollfd mPollHandles[MAX_SOURCES];
+#endif
+
+        /** number of sources */
+        int32_t mNumberOfSources;
+
+        /**
+         * Adds a source.
+         *
+         * @return
+         *      the index of the source, or ERR_BUFFER_OVERFLOW if there are too many.
+         */
+        int32_t
+        addSource(IDataStream* theStream);
+
+        /* private assignment constructor to avoid misuse */
+        explicit
+        EventLoop(const EventLoop& src);
+
+        /* private assignment operator to avoid misuse */
+        EventLoop&
+        operator =(const EventLoop& src);
+
+    public:
+
+        /**
+         * Constructor. Creates an event loop without sources.
+         */
+        EventLoop();
+
+        /**
+         * Destructor.
+         */
+        virtual
+        ~EventLoop();
+
+        /**
+         * Adds a data stream. Its handle is taken by each wait(), so the
+         * data stream may be reopened.
+         *
+         * @param theStream
+         *      the data stream; must exist as long as the event loop.
+         * @return
+         *      the index of the source, or ERR_BUFFER_OVERFLOW if there are too many.
+         */
+        int32_t
+        addStream(IDataStream& theStream);
+
+        /**
+         * Adds the keyboard (standard input). Use kbhit() and getch() to read it.
+         *
+         * @return
+         *      the index of the source, or ERR_BUFFER_OVERFLOW if there are too many.
+         */
+        int32_t
+        addKeyboard();
+
+        /**
+         * Waits until at least one source has data.
+         *
+         * @param theTimeout
+         *      ms to wait, or WAIT_FOREVER.
+         * @return
+         *      ERR_SUCCESS if a source has data, ERR_TIMEOUT if none has,
+         *      otherwise a negative error code.
+         */
+        ErrorID_t
+        wait(int32_t theTimeout);
+
+        /**
+         * Returns true if the source has data after the last wait().
+         *
+         * @param theSource
+         *      the index returned by addStream() or addKeyboard().
+         */
+        bool
+        isReadable(int32_t theSource) const
+        {
+            return ((0 <= theSource) && (theSource < mNumberOfSources)) ? mReadable[theSource] : false;
+        }
+
+        /**
+         * Returns true if the source hung up in the last wait(). It is left
+         * out of the following waits until resume() is called.
+         *
+         * @param theSource
+         *      the index returned by addStream() or addKeyboard().
+         */
+        bool
+        isHungUp(int32_t theSource) const
+        {
+            return ((0 <= theSource) && (theSource < mNumberOfSources)) ? mHungUp[theSource] : false;
+        }
+
+        /**
+         * Waits for a source again which hung up, e.g. after its data
+         * stream has been reopened.
+         *
+         * @param theSource
+         *      the index returned by addStream() or addKeyboard().
+         */
+        void
+        resume(int32_t theSource);
+};
+
+#endif /* EVENTLOOP_HPP_ */
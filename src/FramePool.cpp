@@ -0,0 +1,120 @@
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       FramePool.cpp
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ *
+ ****************************************************************************
+ */
+
+#include <cstring>
+
+#include "FramePool.hpp"
+
+/*
+ * Constructor.
+ */
+FramePool::FramePool(int32_t theNumberOfFrames) :
+        mFramesPtr(0), //
+        mNumberOfFrames((1 > theNumberOfFrames) ? 1 : theNumberOfFrames), //
+        mFirstFreePtr(0), //
+        mNumberOfFreeFrames(0), //
+        mNumberOfExhaustions(0), //
+        mNumberOfCopies(0)
+{
+    mFramesPtr = new Frame_t[mNumberOfFrames];
+    for (int32_t l = mNumberOfFrames - 1; l >= 0; l--)
+    {
+        mFramesPtr[l].mReferences = 0;
+        mFramesPtr[l].mLength = 0;
+        mFramesPtr[l].mNextFreePtr = mFirstFreePtr;
+        mFirstFreePtr = &mFramesPtr[l];
+    }
+    mNumberOfFreeFrames = mNumberOfFrames;
+}
+
+/*
+ * Standard destructor.
+ */
+FramePool::~FramePool()
+{
+    delete[] mFramesPtr;
+}
+
+/*
+ * Takes a free frame.
+ */
+FramePool::Frame_t*
+FramePool::acquire()
+{
+    Frame_t* lFramePtr = mFirstFreePtr;
+
+    if (0 == lFramePtr)
+    {
+        mNumberOfExhaustions++;
+        return 0;
+    }
+    mFirstFreePtr = lFramePtr->mNextFreePtr;
+    mNumberOfFreeFrames--;
+
+    lFramePtr->mReferences = 1;
+    lFramePtr->mLength = 0;
+    lFramePtr->mNextFreePtr = 0;
+    return lFramePtr;
+}
+
+/*
+ * Releases a reference.
+ */
+void
+FramePool::release(Frame_t* theFramePtr)
+{
+    if ((0 == theFramePtr) || (0 >= theFramePtr->mReferences))
+    {
+        return;
+    }
+    if (0 == --theFramePtr->mReferences)
+    {
+        theFramePtr->mNextFreePtr = mFirstFreePtr;
+        mFirstFreePtr = theFramePtr;
+        mNumberOfFreeFrames++;
+    }
+}
+
+/*
+ * Copies a shared frame, so the caller may change it.
+ */
+ErrorID_t
+FramePool::getWritable(Frame_t*& theFramePtr)
+{
+    if (1 >= theFramePtr->mReferences)
+    {
+        return ERR_SUCCESS; // the caller holds the only reference
+    }
+
+    Frame_t* lCopyPtr = acquire();
+    if (0 == lCopyPtr)
+    {
+        return ERR_BUFFER_OVERFLOW;
+    }
+    memcpy(lCopyPtr->mData, theFramePtr->mData, theFramePtr->mLength);
+    lCopyPtr->mLength = theFramePtr->mLength;
+    mNumberOfCopies++;
+
+    release(theFramePtr);
+    theFramePtr = lCopyPtr;
+    return ERR_SUCCESS;
+}
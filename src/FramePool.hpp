@@ -0,0 +1,203 @@
+#ifndef FRAMEPOOL_HPP_
+#define FRAMEPOOL_HPP_
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       FramePool.hpp - Frame buffers allocated once and shared.
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ ****************************************************************************
+ */
+
+extern "C"
+{
+#include "ErrorID.h"
+}
+#include "Global.hpp"
+
+/**
+ * Class FramePool - a fixed number of frame buffers of the protocol's
+ * maximum size, with reference counts.
+ * <p>&nbsp;<p>
+ * A scan of 4000 points with several echoes takes tens of KB. The pool
+ * allocates its frames once, so receiving a frame neither allocates
+ * memory nor limits the frame to a smaller buffer. A frame which is
+ * passed on to several receivers is shared instead of copied: each
+ * receiver holds a reference, and the frame returns to the pool when
+ * the last one is released.
+ * <p>
+ * A receiver which changes the frame, e.g. to convert a response in
+ * place, calls getWritable() first: copy on write. Only a frame which
+ * is shared is copied, so the last receiver always works in place.
+ * <p>
+ * The pool is not thread-safe; it belongs to one thread.
+ */
+class FramePool
+{
+    public:
+
+        /** class constants */
+        enum FramePoolConstants_t
+        {
+            /** maximum size of a frame, as CommandBase::MAX_COMMAND_SIZE */
+            MAX_FRAME_SIZE = 64 * 1024
+        };
+
+        /**
+         * A frame of the pool.
+         */
+        struct Frame_t
+        {
+                /** number of references; 0 while the frame is free */
+                int32_t mReferences;
+
+                /** number of bytes in mData */
+                int32_t mLength;
+
+                /** the next free frame, or 0 */
+                Frame_t* mNextFreePtr;
+
+                /** the frame; aligned for the 32 bit fields */
+                uint32_t mData[MAX_FRAME_SIZE / sizeof(uint32_t)];
+
+                /**
+                 * Returns the frame as bytes.
+                 */
+                char*
+                getBytes()
+                {
+                    return reinterpret_cast<char*>(mData);
+                }
+        };
+
+    private:
+
+        /** the frames */
+        Frame_t* mFramesPtr;
+
+        /** number of frames */
+        int32_t mNumberOfFrames;
+
+        /** the free frames as a list */
+        Frame_t* mFirstFreePtr;
+
+        /** number of free frames */
+        int32_t mNumberOfFreeFrames;
+
+        /** number of acquire() calls failed because all frames were used */
+        uint32_t mNumberOfExhaustions;
+
+        /** number of frames copied by getWritable() */
+        uint32_t mNumberOfCopies;
+
+        /* private assignment constructor to avoid misuse */
+        explicit
+        FramePool(const FramePool& src);
+
+        /* private assignment operator to avoid misuse */
+        FramePool&
+        operator =(const FramePool& src);
+
+    public:
+
+        /**
+         * Constructor. Allocates all frames.
+         *
+         * @param theNumberOfFrames
+         *      number of frames, at least 1.
+         */
+        explicit
+        FramePool(int32_t theNumberOfFrames);
+
+        /**
+         * Destructor. The frames must have been released.
+         */
+        virtual
+        ~FramePool();
+
+        /**
+         * Takes a free frame.
+         *
+         * @return
+         *      the frame with one reference and length 0, or 0 if all
+         *      frames are used.
+         */
+        Frame_t*
+        acquire();
+
+        /**
+         * Adds a reference to a frame which is passed on.
+         *
+         * @param theFramePtr
+         *      the frame.
+         */
+        void
+        addReference(Frame_t* theFramePtr)
+        {
+            theFramePtr->mReferences++;
+        }
+
+        /**
+         * Releases a reference. The frame returns to the pool with the last.
+         *
+         * @param theFramePtr
+         *      the frame, or 0.
+         */
+        void
+        release(Frame_t* theFramePtr);
+
+        /**
+         * Makes sure the caller holds the only reference to a frame, so
+         * it may change it: a shared frame is copied into a free frame and
+         * the reference to the shared one is released.
+         *
+         * @param theFramePtr
+         *      the frame of the caller; replaced by the copy.
+         * @return
+         *      ERR_SUCCESS if OK, ERR_BUFFER_OVERFLOW if a copy was needed
+         *      but all frames are used; the caller keeps the shared frame.
+         */
+        ErrorID_t
+        getWritable(Frame_t*& theFramePtr);
+
+        /**
+         * Returns the number of frames not used.
+         */
+        int32_t
+        getNumberOfFreeFrames() const
+        {
+            return mNumberOfFreeFrames;
+        }
+
+        /**
+         * Returns the number of times all frames were used.
+         */
+        uint32_t
+        getNumberOfExhaustions() const
+        {
+            return mNumberOfExhaustions;
+        }
+
+        /**
+         * Returns the number of frames copied because they were shared.
+         */
+        uint32_t
+        getNumberOfCopies() const
+        {
+            return mNumberOfCopies;
+        }
+};
+
+#endif /* FRAMEPOOL_HPP_ */
@@ -0,0 +1,101 @@
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       FrameStream.cpp
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ *
+ ****************************************************************************
+ */
+
+#include <cstring>
+
+#include "FrameStream.hpp"
+
+/*
+ * Standard constructor.
+ */
+FrameStream::FrameStream() :
+        mFramePtr(0), //
+        mFrameSize(0), //
+        mIsOpen(true)
+{
+    // nothing more to do.
+}
+
+/*
+ * Standard destructor.
+ */
+FrameStream::~FrameStream()
+{
+    // nothing to be done.
+}
+
+/*
+ * Defines the frame returned by read().
+ */
+void
+FrameStream::setFrame(const void* theFramePtr, int32_t theFrameSize)
+{
+    mFramePtr = theFramePtr;
+    mFrameSize = theFrameSize;
+}
+
+/*
+ * Closes the stream.
+ */
+ErrorID_t
+FrameStream::close()
+{
+    mIsOpen = false;
+    return ERR_SUCCESS;
+}
+
+/*
+ * Opens the stream.
+ */
+ErrorID_t
+FrameStream::open()
+{
+    mIsOpen = true;
+    return ERR_SUCCESS;
+}
+
+/*
+ * Copies the frame into the buffer.
+ */
+int32_t
+FrameStream::read(void* buffer, int32_t size)
+{
+    if (!mIsOpen || (0 == mFramePtr))
+    {
+        return -1;
+    }
+    if (mFrameSize > size)
+    {
+        return ERR_BUFFER_OVERFLOW;
+    }
+    memcpy(buffer, mFramePtr, mFrameSize);
+    return mFrameSize;
+}
+
+/*
+ * Discards a request.
+ */
+int32_t
+FrameStream::write(void*, int32_t size)
+{
+    return size;
+}
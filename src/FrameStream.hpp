@@ -0,0 +1,128 @@
+#ifndef FRAMESTREAM_HPP_
+#define FRAMESTREAM_HPP_
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       FrameStream.hpp - Answers each request with the same frame.
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ ****************************************************************************
+ */
+
+#include "Global.hpp"
+#include "IDataStream.hpp"
+
+/**
+ * Class FrameStream - a data stream in memory which returns one frame.
+ * <p>&nbsp;<p>
+ * Requests written are discarded; each read() copies the frame defined
+ * by setFrame() into the buffer, like a socket receives a datagram. So
+ * a command performs its complete receive and parse path without I/O,
+ * e.g. to measure the parsing in the benchmark.
+ */
+class FrameStream : public IDataStream
+{
+    private:
+
+        /** the frame returned by read(), or 0 */
+        const void* mFramePtr;
+
+        /** size of the frame in bytes */
+        int32_t mFrameSize;
+
+        /** true if open */
+        bool mIsOpen;
+
+        /* private assignment constructor to avoid misuse */
+        explicit
+        FrameStream(const FrameStream& src);
+
+        /* private assignment operator to avoid misuse */
+        FrameStream&
+        operator =(const FrameStream& src);
+
+    public:
+
+        /**
+         * Standard constructor.
+         */
+        FrameStream();
+
+        /**
+         * Destructor.
+         */
+        virtual
+        ~FrameStream();
+
+        /**
+         * Defines the frame returned by read(). The frame is not copied
+         * and must be valid while the stream is read.
+         *
+         * @param theFramePtr
+         *      the frame.
+         * @param theFrameSize
+         *      size of the frame in bytes.
+         */
+        void
+        setFrame(const void* theFramePtr, int32_t theFrameSize);
+
+        /**
+         * Closes the stream.
+         *
+         * @return
+         *      ERR_SUCCESS.
+         */
+        virtual ErrorID_t
+        close();
+
+        /**
+         * Returns true if the stream is open.
+         */
+        virtual bool
+        isOpen()
+        {
+            return mIsOpen;
+        }
+
+        /**
+         * Opens the stream.
+         *
+         * @return
+         *      ERR_SUCCESS.
+         */
+        virtual ErrorID_t
+        open();
+
+        /**
+         * Copies the frame into the buffer.
+         *
+         * @return
+         *      the size of the frame, or ERR_BUFFER_OVERFLOW if it does not fit
+         *      into the buffer, or -1 if there is no frame.
+         */
+        virtual int32_t
+        read(void* buffer, int32_t size);
+
+        /**
+         * Discards a request.
+         *
+         * @return
+         *      size.
+         */
+        virtual int32_t
+        write(void* buffer, int32_t size);
+};
+
+#endif /* FRAMESTREAM_HPP_ */
@@ -32,6 +32,9 @@
 #define GSC2COMMAND_HPP_
 
 #include "CommandBase.hpp"
+#include "ScanRecorder.hpp"
+
+class ScanView;
 
 /**
  * Class GSC2Command.hpp - Getting scans from the sensor.
@@ -109,8 +112,14 @@ class GSC2Command : private CommandBase
                 int32_t mCRC;
         } mCommand;
 
+        /** records the responses; kept open while the command exists */
+        ScanRecorder mRecorder;
+
         /**
          * Parses the receiver buffer and copy the result into the scan structure.
+         * The CRC has been checked on receipt; the values are converted from
+         * network byte order while they are copied, so the buffer keeps the
+         * response as received for the data log.
          * Must be called after performCommand().
          *
          * @param theScan
@@ -118,11 +127,35 @@ class GSC2Command : private CommandBase
          *
          * @return
          *      ERR_SUCCESS on success, otherwise a negative error code.
-         *
+         * @retval ERR_BUFFER_OVERFLOW
+         *      if the response is truncated or exceeds the limits of a scan.
          */
         ErrorID_t
         parseScan(Scan_t& theScan);
 
+        /**
+         * Prepares and sends the GSC2 command and receives the response.
+         *
+         * @param theScanAvgNumber
+         *      the number of scans to average.
+         * @param thePointAvgNumber
+         *      the number of points to average.
+         * @return
+         *      ERR_SUCCESS on success, otherwise a negative error code.
+         */
+        ErrorID_t
+        requestScan(int32_t theScanAvgNumber, int32_t thePointAvgNumber);
+
+        /**
+         * Appends the received response to the recording in the data log file.
+         * The recording is opened by the first response and stays open.
+         *
+         * @param theDataLogFileName
+         *      file to store the response, or 0 or an empty string.
+         */
+        void
+        logResponse(char* theDataLogFileName);
+
         /* private assignment constructor to avoid misuse */
         explicit
         GSC2Command(const GSC2Command& src);
@@ -147,6 +180,12 @@ class GSC2Command : private CommandBase
         virtual
         ~GSC2Command();
 
+        /** time in ns when the first byte of the last response arrived */
+        using CommandBase::getFirstByteTime;
+
+        /** time in ns when the last response was complete */
+        using CommandBase::getLastByteTime;
+
         /**
          * Clears a Scan_t structure.
          */
@@ -165,6 +204,26 @@ class GSC2Command : private CommandBase
          */
         ErrorID_t
         performCommand(int32_t theScanNumber, int32_t theAvgNumber, Scan_t& theScan, char* theDataLogFileName);
+
+        /**
+         * Performs the GSC2 command and attaches a view to the response.
+         * Nothing is copied or converted; the view is valid until the next
+         * command is performed.
+         *
+         * @param theScanAvgNumber
+         *      the number of scans to average.
+         * @param thePointAvgNumber
+         *      the number of points to average.
+         * @param theScanView
+         *      the view on the received scan.
+         * @param theDataLogFileName
+         *      file to store the response, or 0.
+         * @return
+         *      ERR_SUCCESS on success, otherwise a negative error code.
+         */
+        ErrorID_t
+        performCommand(int32_t theScanAvgNumber, int32_t thePointAvgNumber, ScanView& theScanView,
+                char* theDataLogFileName);
 };
 
 #endif /* GSC2COMMAND_HPP_ */
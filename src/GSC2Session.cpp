@@ -0,0 +1,638 @@
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       GSC2Session.cpp
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ *
+ ****************************************************************************
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "GSC2Session.hpp"
+#include "CRC32.hpp"
+#include "PointAvg.hpp"
+
+// needed for ntohl
+#if defined(__WIN32__) || (defined(__CYGWIN__) && !defined(_WIN32))
+	#include <winsock2.h>
+#elif defined(__linux__)
+	#include <arpa/inet.h>
+#else
+	#error "This program requires Linux or Win32."
+#endif
+
+/*
+ * Standard constructor.
+ */
+GSC2Session::GSC2Session() :
+        mIsActive(false), //
+        mRequestLength(0), //
+        mScanAvgNumber(1), //
+        mPointAvgNumber(1), //
+        mFilter(FILTER_MEAN), //
+        mWindowSize(0), //
+        mWindowCount(0), //
+        mWindowNext(0), //
+        mWindowPoints(0), //
+        mWindowEchoes(0), //
+        mWindowDataContent(0), //
+        mLastScanNumber(0), //
+        mDistances(), //
+        mPulseWidths(), //
+        mSortedDistances(), //
+        mSums(), //
+        mPointDistances(), //
+        mPointAverages(), //
+        mPointCounts()
+{
+    // nothing more to do.
+}
+
+/*
+ * Standard destructor.
+ */
+GSC2Session::~GSC2Session()
+{
+    // nothing to be done.
+}
+
+/*
+ * Selects the filter of the scan averaging.
+ */
+void
+GSC2Session::setFilter(GSC2Filter_t theFilter)
+{
+    mFilter = theFilter;
+    mWindowSize = 0; // the next scan starts a new window
+}
+
+/*
+ * Returns the name of a filter.
+ */
+const char*
+GSC2Session::getFilterName(GSC2Filter_t theFilter)
+{
+    switch (theFilter)
+    {
+        case FILTER_MEAN:
+            return "MEAN";
+        case FILTER_MEDIAN:
+            return "MEDIAN";
+        case FILTER_TRIMMED_MEAN:
+            return "TRIMMED";
+        default:
+            return "unknown";
+    }
+}
+
+/*
+ * Finds a filter by its name.
+ */
+ErrorID_t
+GSC2Session::findFilter(const char* theName, GSC2Filter_t& theFilter)
+{
+    for (int32_t l = 0; l < NUMBER_OF_FILTERS; l++)
+    {
+        if (0 == strcmp(theName, getFilterName(static_cast<GSC2Filter_t>(l))))
+        {
+            theFilter = static_cast<GSC2Filter_t>(l);
+            return ERR_SUCCESS;
+        }
+    }
+    return ERR_INVALID_PARAMETER;
+}
+
+/*
+ * Ends the averaging.
+ */
+void
+GSC2Session::reset()
+{
+    mIsActive = false;
+}
+
+/*
+ * Converts a GSC2 request into a GSCN request for the latest scan.
+ */
+ErrorID_t
+GSC2Session::convertGSC2Request(char *data, int32_t len, int32_t *plen)
+{
+    CRC32 lCRC;
+    cast_ptr_t lBufferPtr = { data }; // casts the buffer to an array of integer
+    int32_t lCRCPosition = (4 + 4 + 4 + 4) / sizeof(int32_t) - 1; // position of the CRC in the buffer
+    uint32_t lCRCValue;
+
+    // the request has a fixed size; a wrong CRC is a damaged request
+    if (GSC2_REQUEST_SIZE != len)
+    {
+        return ERR_INVALID_PARAMETER;
+    }
+    if (ntohl(lBufferPtr.asIntegerPtr[GSC2_REQUEST_SIZE / sizeof(int32_t) - 1])
+            != lCRC.get(lBufferPtr.asIntegerPtr + 0, GSC2_REQUEST_SIZE - 4))
+    {
+        return ERR_CRC;
+    }
+
+#if 0
+    int32_t lLength;
+
+    lLength = ntohl(lBufferPtr.asIntegerPtr[1]);
+    printf("GSC2: Length = %d\r\n", lLength);
+#endif
+    mScanAvgNumber = ntohl(lBufferPtr.asIntegerPtr[2]);
+    if (mScanAvgNumber < 1) mScanAvgNumber = 1;
+    if (mScanAvgNumber > MAX_SCAN_AVG_NUMBER) mScanAvgNumber = MAX_SCAN_AVG_NUMBER;
+    mPointAvgNumber = ntohl(lBufferPtr.asIntegerPtr[3]);
+    if (mPointAvgNumber < 1) mPointAvgNumber = 1;
+    if (mPointAvgNumber > MAX_POINT_AVG_NUMBER) mPointAvgNumber = MAX_POINT_AVG_NUMBER;
+#if 0
+    printf("GSC2: ScanAvgNumber = %d\r\n", mScanAvgNumber);
+    printf("GSC2: PointAvgNumber = %d\r\n", mPointAvgNumber);
+#endif
+	memcpy((char *)lBufferPtr.asIntegerPtr + 0, "GSCN", 4);
+	lBufferPtr.asIntegerPtr[1] = htonl(4); // Length
+	lBufferPtr.asIntegerPtr[2] = htonl(0); // Always, Scan Number is 0 for latest scan measured.
+	lCRCValue = lCRC.get(lBufferPtr.asIntegerPtr + 0, (4 + 4 + 4 + 4) - 4);
+    lBufferPtr.asIntegerPtr[lCRCPosition] = htonl(lCRCValue);
+    *plen = (4 + 4 + 4 + 4);
+    if (mPointAvgNumber > 1 || mScanAvgNumber > 1)
+    {
+    	mIsActive = true;
+    	memcpy(mRequest, data, *plen);
+    	mRequestLength = *plen;
+    }
+    return ERR_SUCCESS;
+}
+
+/*
+ * Converts a request of the client for the sensor.
+ */
+ErrorID_t
+GSC2Session::convertRequest(char *data, int32_t len, int32_t *plen)
+{
+    mIsActive = false;
+	if ((4 <= len) && !strncmp(data, "GSC2", 4))
+	{
+		return convertGSC2Request(data, len, plen);
+	}
+	return ERR_SUCCESS;
+}
+
+/*
+ * Adds a value of the last echo to the sums of a point, or removes it.
+ */
+void
+GSC2Session::addToSum(PointSum_t& theSum, int32_t theDistance, int32_t thePulseWidth, int32_t theWeight)
+{
+	if ((uint32_t)theDistance == 0x80000000) // Check No Echo
+	{
+		theSum.mNoEchoCount += theWeight;
+	}
+	else if ((uint32_t)theDistance == 0x7FFFFFFF) // Check Noise
+	{
+		theSum.mNoiseCount += theWeight;
+	}
+	else
+	{
+		theSum.mDistanceSum += (int64_t)theWeight * theDistance;
+		theSum.mDistanceCount += theWeight;
+	}
+	theSum.mPulseWidthSum += (int64_t)theWeight * thePulseWidth;
+}
+
+/*
+ * Inserts a distance into the sorted distances of a point.
+ */
+void
+GSC2Session::insertSorted(int32_t* theSortedPtr, int32_t theCount, int32_t theDistance)
+{
+	if (((uint32_t)theDistance == 0x80000000) || ((uint32_t)theDistance == 0x7FFFFFFF))
+	{
+		return;
+	}
+	int32_t* lPositionPtr = std::upper_bound(theSortedPtr, theSortedPtr + theCount, theDistance);
+	std::copy_backward(lPositionPtr, theSortedPtr + theCount, theSortedPtr + theCount + 1);
+	*lPositionPtr = theDistance;
+}
+
+/*
+ * Removes a distance from the sorted distances of a point.
+ */
+void
+GSC2Session::removeSorted(int32_t* theSortedPtr, int32_t theCount, int32_t theDistance)
+{
+	if (((uint32_t)theDistance == 0x80000000) || ((uint32_t)theDistance == 0x7FFFFFFF))
+	{
+		return;
+	}
+	int32_t* lPositionPtr = std::lower_bound(theSortedPtr, theSortedPtr + theCount, theDistance);
+	std::copy(lPositionPtr + 1, theSortedPtr + theCount, lPositionPtr);
+}
+
+/*
+ * Returns the filtered distance of a point.
+ */
+int32_t
+GSC2Session::getFilteredDistance(const PointSum_t& theSum, const int32_t* theSortedPtr) const
+{
+	const int32_t lCount = theSum.mDistanceCount;
+
+	if (0 == lCount)
+	{
+		if (theSum.mNoEchoCount > theSum.mNoiseCount)
+			return 0x80000000; // Set No Echo
+		else
+			return 0x7fffffff; // Set Noise
+	}
+
+	switch (mFilter)
+	{
+		case FILTER_MEDIAN:
+			if (lCount & 1)
+			{
+				return theSortedPtr[lCount / 2];
+			}
+			return int32_t(((int64_t)theSortedPtr[lCount / 2 - 1] + theSortedPtr[lCount / 2]) / 2);
+
+		case FILTER_TRIMMED_MEAN:
+		{
+			const int32_t lTrim = lCount * TRIM_PERCENT / 100;
+			int64_t lDistanceSum = 0;
+			for (int32_t l = lTrim; l < lCount - lTrim; l++)
+			{
+				lDistanceSum += theSortedPtr[l];
+			}
+			return int32_t(lDistanceSum / (lCount - 2 * lTrim));
+		}
+
+		case FILTER_MEAN:
+		default:
+			return int32_t(theSum.mDistanceSum / lCount);
+	}
+}
+
+/*
+ * Empties the window and sizes it for the scan layout.
+ */
+void
+GSC2Session::resetWindow(int32_t theNumberOfPoints, int32_t theNumberOfEchoes, int32_t theDataContent)
+{
+	const PointSum_t lEmptySum = { 0, 0, 0, 0, 0 };
+
+	mWindowSize = mScanAvgNumber;
+	mWindowCount = 0;
+	mWindowNext = 0;
+	mWindowPoints = theNumberOfPoints;
+	mWindowEchoes = theNumberOfEchoes;
+	mWindowDataContent = theDataContent;
+
+	// assign() keeps the capacity, so the vectors grow once per session
+	mDistances.assign(mWindowSize * theNumberOfPoints, 0);
+	mPulseWidths.assign(mWindowSize * theNumberOfPoints, 0);
+	if (FILTER_MEAN == mFilter)
+	{
+		mSortedDistances.clear();
+	}
+	else
+	{
+		mSortedDistances.assign(mWindowSize * theNumberOfPoints, 0);
+	}
+	mSums.assign(theNumberOfPoints, lEmptySum);
+}
+
+/*
+ * Adds the latest scan to the window and writes the moving average into it.
+ */
+bool
+GSC2Session::averageScans(char *data, int32_t len, int32_t *plen)
+{
+	cast_ptr_t lDataPtr = { data };
+	const int32_t lNumberOfIntegers = len / sizeof(int32_t);
+	int32_t lLength = ntohl(lDataPtr.asIntegerPtr[1]);
+	int32_t lNumberOfParameter = ntohl(lDataPtr.asIntegerPtr[2]);
+
+	// command ID, length, number of parameters, parameters, number of points, CRC
+	if ((lNumberOfParameter < 0) || (lNumberOfParameter > lNumberOfIntegers - (3 + 1 + 1)))
+	{
+		return false;
+	}
+	const int32_t* lParameterPtr = &lDataPtr.asIntegerPtr[3];
+	int32_t lScanNumber = (lNumberOfParameter > 0 /* PARAMETER_SCAN_NUMBER */) ? ntohl(lParameterPtr[0]) : 0;
+	int32_t lNumberOfEchoes = (lNumberOfParameter > 4 /* PARAMETER_NUMBER_OF_ECHOES */) ? ntohl(lParameterPtr[4]) : 0;
+	int32_t lDataContent = (lNumberOfParameter > 8 /* PARAMETER_DATA_CONTENT */) ? ntohl(lParameterPtr[8]) : 0;
+	int32_t lNumberOfPoints = ntohl(lParameterPtr[lNumberOfParameter]);
+	int32_t* lValuePtr = &lDataPtr.asIntegerPtr[3 + lNumberOfParameter + 1];
+
+	// get number of echoes. If 0, then the master echo is transfered instead of the number
+	if (0 == lNumberOfEchoes)
+	{
+		lNumberOfEchoes = 1;
+	}
+
+	// check limits; the data block must fit into the response
+	const int32_t lIntegersPerEcho = (lDataContent != 4 /* DATABLOCK_WITH_DISTANCES */) ? 2 : 1;
+	const int32_t lIntegersPerPoint = lNumberOfEchoes * lIntegersPerEcho;
+	if ((4 /* MAX_NUMBER_OF_ECHOS */ < lNumberOfEchoes) || (lNumberOfPoints < 0)
+			|| (4000 /* MAX_POINTS_PER_SCAN */ < lNumberOfPoints)
+			|| ((lValuePtr - lDataPtr.asIntegerPtr) + lNumberOfPoints * lIntegersPerPoint + 1 > lNumberOfIntegers))
+	{
+		return false;
+	}
+
+	// the same scan again adds nothing; ask for the next one
+	const bool lHasScanNumber = (lNumberOfParameter > 0);
+	if (lHasScanNumber && (0 < mWindowCount) && (lScanNumber == mLastScanNumber))
+	{
+		return false;
+	}
+
+	// start over if the settings or the layout changed, or the window is too old
+	if ((mWindowSize != mScanAvgNumber) || (mWindowPoints != lNumberOfPoints)
+			|| (mWindowEchoes != lNumberOfEchoes) || (mWindowDataContent != lDataContent)
+			|| (lHasScanNumber && ((uint32_t)lScanNumber - (uint32_t)mLastScanNumber > (uint32_t)mWindowSize)))
+	{
+		resetWindow(lNumberOfPoints, lNumberOfEchoes, lDataContent);
+	}
+	mLastScanNumber = lScanNumber;
+
+	// the slot of the oldest scan takes the new one
+	const bool lIsFull = (mWindowCount == mWindowSize);
+	const bool lIsSorted = (FILTER_MEAN != mFilter);
+	const int32_t lSlot = mWindowNext;
+	if (!lIsFull)
+	{
+		mWindowCount++;
+	}
+	mWindowNext = (mWindowNext + 1) % mWindowSize;
+	const bool lIsReady = (mWindowCount == mWindowSize);
+
+	// only the last echo of each point is averaged
+	lValuePtr += (lNumberOfEchoes - 1) * lIntegersPerEcho;
+	for (int32_t lPoints = 0; lPoints < lNumberOfPoints; lPoints++)
+	{
+		PointSum_t& lSum = mSums[lPoints];
+		int32_t* lDistancePtr = &mDistances[lPoints * mWindowSize + lSlot];
+		int32_t* lPulseWidthPtr = &mPulseWidths[lPoints * mWindowSize + lSlot];
+		int32_t* lSortedPtr = lIsSorted ? &mSortedDistances[lPoints * mWindowSize] : 0;
+		const int32_t lDistance = ntohl(lValuePtr[0]);
+		const int32_t lPulseWidth = (2 == lIntegersPerEcho) ? ntohl(lValuePtr[1]) : 0;
+
+		if (lIsFull)
+		{
+			if (lIsSorted)
+			{
+				removeSorted(lSortedPtr, lSum.mDistanceCount, *lDistancePtr);
+			}
+			addToSum(lSum, *lDistancePtr, *lPulseWidthPtr, -1);
+		}
+		if (lIsSorted)
+		{
+			insertSorted(lSortedPtr, lSum.mDistanceCount, lDistance);
+		}
+		addToSum(lSum, lDistance, lPulseWidth, 1);
+		*lDistancePtr = lDistance;
+		*lPulseWidthPtr = lPulseWidth;
+
+		if (lIsReady)
+		{
+			lValuePtr[0] = htonl(getFilteredDistance(lSum, lSortedPtr));
+			if (2 == lIntegersPerEcho)
+			{
+				lValuePtr[1] = htonl(int32_t(lSum.mPulseWidthSum / mWindowSize));
+			}
+		}
+		lValuePtr += lIntegersPerPoint;
+	}
+	if (!lIsReady)
+	{
+		return false;
+	}
+
+    CRC32 lCRC;
+    int32_t lCRCPosition; // position of the CRC in the buffer
+    uint32_t lCRCValue;
+
+    lCRCPosition = (8 + lLength + 4) / sizeof(int32_t) - 1;
+	lCRCValue = lCRC.get(lDataPtr.asIntegerPtr + 0,  8 + lLength);
+	lDataPtr.asIntegerPtr[lCRCPosition] = htonl(lCRCValue);
+    *plen = 8 + lLength + 4;
+#if 0
+    printf("Send Length = %d\r\n", lLength);
+	printf("Send CRCPosition = %d\r\n", lCRCPosition);
+	printf("Send CRCValue = 0x%%x\r\n", lCRCValue);
+#endif
+
+	return true;
+}
+
+/*
+ * Averages groups of neighbouring points.
+ */
+void
+GSC2Session::averagePoints(char *data, int32_t len, int32_t *plen)
+{
+	// set moving integer pointer; skip command ID and length
+	cast_ptr_t lDataPtr = { data };
+	int32_t* lRcvIntegerPtr = &lDataPtr.asIntegerPtr[1];
+	const int32_t lNumberOfIntegers = len / sizeof(int32_t);
+	int32_t lSendLength;
+	// take length of parameter block
+	int32_t lNumberOfParameter;
+	int32_t lNumberOfParameterExpected;
+	int32_t lNumberOfEchoes = 0;
+	int32_t lDataContent = 0;
+	int32_t lNumberOfPoints = 0;
+	int32_t lSendNumberOfPoints = 0;
+	int32_t* lNumberOfPointsPtr = 0;
+
+#if 0
+	int32_t lLength;
+	lLength = ntohl(*lRcvIntegerPtr);
+	printf("Length = %d\r\n", lLength);
+#endif
+
+	// skip length field.
+	lRcvIntegerPtr++;
+
+	lNumberOfParameter = ntohl(*lRcvIntegerPtr++);
+	// command ID, length, number of parameters, parameters, number of points, CRC
+	if ((lNumberOfParameter < 0) || (lNumberOfParameter > lNumberOfIntegers - (3 + 1 + 1)))
+	{
+		return;
+	}
+	// check compatibility of firmware and control program
+	if (lNumberOfParameter > 10 /*NUMBER_OF_SCAN_PARAMETER*/)
+	{
+		lNumberOfParameterExpected = 10 /*NUMBER_OF_SCAN_PARAMETER*/;
+	}
+	else
+	{
+		lNumberOfParameterExpected = lNumberOfParameter;
+	}
+#if 0
+	printf("Number of parameters = %d, %d\r\n", lNumberOfParameter, lNumberOfParameterExpected);
+#endif
+
+	// copy known parameter to scan
+	for (int32_t l = 0; l < lNumberOfParameterExpected; l++)
+	{
+#if 0
+		printf("parameter[%d] = %d(0x%x)\r\n", l, ntohl(*lRcvIntegerPtr), ntohl(*lRcvIntegerPtr));
+#endif
+		if (l == 4 /* PARAMETER_NUMBER_OF_ECHOES */)
+		{
+			lNumberOfEchoes = ntohl(*lRcvIntegerPtr);
+		}
+		if (l == 8 /* PARAMETER_DATA_CONTENT */)
+		{
+			lDataContent = ntohl(*lRcvIntegerPtr);
+		}
+		lRcvIntegerPtr++;
+	}
+
+	// skip unkown parameter
+	for (int32_t l = lNumberOfParameterExpected; l < lNumberOfParameter; l++)
+	{
+#if 0
+		printf("parameter[%d] = %d(0x%x)\r\n", l, ntohl(*lRcvIntegerPtr), ntohl(*lRcvIntegerPtr));
+#endif
+		lRcvIntegerPtr++;
+	}
+
+	// get number of echoes. If 0, then the master echo is transfered instead of the number
+#if 0
+	printf("Data Content = %d\r\n", lDataContent);
+#endif
+
+#if 0
+	printf("Number of echoes = %d\r\n", lNumberOfEchoes);
+#endif
+	if (0 == lNumberOfEchoes)
+	{
+		lNumberOfEchoes = 1;
+	}
+
+	// take number of points, check limits
+	lNumberOfPointsPtr = lRcvIntegerPtr;
+	lNumberOfPoints = ntohl(*lRcvIntegerPtr++);
+#if 0
+	printf("Number of points = %d\r\n", lNumberOfPoints);
+#endif
+
+	// the data block must fit into the response
+	const int32_t lIntegersPerEcho = (lDataContent != 4 /* DATABLOCK_WITH_DISTANCES */) ? 2 : 1;
+	if ((lNumberOfEchoes < 0) || (4 /* MAX_NUMBER_OF_ECHOS */ < lNumberOfEchoes) || (lNumberOfPoints < 0)
+			|| (4000 /* MAX_POINTS_PER_SCAN */ < lNumberOfPoints)
+			|| ((lRcvIntegerPtr - lDataPtr.asIntegerPtr) + lNumberOfPoints * lNumberOfEchoes * lIntegersPerEcho + 1
+					> lNumberOfIntegers))
+	{
+		return;
+	}
+
+	// average the distances in host byte order; the pulse widths stay in place
+	const int32_t lNumberOfValues = lNumberOfPoints * lNumberOfEchoes;
+	// a group larger than the scan averages all of its points
+	const int32_t lGroupSize = (mPointAvgNumber < lNumberOfValues) ? mPointAvgNumber
+			: ((0 < lNumberOfValues) ? lNumberOfValues : 1);
+	mPointDistances.resize(lNumberOfValues);
+	mPointAverages.resize(PointAvg::getNumberOfGroups(lNumberOfValues, lGroupSize));
+	mPointCounts.resize(mPointAverages.size());
+	for (int32_t l = 0; l < lNumberOfValues; l++)
+	{
+		mPointDistances[l] = ntohl(lRcvIntegerPtr[l * lIntegersPerEcho]);
+	}
+	lSendNumberOfPoints = PointAvg::average(mPointDistances.data(), lNumberOfValues, lGroupSize,
+			mPointAverages.data(), mPointCounts.data());
+	for (int32_t l = 0; l < lSendNumberOfPoints; l++)
+	{
+		lRcvIntegerPtr[l * lIntegersPerEcho] = htonl(mPointAverages[l]);
+	}
+
+    CRC32 lCRC;
+    int32_t lCRCPosition; // position of the CRC in the buffer
+    uint32_t lCRCValue;
+
+    lSendLength = 4 + 4 * lNumberOfParameter + 4 + (lDataContent == 4 ? 4 : 8) * lSendNumberOfPoints;
+    lCRCPosition = (8 + lSendLength + 4) / sizeof(int32_t) - 1;
+	lDataPtr.asIntegerPtr[1] = htonl(lSendLength); // Length
+	*lNumberOfPointsPtr = htonl(lSendNumberOfPoints); // Number of points
+	lCRCValue = lCRC.get(lDataPtr.asIntegerPtr + 0,  8 + lSendLength);
+	lDataPtr.asIntegerPtr[lCRCPosition] = htonl(lCRCValue);
+    *plen = 8 + lSendLength + 4;
+#if 0
+    printf("Send Length = %d\r\n", lSendLength);
+	printf("Send Number of points = %d\r\n", lSendNumberOfPoints);
+	printf("Send CRCPosition = %d\r\n", lCRCPosition);
+	printf("Send CRCValue = 0x%%x\r\n", lCRCValue);
+#endif
+
+	return;
+}
+
+/*
+ * Collects a GSCN response and averages when the window is full.
+ */
+bool
+GSC2Session::collectScan(char *data, int32_t len, int32_t *plen)
+{
+    if ((len < 4*3) || (len > MAX_FRAME_SIZE))
+    {
+    	return false;
+    }
+
+    CRC32 lCRC;
+	int32_t lLength = ntohl(*(int32_t *)(data + 4));
+    uint32_t lCRCExpected = ntohl(*(int32_t *)(data + (len - 4)));
+    uint32_t lCRCReceived = lCRC.get(data, len - 4);
+
+#if 0
+	printf("GSC2: Length = %d(%d)\r\n", lLength, len);
+    printf("GSC2: CRC expected:0x%x, received:0x%x\n", lCRCExpected, lCRCReceived);
+#endif
+    if (len < (lLength + 4*3) || lCRCExpected != lCRCReceived)
+    {
+    	return false;
+    }
+
+    if (!averageScans(data, len, plen))
+    {
+    	return false;
+    }
+
+    averagePoints(data, len, plen);
+
+    return true;
+}
+
+/*
+ * Converts a response of the sensor for the client.
+ */
+bool
+GSC2Session::convertResponse(char *data, int32_t len, int32_t *plen)
+{
+	if (mIsActive && !strncmp(data, "GSCN", 4))
+	{
+		if (collectScan(data, len, plen) == false)
+		{
+			memcpy(data, mRequest, mRequestLength);
+			*plen = mRequestLength;
+			return false;
+		}
+	}
+	return true;
+}
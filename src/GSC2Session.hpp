@@ -0,0 +1,372 @@
+#ifndef GSC2SESSION_HPP_
+#define GSC2SESSION_HPP_
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       GSC2Session.hpp - GSC2 emulation of the relay.
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ ****************************************************************************
+ */
+
+#include <vector>
+extern "C"
+{
+#include "ErrorID.h"
+}
+#include "Global.hpp"
+
+/**
+ * Class GSC2Session - GSC2 emulation for one client of the relay.
+ * <p>&nbsp;<p>
+ * The relay answers GSC2 requests for sensors which know GSCN only.
+ * A GSC2 request is converted into a GSCN request for the latest scan;
+ * if the client asks for averaging, the GSCN request is repeated until
+ * the requested number of scans is collected. Then the scans are
+ * averaged, groups of neighbouring points are averaged, and the result
+ * is returned to the client.
+ * <p>
+ * The scans are averaged in a sliding window: the last echo of each
+ * point is decoded once and kept in a ring together with running sums
+ * and counts per point. A new scan replaces the oldest one in the sums,
+ * so it costs the same for any window size. The window outlives the
+ * request: once it is full, each GSC2 request is answered with the
+ * moving average as soon as the next scan has arrived. It starts over
+ * if the settings or the layout of the scans change, or if more than
+ * one window of scans was missed.
+ * <p>
+ * Instead of the mean, the median or the trimmed mean of the window may
+ * be taken; they ignore single outliers like reflections of rain drops.
+ * For these filters the valid distances of each point are also kept
+ * sorted: a new scan removes one value from and inserts one value into
+ * each sorted window, so the filters cost O(window size) per point.
+ * <p>
+ * All state of a client is kept in its session, so several clients
+ * can average with their own settings.
+ */
+class GSC2Session
+{
+    public:
+
+        /** class constants */
+        enum GSC2SessionConstants_t
+        {
+            /** maximum number of scans to average */
+            MAX_SCAN_AVG_NUMBER = 64,
+
+            /** percentage of the distances removed at each end by FILTER_TRIMMED_MEAN */
+            TRIM_PERCENT = 25,
+
+            /** maximum size of a GSCN response; the maximum of the protocol */
+            MAX_FRAME_SIZE = 64 * 1024,
+
+            /** size of a GSCN request: command ID, length, scan number and CRC */
+            GSCN_REQUEST_SIZE = 4 + 4 + 4 + 4,
+
+            /** size of a GSC2 request: command ID, length, scan and point average numbers and CRC */
+            GSC2_REQUEST_SIZE = 4 + 4 + 4 + 4 + 4,
+
+            /** maximum number of points to average; the maximum number of points of a scan */
+            MAX_POINT_AVG_NUMBER = 4000
+        };
+
+        /**
+         * Filters to combine the distances of a point over the window.
+         * The pulse widths are always averaged.
+         */
+        enum GSC2Filter_t
+        {
+            /** arithmetic mean */
+            FILTER_MEAN, //
+
+            /** median */
+            FILTER_MEDIAN, //
+
+            /** mean without the TRIM_PERCENT smallest and largest distances */
+            FILTER_TRIMMED_MEAN, //
+
+            /** number of filters */
+            NUMBER_OF_FILTERS
+        };
+
+    private:
+
+        /** true while scans are collected for averaging */
+        bool mIsActive;
+
+        /** the GSCN request to be repeated */
+        char mRequest[GSCN_REQUEST_SIZE];
+
+        /** size of mRequest in bytes */
+        int32_t mRequestLength;
+
+        /** number of scans to average */
+        int32_t mScanAvgNumber;
+
+        /** number of neighbouring points to average */
+        int32_t mPointAvgNumber;
+
+        /** filter of the scan averaging */
+        GSC2Filter_t mFilter;
+
+        /**
+         * Running sums of a point over the window.
+         */
+        struct PointSum_t
+        {
+                /** sum of the valid distances */
+                int64_t mDistanceSum;
+
+                /** sum of the pulse widths */
+                int64_t mPulseWidthSum;
+
+                /** number of valid distances */
+                int32_t mDistanceCount;
+
+                /** number of no echo values */
+                int32_t mNoEchoCount;
+
+                /** number of noise values */
+                int32_t mNoiseCount;
+        };
+
+        /** number of scans in a full window */
+        int32_t mWindowSize;
+
+        /** number of scans in the window */
+        int32_t mWindowCount;
+
+        /** slot of the next scan; the oldest one once the window is full */
+        int32_t mWindowNext;
+
+        /** number of points of the scans in the window */
+        int32_t mWindowPoints;
+
+        /** number of echoes of the scans in the window */
+        int32_t mWindowEchoes;
+
+        /** data content of the scans in the window */
+        int32_t mWindowDataContent;
+
+        /** scan number of the latest scan in the window */
+        int32_t mLastScanNumber;
+
+        /** distances of the last echo in host byte order; mWindowSize per point */
+        std::vector<int32_t> mDistances;
+
+        /** pulse widths of the last echo in host byte order; mWindowSize per point */
+        std::vector<int32_t> mPulseWidths;
+
+        /** the valid distances sorted; mWindowSize per point, empty for FILTER_MEAN */
+        std::vector<int32_t> mSortedDistances;
+
+        /** the running sums; one per point */
+        std::vector<PointSum_t> mSums;
+
+        /** distances of all echoes in host byte order, input of the point averaging */
+        std::vector<int32_t> mPointDistances;
+
+        /** results of the point averaging */
+        std::vector<int32_t> mPointAverages;
+
+        /** valid distances per result of the point averaging */
+        std::vector<int32_t> mPointCounts;
+
+        /**
+         * Converts a GSC2 request into a GSCN request for the latest scan.
+         *
+         * @return
+         *      ERR_SUCCESS, ERR_INVALID_PARAMETER if the request is not
+         *      GSC2_REQUEST_SIZE bytes long, or ERR_CRC.
+         */
+        ErrorID_t
+        convertGSC2Request(char *data, int32_t len, int32_t *plen);
+
+        /**
+         * Adds a value of the last echo to the sums of a point.
+         *
+         * @param theWeight
+         *      1 to add the value, -1 to remove it.
+         */
+        static void
+        addToSum(PointSum_t& theSum, int32_t theDistance, int32_t thePulseWidth, int32_t theWeight);
+
+        /**
+         * Inserts a distance into the sorted distances of a point.
+         * No echo and noise values are not inserted.
+         *
+         * @param theCount
+         *      number of sorted distances.
+         */
+        static void
+        insertSorted(int32_t* theSortedPtr, int32_t theCount, int32_t theDistance);
+
+        /**
+         * Removes a distance from the sorted distances of a point.
+         * No echo and noise values are not removed.
+         *
+         * @param theCount
+         *      number of sorted distances.
+         */
+        static void
+        removeSorted(int32_t* theSortedPtr, int32_t theCount, int32_t theDistance);
+
+        /**
+         * Returns the filtered distance of a point.
+         *
+         * @param theSortedPtr
+         *      the sorted distances of the point; not used by FILTER_MEAN.
+         */
+        int32_t
+        getFilteredDistance(const PointSum_t& theSum, const int32_t* theSortedPtr) const;
+
+        /**
+         * Empties the window and sizes it for the scan layout.
+         */
+        void
+        resetWindow(int32_t theNumberOfPoints, int32_t theNumberOfEchoes, int32_t theDataContent);
+
+        /**
+         * Adds the latest scan to the window and writes the moving average
+         * into it.
+         *
+         * @return
+         *      true if the window is full and data holds the average.
+         */
+        bool
+        averageScans(char *data, int32_t len, int32_t *plen);
+
+        /**
+         * Averages groups of neighbouring points.
+         * A response whose data block does not fit into len bytes is
+         * left unchanged.
+         */
+        void
+        averagePoints(char *data, int32_t len, int32_t *plen);
+
+        /**
+         * Collects a GSCN response.
+         *
+         * @return
+         *      true if enough scans are collected and data holds the result.
+         */
+        bool
+        collectScan(char *data, int32_t len, int32_t *plen);
+
+        /* private assignment constructor to avoid misuse */
+        explicit
+        GSC2Session(const GSC2Session& src);
+
+        /* private assignment operator to avoid misuse */
+        GSC2Session&
+        operator =(const GSC2Session& src);
+
+    public:
+
+        /**
+         * Constructor.
+         */
+        GSC2Session();
+
+        /**
+         * Destructor.
+         */
+        virtual
+        ~GSC2Session();
+
+        /**
+         * Selects the filter of the scan averaging. The window starts over.
+         *
+         * @param theFilter
+         *      the filter.
+         */
+        void
+        setFilter(GSC2Filter_t theFilter);
+
+        /**
+         * Returns the name of a filter for the command line and log files.
+         *
+         * @param theFilter
+         *      the filter.
+         */
+        static const char*
+        getFilterName(GSC2Filter_t theFilter);
+
+        /**
+         * Finds a filter by its name.
+         *
+         * @param theName
+         *      the name as returned by getFilterName().
+         * @param theFilter
+         *      returns the filter.
+         * @return
+         *      ERR_SUCCESS if OK, ERR_INVALID_PARAMETER for an unknown name.
+         */
+        static ErrorID_t
+        findFilter(const char* theName, GSC2Filter_t& theFilter);
+
+        /**
+         * Ends the averaging; responses are passed unchanged.
+         */
+        void
+        reset();
+
+        /**
+         * Returns true while scans are collected for averaging.
+         */
+        bool
+        isActive() const
+        {
+            return mIsActive;
+        }
+
+        /**
+         * Converts a request of the client for the sensor.
+         * A GSC2 request is replaced by a GSCN request, other requests are
+         * left unchanged. A GSC2 request of the wrong size or with a wrong
+         * CRC is rejected and must not be sent to the sensor.
+         *
+         * @param data
+         *      the request; replaced in place.
+         * @param len
+         *      length of the request.
+         * @param plen
+         *      returns the length of the converted request.
+         * @return
+         *      ERR_SUCCESS, ERR_INVALID_PARAMETER or ERR_CRC if a GSC2
+         *      request was rejected.
+         */
+        ErrorID_t
+        convertRequest(char *data, int32_t len, int32_t *plen);
+
+        /**
+         * Converts a response of the sensor for the client.
+         *
+         * @param data
+         *      the response; replaced in place.
+         * @param len
+         *      length of the response.
+         * @param plen
+         *      returns the length of the converted data.
+         * @return
+         *      true if data holds the response for the client, false if
+         *      more scans are needed and data holds the GSCN request to be
+         *      sent to the sensor again.
+         */
+        bool
+        convertResponse(char *data, int32_t len, int32_t *plen);
+};
+
+#endif /* GSC2SESSION_HPP_ */
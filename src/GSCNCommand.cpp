@@ -20,14 +20,25 @@
  */
 
 #include "GSCNCommand.hpp"
+#include "ScanView.hpp"
 #include <stdio.h>
 
+// needed for ntohl
+#if defined(__WIN32__) || (defined(__CYGWIN__) && !defined(_WIN32))
+	#include <winsock2.h>
+#elif defined(__linux__)
+	#include <arpa/inet.h>
+#else
+	#error "This program requires Linux or Win32."
+#endif
+
 //#define DEBUG_PARSE 1
 
 /* Constructor */
 GSCNCommand::GSCNCommand(IDataStream & theDataStream) :
         CommandBase(theDataStream), //
-        mCommand() //
+        mCommand(), //
+        mRecorder()
 {
     // prepare the command
     memcpy(mCommand.mCommandID, "GSCN", 4);
@@ -59,16 +70,34 @@ GSCNCommand::clearScan(Scan_t& theScan)
 
 /*
  * Parses the receiver buffer and copy the result into the scan structure.
+ * The buffer is in network byte order.
  */
 ErrorID_t
 GSCNCommand::parseScan(Scan_t& theScan)
 {
     // set moving integer pointer; skip command ID and length
-    cast_ptr_t lDataPtr = { mBuffer };
-    int32_t* lIntegerPtr = &lDataPtr.asIntegerPtr[2];
+    const cast_ptr_t lDataPtr = { mBuffer };
+    const int32_t* lIntegerPtr = &lDataPtr.asIntegerPtr[2];
+
+    // the data end at the CRC in the last 4 bytes
+    const int32_t* const lEndPtr = &lDataPtr.asIntegerPtr[(mBytesReceived - 4) / sizeof(int32_t)];
+
+    // the header must contain command ID, length and number of parameters
+    if (lIntegerPtr >= lEndPtr)
+    {
+        clearScan(theScan);
+        return ERR_BUFFER_OVERFLOW;
+    }
 
     // take length of parameter block
-    int32_t lNumberOfParameter = *lIntegerPtr++;
+    int32_t lNumberOfParameter = ntohl(*lIntegerPtr++);
+
+    // the parameters and the number of points must be received
+    if ((0 > lNumberOfParameter) || ((lEndPtr - lIntegerPtr) <= lNumberOfParameter))
+    {
+        clearScan(theScan);
+        return ERR_BUFFER_OVERFLOW;
+    }
 
     // check compatibility of firmware and control program
     if (lNumberOfParameter >= NUMBER_OF_SCAN_PARAMETER)
@@ -87,7 +116,7 @@ GSCNCommand::parseScan(Scan_t& theScan)
     // copy known parameter to scan
     for (int32_t l = 0; l < theScan.mNumberOfParameter; l++)
     {
-        theScan.mParameter[l] = *lIntegerPtr++;
+        theScan.mParameter[l] = ntohl(*lIntegerPtr++);
 #if DEBUG_PARSE
         printf("parameter[%d] = %d(0x%x)\r\n", l, theScan.mParameter[l], theScan.mParameter[l]);
 #endif
@@ -97,7 +126,7 @@ GSCNCommand::parseScan(Scan_t& theScan)
     for (int32_t l = theScan.mNumberOfParameter; l < lNumberOfParameter; l++)
     {
 #if DEBUG_PARSE
-        printf("parameter[%d] = %d(0x%x)\r\n", l, *lIntegerPtr, *lIntegerPtr);
+        printf("parameter[%d] = %d(0x%x)\r\n", l, ntohl(*lIntegerPtr), ntohl(*lIntegerPtr));
 #endif
         lIntegerPtr++;
     }
@@ -110,11 +139,31 @@ GSCNCommand::parseScan(Scan_t& theScan)
     }
 
     // take number of points, check limits
-    theScan.mNumberOfPoints = *lIntegerPtr++;
+    theScan.mNumberOfPoints = ntohl(*lIntegerPtr++);
 #if DEBUG_PARSE
     printf("Number of points = %d\r\n", theScan.mNumberOfPoints);
 #endif
-    if ((MAX_NUMBER_OF_ECHOS < theScan.mNumberOfEchoes) || (MAX_POINTS_PER_SCAN < theScan.mNumberOfPoints))
+    if ((MAX_NUMBER_OF_ECHOS < theScan.mNumberOfEchoes) || (MAX_POINTS_PER_SCAN < theScan.mNumberOfPoints)
+            || (0 > theScan.mNumberOfEchoes) || (0 > theScan.mNumberOfPoints))
+    {
+        clearScan(theScan);
+        return ERR_BUFFER_OVERFLOW;
+    }
+
+    // integers per point according to the data content
+    int32_t lIntegersPerPoint = 0;
+    switch (theScan.mParameter[PARAMETER_DATA_CONTENT])
+    {
+        case NO_DATABLOCK:
+            break;
+        case DATABLOCK_WITH_DISTANCES:
+            lIntegersPerPoint = theScan.mNumberOfEchoes;
+            break;
+        default:
+            lIntegersPerPoint = 2 * theScan.mNumberOfEchoes;
+            break;
+    }
+    if ((lEndPtr - lIntegerPtr) < (lIntegersPerPoint * theScan.mNumberOfPoints))
     {
         clearScan(theScan);
         return ERR_BUFFER_OVERFLOW;
@@ -136,7 +185,7 @@ GSCNCommand::parseScan(Scan_t& theScan)
                 // loop for each point through all echos
                 for (int32_t lEchos = 0; lEchos < theScan.mNumberOfEchoes; lEchos++)
                 {
-                    theScan.mScanData[lPoints][lEchos].mDistance = *lIntegerPtr++;
+                    theScan.mScanData[lPoints][lEchos].mDistance = ntohl(*lIntegerPtr++);
                 } // end echos
             } // end points
             break;
@@ -150,8 +199,8 @@ GSCNCommand::parseScan(Scan_t& theScan)
                 // loop for each point through all echos
                 for (int32_t lEchos = 0; lEchos < theScan.mNumberOfEchoes; lEchos++)
                 {
-                    theScan.mScanData[lPoints][lEchos].mDistance = *lIntegerPtr++;
-                    theScan.mScanData[lPoints][lEchos].mPulseWidth = *lIntegerPtr++;
+                    theScan.mScanData[lPoints][lEchos].mDistance = ntohl(*lIntegerPtr++);
+                    theScan.mScanData[lPoints][lEchos].mPulseWidth = ntohl(*lIntegerPtr++);
                 } // end echos
             } // end points
             break;
@@ -162,7 +211,94 @@ GSCNCommand::parseScan(Scan_t& theScan)
 }
 
 /*
- * Performs the GSCN command.
+ * Prepares the command in network byte order.
+ */
+void
+GSCNCommand::prepareRequest(int32_t theScanNumber)
+{
+    mCommand.mScanNumber = theScanNumber;
+    mCommand.mLength = sizeof(mCommand.mScanNumber);
+    convertHostToNetwork(&mCommand, sizeof(mCommand));
+    calculateCRC(&mCommand, sizeof(mCommand));
+}
+
+/*
+ * Prepares and sends the command, receives the response.
+ */
+ErrorID_t
+GSCNCommand::requestScan(int32_t theScanNumber)
+{
+    prepareRequest(theScanNumber);
+    return sendCommand(&mCommand, sizeof(mCommand));
+}
+
+/*
+ * Sends the command without waiting for the response.
+ */
+ErrorID_t
+GSCNCommand::sendRequest(int32_t theScanNumber)
+{
+    prepareRequest(theScanNumber);
+    return writeCommand(&mCommand, sizeof(mCommand));
+}
+
+/*
+ * Receives the response of a command sent by sendRequest() and
+ * attaches a view to it.
+ */
+ErrorID_t
+GSCNCommand::receiveScan(ScanView& theScanView, char* theDataLogFileName)
+{
+    ErrorID_t result = ERR_SUCCESS;
+
+    // clear the view
+    theScanView.clear();
+
+    // receive
+    result = readResponse();
+
+    // the CRC was checked on receipt
+    if (ERR_SUCCESS == result)
+    {
+        result = theScanView.attach(mBuffer, mBytesReceived);
+    }
+
+    // log verified scans only
+    if (ERR_SUCCESS == result)
+    {
+        logResponse(theDataLogFileName);
+    }
+    return result;
+}
+
+/*
+ * Appends the received response to the recording in the data log file.
+ */
+void
+GSCNCommand::logResponse(char* theDataLogFileName)
+{
+    if ((0 == theDataLogFileName) || (0 == theDataLogFileName[0]))
+    {
+        return;
+    }
+
+    // a new file name starts a new recording; a file which failed is not retried
+    if (0 != strcmp(theDataLogFileName, mRecorder.getFileName()))
+    {
+        if (ERR_SUCCESS != mRecorder.open(theDataLogFileName))
+        {
+            fprintf(stderr, "Error: Cannot record scans in %s!\r\n", theDataLogFileName);
+        }
+    }
+    if (mRecorder.isOpen() && (ERR_SUCCESS != mRecorder.writeScan(mBuffer, mBytesReceived)))
+    {
+        fprintf(stderr, "Error: Cannot write %s, recording stopped!\r\n", theDataLogFileName);
+        mRecorder.close();
+    }
+}
+
+/*
+ * Performs the command and copies the scan.
  */
 ErrorID_t
 GSCNCommand::performCommand(int32_t theScanNumber, Scan_t &theScan, char* theDataLogFileName)
@@ -172,27 +308,38 @@ GSCNCommand::performCommand(int32_t theScanNumber, Scan_t &theScan, char* theDat
     // clear the scan
     clearScan(theScan);
 
-    // prepare the command
-    mCommand.mScanNumber = theScanNumber;
-    mCommand.mLength = sizeof(mCommand.mScanNumber);
-    convertHostToNetwork(&mCommand, sizeof(mCommand));
-    calculateCRC(&mCommand, sizeof(mCommand));
-
     // send command
-    result = sendCommand(&mCommand, sizeof(mCommand));
+    result = requestScan(theScanNumber);
 
     // convert to host byte order and copy
     if (ERR_SUCCESS == result)
     {
-        FILE* lDataLogFile = 0;
-        lDataLogFile = fopen(theDataLogFileName, "wb");
-        if (lDataLogFile)
-        {
-        	fwrite(mBuffer, mBytesReceived, 1, lDataLogFile);
-        	fclose(lDataLogFile);
-        }
-        convertNetworkToHost(mBuffer, mBytesReceived);
         result = parseScan(theScan);
     }
+
+    // log verified scans only
+    if (ERR_SUCCESS == result)
+    {
+        logResponse(theDataLogFileName);
+    }
+    return result;
+}
+
+/*
+ * Performs the command and attaches a view to the response.
+ */
+ErrorID_t
+GSCNCommand::performCommand(int32_t theScanNumber, ScanView& theScanView, char* theDataLogFileName)
+{
+    ErrorID_t result = sendRequest(theScanNumber);
+
+    if (ERR_SUCCESS == result)
+    {
+        result = receiveScan(theScanView, theDataLogFileName);
+    }
+    else
+    {
+        theScanView.clear();
+    }
     return result;
 }
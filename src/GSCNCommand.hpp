@@ -32,6 +32,9 @@
 #define GSCNCOMMAND_HPP_
 
 #include "CommandBase.hpp"
+#include "ScanRecorder.hpp"
+
+class ScanView;
 
 /**
  * Class GSCNCommand.hpp - Getting scans from the sensor.
@@ -108,8 +111,14 @@ class GSCNCommand : private CommandBase
                 int32_t mCRC;
         } mCommand;
 
+        /** records the responses; kept open while the command exists */
+        ScanRecorder mRecorder;
+
         /**
          * Parses the receiver buffer and copy the result into the scan structure.
+         * The CRC has been checked on receipt; the values are converted from
+         * network byte order while they are copied, so the buffer keeps the
+         * response as received for the data log.
          * Must be called after performCommand().
          *
          * @param theScan
@@ -117,11 +126,42 @@ class GSCNCommand : private CommandBase
          *
          * @return
          *      ERR_SUCCESS on success, otherwise a negative error code.
-         *
+         * @retval ERR_BUFFER_OVERFLOW
+         *      if the response is truncated or exceeds the limits of a scan.
          */
         ErrorID_t
         parseScan(Scan_t& theScan);
 
+        /**
+         * Prepares the GSCN command in network byte order.
+         *
+         * @param theScanNumber
+         *      the scan number; 0 means the latest scan measured.
+         */
+        void
+        prepareRequest(int32_t theScanNumber);
+
+        /**
+         * Prepares and sends the GSCN command and receives the response.
+         *
+         * @param theScanNumber
+         *      the scan number; 0 means the latest scan measured.
+         * @return
+         *      ERR_SUCCESS on success, otherwise a negative error code.
+         */
+        ErrorID_t
+        requestScan(int32_t theScanNumber);
+
+        /**
+         * Appends the received response to the recording in the data log file.
+         * The recording is opened by the first response and stays open.
+         *
+         * @param theDataLogFileName
+         *      file to store the response, or 0 or an empty string.
+         */
+        void
+        logResponse(char* theDataLogFileName);
+
         /* private assignment constructor to avoid misuse */
         explicit
         GSCNCommand(const GSCNCommand& src);
@@ -146,6 +186,12 @@ class GSCNCommand : private CommandBase
         virtual
         ~GSCNCommand();
 
+        /** time in ns when the first byte of the last response arrived */
+        using CommandBase::getFirstByteTime;
+
+        /** time in ns when the last response was complete */
+        using CommandBase::getLastByteTime;
+
         /**
          * Clears a Scan_t structure.
          */
@@ -164,6 +210,51 @@ class GSCNCommand : private CommandBase
          */
         ErrorID_t
         performCommand(int32_t theScanNumber, Scan_t& theScan, char* theDataLogFileName);
+
+        /**
+         * Performs the GSCN command and attaches a view to the response.
+         * Nothing is copied or converted; the view is valid until the next
+         * command is performed.
+         *
+         * @param theScanNumber
+         *      the scan number; 0 means the latest scan measured.
+         * @param theScanView
+         *      the view on the received scan.
+         * @param theDataLogFileName
+         *      file to store the response, or 0.
+         * @return
+         *      ERR_SUCCESS on success, otherwise a negative error code.
+         */
+        ErrorID_t
+        performCommand(int32_t theScanNumber, ScanView& theScanView, char* theDataLogFileName);
+
+        /**
+         * Sends the GSCN command without waiting for the response.
+         * Several requests may be sent before the responses are received
+         * by receiveScan().
+         *
+         * @param theScanNumber
+         *      the scan number; 0 means the latest scan measured.
+         * @return
+         *      ERR_SUCCESS on success, otherwise a negative error code.
+         */
+        ErrorID_t
+        sendRequest(int32_t theScanNumber);
+
+        /**
+         * Receives the next GSCN response and attaches a view to it.
+         * The responses are received in the order the sensor sends them;
+         * use the scan number to match them with the requests.
+         *
+         * @param theScanView
+         *      the view on the received scan; valid until the next command.
+         * @param theDataLogFileName
+         *      file to store the response, or 0.
+         * @return
+         *      ERR_SUCCESS on success, otherwise a negative error code.
+         */
+        ErrorID_t
+        receiveScan(ScanView& theScanView, char* theDataLogFileName);
 };
 
 #endif /* GSCNCOMMAND_HPP_ */
@@ -56,6 +56,45 @@ class IDataStream
         virtual ErrorID_t
         close(void) = 0;
 
+        /**
+         * Returns the operating system handle of the data stream, so an
+         * event loop can wait for received data with poll().
+         *
+         * @return
+         *      the file descriptor, or -1 if the data stream has none
+         *      which can be polled.
+         */
+        virtual int
+        getHandle()
+        {
+            return -1;
+        }
+
+        /**
+         * Returns the time when the first byte of the last frame read
+         * arrived, for streams which receive a frame in several parts.
+         *
+         * @return
+         *      the time in ns of the MonotonicClock, or 0 if the stream
+         *      does not know it.
+         */
+        virtual uint64_t
+        getFirstByteTime()
+        {
+            return 0;
+        }
+
+        /**
+         * Returns true if a complete frame was received with an earlier
+         * read and is buffered, so the next read() returns it without
+         * waiting. poll() on the handle does not see such a frame.
+         */
+        virtual bool
+        hasBufferedFrame()
+        {
+            return false;
+        }
+
         /**
          * Returns true if the socket is ready to be used.
          */
@@ -77,7 +116,8 @@ class IDataStream
          * Reads up to len bytes of data from the input buffer device
          * into an array of bytes.
          * If no data are available because the end of the data stream has been
-         * reached, the value -1 is returned.
+         * reached, the value -1 is returned. A data stream which has ended for
+         * good, like a replayed recording, returns ERR_END_OF_STREAM.
          *
          * @param buffer-
          *      a buffer to read
@@ -99,7 +139,8 @@ class IDataStream
          * @param size -
          *      number of bytes to write.
          * @return -
-         *      the number bytes written or a negative error code if failed.
+         *      the number bytes written or a negative error code if failed,
+         *      ERR_END_OF_STREAM if the data stream has ended for good.
          */
         virtual int32_t
         write(void* buffer, int32_t size) = 0;
@@ -0,0 +1,158 @@
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       LatencyHistogram.cpp
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ *
+ ****************************************************************************
+ */
+
+#include <cstring>
+
+#include "LatencyHistogram.hpp"
+
+/*
+ * Standard constructor.
+ */
+LatencyHistogram::LatencyHistogram() :
+        mCounts(), //
+        mTotalCount(0), //
+        mSum(0), //
+        mMin(0), //
+        mMax(0)
+{
+    // nothing more to do.
+}
+
+/*
+ * Standard destructor.
+ */
+LatencyHistogram::~LatencyHistogram()
+{
+    // nothing to be done.
+}
+
+/*
+ * Returns the bucket of a duration.
+ * Values below 2 * SUB_BUCKET_COUNT are their own bucket; above, the
+ * value is shifted until it has SUB_BUCKET_BITS + 1 bits left.
+ */
+int32_t
+LatencyHistogram::getBucket(uint64_t theValue)
+{
+    if ((1ULL << MAX_BITS) <= theValue)
+    {
+        return NUMBER_OF_BUCKETS - 1;
+    }
+
+    int32_t lShift = 0;
+    while ((2ULL * SUB_BUCKET_COUNT) <= (theValue >> lShift))
+    {
+        lShift++;
+    }
+    if (0 == lShift)
+    {
+        return static_cast<int32_t>(theValue);
+    }
+    return (lShift + 1) * SUB_BUCKET_COUNT + static_cast<int32_t>((theValue >> lShift) - SUB_BUCKET_COUNT);
+}
+
+/*
+ * Returns the largest duration counted in a bucket.
+ */
+uint64_t
+LatencyHistogram::getHighestValue(int32_t theBucket)
+{
+    if ((2 * SUB_BUCKET_COUNT) > theBucket)
+    {
+        return theBucket;
+    }
+    const int32_t lShift = theBucket / SUB_BUCKET_COUNT - 1;
+    const uint64_t lLowest = static_cast<uint64_t>(theBucket % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT) << lShift;
+    return lLowest + (1ULL << lShift) - 1;
+}
+
+/*
+ * Counts a duration.
+ */
+void
+LatencyHistogram::record(uint64_t theValue)
+{
+    mCounts[getBucket(theValue)]++;
+    if ((0 == mTotalCount) || (theValue < mMin))
+    {
+        mMin = theValue;
+    }
+    if (theValue > mMax)
+    {
+        mMax = theValue;
+    }
+    mSum += theValue;
+    mTotalCount++;
+}
+
+/*
+ * Removes all durations.
+ */
+void
+LatencyHistogram::reset()
+{
+    memset(mCounts, 0, sizeof(mCounts));
+    mTotalCount = 0;
+    mSum = 0;
+    mMin = 0;
+    mMax = 0;
+}
+
+/*
+ * Returns the mean duration in ns.
+ */
+double
+LatencyHistogram::getMean() const
+{
+    return (0 != mTotalCount) ? static_cast<double>(mSum) / mTotalCount : 0.0;
+}
+
+/*
+ * Returns the duration which is not exceeded by the given percentage.
+ * Nearest rank: the bucket which holds the ceil(p * n)th duration.
+ */
+uint64_t
+LatencyHistogram::getValueAtPercentile(double thePercentile) const
+{
+    if (0 == mTotalCount)
+    {
+        return 0;
+    }
+
+    uint64_t lRank = static_cast<uint64_t>(thePercentile / 100.0 * mTotalCount + 0.999999);
+    if (1 > lRank)
+    {
+        lRank = 1;
+    }
+
+    uint64_t lCount = 0;
+    for (int32_t lBucket = 0; lBucket < NUMBER_OF_BUCKETS; lBucket++)
+    {
+        lCount += mCounts[lBucket];
+        if (lCount >= lRank)
+        {
+            const uint64_t lValue = getHighestValue(lBucket);
+            return (lValue < mMax) ? lValue : mMax;
+        }
+    }
+    return mMax;
+}
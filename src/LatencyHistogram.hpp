@@ -0,0 +1,163 @@
+#ifndef LATENCYHISTOGRAM_HPP_
+#define LATENCYHISTOGRAM_HPP_
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       LatencyHistogram.hpp - Counts durations in log-linear buckets.
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ ****************************************************************************
+ */
+
+#include "Global.hpp"
+
+/**
+ * Class LatencyHistogram - histogram of durations in ns, like HdrHistogram.
+ * <p>&nbsp;<p>
+ * The durations are counted in buckets of a fixed relative width: below
+ * 128 ns each value has a bucket of its own, above each power of two
+ * is split into 64 buckets. So a percentile is known to 1.6% from 1 ns
+ * up to the largest duration of about 18 minutes, longer durations are
+ * counted in the last bucket. The minimum, the maximum and the mean are
+ * exact.
+ * <p>
+ * record() takes constant time and does not allocate memory, so it can
+ * be called for each scan.
+ */
+class LatencyHistogram
+{
+    public:
+
+        /** class constants */
+        enum LatencyHistogramConstants_t
+        {
+            /** bits of the buckets in each power of two */
+            SUB_BUCKET_BITS = 6,
+
+            /** buckets in each power of two */
+            SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS,
+
+            /** durations below 2^MAX_BITS ns are counted in their bucket */
+            MAX_BITS = 40,
+
+            /** number of buckets */
+            NUMBER_OF_BUCKETS = (MAX_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT
+        };
+
+    private:
+
+        /** number of durations per bucket */
+        uint32_t mCounts[NUMBER_OF_BUCKETS];
+
+        /** number of durations recorded */
+        uint64_t mTotalCount;
+
+        /** sum of the durations in ns */
+        uint64_t mSum;
+
+        /** shortest duration in ns */
+        uint64_t mMin;
+
+        /** longest duration in ns */
+        uint64_t mMax;
+
+        /**
+         * Returns the bucket of a duration.
+         */
+        static int32_t
+        getBucket(uint64_t theValue);
+
+        /**
+         * Returns the largest duration counted in a bucket.
+         */
+        static uint64_t
+        getHighestValue(int32_t theBucket);
+
+    public:
+
+        /**
+         * Standard constructor. The histogram is empty.
+         */
+        LatencyHistogram();
+
+        /**
+         * Destructor.
+         */
+        virtual
+        ~LatencyHistogram();
+
+        /**
+         * Counts a duration.
+         *
+         * @param theValue
+         *      the duration in ns.
+         */
+        void
+        record(uint64_t theValue);
+
+        /**
+         * Removes all durations.
+         */
+        void
+        reset();
+
+        /**
+         * Returns the number of durations recorded.
+         */
+        uint64_t
+        getTotalCount() const
+        {
+            return mTotalCount;
+        }
+
+        /**
+         * Returns the shortest duration in ns, or 0 if empty.
+         */
+        uint64_t
+        getMin() const
+        {
+            return (0 != mTotalCount) ? mMin : 0;
+        }
+
+        /**
+         * Returns the longest duration in ns, or 0 if empty.
+         */
+        uint64_t
+        getMax() const
+        {
+            return mMax;
+        }
+
+        /**
+         * Returns the mean duration in ns, or 0 if empty.
+         */
+        double
+        getMean() const;
+
+        /**
+         * Returns the duration which is not exceeded by the given percentage
+         * of the durations recorded.
+         *
+         * @param thePercentile
+         *      the percentage, 0 to 100.
+         * @return
+         *      the largest duration of the bucket in ns, but not more than
+         *      the maximum, or 0 if empty.
+         */
+        uint64_t
+        getValueAtPercentile(double thePercentile) const;
+};
+
+#endif /* LATENCYHISTOGRAM_HPP_ */
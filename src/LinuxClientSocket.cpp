@@ -53,7 +53,13 @@ mIsOpen(false),//
 mLogFile(0),//
 mServerIPAddress(),//
 mSocketHandle(-1),//
-mTimeout(0)
+mTimeout(0),//
+mReceiveBufferSize(0),//
+mSendBufferSize(0),//
+mAppliedReceiveBufferSize(0),//
+mAppliedSendBufferSize(0),//
+mReceiveTime(0),//
+mNumberOfDrops(0)
 {
     // create the socket handle
     mSocketHandle = socket(AF_INET, SOCK_DGRAM, 0);
@@ -151,6 +157,62 @@ ClientSocket::setTimeout(int32_t theTimeout)
     return ERR_SUCCESS;
 }
 
+/*
+ * Defines the sizes of the socket buffers.
+ */
+ErrorID_t
+ClientSocket::setBufferSizes(int32_t theReceiveBufferSize, int32_t theSendBufferSize)
+{
+    if ((0 > theReceiveBufferSize) || (0 > theSendBufferSize))
+    {
+        return ERR_INVALID_PARAMETER;
+    }
+    mReceiveBufferSize = theReceiveBufferSize;
+    mSendBufferSize = theSendBufferSize;
+    return ERR_SUCCESS;
+}
+
+/*
+ * Sets the size of a socket buffer.
+ */
+int32_t
+ClientSocket::applyBufferSize(int theOption, int theForcedOption, int32_t theSize)
+{
+    int lSize = theSize;
+    socklen_t lLength = sizeof(lSize);
+
+    // the forced option needs CAP_NET_ADMIN, the other one is limited
+    if ((0 < theSize) && (0 > setsockopt(mSocketHandle, SOL_SOCKET, theForcedOption, &lSize, sizeof(lSize)))
+            && (0 > setsockopt(mSocketHandle, SOL_SOCKET, theOption, &lSize, sizeof(lSize))))
+    {
+        perror("setsockopt failed");
+    }
+
+    // the kernel doubles the size for its bookkeeping
+    lSize = 0;
+    getsockopt(mSocketHandle, SOL_SOCKET, theOption, &lSize, &lLength);
+    if (lSize < 2 * theSize)
+    {
+        fprintf(stderr, "Socket warning: buffer of %d bytes requested, %d bytes applied.\r\n", theSize, lSize / 2);
+    }
+    return lSize;
+}
+
+/*
+ * Takes the receive time and the drop counter of a datagram read.
+ */
+void
+ClientSocket::updateDiagnostics(const Datagram_t& theDatagram)
+{
+    mReceiveTime = theDatagram.mReceiveTime;
+
+    // the counter of the socket; only reported after a drop
+    if (mNumberOfDrops < theDatagram.mNumberOfDrops)
+    {
+        mNumberOfDrops = theDatagram.mNumberOfDrops;
+    }
+}
+
 /*
  * Defines a log file to save received data.
  */
@@ -199,6 +261,20 @@ ClientSocket::open()
         return ERR_INVALID_HANDLE;
     }
 
+    // socket buffers
+    mAppliedReceiveBufferSize = applyBufferSize(SO_RCVBUF, SO_RCVBUFFORCE, mReceiveBufferSize);
+    mAppliedSendBufferSize = applyBufferSize(SO_SNDBUF, SO_SNDBUFFORCE, mSendBufferSize);
+
+    // kernel receive time and drop counter with each datagram; optional
+    int lIsEnabled = 1;
+    if ((0 > setsockopt(mSocketHandle, SOL_SOCKET, SO_TIMESTAMPNS, &lIsEnabled, sizeof(lIsEnabled)))
+            || (0 > setsockopt(mSocketHandle, SOL_SOCKET, SO_RXQ_OVFL, &lIsEnabled, sizeof(lIsEnabled))))
+    {
+    	perror("setsockopt failed");
+        fprintf(stderr, "Socket warning: no kernel receive time stamps and drop counter.\r\n");
+    }
+    mReceiveTime = 0;
+
     mIsOpen = true;
     return ERR_SUCCESS;
 }
@@ -215,7 +291,16 @@ ClientSocket::read(void* buffer, int32_t size)
 
     if (isOpen() && (0 != buffer) && (0 < size))
     {
-        result = recv(mSocketHandle, static_cast<char*>(buffer), size, 0);
+        // recvmsg() with the receive time and drop counter of the kernel
+        Datagram_t lDatagram;
+        lDatagram.mBuffer = buffer;
+        lDatagram.mSize = size;
+        result = DatagramBatch::receive(mSocketHandle, &lDatagram, 1, true, true);
+        if (1 == result)
+        {
+            updateDiagnostics(lDatagram);
+            result = lDatagram.mLength;
+        }
 
         // OK?
         if (0 < result)
@@ -235,17 +320,41 @@ ClientSocket::read(void* buffer, int32_t size)
             }
         }
 
-        // handle most common errors
+        // handle most common errors; receive() returns -errno
         else
         {
-            // get socket error ID.
-            result = -errno;
             //fprintf(stderr, "Socket error: cannot read (%d)\r\n", result);
         }
     }
     return result;
 }
 
+/*
+ * Receives several datagrams with one system call.
+ */
+int32_t
+ClientSocket::readBatch(Datagram_t* theDatagrams, int32_t theCount, bool theIsWaiting)
+{
+    if (false == isOpen())
+    {
+        return 0;
+    }
+
+    const int32_t result = DatagramBatch::receive(mSocketHandle, theDatagrams, theCount, theIsWaiting, true);
+
+    for (int32_t l = 0; l < result; l++)
+    {
+        updateDiagnostics(theDatagrams[l]);
+
+        // write received bytes into a log file
+        if (0 != mLogFile)
+        {
+            fwrite(theDatagrams[l].mBuffer, theDatagrams[l].mLength, 1, mLogFile);
+        }
+    }
+    return result;
+}
+
 /*
  * POSIX similar write() method.
  * Writes len bytes from the specified byte array to the outgoing
@@ -271,4 +380,17 @@ ClientSocket::write(void* buffer, int32_t size)
     return result;
 }
 
+/*
+ * Sends several datagrams with one system call.
+ */
+int32_t
+ClientSocket::writeBatch(Datagram_t* theDatagrams, int32_t theCount)
+{
+    if (false == isOpen())
+    {
+        return 0;
+    }
+    return DatagramBatch::send(mSocketHandle, theDatagrams, theCount, true);
+}
+
 #endif /* __linux__ */
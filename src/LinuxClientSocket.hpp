@@ -33,6 +33,7 @@
 #include <cstdio>
 #include <netinet/in.h>
 #include "IDataStream.hpp"
+#include "LinuxDatagram.hpp"
 
 /**
  * Class ClientSocket.hpp -
@@ -71,6 +72,15 @@
  *  Microsoft Windows. Version 1.1, 20 January 1993",<br>
  *  <ref http://www.sockets.com/winsock.htm>
  *
+ * <b>Socket level diagnostics</b>
+ * <p>
+ * The sizes of the kernel's receive and send buffers can be defined, so
+ * the datagrams of a burst are not dropped while the program processes a
+ * scan. The kernel stamps each datagram when it is received
+ * (SO_TIMESTAMPNS): getFirstByteTime() returns this time, so the time a
+ * response waited in the socket can be told from the processing time.
+ * The datagrams dropped because the receive buffer was full are counted
+ * (SO_RXQ_OVFL).
  */
 class ClientSocket : public IDataStream
 {
@@ -93,6 +103,47 @@ class ClientSocket : public IDataStream
         /** timeout in s. */
         int mTimeout;
 
+        /** requested size of the receive buffer in bytes, or 0 */
+        int32_t mReceiveBufferSize;
+
+        /** requested size of the send buffer in bytes, or 0 */
+        int32_t mSendBufferSize;
+
+        /** size of the receive buffer reported by the kernel */
+        int32_t mAppliedReceiveBufferSize;
+
+        /** size of the send buffer reported by the kernel */
+        int32_t mAppliedSendBufferSize;
+
+        /** time in ns of the MonotonicClock when the kernel received the
+         *  last datagram read, or 0 */
+        uint64_t mReceiveTime;
+
+        /** number of datagrams dropped by the kernel */
+        uint32_t mNumberOfDrops;
+
+        /**
+         * Sets the size of a socket buffer.
+         *
+         * @param theOption
+         *      SO_RCVBUF or SO_SNDBUF.
+         * @param theForcedOption
+         *      SO_RCVBUFFORCE or SO_SNDBUFFORCE, which exceeds the system
+         *      limit if the process may do so.
+         * @param theSize
+         *      the size in bytes; 0 keeps the default.
+         * @return
+         *      the size reported by the kernel.
+         */
+        int32_t
+        applyBufferSize(int theOption, int theForcedOption, int32_t theSize);
+
+        /**
+         * Takes the receive time and the drop counter of a datagram read.
+         */
+        void
+        updateDiagnostics(const Datagram_t& theDatagram);
+
         /** private assignment constructor to avoid misuse */
         explicit
         ClientSocket(const ClientSocket& src);
@@ -125,6 +176,59 @@ class ClientSocket : public IDataStream
         virtual ErrorID_t
         close();
 
+        /**
+         * Returns the time when the kernel received the last datagram read.
+         *
+         * @return
+         *      the time in ns of the MonotonicClock, or 0 if the kernel
+         *      does not stamp the datagrams.
+         */
+        virtual uint64_t
+        getFirstByteTime()
+        {
+            return mReceiveTime;
+        }
+
+        /**
+         * Returns the socket handle, or -1 if the socket is not open.
+         */
+        virtual int
+        getHandle()
+        {
+            return mIsOpen ? mSocketHandle : -1;
+        }
+
+        /**
+         * Returns the number of datagrams the kernel dropped because the
+         * receive buffer was full. The kernel reports it with the next
+         * datagram which is queued after the drop.
+         */
+        uint32_t
+        getNumberOfDrops() const
+        {
+            return mNumberOfDrops;
+        }
+
+        /**
+         * Returns the size of the receive buffer in bytes as reported by
+         * the kernel after open(); Linux doubles the size requested.
+         */
+        int32_t
+        getReceiveBufferSize() const
+        {
+            return mAppliedReceiveBufferSize;
+        }
+
+        /**
+         * Returns the size of the send buffer in bytes as reported by the
+         * kernel after open(); Linux doubles the size requested.
+         */
+        int32_t
+        getSendBufferSize() const
+        {
+            return mAppliedSendBufferSize;
+        }
+
         /**
          * Returns true if the socket is ready to be used.
          */
@@ -161,6 +265,25 @@ class ClientSocket : public IDataStream
         virtual int32_t
         read(void* buffer, int32_t size);
 
+        /**
+         * Receives several datagrams with one system call,
+         * e.g. a burst of responses.
+         *
+         * @param theDatagrams
+         *      the buffers; mLength is set, mAddress is not used.
+         * @param theCount
+         *      number of buffers; at most DatagramBatch::MAX_BATCH_SIZE
+         *      datagrams are received.
+         * @param theIsWaiting
+         *      true to wait for the first datagram like read(), false to
+         *      return -EAGAIN at once if none is waiting.
+         * @return
+         *      the number of datagrams received or a negative error code
+         *      if failed.
+         */
+        int32_t
+        readBatch(Datagram_t* theDatagrams, int32_t theCount, bool theIsWaiting);
+
         /**
          * Setup the client's address.
          * @param theClientAddress
@@ -182,6 +305,22 @@ class ClientSocket : public IDataStream
         ErrorID_t
         setServerIPAddress(const char* theServerAddress, int32_t thePort);
 
+        /**
+         * Defines the sizes of the socket buffers; applied by open().
+         * The system limits them to net.core.rmem_max and wmem_max unless
+         * the process has CAP_NET_ADMIN.
+         *
+         * @param theReceiveBufferSize
+         *      size of the receive buffer in bytes; 0 keeps the default.
+         * @param theSendBufferSize
+         *      size of the send buffer in bytes; 0 keeps the default.
+         * @return
+         *      ERR_SUCCESS if OK, ERR_INVALID_PARAMETER if a size is
+         *      negative.
+         */
+        ErrorID_t
+        setBufferSizes(int32_t theReceiveBufferSize, int32_t theSendBufferSize);
+
         /**
          * Defines a log file to save received data.
          * Set to 0 to disable logging.
@@ -218,6 +357,21 @@ class ClientSocket : public IDataStream
          */
         virtual int32_t
         write(void* buffer, int32_t size);
+
+        /**
+         * Sends several datagrams with one system call,
+         * e.g. pipelined requests.
+         *
+         * @param theDatagrams
+         *      the datagrams with mLength bytes each; mAddress is not used.
+         * @param theCount
+         *      number of datagrams.
+         * @return
+         *      the number of datagrams sent or a negative error code if
+         *      not even the first could be sent.
+         */
+        int32_t
+        writeBatch(Datagram_t* theDatagrams, int32_t theCount);
 };
 #endif /* Linux */
 #endif /* LINUX_CLIENT_SOCKET_HPP_ */
@@ -7,7 +7,7 @@
 
 #if __linux__
 
-#include <arpa/inet.h>
+#include <poll.h>
 #include <stdint.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -21,19 +21,27 @@ namespace fcntl {
 #include <errno.h>
 
 #include "LinuxClientUART.hpp"
+#include "LinuxUARTBaudRate.h"
+#include "MonotonicClock.hpp"
 
 //#define DEBUG_WRITE 1
 //#define DEBUG_READ 1
 
-#define sleep_msecs(s) unistd::usleep(s*1000)
+// ms after the last byte until an incomplete frame is given up, if read() does not wait
+#define FRAME_TIMEOUT 100
 
-#define BUFFER_MAX (8*1024)
+// % the baud rate applied by the driver may differ from the rate requested
+#define BAUD_RATE_TOLERANCE 3
 
 ClientUART::ClientUART() :
         mIsOpen(false), //
+        mBaudRate(0), //
+        mRequestedBaudRate(0), //
+        mAppliedBaudRate(0), //
 		tty_fd(0), //
         mLogFile(0), //
-        mTimeout(0)
+        mTimeout(0), //
+        mFramer()
 {
 	strcpy(mPort, "\0");
 }
@@ -105,9 +113,14 @@ ErrorID_t ClientUART::config(const char* thePort, unsigned int theBaudRate, int3
 		case 460800:
 			mBaudRate = B460800;
 			break;
-		default:
+		case 0:
 			return ERR_CONFIGURATION_ERROR;
+		default:
+			// e.g. 921600 or 3000000: set by termios2 in open()
+			mBaudRate = 0;
+			break;
 	}
+	mRequestedBaudRate = theBaudRate;
 
 	strcpy(mPort, thePort);
 
@@ -149,20 +162,45 @@ ErrorID_t ClientUART::open()
 	tio.c_oflag = 0;
 	tio.c_cflag = CS8 | CREAD | CLOCAL;           // 8n1, see termios.h for more information
 	tio.c_lflag = 0;
-	if (mTimeout == 0)
+	// read() never blocks: the timeout is waited for by poll()
+	tio.c_cc[VMIN] = 0;
+	tio.c_cc[VTIME] = 0;
+	if (mBaudRate != 0)
 	{
-		tio.c_cc[VMIN] = 0;
-		tio.c_cc[VTIME] = 0;
+		cfsetospeed(&tio, (speed_t)mBaudRate);            // mBaudRate
+		cfsetispeed(&tio, (speed_t)mBaudRate);            // mBaudRate
 	}
-	else
+	tcsetattr(tty_fd, TCSANOW, &tio);
+
+	// a rate without B constant is set by termios2
+	if ((mBaudRate == 0) && (setUARTBaudRate(tty_fd, mRequestedBaudRate) < 0))
 	{
-		tio.c_cc[VMIN] = 0;
-		tio.c_cc[VTIME] = mTimeout / 100;
+		fprintf(stderr, "Error: baud rate %u not supported by %s: %s.\r\n", mRequestedBaudRate, mPort, strerror(errno));
+		tcsetattr(tty_fd, TCSANOW, &old_tio);
+		unistd::close(tty_fd);
+		return ERR_CONFIGURATION_ERROR;
+	}
+
+	// the driver may round the rate to the divisors of its clock
+	mAppliedBaudRate = getUARTBaudRate(tty_fd);
+	if (mAppliedBaudRate != 0)
+	{
+		const unsigned int deviation = (mAppliedBaudRate > mRequestedBaudRate) ?
+				mAppliedBaudRate - mRequestedBaudRate : mRequestedBaudRate - mAppliedBaudRate;
+		if ((unsigned long long)deviation * 100 > (unsigned long long)mRequestedBaudRate * BAUD_RATE_TOLERANCE)
+		{
+			fprintf(stderr, "Error: baud rate %u requested, %u applied by %s.\r\n", mRequestedBaudRate, mAppliedBaudRate, mPort);
+			tcsetattr(tty_fd, TCSANOW, &old_tio);
+			unistd::close(tty_fd);
+			return ERR_CONFIGURATION_ERROR;
+		}
+		if (deviation != 0)
+		{
+			printf("UART baud rate %u applied for %u.\r\n", mAppliedBaudRate, mRequestedBaudRate);
+		}
 	}
-	cfsetospeed(&tio, (speed_t)mBaudRate);            // mBaudRate
-	cfsetispeed(&tio, (speed_t)mBaudRate);            // mBaudRate
-	tcsetattr(tty_fd, TCSANOW, &tio);
 
+	mFramer.reset();
 	mIsOpen = true;
     return ERR_SUCCESS;
 }
@@ -186,103 +224,97 @@ ErrorID_t ClientUART::close()
 	return ERR_SUCCESS;
 }
 
-#define LOOP_MAX 100
-
 int32_t ClientUART::read(void* buffer, int32_t size)
 {
+	struct pollfd pfd;
 	ssize_t n;
-	int32_t total = 0; // Init. total received data.
-	int state = 0; // Init. state machine for getting length data of UDP data format.
-	int32_t length = INT32_MAX - 12; // 12 = 4bytes Function code + 4bytes length + 4bytes CRC on UDP data format.
-	int32_t loop = 0;
+	int32_t result;
 
 #if DEBUG_READ
 	printf("Reading UART data!\r\n");
 #endif
 
-	do
+	pfd.fd = tty_fd;
+	pfd.events = POLLIN;
+
+	for (;;)
 	{
-		n = unistd::read(tty_fd, (unsigned char *)buffer + total, size - total);
+		// a frame may be complete already with the bytes of the last read
+		result = mFramer.getFrame(buffer, size);
+		if (result != 0)
+		{
+			break;
+		}
+
+		// sleep until bytes arrive; with timeout 0 only take what is there
+		pfd.revents = 0;
+		n = poll(&pfd, 1, mTimeout);
 		if (n < 0)
 		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
 #if DEBUG_READ
-			printf("Read error UART data! %d,%d,%s\r\n", tty_fd, n, strerror(errno));
+			printf("Poll error UART! %d,%s\r\n", tty_fd, strerror(errno));
 #endif
-			return n;
+			return -1;
 		}
 		else if (n == 0)
 		{
-			if (total == 0)
+			// timeout: give up an incomplete frame and search the next one
+			if (mFramer.hasBufferedBytes()
+					&& ((mTimeout != 0)
+						|| (MonotonicClock::getNanoseconds() - mFramer.getReceiveTime() > FRAME_TIMEOUT * 1000000ULL)))
 			{
 #if DEBUG_READ
-				printf("Read zero byte UART data! %d, %d\r\n", n, total);
+				printf("Read timeout! Resync UART data!\r\n");
 #endif
-				return 0;
+				mFramer.skipFrame();
+				result = mFramer.getFrame(buffer, size);
 			}
-			// If read() return zero byte on timeout than break from loop.
-			if (mTimeout != 0)
+			break;
+		}
+
+		n = unistd::read(tty_fd, mFramer.getWritePtr(), mFramer.getFreeSize());
+		if (n < 0)
+		{
+			if ((errno == EINTR) || (errno == EAGAIN))
 			{
-#if DEBUG_READ
-				printf("Read timeout! %d, %d\r\n", n, total);
-#endif
-				return 0;
+				continue;
 			}
-			else // read() return zero byte on non-blocking mode
-			{
-				loop ++;
-				if (loop > LOOP_MAX)
-				{
 #if DEBUG_READ
-					printf("Read zero byte UART data! %d, %d\r\n", n, total);
+			printf("Read error UART data! %d,%d,%s\r\n", tty_fd, n, strerror(errno));
 #endif
-					return 0;
-				}
-			}
-			sleep_msecs(1);
-			continue;
+			return n;
 		}
-
-		loop = 0;
-
-		total += n;
-#if DEBUG_READ
-		printf("Read total %d bytes!\r\n", total);
-#endif
-
-		if (state == 0) // If state machine is getting length data.
+		else if (n == 0)
 		{
-			if (total >= 8) // If total received data is enough to get length data.
-			{
-				// Get length data from network endians data.
-				length = (int32_t)ntohl(*(uint32_t *)((unsigned char *)buffer + 4));
+			// readable without data: the line hung up
 #if DEBUG_READ
-				printf("Read format Length = %d\r\n", length);
+			printf("Read zero byte UART data!\r\n");
 #endif
-				if (length > BUFFER_MAX - 12)
-				{
+			return 0;
+		}
+		mFramer.commit(n, MonotonicClock::getNanoseconds());
 #if DEBUG_READ
-					printf("Read format Length error!\r\n");
+		printf("Read %d bytes!\r\n", (int)n);
 #endif
-					return 0;
-				}
-				state = 1; // Set state machine to other.
-			}
-		}
-	} while(total < length + 12); // Loop until total received data should reach as UDP data format(Function Code + Length + Data + CRC).
+	}
 
 #if DEBUG_READ
-	printf("Read %d byte UART data!\r\n", total);
-//#if 0
-	for(int32_t i = 0; i < total; i ++)
+	if (result > 0)
 	{
-		//printf("0x%x('%c') ", *((unsigned char *)buffer+i), *((unsigned char *)buffer+i));
-		printf("0x%x ", *((unsigned char *)buffer+i));
+		printf("Read %d byte UART data!\r\n", result);
+		for(int32_t i = 0; i < result; i ++)
+		{
+			printf("0x%x ", *((unsigned char *)buffer+i));
+		}
+		printf("\r\n");
 	}
-	printf("\r\n");
-//#endif
 #endif
 
-	return (length + 12);
+	return result;
 }
 
 int32_t ClientUART::write(void* buffer, int32_t size)
@@ -11,6 +11,7 @@
 #include <cstdio>
 #include <termios.h>
 #include "IDataStream.hpp"
+#include "UARTFramer.hpp"
 
 class ClientUART : public IDataStream
 {
@@ -20,8 +21,15 @@ class ClientUART : public IDataStream
 
         /** the sensors UART port */
 		string32_t mPort;
+		/** the B constant of the baud rate, or 0 to set it by termios2. */
 		unsigned int mBaudRate;
 
+		/** the baud rate requested by config(). */
+		unsigned int mRequestedBaudRate;
+
+		/** the baud rate the driver applied after open(). */
+		unsigned int mAppliedBaudRate;
+
 		struct termios tio, old_tio;
 		int tty_fd;
 
@@ -31,6 +39,9 @@ class ClientUART : public IDataStream
 		/** timeout in ms. */
 		int mTimeout;
 
+		/** reassembles the frames from the bytes received. */
+		UARTFramer mFramer;
+
         /** private assignment constructor to avoid misuse */
         explicit
 		ClientUART(const ClientUART& src);
@@ -44,6 +55,10 @@ class ClientUART : public IDataStream
 
 		virtual ~ClientUART();
 
+		/**
+		 * Configures the UART. Any baud rate is accepted; rates without B constant
+		 * (e.g. 921600, 1500000, 3000000) are set by termios2 and checked by open().
+		 */
 		ErrorID_t config(const char* thePort, unsigned int theBaudRate, int32_t theTimeout, FILE* theLogFile);
 
 		virtual ErrorID_t open();
@@ -53,8 +68,48 @@ class ClientUART : public IDataStream
             return mIsOpen;
         }
 
+		/** Returns the baud rate applied by the driver, or 0 if it is unknown. */
+		unsigned int getBaudRate()
+		{
+			return mAppliedBaudRate;
+		}
+
+		/** Returns the file descriptor of the UART, or -1 if it is not open. */
+		virtual int getHandle()
+		{
+			return mIsOpen ? tty_fd : -1;
+		}
+
 		ErrorID_t close();
 
+		/** Returns the time in ns when the first byte of the last frame arrived. */
+		virtual uint64_t getFirstByteTime()
+		{
+			return mFramer.getFirstByteTime();
+		}
+
+		/** Returns true if a complete frame is buffered from an earlier read(). */
+		virtual bool hasBufferedFrame()
+		{
+			return mFramer.hasFrame();
+		}
+
+		/** Returns the frame reassembler, e.g. for its error counters. */
+		const UARTFramer& getFramer() const
+		{
+			return mFramer;
+		}
+
+		/**
+		 * Reads one frame. Waits with poll() until the frame is complete:
+		 * up to the timeout of config() between two bytes, or not at all
+		 * with timeout 0. Bytes of the next frame are kept for the next read.
+		 * A frame which stays incomplete is given up and the stream resynced
+		 * on the next known command ID.
+		 *
+		 * @return the size of the frame, 0 if no frame is complete, or a
+		 *      negative value on errors.
+		 */
 		int32_t read(void* buffer, int32_t size);
 
 		int32_t write(void* buffer, int32_t size);
@@ -0,0 +1,180 @@
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       LinuxDatagram.cpp
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         Linux gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ *
+ ****************************************************************************
+ */
+
+#if __linux__
+
+#include "LinuxDatagram.hpp"
+
+extern "C"
+{
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <errno.h>
+#include <time.h>
+}
+
+#include <cerrno>
+#include <cstring>
+
+/** control message buffer of a datagram: receive time and drop counter */
+union Control_t
+{
+        cmsghdr mHeader;
+        char mBuffer[CMSG_SPACE(sizeof(timespec)) + CMSG_SPACE(sizeof(uint32_t))];
+};
+
+/*
+ * Describes the datagrams for recvmmsg() or sendmmsg().
+ */
+static void
+setMessages(mmsghdr* theMessages, iovec* theVectors, Datagram_t* theDatagrams, int32_t theCount,
+        bool theIsReceiving, bool theIsConnected)
+{
+    memset(theMessages, 0, theCount * sizeof(mmsghdr));
+    for (int32_t l = 0; l < theCount; l++)
+    {
+        theVectors[l].iov_base = theDatagrams[l].mBuffer;
+        theVectors[l].iov_len = theIsReceiving ? theDatagrams[l].mSize : theDatagrams[l].mLength;
+        theMessages[l].msg_hdr.msg_iov = &theVectors[l];
+        theMessages[l].msg_hdr.msg_iovlen = 1;
+        if (false == theIsConnected)
+        {
+            theMessages[l].msg_hdr.msg_name = &theDatagrams[l].mAddress;
+            theMessages[l].msg_hdr.msg_namelen = sizeof(theDatagrams[l].mAddress);
+        }
+    }
+}
+
+/*
+ * Returns the difference of the MonotonicClock to the system time in ns.
+ */
+static int64_t
+getMonotonicOffset()
+{
+    timespec lRealtime;
+    timespec lMonotonic;
+
+    clock_gettime(CLOCK_REALTIME, &lRealtime);
+    clock_gettime(CLOCK_MONOTONIC, &lMonotonic);
+    return (static_cast<int64_t>(lMonotonic.tv_sec) - lRealtime.tv_sec) * 1000000000LL + lMonotonic.tv_nsec
+            - lRealtime.tv_nsec;
+}
+
+/*
+ * Takes the receive time and the drop counter from the control messages.
+ */
+static void
+getControlMessages(msghdr& theMessage, Datagram_t& theDatagram, int64_t theMonotonicOffset)
+{
+    theDatagram.mReceiveTime = 0;
+    theDatagram.mNumberOfDrops = 0;
+    for (cmsghdr* lHeaderPtr = CMSG_FIRSTHDR(&theMessage); 0 != lHeaderPtr;
+            lHeaderPtr = CMSG_NXTHDR(&theMessage, lHeaderPtr))
+    {
+        if ((SOL_SOCKET == lHeaderPtr->cmsg_level) && (SCM_TIMESTAMPNS == lHeaderPtr->cmsg_type))
+        {
+            timespec lTime;
+            memcpy(&lTime, CMSG_DATA(lHeaderPtr), sizeof(lTime));
+            theDatagram.mReceiveTime = static_cast<int64_t>(lTime.tv_sec) * 1000000000LL + lTime.tv_nsec
+                    + theMonotonicOffset;
+        }
+        else if ((SOL_SOCKET == lHeaderPtr->cmsg_level) && (SO_RXQ_OVFL == lHeaderPtr->cmsg_type))
+        {
+            memcpy(&theDatagram.mNumberOfDrops, CMSG_DATA(lHeaderPtr), sizeof(theDatagram.mNumberOfDrops));
+        }
+    }
+}
+
+/*
+ * Receives up to theCount datagrams with one system call.
+ */
+int32_t
+DatagramBatch::receive(int theSocketHandle, Datagram_t* theDatagrams, int32_t theCount, bool theIsWaiting,
+        bool theIsConnected)
+{
+    mmsghdr lMessages[MAX_BATCH_SIZE];
+    iovec lVectors[MAX_BATCH_SIZE];
+    Control_t lControls[MAX_BATCH_SIZE];
+
+    if (MAX_BATCH_SIZE < theCount)
+    {
+        theCount = MAX_BATCH_SIZE;
+    }
+    if ((0 == theDatagrams) || (0 >= theCount))
+    {
+        return 0;
+    }
+    setMessages(lMessages, lVectors, theDatagrams, theCount, true, theIsConnected);
+    for (int32_t l = 0; l < theCount; l++)
+    {
+        lMessages[l].msg_hdr.msg_control = lControls[l].mBuffer;
+        lMessages[l].msg_hdr.msg_controllen = sizeof(lControls[l].mBuffer);
+    }
+
+    // MSG_WAITFORONE: blocks for the first datagram only
+    int32_t result = recvmmsg(theSocketHandle, lMessages, theCount, theIsWaiting ? MSG_WAITFORONE : MSG_DONTWAIT,
+            0);
+    if (0 > result)
+    {
+        return -errno;
+    }
+    const int64_t lMonotonicOffset = getMonotonicOffset();
+    for (int32_t l = 0; l < result; l++)
+    {
+        theDatagrams[l].mLength = lMessages[l].msg_len;
+        getControlMessages(lMessages[l].msg_hdr, theDatagrams[l], lMonotonicOffset);
+    }
+    return result;
+}
+
+/*
+ * Sends datagrams, MAX_BATCH_SIZE with one system call.
+ */
+int32_t
+DatagramBatch::send(int theSocketHandle, Datagram_t* theDatagrams, int32_t theCount, bool theIsConnected)
+{
+    mmsghdr lMessages[MAX_BATCH_SIZE];
+    iovec lVectors[MAX_BATCH_SIZE];
+    int32_t lSent = 0;
+
+    while ((0 != theDatagrams) && (lSent < theCount))
+    {
+        const int32_t lCount = (MAX_BATCH_SIZE < theCount - lSent) ? MAX_BATCH_SIZE : theCount - lSent;
+        setMessages(lMessages, lVectors, &theDatagrams[lSent], lCount, false, theIsConnected);
+
+        const int32_t lResult = sendmmsg(theSocketHandle, lMessages, lCount, 0);
+        if (0 > lResult)
+        {
+            return (0 == lSent) ? -errno : lSent;
+        }
+        lSent += lResult;
+
+        // a datagram was refused: the caller sees which
+        if (lCount > lResult)
+        {
+            break;
+        }
+    }
+    return lSent;
+}
+
+#endif /* __linux__ */
@@ -0,0 +1,140 @@
+#ifndef LINUX_DATAGRAM_HPP_
+#define LINUX_DATAGRAM_HPP_
+
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       LinuxDatagram.hpp -
+ *              Receives and sends a batch of datagrams with one system call.
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         Linux gcc 4
+ *
+ *
+ * (c) 2014     Triple-IN GmbH Hamburg, Germany
+ *
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ ****************************************************************************
+ */
+
+#if defined(__linux__)
+
+#include <netinet/in.h>
+#include "Global.hpp"
+
+/**
+ * A datagram of a batch.
+ * <p>
+ * Several datagrams of a batch to be sent may share a buffer, e.g. a scan
+ * for several clients.
+ */
+struct Datagram_t
+{
+        /** the data */
+        void* mBuffer;
+
+        /** size of mBuffer in bytes */
+        int32_t mSize;
+
+        /** number of bytes received, or to be sent */
+        int32_t mLength;
+
+        /** the sender of a datagram received, the receiver of one sent;
+         *  not used on a connected socket */
+        sockaddr_in mAddress;
+
+        /** time in ns of the MonotonicClock when the kernel received the
+         *  datagram, or 0 if the socket has no SO_TIMESTAMPNS */
+        uint64_t mReceiveTime;
+
+        /** number of datagrams the socket dropped before this one was
+         *  queued (SO_RXQ_OVFL), or 0 */
+        uint32_t mNumberOfDrops;
+};
+
+/**
+ * Class DatagramBatch - recvmmsg() and sendmmsg() for the UDP sockets.
+ * <p>&nbsp;<p>
+ * Each recv() or send() is a system call, and on a slow CPU the call
+ * costs more than the copy of a small datagram. A burst of responses, or
+ * a scan for several clients, is received or sent with one call instead.
+ * <p>
+ * ClientSocket and ServerSocket use it for their batch methods.
+ * <p>
+ * If the socket has SO_TIMESTAMPNS and SO_RXQ_OVFL enabled, the kernel's
+ * receive time and drop counter are returned with each datagram. The
+ * kernel stamps the datagram with the system time (CLOCK_REALTIME); it is
+ * moved to the MonotonicClock when the datagram is received, so it can be
+ * compared to the other time stamps of a scan.
+ */
+class DatagramBatch
+{
+    public:
+
+        /** class constants */
+        enum DatagramBatchConstants_t
+        {
+            /** maximum number of datagrams of a system call */
+            MAX_BATCH_SIZE = 32
+        };
+
+    private:
+
+        /* private constructor: there are static methods only */
+        DatagramBatch();
+
+    public:
+
+        /**
+         * Receives up to theCount datagrams.
+         *
+         * @param theSocketHandle
+         *      the socket.
+         * @param theDatagrams
+         *      the buffers; mLength, mAddress, mReceiveTime and
+         *      mNumberOfDrops are set.
+         * @param theCount
+         *      number of datagrams; at most MAX_BATCH_SIZE are received.
+         * @param theIsWaiting
+         *      true to wait for the first datagram like recv(), false to
+         *      return at once if none is waiting. The datagrams after the
+         *      first are only taken if they are waiting.
+         * @param theIsConnected
+         *      true if the socket is connected, so no address is returned.
+         * @return
+         *      the number of datagrams received, or a negative error code
+         *      (-errno).
+         */
+        static int32_t
+        receive(int theSocketHandle, Datagram_t* theDatagrams, int32_t theCount, bool theIsWaiting,
+                bool theIsConnected);
+
+        /**
+         * Sends datagrams, MAX_BATCH_SIZE with one system call.
+         *
+         * @param theSocketHandle
+         *      the socket.
+         * @param theDatagrams
+         *      the datagrams, with mLength bytes each.
+         * @param theCount
+         *      number of datagrams.
+         * @param theIsConnected
+         *      true if the socket is connected, so mAddress is not used.
+         * @return
+         *      the number of datagrams sent, or a negative error code
+         *      (-errno) if not even the first could be sent.
+         */
+        static int32_t
+        send(int theSocketHandle, Datagram_t* theDatagrams, int32_t theCount, bool theIsConnected);
+};
+
+#endif /* Linux */
+#endif /* LINUX_DATAGRAM_HPP_ */
@@ -0,0 +1,166 @@
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       LinuxPseudoTerminal.cpp
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         Linux gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ *
+ ****************************************************************************
+ */
+
+#if __linux__
+
+#include "LinuxPseudoTerminal.hpp"
+
+extern "C"
+{
+#include <fcntl.h>
+#include <stdlib.h>
+#include <termios.h>
+    namespace unistd
+    {
+#include <unistd.h>
+    }
+#include <errno.h>
+}
+
+#include <cstring>
+#include <cstdio>
+
+/*
+ * Standard constructor.
+ */
+PseudoTerminal::PseudoTerminal() :
+        mMasterHandle(-1), //
+        mSlaveHandle(-1), //
+        mDeviceName()
+{
+    // nothing more to do.
+}
+
+/*
+ * Destructor.
+ */
+PseudoTerminal::~PseudoTerminal()
+{
+    close();
+}
+
+/*
+ * Closes both sides.
+ */
+ErrorID_t
+PseudoTerminal::close()
+{
+    if (0 <= mSlaveHandle)
+    {
+        unistd::close(mSlaveHandle);
+        mSlaveHandle = -1;
+    }
+    if (0 <= mMasterHandle)
+    {
+        unistd::close(mMasterHandle);
+        mMasterHandle = -1;
+    }
+    mDeviceName[0] = 0;
+    return ERR_SUCCESS;
+}
+
+/*
+ * Creates the pseudo terminal in raw mode.
+ */
+ErrorID_t
+PseudoTerminal::open()
+{
+    struct termios lSettings;
+
+    close();
+
+    mMasterHandle = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if ((0 > mMasterHandle) || (0 != grantpt(mMasterHandle)) || (0 != unlockpt(mMasterHandle))
+            || (0 != ptsname_r(mMasterHandle, mDeviceName, sizeof(mDeviceName))))
+    {
+        perror("posix_openpt failed");
+        fprintf(stderr, "Error: Cannot create pseudo terminal.\r\n");
+        close();
+        return ERR_INVALID_HANDLE;
+    }
+
+    // no echo and no line editing before the client configures the terminal
+    mSlaveHandle = ::open(mDeviceName, O_RDWR | O_NOCTTY);
+    if ((0 > mSlaveHandle) || (0 != tcgetattr(mSlaveHandle, &lSettings)))
+    {
+        perror("open failed");
+        fprintf(stderr, "Error: Cannot open %s.\r\n", mDeviceName);
+        close();
+        return ERR_INVALID_HANDLE;
+    }
+    cfmakeraw(&lSettings);
+    tcsetattr(mSlaveHandle, TCSANOW, &lSettings);
+    return ERR_SUCCESS;
+}
+
+/*
+ * Reads the bytes received so far.
+ */
+int32_t
+PseudoTerminal::read(void* buffer, int32_t size)
+{
+    const ssize_t lResult = unistd::read(mMasterHandle, buffer, size);
+
+    if (0 > lResult)
+    {
+        return (EAGAIN == errno) ? 0 : -errno;
+    }
+    return static_cast<int32_t>(lResult);
+}
+
+/*
+ * Sends bytes to the client; waits while the terminal buffer is full,
+ * but not longer than WRITE_TIMEOUT ms without progress.
+ */
+int32_t
+PseudoTerminal::write(void* buffer, int32_t size)
+{
+    const char* lBufferPtr = static_cast<const char*>(buffer);
+    int32_t lWritten = 0;
+    int32_t lWaitTime = 0;
+
+    while (lWritten < size)
+    {
+        const ssize_t lResult = unistd::write(mMasterHandle, lBufferPtr + lWritten, size - lWritten);
+        if (0 <= lResult)
+        {
+            lWritten += static_cast<int32_t>(lResult);
+            lWaitTime = 0;
+        }
+        else if ((EAGAIN == errno) && (WRITE_TIMEOUT > lWaitTime))
+        {
+            unistd::usleep(1000);
+            lWaitTime++;
+        }
+        else if (EAGAIN == errno)
+        {
+            return ERR_TIMEOUT; // the client does not read
+        }
+        else
+        {
+            return -errno;
+        }
+    }
+    return lWritten;
+}
+
+#endif
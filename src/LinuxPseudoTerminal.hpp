@@ -0,0 +1,156 @@
+#ifndef LINUX_PSEUDO_TERMINAL_HPP_
+#define LINUX_PSEUDO_TERMINAL_HPP_
+
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       LinuxPseudoTerminal.hpp -
+ *              Pseudo terminal to stand in for the UART of a sensor.
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         Linux gcc 4
+ *
+ *
+ * (c) 2014     Triple-IN GmbH Hamburg, Germany
+ *
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ ****************************************************************************
+ */
+
+#if defined(__linux__)
+
+#include "IDataStream.hpp"
+
+/**
+ * Class PseudoTerminal.hpp -
+ * the sensor side of a pseudo terminal.
+ * <p>&nbsp;<p>
+ *
+ * <b>Executive summary:</b>
+ * <p>
+ * open() creates a pseudo terminal in raw mode. A client opens the
+ * device returned by getDeviceName() like a UART, e.g. with ClientUART;
+ * the baud rate does not matter. The stream reads and writes the other
+ * side, so a simulator looks like a sensor connected by UART.
+ * <p>
+ * read() returns the bytes received so far and does not block; the
+ * frames have to be put together by the reader.
+ * <p>&nbsp;<p>
+ */
+class PseudoTerminal : public IDataStream
+{
+    public:
+
+        /** class constants */
+        enum PseudoTerminalConstants_t
+        {
+            /** ms write() waits for the client to read */
+            WRITE_TIMEOUT = 1000
+        };
+
+    private:
+        /** the handle of the master side, or -1 */
+        int mMasterHandle;
+
+        /** the handle of the client side, kept open so the master never hangs up */
+        int mSlaveHandle;
+
+        /** the device a client opens */
+        string128_t mDeviceName;
+
+        /* private assignment constructor to avoid misuse */
+        explicit
+        PseudoTerminal(const PseudoTerminal& src);
+
+        /* private assignment operator to avoid misuse */
+        PseudoTerminal&
+        operator =(const PseudoTerminal& src);
+
+    public:
+
+        /**
+         * Standard constructor.
+         */
+        PseudoTerminal();
+
+        /**
+         * Destructor. Closes the pseudo terminal.
+         */
+        virtual
+        ~PseudoTerminal();
+
+        /**
+         * Closes the pseudo terminal.
+         *
+         * @return
+         *      ERR_SUCCESS.
+         */
+        virtual ErrorID_t
+        close();
+
+        /**
+         * Returns the handle of the master side for poll().
+         */
+        virtual int
+        getHandle()
+        {
+            return mMasterHandle;
+        }
+
+        /**
+         * Returns the device a client opens, e.g. /dev/pts/3, or an empty string.
+         */
+        const char*
+        getDeviceName() const
+        {
+            return mDeviceName;
+        }
+
+        /**
+         * Returns true if the pseudo terminal is open.
+         */
+        virtual bool
+        isOpen()
+        {
+            return (0 <= mMasterHandle);
+        }
+
+        /**
+         * Creates the pseudo terminal.
+         *
+         * @return
+         *      ERR_SUCCESS if OK, ERR_INVALID_HANDLE if it cannot be created.
+         */
+        virtual ErrorID_t
+        open();
+
+        /**
+         * Reads the bytes received from the client.
+         *
+         * @return
+         *      the number of bytes, 0 if there are none,
+         *      or a negative error code if failed.
+         */
+        virtual int32_t
+        read(void* buffer, int32_t size);
+
+        /**
+         * Sends bytes to the client.
+         *
+         * @return
+         *      the number of bytes written or a negative error code if failed;
+         *      ERR_TIMEOUT if the client did not read for WRITE_TIMEOUT ms.
+         */
+        virtual int32_t
+        write(void* buffer, int32_t size);
+};
+#endif /* Linux */
+#endif /* LINUX_PSEUDO_TERMINAL_HPP_ */
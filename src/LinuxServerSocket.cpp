@@ -0,0 +1,209 @@
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+
+ * @file:       LinuxServerSocket.cpp
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         Linux 4
+ *
+ *
+ * (c) 2008-2011 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ *
+ ****************************************************************************
+ */
+
+#if __linux__
+
+#include "LinuxServerSocket.hpp"
+
+extern "C"
+{
+#include <sys/socket.h>
+#include <sys/types.h>
+    namespace unistd
+    {
+#include <unistd.h>
+    }
+#include <errno.h>
+}
+
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+
+/*
+ * Standard constructor.
+ */
+ServerSocket::ServerSocket() :
+mIsOpen(false),//
+mPeerIPAddress(),//
+mPort(0),//
+mSocketHandle(-1)
+{
+    // nothing more to do.
+}
+
+/*
+ * Destructor.
+ */
+ServerSocket::~ServerSocket()
+{
+    close();
+}
+
+/*
+ * Closes the socket.
+ */
+ErrorID_t
+ServerSocket::close()
+{
+    if (isOpen())
+    {
+        unistd::close(mSocketHandle);
+        mSocketHandle = -1;
+        mIsOpen = false;
+    }
+    return ERR_SUCCESS;
+}
+
+/*
+ * Defines the local port.
+ */
+void
+ServerSocket::setPort(int32_t thePort)
+{
+    mPort = thePort;
+}
+
+/*
+ * Creates the socket and binds it to the local port.
+ */
+ErrorID_t
+ServerSocket::open()
+{
+    sockaddr_in lAddress;
+
+    close();
+
+    // create the socket handle
+    mSocketHandle = socket(AF_INET, SOCK_DGRAM, 0);
+    if (0 > mSocketHandle)
+    {
+    	perror("socket failed");
+        fprintf(stderr, "cannot create sockets.\r\n");
+        return ERR_INVALID_HANDLE;
+    }
+
+    // bind port, any interface
+    memset(&lAddress, 0, sizeof(lAddress));
+    lAddress.sin_family = AF_INET;
+    lAddress.sin_port = htons(mPort);
+    lAddress.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (0 > bind(mSocketHandle, (struct sockaddr*) &lAddress, sizeof(lAddress)))
+    {
+    	perror("bind failed");
+        fprintf(stderr, "Socket error: Cannot bind connection/port\r\n");
+        unistd::close(mSocketHandle);
+        mSocketHandle = -1;
+        return ERR_INVALID_HANDLE;
+    }
+
+    mIsOpen = true;
+    return ERR_SUCCESS;
+}
+
+/*
+ * Receives a datagram from any client.
+ */
+int32_t
+ServerSocket::readFrom(void* buffer, int32_t size, sockaddr_in& theClientAddress)
+{
+    int32_t result = 0;
+
+    if (isOpen() && (0 != buffer) && (0 < size))
+    {
+        socklen_t lAddressLength = sizeof(theClientAddress);
+        result = recvfrom(mSocketHandle, static_cast<char*>(buffer), size, 0,
+                (struct sockaddr*) &theClientAddress, &lAddressLength);
+        if (0 > result)
+        {
+            result = -errno;
+        }
+    }
+    return result;
+}
+
+/*
+ * Receives the waiting datagrams from any clients with one system call.
+ */
+int32_t
+ServerSocket::readFromBatch(Datagram_t* theDatagrams, int32_t theCount)
+{
+    if (false == isOpen())
+    {
+        return 0;
+    }
+    return DatagramBatch::receive(mSocketHandle, theDatagrams, theCount, true, false);
+}
+
+/*
+ * Receives a datagram and remembers the client.
+ */
+int32_t
+ServerSocket::read(void* buffer, int32_t size)
+{
+    return readFrom(buffer, size, mPeerIPAddress);
+}
+
+/*
+ * Sends a datagram to a client.
+ */
+int32_t
+ServerSocket::writeTo(const void* buffer, int32_t size, const sockaddr_in& theClientAddress)
+{
+    int32_t result = 0;
+
+    if (isOpen() && (0 != buffer) && (0 < size))
+    {
+        result = sendto(mSocketHandle, static_cast<const char*>(buffer), size, 0,
+                (const struct sockaddr*) &theClientAddress, sizeof(theClientAddress));
+        if (0 > result)
+        {
+            result = -errno;
+        }
+    }
+    return result;
+}
+
+/*
+ * Sends datagrams to clients with one system call.
+ */
+int32_t
+ServerSocket::writeToBatch(Datagram_t* theDatagrams, int32_t theCount)
+{
+    if (false == isOpen())
+    {
+        return 0;
+    }
+    return DatagramBatch::send(mSocketHandle, theDatagrams, theCount, false);
+}
+
+/*
+ * Sends a datagram to the client of the last datagram received.
+ */
+int32_t
+ServerSocket::write(void* buffer, int32_t size)
+{
+    return writeTo(buffer, size, mPeerIPAddress);
+}
+
+#endif
@@ -0,0 +1,223 @@
+#ifndef LINUX_SERVER_SOCKET_HPP_
+#define LINUX_SERVER_SOCKET_HPP_
+
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       LinuxServerSocket.hpp -
+ *              Server Socket to serve several clients.
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         Linux gcc 4
+ *
+ *
+ * (c) 2014     Triple-IN GmbH Hamburg, Germany
+ *
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ ****************************************************************************
+ */
+
+#if defined(__linux__)
+
+#include <cstdio>
+#include <netinet/in.h>
+#include "IDataStream.hpp"
+#include "LinuxDatagram.hpp"
+
+/**
+ * Class ServerSocket.hpp -
+ * UDP socket which receives datagrams from any client.
+ * <p>&nbsp;<p>
+ *
+ * <b>Executive summary:</b>
+ * <p>
+ * Unlike the ClientSocket, the ServerSocket is not connected to a peer.
+ * It is bound to a local port, receives from any client and answers to
+ * the address a datagram was received from. A relay uses it to look
+ * like a sensor to several clients at once.
+ * <p>
+ * read() and write() talk to the client of the last datagram received;
+ * readFrom() and writeTo() take the client address; readFromBatch() and
+ * writeToBatch() receive and send several datagrams with one system call.
+ * <p>&nbsp;<p>
+ */
+class ServerSocket : public IDataStream
+{
+    private:
+        /** a flag indicating an opened socket. */
+        bool mIsOpen;
+
+        /** the client of the last datagram received */
+        sockaddr_in mPeerIPAddress;
+
+        /** the local port */
+        int32_t mPort;
+
+        /** the socket handle, used to listen to data */
+        int mSocketHandle;
+
+        /** private assignment constructor to avoid misuse */
+        explicit
+        ServerSocket(const ServerSocket& src);
+
+        /** private assignment operator to avoid misuse */
+        ServerSocket&
+        operator =(const ServerSocket& src);
+
+    public:
+
+        /**
+         * Constructor. The socket is created by open().
+         */
+        ServerSocket();
+
+        /**
+         * Destructor.
+         */
+        virtual
+        ~ServerSocket();
+
+        /**
+         * Closes the socket.
+         *
+         * @return -
+         *      here always ERR_SUCCESS.
+         */
+        virtual ErrorID_t
+        close();
+
+        /**
+         * Returns the socket handle, or -1 if the socket is not open.
+         */
+        virtual int
+        getHandle()
+        {
+            return mIsOpen ? mSocketHandle : -1;
+        }
+
+        /**
+         * Returns true if the socket is ready to be used.
+         */
+        inline bool
+        isOpen()
+        {
+            return mIsOpen;
+        }
+
+        /**
+         * Creates the socket and binds it to the local port.
+         *
+         * @return
+         *      ERR_SUCCESS if the socket could be opened successfully,
+         *      negative error code if open() failed.
+         */
+        virtual ErrorID_t
+        open();
+
+        /**
+         * Receives a datagram from any client; blocks until one arrives.
+         * The client becomes the peer of write().
+         *
+         * @param buffer-
+         *      a buffer to read
+         * @param size -
+         *      the number of bytes to read
+         * @return -
+         *      the number bytes received or a negative error code if failed.
+         */
+        virtual int32_t
+        read(void* buffer, int32_t size);
+
+        /**
+         * Receives a datagram from any client; blocks until one arrives.
+         *
+         * @param buffer-
+         *      a buffer to read
+         * @param size -
+         *      the number of bytes to read
+         * @param theClientAddress
+         *      returns the address of the client.
+         * @return -
+         *      the number bytes received or a negative error code if failed.
+         */
+        int32_t
+        readFrom(void* buffer, int32_t size, sockaddr_in& theClientAddress);
+
+        /**
+         * Receives the datagrams waiting from any clients with one system
+         * call; blocks until the first one arrives.
+         *
+         * @param theDatagrams
+         *      the buffers; mLength and the client's mAddress are set.
+         * @param theCount
+         *      number of buffers; at most DatagramBatch::MAX_BATCH_SIZE
+         *      datagrams are received.
+         * @return
+         *      the number of datagrams received or a negative error code
+         *      if failed.
+         */
+        int32_t
+        readFromBatch(Datagram_t* theDatagrams, int32_t theCount);
+
+        /**
+         * Defines the local port. Must be called before open().
+         *
+         * @param thePort
+         *      the Port number
+         */
+        void
+        setPort(int32_t thePort);
+
+        /**
+         * Sends a datagram to the client of the last datagram received.
+         *
+         * @param buffer -
+         *      the byte array to write (null permitted).
+         * @param size -
+         *      number of bytes to write.
+         * @return -
+         *      the number bytes written or a negative error code if failed.
+         */
+        virtual int32_t
+        write(void* buffer, int32_t size);
+
+        /**
+         * Sends a datagram to a client.
+         *
+         * @param buffer -
+         *      the byte array to write (null permitted).
+         * @param size -
+         *      number of bytes to write.
+         * @param theClientAddress
+         *      the address of the client.
+         * @return -
+         *      the number bytes written or a negative error code if failed.
+         */
+        int32_t
+        writeTo(const void* buffer, int32_t size, const sockaddr_in& theClientAddress);
+
+        /**
+         * Sends datagrams to clients with one system call, e.g. a scan
+         * to all waiting clients. The datagrams may share a buffer.
+         *
+         * @param theDatagrams
+         *      the datagrams with mLength bytes each, to mAddress.
+         * @param theCount
+         *      number of datagrams.
+         * @return
+         *      the number of datagrams sent or a negative error code if
+         *      not even the first could be sent.
+         */
+        int32_t
+        writeToBatch(Datagram_t* theDatagrams, int32_t theCount);
+};
+#endif /* Linux */
+#endif /* LINUX_SERVER_SOCKET_HPP_ */
@@ -0,0 +1,57 @@
+/*
+ * LinuxUARTBaudRate.c
+ *
+ *  Created on: 2016. 11. 02.
+ *      Author: leesy
+ */
+
+#if defined(__linux__)
+/* termios2 is declared by the kernel headers only, which clash with <termios.h>: keep them apart in this file. */
+#include <errno.h>
+#include <asm/termbits.h>
+#include <sys/ioctl.h>
+
+#include "LinuxUARTBaudRate.h"
+
+int setUARTBaudRate(int fd, unsigned int baudRate)
+{
+#if defined(BOTHER) && defined(TCSETS2)
+	struct termios2 tio2;
+
+	if (ioctl(fd, TCGETS2, &tio2) < 0)
+		return -1;
+
+	// the rate is taken from c_ispeed and c_ospeed instead of a B constant
+	tio2.c_cflag &= ~CBAUD;
+	tio2.c_cflag |= BOTHER;
+	tio2.c_ospeed = baudRate;
+#if defined(IBSHIFT)
+	tio2.c_cflag &= ~(CBAUD << IBSHIFT);
+	tio2.c_cflag |= BOTHER << IBSHIFT;
+#endif
+	tio2.c_ispeed = baudRate;
+
+	return ioctl(fd, TCSETS2, &tio2);
+#else
+	(void)fd;
+	(void)baudRate;
+	errno = ENOTSUP;
+	return -1;
+#endif
+}
+
+unsigned int getUARTBaudRate(int fd)
+{
+#if defined(BOTHER) && defined(TCGETS2)
+	struct termios2 tio2;
+
+	// the driver writes the rate it applied back to c_ospeed
+	if (ioctl(fd, TCGETS2, &tio2) < 0)
+		return 0;
+	return tio2.c_ospeed;
+#else
+	(void)fd;
+	return 0;
+#endif
+}
+#endif
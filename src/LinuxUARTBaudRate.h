@@ -0,0 +1,32 @@
+/*
+ * LinuxUARTBaudRate.h
+ *
+ *  Created on: 2016. 11. 02.
+ *      Author: leesy
+ */
+
+#ifndef SRC_LINUXUARTBAUDRATE_H_
+#define SRC_LINUXUARTBAUDRATE_H_
+	#if defined(__linux__)
+		#if defined (__cplusplus)
+			extern "C" {
+		#endif
+
+			/*
+			 * Sets any baud rate, also one without B constant like 921600 or 3000000,
+			 * by termios2 and BOTHER. The other settings of the UART are kept.
+			 * Returns 0 on success, -1 if the driver refused the rate (see errno).
+			 */
+			int setUARTBaudRate(int fd, unsigned int baudRate);
+
+			/*
+			 * Returns the output baud rate the driver applied, which can differ
+			 * from the rate set by the divisor of the UART clock, or 0 if unknown.
+			 */
+			unsigned int getUARTBaudRate(int fd);
+
+		#if defined (__cplusplus)
+			}
+		#endif
+	#endif
+#endif /* SRC_LINUXUARTBAUDRATE_H_ */
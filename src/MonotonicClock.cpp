@@ -0,0 +1,59 @@
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       MonotonicClock.cpp
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ *
+ ****************************************************************************
+ */
+
+#if defined(__WIN32__) || (defined(__CYGWIN__) && !defined(_WIN32))
+	#include <windows.h>
+#elif defined(__linux__)
+	#include <time.h>
+#else
+	#error "This program requires Linux or Win32."
+#endif
+
+#include "MonotonicClock.hpp"
+
+/*
+ * Returns the time of the monotonic clock in ns.
+ */
+uint64_t
+MonotonicClock::getNanoseconds()
+{
+#if defined(__WIN32__) || (defined(__CYGWIN__) && !defined(_WIN32))
+    static LARGE_INTEGER sFrequency = { { 0, 0 } };
+    LARGE_INTEGER lCounter;
+
+    if (0 == sFrequency.QuadPart)
+    {
+        QueryPerformanceFrequency(&sFrequency);
+    }
+    QueryPerformanceCounter(&lCounter);
+
+    // split to avoid the overflow of counter * 10^9
+    const uint64_t lSeconds = lCounter.QuadPart / sFrequency.QuadPart;
+    const uint64_t lRemainder = lCounter.QuadPart % sFrequency.QuadPart;
+    return lSeconds * 1000000000ULL + lRemainder * 1000000000ULL / sFrequency.QuadPart;
+#else
+    struct timespec lTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &lTime);
+    return lTime.tv_sec * 1000000000ULL + lTime.tv_nsec;
+#endif
+}
@@ -0,0 +1,65 @@
+#ifndef MONOTONICCLOCK_HPP_
+#define MONOTONICCLOCK_HPP_
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       MonotonicClock.hpp - Time stamps which never jump.
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ ****************************************************************************
+ */
+
+#include "Global.hpp"
+
+/**
+ * Class MonotonicClock - time stamps for measuring durations.
+ * <p>&nbsp;<p>
+ * The system time of gettimeofday() jumps when it is set or adjusted by
+ * NTP, and a millisecond counter in 32 bits wraps after 49 days. The
+ * monotonic clock counts from an arbitrary start (usually the boot) and
+ * is never set: CLOCK_MONOTONIC on Linux, the performance counter on
+ * Windows.
+ * <p>
+ * The time stamps are meant for differences only; they do not tell the
+ * time of day.
+ */
+class MonotonicClock
+{
+    private:
+
+        /* private constructor: there are static methods only */
+        MonotonicClock();
+
+    public:
+
+        /**
+         * Returns the time of the monotonic clock in ns.
+         */
+        static uint64_t
+        getNanoseconds();
+
+        /**
+         * Returns the time of the monotonic clock in ms.
+         * The 32 bit value wraps: compare differences only, like
+         * (getMilliseconds() - lStartTime) < lTimeout.
+         */
+        static uint32_t
+        getMilliseconds()
+        {
+            return static_cast<uint32_t>(getNanoseconds() / 1000000ULL);
+        }
+};
+
+#endif /* MONOTONICCLOCK_HPP_ */
@@ -33,26 +33,41 @@
 	#include "WinClientSocket.hpp"
 	#include "WinClientUART.hpp"
 #elif defined(__linux__)
+	#include "EndToEndBenchmark.hpp"
 	#include "LinuxClientSocket.hpp"
 	#include "LinuxClientUART.hpp"
+	#include "LinuxPseudoTerminal.hpp"
+	#include "LinuxServerSocket.hpp"
+	#include "RelayServer.hpp"
+	#include "SimulatorServer.hpp"
 #else
 	#error "This program requires Linux or Win32."
 #endif
 
+#include "Benchmark.hpp"
 #include "ErrorID.h"
+#include "EventLoop.hpp"
 #include "Global.hpp"
 #include "GPINCommand.hpp"
 #include "GPRMCommand.hpp"
+#include "GSC2Session.hpp"
 #include "GVERCommand.hpp"
 #include "ProgramVersion.hpp"
+#include "ReplayStream.hpp"
+#include "ScanPipeline.hpp"
 #include "ScanSequence.hpp"
 #include "Scan2Sequence.hpp"
 #include "ScanPrint.hpp"
 #include "Scan2Print.hpp"
+#include "SensorSimulator.hpp"
 #include "SPRMCommand.hpp"
 #include "KbhitGetch.h"
 
-#define DATA_BUF_SIZE_MAX (8*1024)
+// the largest frame of the protocol, e.g. a scan of 4000 points with several echoes
+#define DATA_BUF_SIZE_MAX (64*1024)
+
+// the kernel buffer of a sensor socket; takes the scans of a processing stall
+#define SOCKET_RECEIVE_BUFFER_SIZE (1024*1024)
 
 /**
  * Shows how to read the firmware version.
@@ -162,6 +177,29 @@ testSCAN(IDataStream& theDataStream, char* theDataLogFileName, FILE* theTerminal
     lScanSequence.run(theDataLogFileName);
 }
 
+/**
+ * Same as testSCAN, but keeps several GSCN requests in flight,
+ * so the sensor does not wait for the round trip of each scan.
+ */
+void
+testSCANPIPE(IDataStream& theDataStream, char* theDataLogFileName, FILE* theTerminalLogFile)
+{
+    int32_t lPipelineDepth = 0;
+
+    fprintf(stdout, "> Scans in flight (1...%d): ", ScanPipeline::MAX_DEPTH);
+    fscanf(stdin, "%d", &lPipelineDepth);
+    if ((1 > lPipelineDepth) || (ScanPipeline::MAX_DEPTH < lPipelineDepth))
+    {
+        lPipelineDepth = (1 > lPipelineDepth) ? 1 : ScanPipeline::MAX_DEPTH;
+        fprintf(stdout, "Scans in flight limited to %d\r\n", lPipelineDepth);
+    }
+
+    ScanSequence lScanSequence(theDataStream);
+    lScanSequence.setTerminalLogFile(theTerminalLogFile);
+    lScanSequence.setPipelineDepth(lPipelineDepth);
+    lScanSequence.run(theDataLogFileName);
+}
+
 /**
  */
 void
@@ -192,531 +230,17 @@ testSCN2PR(IDataStream& theDataStream, char* theDataLogFileName, FILE* theTermin
     lScan2Print.run(theDataLogFileName);
 }
 
-bool g_GSC2_flag = false;
-char g_GSC2_GSCN_send_data[4*4]; // func + length + data + crc
-int32_t g_GSC2_GSCN_send_data_len;
-int32_t g_GSC2_ScanAvgNumber = 1;
-int32_t g_GSC2_ScanAvgNumber_cnt;
-int32_t g_GSC2_PointAvgNumber = 1;
-char g_GSC2_GSCN_rcvd_data[10][DATA_BUF_SIZE_MAX];
-
-void
-convertRELAY_Client_Sensor_GSC2_GSCN(char *data, int32_t len, int32_t *plen)
-{
-    CRC32 lCRC;
-    cast_ptr_t lBufferPtr = { data }; // casts the buffer to an array of integer
-    int32_t lCRCPosition = (4 + 4 + 4 + 4) / sizeof(int32_t) - 1; // position of the CRC in the buffer
-    uint32_t lCRCValue;
-
-#if 0
-    int32_t lLength;
-
-    lLength = ntohl(lBufferPtr.asIntegerPtr[1]);
-    printf("GSC2: Length = %d\r\n", lLength);
-#endif
-    g_GSC2_ScanAvgNumber = ntohl(lBufferPtr.asIntegerPtr[2]);
-    if (g_GSC2_ScanAvgNumber < 1) g_GSC2_ScanAvgNumber = 1;
-    if (g_GSC2_ScanAvgNumber > 10) g_GSC2_ScanAvgNumber = 10;
-    g_GSC2_PointAvgNumber = ntohl(lBufferPtr.asIntegerPtr[3]);
-    if (g_GSC2_PointAvgNumber < 1) g_GSC2_PointAvgNumber = 1;
-#if 0
-    printf("GSC2: ScanAvgNumber = %d\r\n", g_GSC2_ScanAvgNumber);
-    printf("GSC2: PointAvgNumber = %d\r\n", g_GSC2_PointAvgNumber);
-#endif
-	strncpy((char *)lBufferPtr.asIntegerPtr + 0, "GSCN", 4);
-	lBufferPtr.asIntegerPtr[1] = htonl(4); // Length
-	lBufferPtr.asIntegerPtr[2] = htonl(0); // Always, Scan Number is 0 for latest scan measured.
-	lCRCValue = lCRC.get(lBufferPtr.asIntegerPtr + 0, (4 + 4 + 4 + 4) - 4);
-    lBufferPtr.asIntegerPtr[lCRCPosition] = htonl(lCRCValue);
-    *plen = (4 + 4 + 4 + 4);
-    if (g_GSC2_PointAvgNumber > 1 || g_GSC2_ScanAvgNumber > 1)
-    {
-    	g_GSC2_flag = true;
-    	g_GSC2_ScanAvgNumber_cnt = 0;
-    	memcpy(g_GSC2_GSCN_send_data, data, *plen);
-    	g_GSC2_GSCN_send_data_len = *plen;
-    }
-}
-
-void
-convertRELAY_Client_Sensor(char *data, int32_t len, int32_t *plen)
-{
-    g_GSC2_flag = false;
-	if (!strncmp(data, "GSC2", 4))
-	{
-		convertRELAY_Client_Sensor_GSC2_GSCN(data, len, plen);
-	}
-}
-
-void
-convertRELAY_Sensor_Client_GSCN_GSC2_ScanAvg(char *data, int32_t len, int32_t *plen)
-{
-	// set moving integer pointer; skip command ID and length
-	cast_ptr_t lDataPtr = { data };
-	int32_t* lRcvIntegerPtr = &lDataPtr.asIntegerPtr[1];
-	// take length of parameter block
-	int32_t lNumberOfParameter;
-	int32_t lNumberOfParameterExpected;
-	int32_t lNumberOfEchoes = 0;
-	int32_t lDataContent = 0;
-	int32_t lNumberOfPoints = 0;
-	int32_t lLength;
-
-	lLength = ntohl(*lRcvIntegerPtr++);
-#if 0
-	printf("Length = %d\r\n", lLength);
-#endif
-
-	lNumberOfParameter = ntohl(*lRcvIntegerPtr++);
-	// check compatibility of firmware and control program
-	if (lNumberOfParameter > 10 /*NUMBER_OF_SCAN_PARAMETER*/)
-	{
-		lNumberOfParameterExpected = 10 /*NUMBER_OF_SCAN_PARAMETER*/;
-	}
-	else
-	{
-		lNumberOfParameterExpected = lNumberOfParameter;
-	}
-#if 0
-	printf("Number of parameters = %d, %d\r\n", lNumberOfParameter, lNumberOfParameterExpected);
-#endif
-
-	// copy known parameter to scan
-	for (int32_t l = 0; l < lNumberOfParameterExpected; l++)
-	{
-#if 0
-		printf("parameter[%d] = %d(0x%x)\r\n", l, ntohl(*lRcvIntegerPtr), ntohl(*lRcvIntegerPtr));
-#endif
-		if (l == 0 /* PARAMETER_SCAN_NUMBER */)
-		{
-#if 0
-			int32_t* lSaveIntegerPtr;
-			int32_t lScanNumber = 0;
-			for(int i = 0; i < g_GSC2_ScanAvgNumber; i++)
-			{
-				lSaveIntegerPtr = (int32_t *)(g_GSC2_GSCN_rcvd_data[i] + ((char *)lRcvIntegerPtr - data));
-				lScanNumber = ntohl(*lSaveIntegerPtr);
-				printf("%d:lScanNumber=%d, ", i, lScanNumber);
-			}
-			printf("\r\n");
-#endif
-		}
-		if (l == 4 /* PARAMETER_NUMBER_OF_ECHOES */)
-		{
-			lNumberOfEchoes = ntohl(*lRcvIntegerPtr);
-		}
-		if (l == 8 /* PARAMETER_DATA_CONTENT */)
-		{
-			lDataContent = ntohl(*lRcvIntegerPtr);
-		}
-		lRcvIntegerPtr++;
-	}
-
-	// skip unkown parameter
-	for (int32_t l = lNumberOfParameterExpected; l < lNumberOfParameter; l++)
-	{
-#if 0
-		printf("parameter[%d] = %d(0x%x)\r\n", l, ntohl(*lRcvIntegerPtr), ntohl(*lRcvIntegerPtr));
-#endif
-		lRcvIntegerPtr++;
-	}
-
-	// get number of echoes. If 0, then the master echo is transfered instead of the number
-#if 0
-	printf("Data Content = %d\r\n", lDataContent);
-#endif
-
-#if 0
-	printf("Number of echoes = %d\r\n", lNumberOfEchoes);
-#endif
-	if (0 == lNumberOfEchoes)
-	{
-		lNumberOfEchoes = 1;
-	}
-
-	// take number of points, check limits
-	lNumberOfPoints = ntohl(*lRcvIntegerPtr++);
-#if 0
-	printf("Number of points = %d\r\n", lNumberOfPoints);
-#endif
-
-	if ((4 /* MAX_NUMBER_OF_ECHOS */ < lNumberOfEchoes) || (4000 /* MAX_POINTS_PER_SCAN */ < lNumberOfPoints))
-	{
-		return;
-	}
-
-	// copy data block according to the data content.
-	if (1 /* lDataContent == 4 */ /* DATABLOCK_WITH_DISTANCES */)
-	{
-
-    	for (int32_t lPoints = 0; lPoints < lNumberOfPoints; lPoints++)
-		{
-			// loop for each point through all echos
-			for (int32_t lEchos = 0; lEchos < lNumberOfEchoes - 1; lEchos++)
-			{
-				lRcvIntegerPtr++;
-				if (lDataContent != 4)
-				{
-					lRcvIntegerPtr++;
-				}
-			} // end lNumberOfEchoes
-
-			int32_t* lSaveIntegerPtr;
-			int32_t lDistanceCnt = 0;
-			int32_t lNoEchoCnt = 0;
-			int32_t lNoiseCnt = 0;
-			int64_t lDistanceSum = 0;
-			int64_t lPulseWidthSum = 0;
-			int32_t lDistance = 0;
-			int32_t lPulseWidth = 0;
-
-#if 0
-		    printf("lPoints = %d,", lPoints);
-#endif
-			for(int i = 0; i < g_GSC2_ScanAvgNumber; i++)
-			{
-				lSaveIntegerPtr = (int32_t *)(g_GSC2_GSCN_rcvd_data[i] + ((char *)lRcvIntegerPtr - data));
-
-				lDistance = ntohl(*lSaveIntegerPtr++);
-				if ((uint32_t)lDistance == 0x80000000) // Check No Echo
-				{
-					lNoEchoCnt ++;
-				}
-				else if ((uint32_t)lDistance == 0x7FFFFFFF) // Check Noise
-				{
-					lNoiseCnt ++;
-				}
-				else
-				{
-					lDistanceSum += lDistance;
-					lDistanceCnt ++;
-				}
-
-				if (lDataContent != 4)
-				{
-					lPulseWidth = ntohl(*lSaveIntegerPtr++);
-				}
-				lPulseWidthSum += lPulseWidth;
-#if 0
-			    printf("0x%08x,", lPulseWidth);
-#endif
-			} // end g_GSC2_ScanAvgNumber
-#if 0
-			printf("\r\n");
-#endif
-
-			if (lDistanceCnt)
-			{
-				*lRcvIntegerPtr = htonl(int32_t(lDistanceSum / lDistanceCnt));
-			}
-			else
-			{
-				if (lNoEchoCnt > lNoiseCnt)
-					*lRcvIntegerPtr = htonl(0x80000000); // Set No Echo
-				else
-					*lRcvIntegerPtr = htonl(0x7fffffff); // Set Noise
-			}
-#if 0
-			printf("lPoints = %d,", lPoints);
-			printf("lDistanceCnt = %d,", lDistanceCnt);
-			printf("lNoEchoCnt = %d,", lNoEchoCnt);
-			printf("lNoiseCnt = %d,", lNoiseCnt);
-			printf("*lRcvIntegerPtr = 0x%x\r\n", ntohl()*lRcvIntegerPtr));
-#endif
-			lRcvIntegerPtr++;
-
-			if (lDataContent != 4)
-			{
-				*lRcvIntegerPtr = htonl(int32_t(lPulseWidthSum / g_GSC2_ScanAvgNumber));
-				lRcvIntegerPtr++;
-			}
-		} // end lNumberOfPoints
-	}
-
-    CRC32 lCRC;
-    int32_t lCRCPosition; // position of the CRC in the buffer
-    uint32_t lCRCValue;
-
-    lCRCPosition = (8 + lLength + 4) / sizeof(int32_t) - 1;
-	lCRCValue = lCRC.get(lDataPtr.asIntegerPtr + 0,  8 + lLength);
-	lDataPtr.asIntegerPtr[lCRCPosition] = htonl(lCRCValue);
-    *plen = 8 + lLength + 4;
-#if 0
-    printf("Send Length = %d\r\n", lLength);
-	printf("Send CRCPosition = %d\r\n", lCRCPosition);
-	printf("Send CRCValue = 0x%%x\r\n", lCRCValue);
-#endif
-
-	return;
-}
-
+/**
+ * Measures the processing cost of a scan without sensor.
+ */
 void
-convertRELAY_Sensor_Client_GSCN_GSC2_PointAvg(char *data, int32_t len, int32_t *plen)
+testBENCH(FILE* theTerminalLogFile)
 {
-	// set moving integer pointer; skip command ID and length
-	cast_ptr_t lDataPtr = { data };
-	int32_t* lRcvIntegerPtr = &lDataPtr.asIntegerPtr[1];
-	int32_t lSendLength;
-	// take length of parameter block
-	int32_t lNumberOfParameter;
-	int32_t lNumberOfParameterExpected;
-	int32_t lNumberOfEchoes = 0;
-	int32_t lDataContent = 0;
-	int32_t lNumberOfPoints = 0;
-	int32_t lSendNumberOfPoints = 0;
-
-#if 0
-	int32_t lLength;
-	lLength = ntohl(*lRcvIntegerPtr);
-	printf("Length = %d\r\n", lLength);
-#endif
-
-	// skip length field.
-	lRcvIntegerPtr++;
-
-	lNumberOfParameter = ntohl(*lRcvIntegerPtr++);
-	// check compatibility of firmware and control program
-	if (lNumberOfParameter > 10 /*NUMBER_OF_SCAN_PARAMETER*/)
-	{
-		lNumberOfParameterExpected = 10 /*NUMBER_OF_SCAN_PARAMETER*/;
-	}
-	else
-	{
-		lNumberOfParameterExpected = lNumberOfParameter;
-	}
-#if 0
-	printf("Number of parameters = %d, %d\r\n", lNumberOfParameter, lNumberOfParameterExpected);
-#endif
-
-	// copy known parameter to scan
-	for (int32_t l = 0; l < lNumberOfParameterExpected; l++)
-	{
-#if 0
-		printf("parameter[%d] = %d(0x%x)\r\n", l, ntohl(*lRcvIntegerPtr), ntohl(*lRcvIntegerPtr));
-#endif
-		if (l == 4 /* PARAMETER_NUMBER_OF_ECHOES */)
-		{
-			lNumberOfEchoes = ntohl(*lRcvIntegerPtr);
-		}
-		if (l == 8 /* PARAMETER_DATA_CONTENT */)
-		{
-			lDataContent = ntohl(*lRcvIntegerPtr);
-		}
-		lRcvIntegerPtr++;
-	}
-
-	// skip unkown parameter
-	for (int32_t l = lNumberOfParameterExpected; l < lNumberOfParameter; l++)
-	{
-#if 0
-		printf("parameter[%d] = %d(0x%x)\r\n", l, ntohl(*lRcvIntegerPtr), ntohl(*lRcvIntegerPtr));
-#endif
-		lRcvIntegerPtr++;
-	}
-
-	// get number of echoes. If 0, then the master echo is transfered instead of the number
-#if 0
-	printf("Data Content = %d\r\n", lDataContent);
-#endif
-
-#if 0
-	printf("Number of echoes = %d\r\n", lNumberOfEchoes);
-#endif
-	if (0 == lNumberOfEchoes)
-	{
-		lNumberOfEchoes = 1;
-	}
-
-	// take number of points, check limits
-	lNumberOfPoints = ntohl(*lRcvIntegerPtr++);
-#if 0
-	printf("Number of points = %d\r\n", lNumberOfPoints);
-#endif
-
-	if ((4 /* MAX_NUMBER_OF_ECHOS */ < lNumberOfEchoes) || (4000 /* MAX_POINTS_PER_SCAN */ < lNumberOfPoints))
-	{
-		return;
-	}
-
-	// copy data block according to the data content.
-	if (1 /* lDataContent == 4 */ /* DATABLOCK_WITH_DISTANCES */)
-	{
-    	int32_t lCnt = 0;
-    	int32_t lDistanceSum = 0;
-    	int32_t lSumCnt = 0;
-		int32_t* lSendIntegerPtr = lRcvIntegerPtr;
-
-    	for (int32_t lPoints = 0; lPoints < lNumberOfPoints; lPoints++)
-		{
-			// loop for each point through all echos
-			for (int32_t lEchos = 0; lEchos < lNumberOfEchoes; lEchos++)
-			{
-            	int32_t lDistance;
-
-            	lDistance = ntohl(*lRcvIntegerPtr++);
-            	if (lDataContent != 4)
-            	{
-            		lRcvIntegerPtr++;
-            	}
-
-        		lCnt ++;
-
-        		if ((uint32_t)lDistance == 0x80000000)
-            	{
-            		if (lSumCnt == 0)
-            		{
-            			lDistanceSum = lDistance;
-            		}
-            	}
-            	else if ((uint32_t)lDistance == 0x7FFFFFFF)
-            	{
-            		if (lSumCnt == 0)
-            		{
-            			lDistanceSum = lDistance;
-            		}
-            	}
-            	else
-            	{
-            		if (lSumCnt == 0)
-            		{
-            			lDistanceSum = 0;
-            		}
-            		lSumCnt ++;
-            		lDistanceSum += lDistance;
-            	}
-
-            	if (lCnt == g_GSC2_PointAvgNumber)
-            	{
-            		if (lSumCnt > 0)
-            		{
-                		*lSendIntegerPtr++ = htonl(lDistanceSum / lSumCnt);
-#if 0
-                		printf("%4d:%2d:", lPoints, lSumCnt);
-            			for (int32_t lSpaceCnt = 0; lSpaceCnt < ((lDistanceSum / lSumCnt) - 15000) / 500; lSpaceCnt ++)
-            			{
-            				printf("-");
-            			}
-        				printf("|\r\n");
-#endif
-            		}
-            		else
-            		{
-                		*lSendIntegerPtr++ = htonl(lDistanceSum);
-#if 0
-            			printf("%4d:%2d:%-8s\r\n", lPoints, lSumCnt, (uint32_t)lDistanceSum == 0x80000000 ? "Low" : "Noise");
-#endif
-            		}
-
-            		if (lDataContent != 4)
-                	{
-                		lSendIntegerPtr++;
-                	}
-                	lSendNumberOfPoints ++;
-
-                	lCnt = 0;
-            		lDistanceSum = 0;
-            		lSumCnt = 0;
-            	}
-			} // end echos
-            if ((lPoints == (lNumberOfPoints - 1)) && (lCnt != 0))
-        	{
-        		if (lSumCnt > 0)
-        		{
-            		*lSendIntegerPtr++ = htonl(lDistanceSum / lSumCnt);
-#if 0
-        			printf("%4d:%2d:", lPoints, lSumCnt);
-        			for (int32_t lSpaceCnt = 0; lSpaceCnt < ((lDistanceSum / lSumCnt) - 15000) / 500; lSpaceCnt ++)
-        			{
-        				printf("-");
-        			}
-    				printf("|\r\n");
-#endif
-        		}
-        		else
-        		{
-            		*lSendIntegerPtr++ = htonl(lDistanceSum);
-#if 0
-        			printf("%4d:%2d:%-8s\r\n", lPoints, lSumCnt, (uint32_t)lDistanceSum == 0x80000000 ? "Low" : "Noise");
-#endif
-        		}
-
-        		if (lDataContent != 4)
-            	{
-            		lSendIntegerPtr++;
-            	}
-            	lSendNumberOfPoints ++;
-        	}
-		} // end points
-	}
-
-    CRC32 lCRC;
-    int32_t lCRCPosition; // position of the CRC in the buffer
-    uint32_t lCRCValue;
-
-    lSendLength = 4 + 4 * lNumberOfParameter + 4 + (lDataContent == 4 ? 4 : 8) * lSendNumberOfPoints;
-    lCRCPosition = (8 + lSendLength + 4) / sizeof(int32_t) - 1;
-	lDataPtr.asIntegerPtr[1] = htonl(lSendLength); // Length
-	lDataPtr.asIntegerPtr[12] = htonl(lSendNumberOfPoints); // Number of points
-	lCRCValue = lCRC.get(lDataPtr.asIntegerPtr + 0,  8 + lSendLength);
-	lDataPtr.asIntegerPtr[lCRCPosition] = htonl(lCRCValue);
-    *plen = 8 + lSendLength + 4;
-#if 0
-    printf("Send Length = %d\r\n", lSendLength);
-	printf("Send Number of points = %d\r\n", lSendNumberOfPoints);
-	printf("Send CRCPosition = %d\r\n", lCRCPosition);
-	printf("Send CRCValue = 0x%%x\r\n", lCRCValue);
-#endif
-
-	return;
-}
-
-bool
-convertRELAY_Sensor_Client_GSCN_GSC2(char *data, int32_t len, int32_t *plen)
-{
-    CRC32 lCRC;
-	int32_t lLength = ntohl(*(int32_t *)(data + 4));
-    uint32_t lCRCExpected = ntohl(*(int32_t *)(data + (len - 4)));
-    uint32_t lCRCReceived = lCRC.get(data, len - 4);
-
-#if 0
-	printf("GSC2: Length = %d(%d)\r\n", lLength, len);
-    printf("GSC2: CRC expected:0x%x, received:0x%x\n", lCRCExpected, lCRCReceived);
-#endif
-    if (len < (lLength + 4*3) || lCRCExpected != lCRCReceived)
+    Benchmark lBenchmark(theTerminalLogFile);
+    if (ERR_SUCCESS != lBenchmark.run())
     {
-    	return false;
+        fprintf(stderr, "Error: Benchmark results differ!\r\n");
     }
-
-	memcpy(g_GSC2_GSCN_rcvd_data[g_GSC2_ScanAvgNumber_cnt], data, len);
-    g_GSC2_ScanAvgNumber_cnt ++;
-#if 0
-    printf("GSC2: g_GSC2_ScanAvgNumber_cnt = %d of %d\n", g_GSC2_ScanAvgNumber_cnt, g_GSC2_ScanAvgNumber);
-#endif
-    if ( g_GSC2_ScanAvgNumber_cnt < g_GSC2_ScanAvgNumber)
-    {
-    	return false;
-    }
-
-    convertRELAY_Sensor_Client_GSCN_GSC2_ScanAvg(data, len, plen);
-
-    convertRELAY_Sensor_Client_GSCN_GSC2_PointAvg(data, len, plen);
-
-    return true;
-}
-
-bool
-convertRELAY_Sensor_Client(char *data, int32_t len, int32_t *plen)
-{
-	if (g_GSC2_flag && !strncmp(data, "GSCN", 4))
-	{
-		if (convertRELAY_Sensor_Client_GSCN_GSC2(data, len, plen) == false)
-		{
-			memcpy(data, g_GSC2_GSCN_send_data, g_GSC2_GSCN_send_data_len);
-			*plen = g_GSC2_GSCN_send_data_len;
-			return false;
-		}
-	}
-	return true;
 }
 
 char g_RELAY_read_data[DATA_BUF_SIZE_MAX];
@@ -728,11 +252,19 @@ char g_RELAY_read_data[DATA_BUF_SIZE_MAX];
 /**
  */
 void
-testRELAY_UART_NET(IDataStream& theUART, IDataStream& theSensorSocket, FILE* theTerminalLogFile)
+testRELAY_UART_NET(IDataStream& theUART, IDataStream& theSensorSocket, GSC2Session::GSC2Filter_t theFilter,
+        FILE* theTerminalLogFile)
 {
 	int32_t read_len;
 	int c = 0;
-
+	EventLoop lEventLoop;
+	const int32_t lClient = lEventLoop.addStream(theUART);
+	const int32_t lSensor = lEventLoop.addStream(theSensorSocket);
+	const int32_t lKeyboard = lEventLoop.addKeyboard();
+	GSC2Session lSession;
+
+	lSession.setFilter(theFilter);
+	printf("GSC2 scan filter: %s\r\n", GSC2Session::getFilterName(theFilter));
 	printf("RELAY UART-NET mode started!\r\n");
 
     // terminal mode change on linux for kbhit of isTerminated().
@@ -740,17 +272,33 @@ testRELAY_UART_NET(IDataStream& theUART, IDataStream& theSensorSocket, FILE* the
 
     do
 	{
+		// sleep until the client, the sensor or the keyboard has data
+		if (ERR_SUCCESS != lEventLoop.wait(EventLoop::WAIT_FOREVER))
+		{
+			continue;
+		}
+
+		// nothing to relay without the client or the sensor
+		if (lEventLoop.isHungUp(lClient) || lEventLoop.isHungUp(lSensor))
+		{
+			printf("RELAY: %s connection hung up\r\n", lEventLoop.isHungUp(lClient) ? "client" : "sensor");
+			break;
+		}
+
 		// if new data is available on the serial port, print it out
-		if ((read_len = theUART.read(g_RELAY_read_data, sizeof(g_RELAY_read_data))) > 0)
+		if (lEventLoop.isReadable(lClient)
+				&& ((read_len = theUART.read(g_RELAY_read_data, sizeof(g_RELAY_read_data))) > 0))
 		{
 #if DEBUG_RELAY_U
 		    printf("Client read_len=%d\r\n", read_len);
 #endif
-		    convertRELAY_Client_Sensor(g_RELAY_read_data, read_len, &read_len);
+		    if (ERR_SUCCESS == lSession.convertRequest(g_RELAY_read_data, read_len, &read_len))
+		    {
 #if DEBUG_RELAY_U
-		    printf("Sensor write_len=%d\r\n", read_len);
+		        printf("Sensor write_len=%d\r\n", read_len);
 #endif
-		    theSensorSocket.write(g_RELAY_read_data, read_len);
+		        theSensorSocket.write(g_RELAY_read_data, read_len);
+		    }
 		}
 #if DEBUG_RELAY_U_NO_DOT
 		else
@@ -759,12 +307,13 @@ testRELAY_UART_NET(IDataStream& theUART, IDataStream& theSensorSocket, FILE* the
 		}
 #endif
 		// if new data is available on the console, send it to the serial port
-		if ((read_len = theSensorSocket.read(g_RELAY_read_data, sizeof(g_RELAY_read_data))) > 0)
+		if (lEventLoop.isReadable(lSensor)
+				&& ((read_len = theSensorSocket.read(g_RELAY_read_data, sizeof(g_RELAY_read_data))) > 0))
 		{
 #if DEBUG_RELAY_U
 		    printf("Sensor read_len=%d\r\n", read_len);
 #endif
-			if (convertRELAY_Sensor_Client(g_RELAY_read_data, read_len, &read_len))
+			if (lSession.convertResponse(g_RELAY_read_data, read_len, &read_len))
 			{
 #if DEBUG_RELAY_U
 			    printf("Client write_len=%d\r\n", read_len);
@@ -785,7 +334,8 @@ testRELAY_UART_NET(IDataStream& theUART, IDataStream& theSensorSocket, FILE* the
 #if DEBUG_RELAY_U_DOT
 		printf(".");
 #endif
-	} while((kbhit() == 0) || (((c = getch()) != 'q') && (c != 'Q') && (c != 27/*VK_ESC*/)));
+	} while((false == lEventLoop.isReadable(lKeyboard)) || (kbhit() == 0)
+			|| (((c = getch()) != 'q') && (c != 'Q') && (c != 27/*VK_ESC*/)));
 
     // terminal mode restore on linux for kbhit of isTerminated().
     changemode(0);
@@ -794,11 +344,19 @@ testRELAY_UART_NET(IDataStream& theUART, IDataStream& theSensorSocket, FILE* the
 /**
  */
 void
-testRELAY_NET_NET(IDataStream& theClientSocket, IDataStream& theSensorSocket, FILE* theTerminalLogFile)
+testRELAY_NET_NET(IDataStream& theClientSocket, IDataStream& theSensorSocket, GSC2Session::GSC2Filter_t theFilter,
+        FILE* theTerminalLogFile)
 {
 	int32_t read_len;
 	int c = 0;
-
+	EventLoop lEventLoop;
+	const int32_t lClient = lEventLoop.addStream(theClientSocket);
+	const int32_t lSensor = lEventLoop.addStream(theSensorSocket);
+	const int32_t lKeyboard = lEventLoop.addKeyboard();
+	GSC2Session lSession;
+
+	lSession.setFilter(theFilter);
+	printf("GSC2 scan filter: %s\r\n", GSC2Session::getFilterName(theFilter));
 	printf("RELAY NET-NET mode started!\r\n");
 
     // terminal mode change on linux for kbhit of isTerminated().
@@ -806,19 +364,36 @@ testRELAY_NET_NET(IDataStream& theClientSocket, IDataStream& theSensorSocket, FI
 
     do
 	{
+		// sleep until the client, the sensor or the keyboard has data
+		if (ERR_SUCCESS != lEventLoop.wait(EventLoop::WAIT_FOREVER))
+		{
+			continue;
+		}
+
+		// nothing to relay without the client or the sensor
+		if (lEventLoop.isHungUp(lClient) || lEventLoop.isHungUp(lSensor))
+		{
+			printf("RELAY: %s connection hung up\r\n", lEventLoop.isHungUp(lClient) ? "client" : "sensor");
+			break;
+		}
+
 		// if new data is available on the serial port, print it out
-		if ((read_len = theClientSocket.read(g_RELAY_read_data, sizeof(g_RELAY_read_data))) > 0)
+		if (lEventLoop.isReadable(lClient)
+				&& ((read_len = theClientSocket.read(g_RELAY_read_data, sizeof(g_RELAY_read_data))) > 0))
 		{
 		    //printf("Client read_len=%d\r\n", read_len);
-			convertRELAY_Client_Sensor(g_RELAY_read_data, read_len, &read_len);
-			theSensorSocket.write(g_RELAY_read_data, read_len);
+			if (ERR_SUCCESS == lSession.convertRequest(g_RELAY_read_data, read_len, &read_len))
+			{
+				theSensorSocket.write(g_RELAY_read_data, read_len);
+			}
 		}
 	    //printf("Client read_len=%d\r\n", read_len);
 		// if new data is available on the console, send it to the serial port
-		if ((read_len = theSensorSocket.read(g_RELAY_read_data, sizeof(g_RELAY_read_data))) > 0)
+		if (lEventLoop.isReadable(lSensor)
+				&& ((read_len = theSensorSocket.read(g_RELAY_read_data, sizeof(g_RELAY_read_data))) > 0))
 		{
 		    //printf("Sensor read_len=%d\r\n", read_len);
-			if (convertRELAY_Sensor_Client(g_RELAY_read_data, read_len, &read_len))
+			if (lSession.convertResponse(g_RELAY_read_data, read_len, &read_len))
 			{
 				theClientSocket.write(g_RELAY_read_data, read_len);
 			}
@@ -828,12 +403,99 @@ testRELAY_NET_NET(IDataStream& theClientSocket, IDataStream& theSensorSocket, FI
 			}
 		}
 	    //printf("Sensor read_len=%d\r\n", read_len);
-	} while((kbhit() == 0) || (((c = getch()) != 'q') && (c != 'Q') && (c != 27/*VK_ESC*/)));
+	} while((false == lEventLoop.isReadable(lKeyboard)) || (kbhit() == 0)
+			|| (((c = getch()) != 'q') && (c != 'Q') && (c != 27/*VK_ESC*/)));
 
     // terminal mode restore on linux for kbhit of isTerminated().
     changemode(0);
 }
 
+#if defined(__linux__)
+/**
+ * Shares the sensor between several clients.
+ */
+void
+testRELAY_MULTI(ServerSocket& theServerSocket, IDataStream& theSensorSocket, GSC2Session::GSC2Filter_t theFilter,
+        FILE* theTerminalLogFile)
+{
+    RelayServer lRelayServer(theServerSocket, theSensorSocket);
+    lRelayServer.setFilter(theFilter);
+    printf("GSC2 scan filter: %s\r\n", GSC2Session::getFilterName(theFilter));
+    lRelayServer.setTerminalLogFile(theTerminalLogFile);
+    lRelayServer.run();
+}
+
+/**
+ * Simulates a sensor on a UDP port and a pseudo terminal.
+ */
+void
+testSIM(ServerSocket& theServerSocket, SensorSimulator& theSimulator, FILE* theTerminalLogFile)
+{
+    PseudoTerminal lTerminal;
+    SimulatorServer lSimulatorServer(theServerSocket, theSimulator);
+
+    // UDP only if there is no pseudo terminal
+    if (ERR_SUCCESS == lTerminal.open())
+    {
+        lSimulatorServer.setTerminal(&lTerminal);
+    }
+    lSimulatorServer.setTerminalLogFile(theTerminalLogFile);
+    lSimulatorServer.run();
+}
+
+/**
+ * Measures scan requests against a local simulator; theScenarioName is NET, UART, RELAY, GSC2 or ALL.
+ */
+void
+testE2E(SensorSimulator& theSimulator, const char* theScenarioName, int32_t theNumberOfRequests,
+        FILE* theResultFile, FILE* theTerminalLogFile)
+{
+    EndToEndBenchmark lBenchmark(theSimulator, theTerminalLogFile);
+    EndToEndBenchmark::Scenario_t lScenario = EndToEndBenchmark::SCENARIO_NET;
+    ErrorID_t result = ERR_SUCCESS;
+    string32_t lScenarioName;
+    char* lBaudRatePtr;
+
+    if (ERR_SUCCESS != lBenchmark.setNumberOfRequests(theNumberOfRequests))
+    {
+        fprintf(stderr, "Error: Invalid number of requests!\r\n");
+        return;
+    }
+    lBenchmark.setResultFile(theResultFile);
+
+    // the baud rate of the UART scenario follows the name, like UART:921600
+    strncpy(lScenarioName, theScenarioName, sizeof(lScenarioName) - 1);
+    lScenarioName[sizeof(lScenarioName) - 1] = 0;
+    if (0 != (lBaudRatePtr = strchr(lScenarioName, ':')))
+    {
+        *lBaudRatePtr++ = 0;
+        if (ERR_SUCCESS != lBenchmark.setBaudRate(static_cast<uint32_t>(strtoul(lBaudRatePtr, 0, 10))))
+        {
+            fprintf(stderr, "Error: Invalid baud rate %s!\r\n", lBaudRatePtr);
+            return;
+        }
+    }
+
+    if (0 == strcmp(lScenarioName, "ALL"))
+    {
+        result = lBenchmark.runAll();
+    }
+    else if (ERR_SUCCESS == EndToEndBenchmark::findScenario(lScenarioName, lScenario))
+    {
+        result = lBenchmark.run(lScenario);
+    }
+    else
+    {
+        fprintf(stderr, "Error: Unknown scenario %s!\r\n", lScenarioName);
+        return;
+    }
+    if (ERR_SUCCESS != result)
+    {
+        fprintf(stderr, "Error: Benchmark failed!\r\n");
+    }
+}
+#endif
+
 /*
  * Main for a number of tests.
  */
@@ -852,6 +514,10 @@ main(int argc, char **argv)
     string32_t lSensorIP = { "10.0.8.86" }; // default sensor IP
     ClientSocket lSensorSocket;
     ClientUART lClientUART;
+    ReplayStream lReplayStream;
+#if defined(__linux__)
+    ServerSocket lServerSocket;
+#endif
     string32_t lDataLogFileName = { 0 };
     string32_t lTerminalLogFileName = { 0 };
 #if __WIN32__
@@ -875,8 +541,31 @@ main(int argc, char **argv)
     // print program version
     printf("%s\r\n", getVersionString());
 
+    // parse command line: mode; the relays may take the filter of the GSC2 scan averaging, e.g. RELAY_N:MEDIAN,
+    // the replay its speed, e.g. REPLAY:FAST
+    string32_t lMode = { 0 };
+    GSC2Session::GSC2Filter_t lFilter = GSC2Session::FILTER_MEAN;
+    bool lIsReplayPaced = true;
+    if (2 <= argc)
+    {
+		char *lp;
+		strncpy(lMode, argv[1], sizeof(lMode) - 1);
+		if ((lp = strchr(lMode, ':')))
+		{
+			*lp = 0;
+			if (!strcmp(lMode, "REPLAY") && (!strcmp(lp + 1, "FAST") || !strcmp(lp + 1, "PACED")))
+			{
+				lIsReplayPaced = (0 != strcmp(lp + 1, "FAST"));
+			}
+			else if (strncmp(lMode, "RELAY_", 6) || (ERR_SUCCESS != GSC2Session::findFilter(lp + 1, lFilter)))
+			{
+				lMode[0] = 0; // show the help
+			}
+		}
+    }
+
     // parse command line: help
-    if (argc < 2 || (strcmp(argv[1], "NET") && strcmp(argv[1], "UART") && strcmp(argv[1], "RELAY_N") && strcmp(argv[1], "RELAY_U")))
+    if (argc < 2 || (strcmp(lMode, "NET") && strcmp(lMode, "UART") && strcmp(lMode, "REPLAY") && strcmp(lMode, "RELAY_N") && strcmp(lMode, "RELAY_U") && strcmp(lMode, "RELAY_M") && strcmp(lMode, "SIM") && strcmp(lMode, "BENCH") && strcmp(lMode, "E2E")))
     {
 		puts(	"Usage: PSDemoProgram \r\n"
 				"   NET\r\n"
@@ -887,15 +576,45 @@ main(int argc, char **argv)
 				"   [UART_port] [BAUD_rate]\r\n"
 				"   [data log file] [terminal log file]\r\n"
 				"    -or-\r\n"
-				"   RELAY_N\r\n"
+				"   REPLAY[:speed]\r\n"
+				"   [recording] [data log file] [terminal log file]\r\n"
+				"    -or-\r\n"
+				"   RELAY_N[:filter]\r\n"
 				"   [client_ip_address] [client_port]\r\n"
 				"   [sensor_ip_address] [sensor_port] [my_port]\r\n"
 				"   [data log file] [terminal log file]\r\n"
 				"    -or-\r\n"
-				"   RELAY_U\r\n"
+				"   RELAY_U[:filter]\r\n"
 				"   [UART_port] [BAUD_rate]\r\n"
 				"   [sensor_ip_address] [sensor_port] [my_port]\r\n"
-				"   [data log file] [terminal log file]\r\n\n");
+				"   [data log file] [terminal log file]\r\n"
+				"    -or-\r\n"
+				"   RELAY_M[:filter] (Linux only)\r\n"
+				"   [server_port]\r\n"
+				"   [sensor_ip_address] [sensor_port] [my_port]\r\n"
+				"   [terminal log file]\r\n"
+				"    -or-\r\n"
+				"   SIM (Linux only)\r\n"
+				"   [my_port] [points] [echoes] [data content] [scans/s]\r\n"
+				"   [no echo %] [noise %] [loss %] [delay ms] [seed]\r\n"
+				"   [terminal log file]\r\n"
+				"    -or-\r\n"
+				"   BENCH\r\n"
+				"   [terminal log file]\r\n"
+				"    -or-\r\n"
+				"   E2E (Linux only)\r\n"
+				"   [scenario] [points] [echoes] [data content] [requests] [loss %]\r\n"
+				"   [result file] [terminal log file]\r\n\n"
+				"The filter of the relays combines the scans averaged for GSC2:\r\n"
+				"   MEAN (default), MEDIAN or TRIMMED (mean of the middle 50%)\r\n"
+				"The replay answers the requests from a recording of the data log:\r\n"
+				"   PACED (default) at the recorded times, or FAST\r\n"
+				"The simulator serves UDP and a pseudo terminal for UART clients;\r\n"
+				"   data content 0, 4 (distances) or 7, 8 (with pulse widths), 0 scans/s for a scan per request\r\n"
+				"The end-to-end benchmark requests scans from the simulator by\r\n"
+				"   NET, UART, RELAY, GSC2 (by the relay) or ALL (default);\r\n"
+				"   UART and ALL take the baud rate like UART:921600 (default 115200)\r\n"
+				"   the results are appended to the result file as comma separated values\r\n\n");
 		printf(	"Example:\r\n");
 		printf(	"   PSDemoProgram NET 10.0.3.12 1024 1025 %s\r\n", lDataLogFile);
 		printf(	"    -or- PSDemoProgram NET 10.0.3.12\r\n");
@@ -903,17 +622,28 @@ main(int argc, char **argv)
 		printf(	"    -or- PSDemoProgram UART %s:115200\r\n", lUARTName);
 		printf(	"    -or- PSDemoProgram UART %s:115200 %s\r\n", lUARTName, lDataLogFile);
 		printf(	"    -or- PSDemoProgram UART %s:9600\r\n", lUARTName);
+		printf(	"    -or- PSDemoProgram UART %s:921600\r\n", lUARTName);
+		printf(	"   PSDemoProgram REPLAY %s\r\n", lDataLogFile);
+		printf(	"    -or- PSDemoProgram REPLAY:FAST %s\r\n", lDataLogFile);
 		printf(	"   PSDemoProgram RELAY_N 10.0.10.1 1025 10.0.3.12 1024 1025 %s\r\n", lDataLogFile);
 		printf(	"    -or- PSDemoProgram RELAY_N 10.0.10.1 1025 10.0.3.12\r\n");
 		printf(	"   PSDemoProgram RELAY_U %s:115200 10.0.3.12 1024 1025 %s\r\n", lUARTName, lDataLogFile);
 		printf(	"    -or- PSDemoProgram RELAY_U %s:115200 10.0.3.12\r\n", lUARTName);
 		printf(	"    -or- PSDemoProgram RELAY_U %s:9600 10.0.3.12\r\n", lUARTName);
+		printf(	"   PSDemoProgram RELAY_M 1024 10.0.3.12 1024 1025\r\n");
+		printf(	"    -or- PSDemoProgram RELAY_M:MEDIAN 1024 10.0.3.12 1024 1025\r\n");
+		printf(	"   PSDemoProgram SIM 1024 1000 1 8 25\r\n");
+		printf(	"    -or- PSDemoProgram SIM 1024 4000 2 8 0 5 5 1 2\r\n");
+		printf(	"   PSDemoProgram BENCH\r\n");
+		printf(	"   PSDemoProgram E2E ALL 1000 1 8 2000 0 /tmp/e2e.csv\r\n");
+		printf(	"    -or- PSDemoProgram E2E UART 4000 2 8\r\n");
+		printf(	"    -or- PSDemoProgram E2E UART:3000000 4000 2 8\r\n");
 		return -1;
 	}
 
-    if (!strcmp(argv[1], "NET") || !strcmp(argv[1], "UART"))
+    if (!strcmp(lMode, "NET") || !strcmp(lMode, "UART") || !strcmp(lMode, "REPLAY"))
     {
-		if (!strcmp(argv[1], "NET"))
+		if (!strcmp(lMode, "NET"))
 		{
 			// get sensor IP and port from the command line
 			if (3 <= argc)
@@ -950,6 +680,9 @@ main(int argc, char **argv)
 			lSensorSocket.setServerIPAddress(lSensorIP, lSensorPort);
 			//lSensorSocket.setDataLogFile(lDataLogFile);
 			lSensorSocket.setTimeout(10);
+#if defined(__linux__)
+			lSensorSocket.setBufferSizes(SOCKET_RECEIVE_BUFFER_SIZE, 0);
+#endif
 
 			// open the socket
 			if (ERR_SUCCESS != lSensorSocket.open())
@@ -961,7 +694,7 @@ main(int argc, char **argv)
 			}
 			lpDataSteam = &lSensorSocket;
 		}
-		else // if (!strcmp(argv[1], "UART"))
+		else if (!strcmp(lMode, "UART"))
 		{
 			// get UART port and baud rate from the command line
 			if (argc >= 3)
@@ -1008,6 +741,39 @@ main(int argc, char **argv)
 			}
 			lpDataSteam = &lClientUART;
 		}
+		else // if (!strcmp(lMode, "REPLAY"))
+		{
+			// get the recording from the command line
+			if (3 <= argc)
+			{
+				strcpy(lDataLogFile, argv[2]);
+			}
+			printf("Recording: %s (%s)\r\n", lDataLogFile, lIsReplayPaced ? "paced" : "fast");
+
+			// open the log files
+			if (4 <= argc)
+			{
+				strcpy(lDataLogFileName, argv[3]);
+			}
+			if (5 <= argc)
+			{
+				strcpy(lTerminalLogFileName, argv[4]);
+				lTerminalLogFile = fopen(lTerminalLogFileName, "ab");
+			}
+			printf("Data log file name: %s\r\n\n", lDataLogFileName);
+
+			// map the recording
+			lReplayStream.setFileName(lDataLogFile);
+			lReplayStream.setPaced(lIsReplayPaced);
+			if (ERR_SUCCESS != lReplayStream.open())
+			{
+				if (lTerminalLogFile) fclose(lTerminalLogFile);
+				fprintf(stderr, "Error: Cannot open recording %s!\r\n", lDataLogFile);
+				return ERR_IO;
+			}
+			printf("Recorded scans: %d\r\n", lReplayStream.getNumberOfScans());
+			lpDataSteam = &lReplayStream;
+		}
 
 		// menu
 	    while (false == done)
@@ -1019,7 +785,8 @@ main(int argc, char **argv)
 	                " 4 - SCAN: Starting a scan sequence\r\n"
 	                " 5 - SCANPR: Getting a scan data and print graph\r\n"
 	                " 6 - SCN2: Starting a scan2 sequence\r\n"
-	                " 7 - SCN2PR: Getting a scan2 data and print graph\r\n");
+	                " 7 - SCN2PR: Getting a scan2 data and print graph\r\n"
+	                " 8 - SCANPIPE: Starting a scan sequence with pipelined requests\r\n");
 	        printf( " 0 - Exit\r\n> ");
 
 	        lSelection = -1;
@@ -1061,6 +828,10 @@ main(int argc, char **argv)
     	        	testSCN2PR(*lpDataSteam, lDataLogFileName, lTerminalLogFile);
 	                break;
 
+	            case 8:
+	                testSCANPIPE(*lpDataSteam, lDataLogFileName, lTerminalLogFile);
+	                break;
+
 	            case 0:
 	                done = true;
 	                break;
@@ -1071,7 +842,18 @@ main(int argc, char **argv)
 	        }
 	    }
     }
-    else if (!strcmp(argv[1], "RELAY_N"))
+    else if (!strcmp(lMode, "BENCH"))
+    {
+		// get terminal log file name from the command line
+		if (3 <= argc)
+		{
+			strcpy(lTerminalLogFileName, argv[2]);
+			lTerminalLogFile = fopen(lTerminalLogFileName, "ab");
+		}
+
+		testBENCH(lTerminalLogFile);
+    }
+    else if (!strcmp(lMode, "RELAY_N"))
     {
 		// get client IP and port from the command line
 		if (3 <= argc)
@@ -1143,10 +925,162 @@ main(int argc, char **argv)
 			return ERR_IO;
 		}
 
-        testRELAY_NET_NET(lClientSocket, lSensorSocket, lTerminalLogFile);
+        testRELAY_NET_NET(lClientSocket, lSensorSocket, lFilter, lTerminalLogFile);
 
     }
-    else //if (!strcmp(argv[1], "RELAY_U"))
+    else if (!strcmp(lMode, "RELAY_M"))
+    {
+#if defined(__linux__)
+		// get the port the clients send to from the command line
+		int32_t lServerPort = lSensorPort;
+		if (3 <= argc)
+		{
+			lServerPort = atoi(argv[2]);
+		}
+		printf("Server port: %d\r\n\n", lServerPort);
+
+		// get sensor IP and port from the command line
+		if (4 <= argc)
+		{
+			strcpy(lSensorIP, argv[3]);
+		}
+		if (5 <= argc)
+		{
+			lSensorPort = atoi(argv[4]);
+		}
+
+		// get local Port from the command line
+		if (6 <= argc)
+		{
+			lMyPort = atoi(argv[5]);
+		}
+		printf("Sensor IP: %s:%d and My port: %d\r\n\n", lSensorIP, lSensorPort, lMyPort);
+
+		// open the log file
+		if (7 <= argc)
+		{
+			strcpy(lTerminalLogFileName, argv[6]);
+			lTerminalLogFile = fopen(lTerminalLogFileName, "ab");
+		}
+
+		// open the server socket
+		lServerSocket.setPort(lServerPort);
+		if (ERR_SUCCESS != lServerSocket.open())
+		{
+			if (lTerminalLogFile) fclose(lTerminalLogFile);
+			fprintf(stderr, "Error: Cannot open server IP connection!\r\n");
+			return ERR_IO;
+		}
+
+		// create the sensor socket
+		lSensorSocket.setClientIPAddress(0, lMyPort);
+		lSensorSocket.setServerIPAddress(lSensorIP, lSensorPort);
+		lSensorSocket.setTimeout(0);
+		lSensorSocket.setBufferSizes(SOCKET_RECEIVE_BUFFER_SIZE, 0);
+		// open the sensor socket
+		if (ERR_SUCCESS != lSensorSocket.open())
+		{
+			lServerSocket.close();
+			if (lTerminalLogFile) fclose(lTerminalLogFile);
+			fprintf(stderr, "Error: Cannot open sensor IP connection!\r\n");
+			return ERR_IO;
+		}
+
+		testRELAY_MULTI(lServerSocket, lSensorSocket, lFilter, lTerminalLogFile);
+		lServerSocket.close();
+#else
+		fprintf(stderr, "Error: RELAY_M requires Linux!\r\n");
+#endif
+    }
+    else if (!strcmp(lMode, "SIM"))
+    {
+#if defined(__linux__)
+		SensorSimulator lSimulator;
+		int32_t lValues[9] = { lSensorPort, 1000, 1, 8, 25, 0, 0, 0, 0 };
+
+		// get port, scan format, invalid echoes and faults from the command line
+		for (int32_t l = 0; (l < 9) && (l + 2 < argc); l++)
+		{
+			lValues[l] = atoi(argv[l + 2]);
+		}
+		if (11 < argc)
+		{
+			lSimulator.setSeed(atoi(argv[11]));
+		}
+		if ((ERR_SUCCESS != lSimulator.setScanFormat(lValues[1], lValues[2], lValues[3]))
+				|| (ERR_SUCCESS != lSimulator.setScanRate(lValues[4]))
+				|| (ERR_SUCCESS != lSimulator.setInvalidEchoes(lValues[5], lValues[6]))
+				|| (ERR_SUCCESS != lSimulator.setFaults(lValues[7], lValues[8])))
+		{
+			fprintf(stderr, "Error: Invalid simulator settings!\r\n");
+			return ERR_INVALID_PARAMETER;
+		}
+		printf("My port: %d\r\n\n", lValues[0]);
+
+		// open the log file
+		if (13 <= argc)
+		{
+			strcpy(lTerminalLogFileName, argv[12]);
+			lTerminalLogFile = fopen(lTerminalLogFileName, "ab");
+		}
+
+		// open the server socket
+		lServerSocket.setPort(lValues[0]);
+		if (ERR_SUCCESS != lServerSocket.open())
+		{
+			if (lTerminalLogFile) fclose(lTerminalLogFile);
+			fprintf(stderr, "Error: Cannot open server IP connection!\r\n");
+			return ERR_IO;
+		}
+
+		testSIM(lServerSocket, lSimulator, lTerminalLogFile);
+		lServerSocket.close();
+#else
+		fprintf(stderr, "Error: SIM requires Linux!\r\n");
+#endif
+    }
+    else if (!strcmp(lMode, "E2E"))
+    {
+#if defined(__linux__)
+		SensorSimulator lSimulator;
+		string32_t lScenarioName = { "ALL" };
+		int32_t lValues[5] = { 1000, 1, 8, 1000, 0 };
+		FILE* lResultFile = 0;
+
+		// get scenario, scan format, number of requests and losses from the command line
+		if (3 <= argc)
+		{
+			strncpy(lScenarioName, argv[2], sizeof(lScenarioName) - 1);
+		}
+		for (int32_t l = 0; (l < 5) && (l + 3 < argc); l++)
+		{
+			lValues[l] = atoi(argv[l + 3]);
+		}
+		if ((ERR_SUCCESS != lSimulator.setScanFormat(lValues[0], lValues[1], lValues[2]))
+				|| (ERR_SUCCESS != lSimulator.setFaults(lValues[4], 0)))
+		{
+			fprintf(stderr, "Error: Invalid simulator settings!\r\n");
+			return ERR_INVALID_PARAMETER;
+		}
+
+		// open the result and the log file
+		if (9 <= argc)
+		{
+			lResultFile = fopen(argv[8], "ab");
+		}
+		if (10 <= argc)
+		{
+			strcpy(lTerminalLogFileName, argv[9]);
+			lTerminalLogFile = fopen(lTerminalLogFileName, "ab");
+		}
+
+		testE2E(lSimulator, lScenarioName, lValues[3], lResultFile, lTerminalLogFile);
+		if (lResultFile) fclose(lResultFile);
+#else
+		fprintf(stderr, "Error: E2E requires Linux!\r\n");
+#endif
+    }
+    else //if (!strcmp(lMode, "RELAY_U"))
     {
 		// get UART port and baud rate from the command line
 		if (argc >= 3)
@@ -1224,13 +1158,19 @@ main(int argc, char **argv)
 			return ERR_IO;
 		}
 
-        testRELAY_UART_NET(lClientUART, lSensorSocket, lTerminalLogFile);
+        testRELAY_UART_NET(lClientUART, lSensorSocket, lFilter, lTerminalLogFile);
 
     }
 
     // close the sensor socket
     if (lSensorSocket.isOpen())
     {
+#if defined(__linux__)
+    	if (0 != lSensorSocket.getNumberOfDrops())
+    	{
+    		printf("Sensor socket: %u datagrams dropped by the kernel\r\n", lSensorSocket.getNumberOfDrops());
+    	}
+#endif
     	lSensorSocket.close();
     }
     // close the client socket
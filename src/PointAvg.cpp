@@ -0,0 +1,289 @@
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       PointAvg.cpp
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ *
+ ****************************************************************************
+ */
+
+#include "PointAvg.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    #include <immintrin.h>
+    #define POINTAVG_HAVE_X86 1
+#endif
+
+#if defined(__ARM_NEON)
+    #include <arm_neon.h>
+    #define POINTAVG_HAVE_NEON 1
+#endif
+
+/*
+ * The AVX2 engine sums in double precision, which is exact and truncates
+ * like the integer division as long as a sum has less than 53 bits.
+ */
+#define POINTAVG_MAX_AVX2_GROUP_SIZE (1 << 20)
+
+/* the engine used by average(); the scalar loop until the selection below is done */
+PointAvg::Engine_t PointAvg::sEngine = PointAvg::averageScalar;
+
+/* ID of the engine used by average() */
+PointAvg::PointAvgEngine_t PointAvg::sEngineID = PointAvg::ENGINE_SCALAR;
+
+/* selects the fastest engine during static initialization, before any thread is started */
+static const ErrorID_t sEngineSelection = PointAvg::setEngine(PointAvg::ENGINE_AUTO);
+
+/*
+ * One distance at a time.
+ * A group without valid distance holds no echo and noise values only;
+ * its result is the last of them.
+ */
+void
+PointAvg::averageScalar(const int32_t* theDistancePtr, int32_t theNumberOfDistances, int32_t theGroupSize,
+        int32_t* theAveragePtr, int32_t* theCountPtr)
+{
+    for (int32_t lStart = 0; lStart < theNumberOfDistances; lStart += theGroupSize)
+    {
+        const int32_t lEnd = (theNumberOfDistances - lStart > theGroupSize) ? lStart + theGroupSize :
+                theNumberOfDistances;
+        int64_t lSum = 0;
+        int32_t lCount = 0;
+
+        for (int32_t l = lStart; l < lEnd; l++)
+        {
+            const int32_t lDistance = theDistancePtr[l];
+            if ((NO_ECHO != lDistance) && (NOISE != lDistance))
+            {
+                lSum += lDistance;
+                lCount++;
+            }
+        }
+        *theAveragePtr++ = (0 < lCount) ? static_cast<int32_t>(lSum / lCount) : theDistancePtr[lEnd - 1];
+        *theCountPtr++ = lCount;
+    }
+}
+
+#if POINTAVG_HAVE_X86
+/*
+ * Four groups at a time: lane i of each gather takes the next distance of group i.
+ * The groups which do not fill four lanes are left to the scalar loop.
+ */
+__attribute__((target("avx2"))) void
+PointAvg::averageAVX2(const int32_t* theDistancePtr, int32_t theNumberOfDistances, int32_t theGroupSize,
+        int32_t* theAveragePtr, int32_t* theCountPtr)
+{
+    const int32_t lNumberOfFullGroups = theNumberOfDistances / theGroupSize;
+    int32_t lGroup = 0;
+
+    if (POINTAVG_MAX_AVX2_GROUP_SIZE >= theGroupSize)
+    {
+        const __m128i lNoEcho = _mm_set1_epi32(NO_ECHO);
+        const __m128i lNoise = _mm_set1_epi32(NOISE);
+        const __m128i lOne = _mm_set1_epi32(1);
+        const __m128i lOffsets = _mm_setr_epi32(0, theGroupSize, 2 * theGroupSize, 3 * theGroupSize);
+
+        for (; lGroup + 4 <= lNumberOfFullGroups; lGroup += 4)
+        {
+            const int32_t* lGroupPtr = &theDistancePtr[lGroup * theGroupSize];
+            __m256d lSum = _mm256_setzero_pd();
+            __m128i lCount = _mm_setzero_si128();
+            __m128i lDistance = _mm_setzero_si128();
+
+            for (int32_t l = 0; l < theGroupSize; l++)
+            {
+                lDistance = _mm_i32gather_epi32(lGroupPtr + l, lOffsets, sizeof(int32_t));
+                const __m128i lIsInvalid = _mm_or_si128(_mm_cmpeq_epi32(lDistance, lNoEcho),
+                        _mm_cmpeq_epi32(lDistance, lNoise));
+                lSum = _mm256_add_pd(lSum, _mm256_cvtepi32_pd(_mm_andnot_si128(lIsInvalid, lDistance)));
+                lCount = _mm_add_epi32(lCount, _mm_andnot_si128(lIsInvalid, lOne));
+            }
+
+            // the lanes without valid distance take the last distance of the group
+            const __m128i lAverage = _mm256_cvttpd_epi32(_mm256_div_pd(lSum, _mm256_cvtepi32_pd(lCount)));
+            const __m128i lIsEmpty = _mm_cmpeq_epi32(lCount, _mm_setzero_si128());
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&theAveragePtr[lGroup]),
+                    _mm_blendv_epi8(lAverage, lDistance, lIsEmpty));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&theCountPtr[lGroup]), lCount);
+        }
+    }
+    averageScalar(&theDistancePtr[lGroup * theGroupSize], theNumberOfDistances - lGroup * theGroupSize,
+            theGroupSize, &theAveragePtr[lGroup], &theCountPtr[lGroup]);
+}
+#else
+/* not available on this CPU; never selected */
+void
+PointAvg::averageAVX2(const int32_t* theDistancePtr, int32_t theNumberOfDistances, int32_t theGroupSize,
+        int32_t* theAveragePtr, int32_t* theCountPtr)
+{
+    averageScalar(theDistancePtr, theNumberOfDistances, theGroupSize, theAveragePtr, theCountPtr);
+}
+#endif
+
+/*
+ * Four distances of a group at a time, summed into two 64 bit lanes.
+ * The division is scalar; ARMv7 NEON has no vector division.
+ */
+void
+PointAvg::averageNEON(const int32_t* theDistancePtr, int32_t theNumberOfDistances, int32_t theGroupSize,
+        int32_t* theAveragePtr, int32_t* theCountPtr)
+{
+#if POINTAVG_HAVE_NEON
+    const int32x4_t lNoEcho = vdupq_n_s32(NO_ECHO);
+    const int32x4_t lNoise = vdupq_n_s32(NOISE);
+
+    for (int32_t lStart = 0; lStart < theNumberOfDistances; lStart += theGroupSize)
+    {
+        const int32_t lEnd = (theNumberOfDistances - lStart > theGroupSize) ? lStart + theGroupSize :
+                theNumberOfDistances;
+        int64x2_t lSums = vdupq_n_s64(0);
+        uint32x4_t lCounts = vdupq_n_u32(0);
+        int32_t l = lStart;
+
+        for (; l + 4 <= lEnd; l += 4)
+        {
+            const int32x4_t lDistance = vld1q_s32(&theDistancePtr[l]);
+            const uint32x4_t lIsValid = vmvnq_u32(vorrq_u32(vceqq_s32(lDistance, lNoEcho),
+                    vceqq_s32(lDistance, lNoise)));
+            lSums = vpadalq_s32(lSums, vandq_s32(lDistance, vreinterpretq_s32_u32(lIsValid)));
+            lCounts = vsubq_u32(lCounts, lIsValid); // all bits set is -1
+        }
+
+        const uint64x2_t lCountPairs = vpaddlq_u32(lCounts);
+        int64_t lSum = vgetq_lane_s64(lSums, 0) + vgetq_lane_s64(lSums, 1);
+        int32_t lCount = static_cast<int32_t>(vgetq_lane_u64(lCountPairs, 0) + vgetq_lane_u64(lCountPairs, 1));
+        for (; l < lEnd; l++)
+        {
+            const int32_t lDistance = theDistancePtr[l];
+            if ((NO_ECHO != lDistance) && (NOISE != lDistance))
+            {
+                lSum += lDistance;
+                lCount++;
+            }
+        }
+        *theAveragePtr++ = (0 < lCount) ? static_cast<int32_t>(lSum / lCount) : theDistancePtr[lEnd - 1];
+        *theCountPtr++ = lCount;
+    }
+#else
+    averageScalar(theDistancePtr, theNumberOfDistances, theGroupSize, theAveragePtr, theCountPtr);
+#endif
+}
+
+/*
+ * Returns the engine currently used by average().
+ */
+PointAvg::PointAvgEngine_t
+PointAvg::getEngine()
+{
+    return sEngineID;
+}
+
+/*
+ * Returns a printable name of an engine.
+ */
+const char*
+PointAvg::getEngineName(PointAvgEngine_t theEngine)
+{
+    switch (theEngine)
+    {
+        case ENGINE_AUTO:
+            return "auto";
+        case ENGINE_SCALAR:
+            return "scalar";
+        case ENGINE_AVX2:
+            return "x86-avx2";
+        case ENGINE_NEON:
+            return "arm-neon";
+        default:
+            return "unknown";
+    }
+}
+
+/*
+ * Checks if an engine is compiled in and supported by the CPU.
+ */
+bool
+PointAvg::isEngineSupported(PointAvgEngine_t theEngine)
+{
+    switch (theEngine)
+    {
+        case ENGINE_AUTO:
+        case ENGINE_SCALAR:
+            return true;
+
+        case ENGINE_AVX2:
+#if POINTAVG_HAVE_X86
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#else
+            return false;
+#endif
+
+        case ENGINE_NEON:
+#if POINTAVG_HAVE_NEON
+            return true; // compiled for a CPU with NEON
+#else
+            return false;
+#endif
+
+        default:
+            return false;
+    }
+}
+
+/*
+ * Selects the engine used by average().
+ */
+ErrorID_t
+PointAvg::setEngine(PointAvgEngine_t theEngine)
+{
+    if (ENGINE_AUTO == theEngine)
+    {
+        if (isEngineSupported(ENGINE_AVX2))
+        {
+            theEngine = ENGINE_AVX2;
+        }
+        else if (isEngineSupported(ENGINE_NEON))
+        {
+            theEngine = ENGINE_NEON;
+        }
+        else
+        {
+            theEngine = ENGINE_SCALAR;
+        }
+    }
+
+    if (false == isEngineSupported(theEngine))
+    {
+        return ERR_UNSUPPORTED_FUNCTION;
+    }
+
+    switch (theEngine)
+    {
+        case ENGINE_AVX2:
+            sEngine = averageAVX2;
+            break;
+        case ENGINE_NEON:
+            sEngine = averageNEON;
+            break;
+        case ENGINE_SCALAR:
+        default:
+            sEngine = averageScalar;
+            break;
+    }
+    sEngineID = theEngine;
+    return ERR_SUCCESS;
+}
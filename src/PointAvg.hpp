@@ -0,0 +1,200 @@
+#ifndef POINTAVG_HPP_
+#define POINTAVG_HPP_
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       PointAvg.hpp - Averages groups of neighbouring distances.
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ ****************************************************************************
+ */
+
+extern "C"
+{
+#include "ErrorID.h"
+}
+#include "Global.hpp"
+
+/**
+ * Class PointAvg - point decimation: averages groups of neighbouring distances.
+ * <p>&nbsp;<p>
+ * The distances are split into groups of a given size; the last group
+ * may be smaller. The result of a group is the average of its valid
+ * distances. The values 0x80000000 (no echo) and 0x7FFFFFFF (noise) are
+ * not averaged; if a group has no valid distance, its result is the last
+ * of these values in the group. The sums are kept in 64 bit.
+ * <p>
+ *
+ * State Information:<br>
+ * The fastest engine supported by the CPU is selected at program start:
+ * AVX2 averages four groups at a time on x86 processors, NEON sums the
+ * groups four distances at a time on ARM processors, otherwise a scalar
+ * loop is used.
+ *
+ * @ingroup common
+ */
+class PointAvg
+{
+    public:
+
+        /** the distance of a point without echo */
+        static const int32_t NO_ECHO = static_cast<int32_t>(0x80000000);
+
+        /** the distance of a point with noise only */
+        static const int32_t NOISE = 0x7FFFFFFF;
+
+        /**
+         * Implementations of average().
+         * All engines produce identical results; they differ in speed only.
+         */
+        enum PointAvgEngine_t
+        {
+            /** select the fastest engine supported by the CPU */
+            ENGINE_AUTO, //
+
+            /** one distance at a time */
+            ENGINE_SCALAR, //
+
+            /** x86 AVX2, four groups per iteration */
+            ENGINE_AVX2, //
+
+            /** ARM NEON, four distances of a group per iteration */
+            ENGINE_NEON, //
+
+            /** number of engines */
+            NUMBER_OF_ENGINES
+        };
+
+    private:
+
+        /** signature of an engine */
+        typedef void
+        (*Engine_t)(const int32_t* theDistancePtr, int32_t theNumberOfDistances, int32_t theGroupSize,
+                int32_t* theAveragePtr, int32_t* theCountPtr);
+
+        /** the engine used by average() */
+        static Engine_t sEngine;
+
+        /** ID of the engine used by average() */
+        static PointAvgEngine_t sEngineID;
+
+        /** portable engine */
+        static void
+        averageScalar(const int32_t* theDistancePtr, int32_t theNumberOfDistances, int32_t theGroupSize,
+                int32_t* theAveragePtr, int32_t* theCountPtr);
+
+        /** x86 AVX2 engine */
+        static void
+        averageAVX2(const int32_t* theDistancePtr, int32_t theNumberOfDistances, int32_t theGroupSize,
+                int32_t* theAveragePtr, int32_t* theCountPtr);
+
+        /** ARM NEON engine */
+        static void
+        averageNEON(const int32_t* theDistancePtr, int32_t theNumberOfDistances, int32_t theGroupSize,
+                int32_t* theAveragePtr, int32_t* theCountPtr);
+
+        /* not to be instantiated */
+        PointAvg();
+
+    public:
+
+        /**
+         * Returns the number of groups of a given number of distances.
+         *
+         * @param theNumberOfDistances
+         *      number of distances.
+         * @param theGroupSize
+         *      number of distances per group; at least 1.
+         */
+        static inline int32_t
+        getNumberOfGroups(int32_t theNumberOfDistances, int32_t theGroupSize)
+        {
+            return (theNumberOfDistances + theGroupSize - 1) / theGroupSize;
+        }
+
+        /**
+         * Averages groups of neighbouring distances.
+         *
+         * @param theDistancePtr
+         *      the distances in host byte order.
+         * @param theNumberOfDistances
+         *      number of distances.
+         * @param theGroupSize
+         *      number of distances per group; values below 1 are taken as 1.
+         * @param theAveragePtr
+         *      returns the result of each group; getNumberOfGroups() integers.
+         * @param theCountPtr
+         *      returns the number of valid distances of each group;
+         *      getNumberOfGroups() integers.
+         * @return
+         *      the number of groups.
+         */
+        static inline int32_t
+        average(const int32_t* theDistancePtr, int32_t theNumberOfDistances, int32_t theGroupSize,
+                int32_t* theAveragePtr, int32_t* theCountPtr)
+        {
+            if (1 > theGroupSize)
+            {
+                theGroupSize = 1;
+            }
+            if (0 >= theNumberOfDistances)
+            {
+                return 0;
+            }
+            sEngine(theDistancePtr, theNumberOfDistances, theGroupSize, theAveragePtr, theCountPtr);
+            return getNumberOfGroups(theNumberOfDistances, theGroupSize);
+        }
+
+        /**
+         * Returns the engine used by average().
+         */
+        static PointAvgEngine_t
+        getEngine();
+
+        /**
+         * Returns the name of an engine for log files and benchmarks.
+         *
+         * @param theEngine
+         *      the engine.
+         */
+        static const char*
+        getEngineName(PointAvgEngine_t theEngine);
+
+        /**
+         * Checks if an engine is compiled in and supported by the CPU.
+         *
+         * @param theEngine
+         *      the engine.
+         * @return
+         *      true if the engine can be selected.
+         */
+        static bool
+        isEngineSupported(PointAvgEngine_t theEngine);
+
+        /**
+         * Selects the engine used by average().
+         * Call it before any thread is started; the selection is not thread safe.
+         *
+         * @param theEngine
+         *      the engine, or ENGINE_AUTO for the fastest one.
+         * @return
+         *      ERR_SUCCESS if OK,
+         *      ERR_UNSUPPORTED_FUNCTION if the engine is not available.
+         */
+        static ErrorID_t
+        setEngine(PointAvgEngine_t theEngine);
+};
+
+#endif /* POINTAVG_HPP_ */
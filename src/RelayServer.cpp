@@ -0,0 +1,539 @@
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       RelayServer.cpp
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         Linux gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ *
+ ****************************************************************************
+ */
+
+#if __linux__
+
+#include <cstring>
+#include <arpa/inet.h>
+#include "KbhitGetch.h"
+
+#include "RelayServer.hpp"
+#include "CRC32.hpp"
+#include "EventLoop.hpp"
+#include "IDataStream.hpp"
+#include "LinuxServerSocket.hpp"
+#include "MonotonicClock.hpp"
+
+/*
+ * Standard constructor.
+ */
+RelayServer::RelayServer(ServerSocket& theServerSocket, IDataStream& theSensorStream) :
+        mServerSocket(theServerSocket), //
+        mSensorStream(theSensorStream), //
+        mClients(new Client_t[MAX_CLIENTS]), //
+        mFirstPendingCommand(0), //
+        mNumberOfPendingCommands(0), //
+        mScanRequested(false), //
+        mScanRequestTime(0), //
+        mNumberOfScans(0), //
+        mNumberOfScansSent(0), //
+        mFramePool(NUMBER_OF_FRAMES), //
+        mTerminalLogFile(0)
+{
+    for (int32_t l = 0; l < MAX_CLIENTS; l++)
+    {
+        mClients[l].mIsUsed = false;
+        mClients[l].mWaitsForScan = false;
+    }
+}
+
+/*
+ * Standard destructor.
+ */
+RelayServer::~RelayServer()
+{
+    delete[] mClients;
+}
+
+/*
+ * Defines a text file to log the terminal output.
+ */
+void
+RelayServer::setTerminalLogFile(FILE* theTerminalLogFile)
+{
+    mTerminalLogFile = theTerminalLogFile;
+}
+
+/*
+ * Selects the filter of the GSC2 scan averaging of all clients.
+ */
+void
+RelayServer::setFilter(GSC2Session::GSC2Filter_t theFilter)
+{
+    for (int32_t l = 0; l < MAX_CLIENTS; l++)
+    {
+        mClients[l].mSession.setFilter(theFilter);
+    }
+}
+
+/*
+ * Logs a message on the console and in the terminal log file.
+ */
+void
+RelayServer::logMessage(const char* theMessage, const sockaddr_in* theAddress)
+{
+    string1024_t lTextLine;
+
+    if (0 != theAddress)
+    {
+        snprintf(lTextLine, sizeof(lTextLine), "RELAY: %s %s:%d\r\n", theMessage, inet_ntoa(theAddress->sin_addr),
+                ntohs(theAddress->sin_port));
+    }
+    else
+    {
+        snprintf(lTextLine, sizeof(lTextLine), "RELAY: %s\r\n", theMessage);
+    }
+
+    // write to file
+    if (0 != mTerminalLogFile)
+    {
+        fputs(lTextLine, mTerminalLogFile);
+    }
+
+    // write to console
+    printf("%s", lTextLine);
+}
+
+/*
+ * Returns the context of a client, and creates it for a new client.
+ */
+int32_t
+RelayServer::findClient(const sockaddr_in& theAddress, uint32_t theTime)
+{
+    int32_t lFree = ERR_BUFFER_OVERFLOW;
+
+    for (int32_t l = 0; l < MAX_CLIENTS; l++)
+    {
+        if (false == mClients[l].mIsUsed)
+        {
+            if (0 > lFree)
+            {
+                lFree = l;
+            }
+        }
+        else if ((mClients[l].mAddress.sin_addr.s_addr == theAddress.sin_addr.s_addr)
+                && (mClients[l].mAddress.sin_port == theAddress.sin_port))
+        {
+            return l;
+        }
+    }
+
+    // new client
+    if (0 <= lFree)
+    {
+        Client_t& lClient = mClients[lFree];
+        lClient.mIsUsed = true;
+        lClient.mAddress = theAddress;
+        lClient.mRequestTime = theTime;
+        lClient.mWaitsForScan = false;
+        lClient.mSession.reset();
+        logMessage("new client", &theAddress);
+    }
+    return lFree;
+}
+
+/*
+ * Removes inactive clients and unanswered commands.
+ */
+void
+RelayServer::checkTimeouts(uint32_t theTime)
+{
+    for (int32_t l = 0; l < MAX_CLIENTS; l++)
+    {
+        if (mClients[l].mIsUsed && ((theTime - mClients[l].mRequestTime) > CLIENT_TIMEOUT))
+        {
+            mClients[l].mIsUsed = false;
+            mClients[l].mWaitsForScan = false;
+            logMessage("client timed out", &mClients[l].mAddress);
+        }
+    }
+
+    // a lost response must not be returned to the next client
+    while ((0 < mNumberOfPendingCommands)
+            && ((theTime - mPendingCommands[mFirstPendingCommand].mRequestTime) > SENSOR_TIMEOUT))
+    {
+        mFirstPendingCommand = (mFirstPendingCommand + 1) % MAX_PENDING_COMMANDS;
+        mNumberOfPendingCommands--;
+    }
+
+    // lost scan: ask again
+    if (mScanRequested && ((theTime - mScanRequestTime) > SENSOR_TIMEOUT))
+    {
+        mScanRequested = false;
+        for (int32_t l = 0; l < MAX_CLIENTS; l++)
+        {
+            if (mClients[l].mIsUsed && mClients[l].mWaitsForScan)
+            {
+                requestScan(theTime);
+                break;
+            }
+        }
+    }
+}
+
+/*
+ * Sends a GSCN request for the latest scan to the sensor.
+ */
+void
+RelayServer::requestScan(uint32_t theTime)
+{
+    CRC32 lCRC;
+    uint32_t lRequest[GSC2Session::GSCN_REQUEST_SIZE / sizeof(uint32_t)];
+
+    if (mScanRequested)
+    {
+        return;
+    }
+
+    memcpy(&lRequest[0], "GSCN", 4);
+    lRequest[1] = htonl(4); // length
+    lRequest[2] = htonl(0); // latest scan
+    lRequest[3] = htonl(lCRC.get(lRequest, sizeof(lRequest) - 4));
+    if (0 < mSensorStream.write(lRequest, sizeof(lRequest)))
+    {
+        mScanRequested = true;
+        mScanRequestTime = theTime;
+    }
+}
+
+/*
+ * Receives the waiting requests with one system call and handles them.
+ */
+void
+RelayServer::handleClient(uint32_t theTime)
+{
+    FramePool::Frame_t* lFrames[MAX_CLIENTS];
+    Datagram_t lDatagrams[MAX_CLIENTS];
+    int32_t lNumberOfFrames = 0;
+
+    // a frame for each client which may have sent a request
+    while (MAX_CLIENTS > lNumberOfFrames)
+    {
+        FramePool::Frame_t* lFramePtr = mFramePool.acquire();
+        if (0 == lFramePtr)
+        {
+            break;
+        }
+        lFrames[lNumberOfFrames] = lFramePtr;
+        lDatagrams[lNumberOfFrames].mBuffer = lFramePtr->getBytes();
+        lDatagrams[lNumberOfFrames].mSize = FRAME_SIZE;
+        lNumberOfFrames++;
+    }
+
+    const int32_t lNumberOfRequests = mServerSocket.readFromBatch(lDatagrams, lNumberOfFrames);
+    for (int32_t l = 0; l < lNumberOfRequests; l++)
+    {
+        handleRequest(lFrames[l]->getBytes(), lDatagrams[l].mLength, lDatagrams[l].mAddress, theTime);
+    }
+    for (int32_t l = 0; l < lNumberOfFrames; l++)
+    {
+        mFramePool.release(lFrames[l]);
+    }
+}
+
+/*
+ * Handles a request of a client.
+ */
+void
+RelayServer::handleRequest(char* theRequestPtr, int32_t theLength, const sockaddr_in& theAddress,
+        uint32_t theTime)
+{
+    const int32_t lIndex = (4 > theLength) ? -1 : findClient(theAddress, theTime);
+    if (0 > lIndex)
+    {
+        if (4 <= theLength)
+        {
+            logMessage("too many clients, request dropped from", &theAddress);
+        }
+        return;
+    }
+    Client_t& lClient = mClients[lIndex];
+    lClient.mRequestTime = theTime;
+
+    // scan request: served by the shared GSCN request
+    if (!strncmp(theRequestPtr, "GSCN", 4) || !strncmp(theRequestPtr, "GSC2", 4))
+    {
+        if (ERR_SUCCESS != lClient.mSession.convertRequest(theRequestPtr, theLength, &theLength))
+        {
+            logMessage("invalid GSC2 request dropped from", &theAddress);
+            return;
+        }
+        lClient.mWaitsForScan = true;
+        requestScan(theTime);
+        return;
+    }
+
+    // other commands: forward, remember who waits for the response
+    if (MAX_PENDING_COMMANDS <= mNumberOfPendingCommands)
+    {
+        mFirstPendingCommand = (mFirstPendingCommand + 1) % MAX_PENDING_COMMANDS;
+        mNumberOfPendingCommands--;
+    }
+    PendingCommand_t& lCommand =
+            mPendingCommands[(mFirstPendingCommand + mNumberOfPendingCommands) % MAX_PENDING_COMMANDS];
+    lCommand.mClient = lIndex;
+    lCommand.mRequestTime = theTime;
+    mNumberOfPendingCommands++;
+    mSensorStream.write(theRequestPtr, theLength);
+}
+
+/*
+ * Sends a frame to several clients with one system call.
+ */
+void
+RelayServer::sendToClients(const char* theFramePtr, int32_t theLength, Datagram_t* theDatagrams,
+        int32_t theCount)
+{
+    for (int32_t l = 0; l < theCount; l++)
+    {
+        theDatagrams[l].mBuffer = const_cast<char*>(theFramePtr);
+        theDatagrams[l].mSize = theLength;
+        theDatagrams[l].mLength = theLength;
+    }
+    mServerSocket.writeToBatch(theDatagrams, theCount);
+}
+
+/*
+ * Sends the received scan to all waiting clients.
+ */
+void
+RelayServer::distributeScan(FramePool::Frame_t* theScanPtr, uint32_t theTime)
+{
+    bool lMoreScans = false;
+    int32_t lNumberOfSessions = 0;
+    Datagram_t lDatagrams[MAX_CLIENTS];
+    int32_t lNumberOfDatagrams = 0;
+
+    // plain GSCN: the response as is, before a session converts it
+    for (int32_t l = 0; l < MAX_CLIENTS; l++)
+    {
+        Client_t& lClient = mClients[l];
+        if ((false == lClient.mIsUsed) || (false == lClient.mWaitsForScan))
+        {
+            continue;
+        }
+        if (lClient.mSession.isActive())
+        {
+            lNumberOfSessions++;
+            continue;
+        }
+        lDatagrams[lNumberOfDatagrams++].mAddress = lClient.mAddress;
+        lClient.mWaitsForScan = false;
+        mNumberOfScansSent++;
+    }
+    sendToClients(theScanPtr->getBytes(), theScanPtr->mLength, lDatagrams, lNumberOfDatagrams);
+
+    // GSC2: a reference for each session, so only the last one converts in place
+    if (0 == lNumberOfSessions)
+    {
+        mFramePool.release(theScanPtr);
+    }
+    for (int32_t l = 1; l < lNumberOfSessions; l++)
+    {
+        mFramePool.addReference(theScanPtr);
+    }
+
+    // GSC2: collect in the session of the client, send when averaged
+    for (int32_t l = 0; (l < MAX_CLIENTS) && (0 < lNumberOfSessions); l++)
+    {
+        Client_t& lClient = mClients[l];
+        if ((false == lClient.mIsUsed) || (false == lClient.mWaitsForScan) || (false == lClient.mSession.isActive()))
+        {
+            continue;
+        }
+        lNumberOfSessions--;
+
+        FramePool::Frame_t* lFramePtr = theScanPtr;
+        if (ERR_SUCCESS != mFramePool.getWritable(lFramePtr))
+        {
+            mFramePool.release(lFramePtr);
+            lMoreScans = true; // no frame for the copy: the next scan
+            continue;
+        }
+        int32_t lLength = lFramePtr->mLength;
+        if (lClient.mSession.convertResponse(lFramePtr->getBytes(), lFramePtr->mLength, &lLength))
+        {
+            mServerSocket.writeTo(lFramePtr->getBytes(), lLength, lClient.mAddress);
+            lClient.mWaitsForScan = false;
+            mNumberOfScansSent++;
+        }
+        else
+        {
+            lMoreScans = true;
+        }
+        mFramePool.release(lFramePtr);
+    }
+
+    // GSC2 sessions which need more scans
+    if (lMoreScans)
+    {
+        requestScan(theTime);
+    }
+}
+
+/*
+ * Receives and handles a response of the sensor.
+ */
+void
+RelayServer::handleSensor(uint32_t theTime)
+{
+    FramePool::Frame_t* lFramePtr = mFramePool.acquire();
+
+    if (0 == lFramePtr)
+    {
+        return;
+    }
+    const char* lResponsePtr = lFramePtr->getBytes();
+    const int32_t lLength = mSensorStream.read(lFramePtr->getBytes(), FRAME_SIZE);
+
+    if (4 > lLength)
+    {
+        mFramePool.release(lFramePtr);
+        return;
+    }
+    lFramePtr->mLength = lLength;
+
+    // the response to the shared scan request
+    if (mScanRequested && !strncmp(lResponsePtr, "GSCN", 4))
+    {
+        mScanRequested = false;
+        mNumberOfScans++;
+        distributeScan(lFramePtr, theTime);
+        return;
+    }
+
+    // the response to a forwarded command
+    if (0 < mNumberOfPendingCommands)
+    {
+        const PendingCommand_t& lCommand = mPendingCommands[mFirstPendingCommand];
+        mFirstPendingCommand = (mFirstPendingCommand + 1) % MAX_PENDING_COMMANDS;
+        mNumberOfPendingCommands--;
+        if (mClients[lCommand.mClient].mIsUsed)
+        {
+            mServerSocket.writeTo(lResponsePtr, lLength, mClients[lCommand.mClient].mAddress);
+        }
+    }
+
+    // error response to the scan request: the waiting clients get it
+    else if (mScanRequested)
+    {
+        Datagram_t lDatagrams[MAX_CLIENTS];
+        int32_t lNumberOfDatagrams = 0;
+
+        mScanRequested = false;
+        for (int32_t l = 0; l < MAX_CLIENTS; l++)
+        {
+            if (mClients[l].mIsUsed && mClients[l].mWaitsForScan)
+            {
+                lDatagrams[lNumberOfDatagrams++].mAddress = mClients[l].mAddress;
+                mClients[l].mWaitsForScan = false;
+            }
+        }
+        sendToClients(lResponsePtr, lLength, lDatagrams, lNumberOfDatagrams);
+    }
+    mFramePool.release(lFramePtr);
+}
+
+/*
+ * Waits for requests and responses and handles them.
+ */
+void
+RelayServer::handleEvents(EventLoop& theEventLoop, int32_t theServer, int32_t theSensor)
+{
+    const ErrorID_t result = theEventLoop.wait(WAIT_TIME);
+    // the timeouts must not jump with the system time
+    const uint32_t lTime = MonotonicClock::getMilliseconds();
+
+    if (ERR_SUCCESS == result)
+    {
+        // the event loop leaves a hung up source out; the clients time out
+        if (theEventLoop.isHungUp(theSensor))
+        {
+            logMessage("sensor connection hung up", 0);
+        }
+        if (theEventLoop.isHungUp(theServer))
+        {
+            logMessage("server socket hung up", 0);
+        }
+        if (theEventLoop.isReadable(theSensor))
+        {
+            handleSensor(lTime);
+        }
+        if (theEventLoop.isReadable(theServer))
+        {
+            handleClient(lTime);
+        }
+    }
+    checkTimeouts(lTime);
+}
+
+/*
+ * Relays until the flag is cleared.
+ */
+ErrorID_t
+RelayServer::serve(const std::atomic<bool>& theIsRunning)
+{
+    EventLoop lEventLoop;
+    const int32_t lServer = lEventLoop.addStream(mServerSocket);
+    const int32_t lSensor = lEventLoop.addStream(mSensorStream);
+
+    while (theIsRunning.load())
+    {
+        handleEvents(lEventLoop, lServer, lSensor);
+    }
+    return ERR_SUCCESS;
+}
+
+/*
+ * Relays until the user presses ESC or 'q'.
+ */
+ErrorID_t
+RelayServer::run()
+{
+    EventLoop lEventLoop;
+    const int32_t lServer = lEventLoop.addStream(mServerSocket);
+    const int32_t lSensor = lEventLoop.addStream(mSensorStream);
+    const int32_t lKeyboard = lEventLoop.addKeyboard();
+    int c = 0;
+    string128_t lMessage;
+
+    logMessage("multi-client mode started", 0);
+
+    // terminal mode change on linux for kbhit.
+    changemode(1);
+
+    do
+    {
+        handleEvents(lEventLoop, lServer, lSensor);
+    } while ((false == lEventLoop.isReadable(lKeyboard)) || (kbhit() == 0)
+            || (((c = getch()) != 'q') && (c != 'Q') && (c != VK_ESC)));
+
+    // terminal mode restore on linux for kbhit.
+    changemode(0);
+
+    sprintf(lMessage, "%u scans received, %u scans sent, %u frames copied", mNumberOfScans, mNumberOfScansSent,
+            mFramePool.getNumberOfCopies());
+    logMessage(lMessage, 0);
+    return ERR_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,315 @@
+#ifndef RELAYSERVER_HPP_
+#define RELAYSERVER_HPP_
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       RelayServer.hpp - Relay between several clients and a sensor.
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         Linux gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ ****************************************************************************
+ */
+
+#if defined(__linux__)
+
+#include <atomic>
+#include <cstdio>
+#include <netinet/in.h>
+extern "C"
+{
+#include "ErrorID.h"
+}
+#include "FramePool.hpp"
+#include "Global.hpp"
+#include "GSC2Session.hpp"
+#include "LinuxDatagram.hpp"
+
+class EventLoop;
+class IDataStream;
+class ServerSocket;
+
+/**
+ * Class RelayServer - shares one sensor between several UDP clients.
+ * <p>&nbsp;<p>
+ * The relay looks like a sensor to its clients. Each client which sends
+ * a request gets a context of its own, with its own GSC2 session.
+ * <p>
+ * Scan requests (GSCN and GSC2) are not forwarded one by one: the relay
+ * keeps a single GSCN request for the latest scan outstanding while any
+ * client waits for a scan, and fans each response out to all waiting
+ * clients. Clients with a GSC2 session collect and average in their
+ * session, the others get the GSCN response as is. So the sensor load
+ * does not grow with the number of clients. The scan number of a GSCN
+ * request is not regarded; a client gets the next scan received.
+ * <p>
+ * Other commands are forwarded to the sensor. Their responses are
+ * returned to the clients in the order of the requests.
+ * <p>
+ * A client which has not sent a request for CLIENT_TIMEOUT ms is removed.
+ * <p>
+ * The frames are received into a FramePool up to the maximum frame size.
+ * A scan is shared by its receivers; a copy is made only for a GSC2
+ * session while another one still needs the scan unchanged.
+ * <p>
+ * The requests waiting at the socket are received with one system call,
+ * and a scan is sent to all plain GSCN clients with one system call.
+ */
+class RelayServer
+{
+    public:
+
+        /** class constants */
+        enum RelayServerConstants_t
+        {
+            /** maximum number of clients */
+            MAX_CLIENTS = 8,
+
+            /** ms without request after which a client is removed */
+            CLIENT_TIMEOUT = 10000,
+
+            /** ms to wait for a response of the sensor */
+            SENSOR_TIMEOUT = 1000,
+
+            /** maximum number of forwarded commands waiting for a response */
+            MAX_PENDING_COMMANDS = 16,
+
+            /** maximum size of a frame */
+            FRAME_SIZE = FramePool::MAX_FRAME_SIZE,
+
+            /** frames of the pool: a request of each client received at once,
+             *  or a scan, a copy for a GSC2 session and spares */
+            NUMBER_OF_FRAMES = MAX_CLIENTS + 4,
+
+            /** ms the event loop waits before the timeouts are checked */
+            WAIT_TIME = 100,
+
+            /**
+             * ESC key
+             */
+            VK_ESC = 27
+        };
+
+    private:
+
+        /**
+         * Context of a client.
+         */
+        struct Client_t
+        {
+                /** true if the context is used by a client */
+                bool mIsUsed;
+
+                /** the address of the client */
+                sockaddr_in mAddress;
+
+                /** ms when the client sent the last request */
+                uint32_t mRequestTime;
+
+                /** true if the client waits for a scan */
+                bool mWaitsForScan;
+
+                /** GSC2 emulation for the client */
+                GSC2Session mSession;
+        };
+
+        /**
+         * A forwarded command waiting for a response.
+         */
+        struct PendingCommand_t
+        {
+                /** index of the client */
+                int32_t mClient;
+
+                /** ms when the command was forwarded */
+                uint32_t mRequestTime;
+        };
+
+        /** the socket the clients send to */
+        ServerSocket& mServerSocket;
+
+        /** the connection to the sensor */
+        IDataStream& mSensorStream;
+
+        /** the client contexts; MAX_CLIENTS entries */
+        Client_t* mClients;
+
+        /** forwarded commands in the order of the requests */
+        PendingCommand_t mPendingCommands[MAX_PENDING_COMMANDS];
+
+        /** index of the oldest forwarded command */
+        int32_t mFirstPendingCommand;
+
+        /** number of forwarded commands */
+        int32_t mNumberOfPendingCommands;
+
+        /** true if a GSCN request is outstanding */
+        bool mScanRequested;
+
+        /** ms when the GSCN request was sent */
+        uint32_t mScanRequestTime;
+
+        /** number of scans received from the sensor */
+        uint32_t mNumberOfScans;
+
+        /** number of scans sent to clients */
+        uint32_t mNumberOfScansSent;
+
+        /** the frames received; all are released before a handler returns */
+        FramePool mFramePool;
+
+        /** the terminal log file */
+        FILE* mTerminalLogFile;
+
+        /**
+         * Returns the context of a client, and creates it for a new client.
+         *
+         * @return
+         *      the index of the client, or ERR_BUFFER_OVERFLOW if there
+         *      are too many clients.
+         */
+        int32_t
+        findClient(const sockaddr_in& theAddress, uint32_t theTime);
+
+        /**
+         * Removes clients which did not send a request for CLIENT_TIMEOUT ms,
+         * and forwarded commands which were not answered.
+         */
+        void
+        checkTimeouts(uint32_t theTime);
+
+        /**
+         * Receives and handles the waiting requests of the clients.
+         */
+        void
+        handleClient(uint32_t theTime);
+
+        /**
+         * Handles a request of a client.
+         *
+         * @param theRequestPtr
+         *      the request; a GSCN or GSC2 request is converted in place.
+         */
+        void
+        handleRequest(char* theRequestPtr, int32_t theLength, const sockaddr_in& theAddress, uint32_t theTime);
+
+        /**
+         * Sends a frame to several clients with one system call.
+         *
+         * @param theDatagrams
+         *      the datagrams; the addresses are set.
+         */
+        void
+        sendToClients(const char* theFramePtr, int32_t theLength, Datagram_t* theDatagrams, int32_t theCount);
+
+        /**
+         * Receives and handles a response of the sensor.
+         */
+        void
+        handleSensor(uint32_t theTime);
+
+        /**
+         * Sends a GSCN request for the latest scan to the sensor.
+         */
+        void
+        requestScan(uint32_t theTime);
+
+        /**
+         * Sends the received scan to all waiting clients.
+         *
+         * @param theScanPtr
+         *      the scan; the reference of the caller is taken over.
+         */
+        void
+        distributeScan(FramePool::Frame_t* theScanPtr, uint32_t theTime);
+
+        /**
+         * Waits WAIT_TIME ms at most for requests and responses and handles them.
+         */
+        void
+        handleEvents(EventLoop& theEventLoop, int32_t theServer, int32_t theSensor);
+
+        /**
+         * Logs a message on the console and in the terminal log file.
+         */
+        void
+        logMessage(const char* theMessage, const sockaddr_in* theAddress);
+
+        /* private assignment constructor to avoid misuse */
+        explicit
+        RelayServer(const RelayServer& src);
+
+        /* private assignment operator to avoid misuse */
+        RelayServer&
+        operator =(const RelayServer& src);
+
+    public:
+
+        /**
+         * Constructor.
+         *
+         * @param theServerSocket
+         *      the socket the clients send to; must be open.
+         * @param theSensorStream
+         *      the connection to the sensor; must be open.
+         */
+        RelayServer(ServerSocket& theServerSocket, IDataStream& theSensorStream);
+
+        /**
+         * Destructor.
+         */
+        virtual
+        ~RelayServer();
+
+        /**
+         * Relays until the user presses ESC or 'q'.
+         *
+         * @return
+         *      ERR_SUCCESS on success, otherwise a negative error code.
+         */
+        ErrorID_t
+        run();
+
+        /**
+         * Relays without console until the flag is cleared,
+         * e.g. on a thread of its own for the end-to-end benchmark.
+         *
+         * @param theIsRunning
+         *      cleared by another thread to stop; checked every WAIT_TIME ms.
+         * @return
+         *      ERR_SUCCESS on success, otherwise a negative error code.
+         */
+        ErrorID_t
+        serve(const std::atomic<bool>& theIsRunning);
+
+        /**
+         * Defines a text file to log the terminal output.
+         *
+         * @param theTerminalLogFile
+         *      the log file, or 0.
+         */
+        void
+        setTerminalLogFile(FILE* theTerminalLogFile);
+
+        /**
+         * Selects the filter of the GSC2 scan averaging of all clients.
+         *
+         * @param theFilter
+         *      the filter.
+         */
+        void
+        setFilter(GSC2Session::GSC2Filter_t theFilter);
+};
+
+#endif /* Linux */
+#endif /* RELAYSERVER_HPP_ */
@@ -0,0 +1,546 @@
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       ReplayStream.cpp
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ *
+ ****************************************************************************
+ */
+
+// recordings of some hours exceed 2 GB, also on 32 bit boards
+#define _FILE_OFFSET_BITS 64
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sys/time.h>
+
+#include "ReplayStream.hpp"
+#include "CRC32.hpp"
+#include "ScanRecorder.hpp"
+
+#if defined(__WIN32__) || (defined(__CYGWIN__) && !defined(_WIN32))
+	#include <winsock2.h>
+	#include <windows.h>
+	#define fseeko _fseeki64
+	#define ftello _ftelli64
+#elif defined(__linux__)
+	#include <arpa/inet.h>
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#else
+	#error "This program requires Linux or Win32."
+#endif
+
+/* size of the command ID, the length and the CRC of a response */
+#define REPLAY_FRAME_OVERHEAD 12
+
+/* byte offset of the scan number in a GSCN request */
+#define REPLAY_REQUEST_SCAN_NUMBER 8
+
+/* byte offset of the scan number in a GSCN response */
+#define REPLAY_RESPONSE_SCAN_NUMBER 12
+
+/*
+ * Standard constructor.
+ */
+ReplayStream::ReplayStream() :
+        mFileName(), //
+        mDataPtr(0), //
+        mSize(0), //
+        mScans(), //
+        mSessionStarts(), //
+        mNextScan(0), //
+        mRequests(), //
+        mFirstRequest(0), //
+        mNumberOfRequests(0), //
+        mIsPaced(false), //
+        mIsLooped(false), //
+        mIsTimeBaseSet(false), //
+        mReplayStartTime(0), //
+        mRecordStartTime(0)
+{
+    // nothing more to do.
+}
+
+/*
+ * Standard destructor.
+ */
+ReplayStream::~ReplayStream()
+{
+    close();
+}
+
+/*
+ * Returns the current system time in us.
+ */
+uint64_t
+ReplayStream::getMicroseconds()
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL); // get current time
+    return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+
+/*
+ * Reads an integer in network byte order; the records are aligned to integers.
+ */
+uint32_t
+ReplayStream::getInteger(uint64_t theOffset) const
+{
+    uint32_t lValue;
+
+    memcpy(&lValue, &mDataPtr[theOffset], sizeof(lValue));
+    return ntohl(lValue);
+}
+
+/*
+ * Returns the sensor scan number of a recorded response.
+ */
+int32_t
+ReplayStream::getScanNumber(int32_t theScan) const
+{
+    const ScanEntry_t& lScan = mScans[theScan];
+
+    if (REPLAY_RESPONSE_SCAN_NUMBER + static_cast<int32_t>(sizeof(uint32_t)) > lScan.mLength)
+    {
+        return 0;
+    }
+    return static_cast<int32_t>(getInteger(lScan.mOffset + REPLAY_RESPONSE_SCAN_NUMBER));
+}
+
+/*
+ * Walks the records of the recording; the index records are not needed
+ * since all scan records are visited anyway.
+ * A record cut off at the end of the file ends the recording.
+ * A scan number lower than the one before starts a new session.
+ */
+ErrorID_t
+ReplayStream::buildIndex()
+{
+    mScans.clear();
+    mSessionStarts.clear();
+
+    if ((ScanRecorder::FILE_HEADER_SIZE > mSize) || (ScanRecorder::FILE_MAGIC != getInteger(0))
+            || (ScanRecorder::FORMAT_VERSION != getInteger(4)))
+    {
+        return ERR_IO;
+    }
+
+    uint64_t lOffset = getInteger(8);
+    while (lOffset + ScanRecorder::RECORD_HEADER_SIZE <= mSize)
+    {
+        const uint32_t lTag = getInteger(lOffset);
+        const uint64_t lPayloadSize = getInteger(lOffset + 4);
+        const uint64_t lPayloadOffset = lOffset + ScanRecorder::RECORD_HEADER_SIZE;
+
+        if (lPayloadOffset + lPayloadSize > mSize)
+        {
+            break;
+        }
+
+        if ((ScanRecorder::TAG_SCAN == lTag) && (2 * sizeof(uint32_t) + REPLAY_FRAME_OVERHEAD <= lPayloadSize))
+        {
+            // the length field of the response tells the padding, if it is valid
+            const uint64_t lFrameOffset = lPayloadOffset + 2 * sizeof(uint32_t);
+            const uint64_t lPaddedLength = lPayloadSize - 2 * sizeof(uint32_t);
+            const uint64_t lLength = getInteger(lFrameOffset + 4) + static_cast<uint64_t>(REPLAY_FRAME_OVERHEAD);
+
+            ScanEntry_t lScan;
+            lScan.mOffset = lFrameOffset;
+            lScan.mTimestamp = (static_cast<uint64_t>(getInteger(lPayloadOffset)) << 32)
+                    | getInteger(lPayloadOffset + 4);
+            lScan.mLength = static_cast<int32_t>(
+                    ((lLength <= lPaddedLength) && (lLength + sizeof(uint32_t) > lPaddedLength)) ? lLength :
+                            lPaddedLength);
+            mScans.push_back(lScan);
+
+            const int32_t lLast = getNumberOfScans() - 1;
+            if ((0 == lLast) || (getScanNumber(lLast) < getScanNumber(lLast - 1)))
+            {
+                mSessionStarts.push_back(lLast);
+            }
+        }
+        lOffset = lPayloadOffset + lPayloadSize;
+    }
+    return ERR_SUCCESS;
+}
+
+/*
+ * Finds the next recorded response with a command ID.
+ */
+int32_t
+ReplayStream::findNextScan(const char* theCommandID)
+{
+    const int32_t lNumberOfScans = getNumberOfScans();
+
+    for (int32_t lPass = 0; lPass < 2; lPass++)
+    {
+        for (; mNextScan < lNumberOfScans; mNextScan++)
+        {
+            if (0 == memcmp(&mDataPtr[mScans[mNextScan].mOffset], theCommandID, COMMAND_ID_SIZE))
+            {
+                return mNextScan++;
+            }
+        }
+        if ((false == mIsLooped) || (0 == lPass && 0 == mNextScan))
+        {
+            break;
+        }
+        mNextScan = 0;
+        mIsTimeBaseSet = false;
+    }
+    return -1;
+}
+
+/*
+ * Waits until a response is due. The first response after open() or a
+ * seek is due at once and sets the time base.
+ */
+void
+ReplayStream::waitForTimestamp(const ScanEntry_t& theScan)
+{
+    const uint64_t lNow = getMicroseconds();
+
+    if ((false == mIsTimeBaseSet) || (theScan.mTimestamp < mRecordStartTime))
+    {
+        mReplayStartTime = lNow;
+        mRecordStartTime = theScan.mTimestamp;
+        mIsTimeBaseSet = true;
+        return;
+    }
+
+    const uint64_t lDue = mReplayStartTime + (theScan.mTimestamp - mRecordStartTime);
+    if (lDue > lNow)
+    {
+#if defined(__WIN32__) || (defined(__CYGWIN__) && !defined(_WIN32))
+        Sleep(static_cast<DWORD>((lDue - lNow) / 1000));
+#elif defined(__linux__)
+        usleep(static_cast<useconds_t>(lDue - lNow));
+#endif
+    }
+}
+
+/*
+ * Sets the recording to be replayed by the next open().
+ */
+void
+ReplayStream::setFileName(const char* theFileName)
+{
+    strncpy(mFileName, theFileName, sizeof(mFileName) - 1);
+    mFileName[sizeof(mFileName) - 1] = 0;
+}
+
+/*
+ * Selects the replay speed.
+ */
+void
+ReplayStream::setPaced(bool theIsPaced)
+{
+    mIsPaced = theIsPaced;
+    mIsTimeBaseSet = false;
+}
+
+/*
+ * Selects what happens at the end of the recording.
+ */
+void
+ReplayStream::setLooped(bool theIsLooped)
+{
+    mIsLooped = theIsLooped;
+}
+
+/*
+ * Continues the replay at a recorded response.
+ */
+ErrorID_t
+ReplayStream::seek(int32_t theScan)
+{
+    if ((0 > theScan) || (getNumberOfScans() <= theScan))
+    {
+        return ERR_INVALID_PARAMETER;
+    }
+    mNextScan = theScan;
+    mIsTimeBaseSet = false;
+    return ERR_SUCCESS;
+}
+
+/*
+ * Binary search on the scan numbers of the session of the next response.
+ */
+ErrorID_t
+ReplayStream::seekScanNumber(int32_t theScanNumber)
+{
+    const int32_t lNumberOfScans = getNumberOfScans();
+    const int32_t lCurrent = (mNextScan < lNumberOfScans) ? mNextScan : lNumberOfScans - 1;
+
+    // the session holding the next response; at the end, the last one
+    std::vector<int32_t>::const_iterator lSession =
+            std::upper_bound(mSessionStarts.begin(), mSessionStarts.end(), lCurrent);
+    if (mSessionStarts.begin() == lSession)
+    {
+        return ERR_INVALID_PARAMETER;
+    }
+    const int32_t lSessionEnd = (mSessionStarts.end() == lSession) ? lNumberOfScans : *lSession;
+    int32_t lLow = *(--lSession);
+    int32_t lHigh = lSessionEnd;
+
+    while (lLow < lHigh)
+    {
+        const int32_t lMiddle = lLow + (lHigh - lLow) / 2;
+        if (getScanNumber(lMiddle) < theScanNumber)
+        {
+            lLow = lMiddle + 1;
+        }
+        else
+        {
+            lHigh = lMiddle;
+        }
+    }
+
+    // all scans of the session are older: the next session is not searched
+    if (lSessionEnd <= lLow)
+    {
+        return ERR_INVALID_PARAMETER;
+    }
+    return seek(lLow);
+}
+
+/*
+ * Continues the replay with the next session.
+ */
+void
+ReplayStream::skipSession()
+{
+    std::vector<int32_t>::const_iterator lSession =
+            std::upper_bound(mSessionStarts.begin(), mSessionStarts.end(), mNextScan);
+
+    mNextScan = (mSessionStarts.end() == lSession) ? getNumberOfScans() : *lSession;
+    mIsTimeBaseSet = false;
+}
+
+/*
+ * Releases the mapping.
+ */
+ErrorID_t
+ReplayStream::close()
+{
+    if (0 != mDataPtr)
+    {
+#if defined(__WIN32__) || (defined(__CYGWIN__) && !defined(_WIN32))
+        delete[] mDataPtr;
+#elif defined(__linux__)
+        munmap(const_cast<char*>(mDataPtr), mSize);
+#endif
+        mDataPtr = 0;
+    }
+    mSize = 0;
+    mScans.clear();
+    mSessionStarts.clear();
+    mNextScan = 0;
+    mFirstRequest = 0;
+    mNumberOfRequests = 0;
+    mIsTimeBaseSet = false;
+    return ERR_SUCCESS;
+}
+
+/*
+ * Returns true if the recording is open.
+ */
+bool
+ReplayStream::isOpen()
+{
+    return (0 != mDataPtr);
+}
+
+/*
+ * Maps the recording into memory; Windows reads it into memory instead.
+ */
+ErrorID_t
+ReplayStream::open()
+{
+    close();
+
+#if defined(__WIN32__) || (defined(__CYGWIN__) && !defined(_WIN32))
+    FILE* lFile = fopen(mFileName, "rb");
+    if (0 == lFile)
+    {
+        return ERR_IO;
+    }
+    char* lDataPtr = 0;
+    if (0 == fseeko(lFile, 0, SEEK_END))
+    {
+        mSize = ftello(lFile);
+        lDataPtr = (0 < mSize) ? new char[mSize] : 0;
+    }
+    if ((0 != lDataPtr) && ((0 != fseeko(lFile, 0, SEEK_SET)) || (1 != fread(lDataPtr, mSize, 1, lFile))))
+    {
+        delete[] lDataPtr;
+        lDataPtr = 0;
+    }
+    fclose(lFile);
+    if (0 == lDataPtr)
+    {
+        mSize = 0;
+        return ERR_IO;
+    }
+    mDataPtr = lDataPtr;
+#elif defined(__linux__)
+    const int lHandle = ::open(mFileName, O_RDONLY);
+    if (0 > lHandle)
+    {
+        return ERR_IO;
+    }
+    struct stat lStat;
+    void* lDataPtr = MAP_FAILED;
+    if ((0 == fstat(lHandle, &lStat)) && (0 < lStat.st_size))
+    {
+        mSize = lStat.st_size;
+        lDataPtr = mmap(0, mSize, PROT_READ, MAP_PRIVATE, lHandle, 0);
+    }
+    ::close(lHandle); // the mapping keeps the file
+    if (MAP_FAILED == lDataPtr)
+    {
+        mSize = 0;
+        return ERR_IO;
+    }
+    madvise(lDataPtr, mSize, MADV_SEQUENTIAL);
+    mDataPtr = static_cast<const char*>(lDataPtr);
+#endif
+
+    const ErrorID_t result = buildIndex();
+    if (ERR_SUCCESS != result)
+    {
+        close();
+    }
+    return result;
+}
+
+/*
+ * Builds an ERR response: command ID, length, error code and CRC.
+ */
+int32_t
+ReplayStream::buildError(char* theFramePtr, ErrorID_t theError)
+{
+    CRC32 lCRC;
+    uint32_t lFrame[4];
+
+    memcpy(&lFrame[0], "ERR\0", COMMAND_ID_SIZE);
+    lFrame[1] = htonl(sizeof(int32_t));
+    lFrame[2] = htonl(theError);
+    lFrame[3] = htonl(lCRC.get(lFrame, sizeof(lFrame) - 4));
+    memcpy(theFramePtr, lFrame, sizeof(lFrame));
+    return sizeof(lFrame);
+}
+
+/*
+ * Copies the response of the oldest request into the buffer.
+ */
+int32_t
+ReplayStream::read(void* buffer, int32_t size)
+{
+    if (0 == mDataPtr)
+    {
+        return -1;
+    }
+    if (0 == mNumberOfRequests)
+    {
+        return ((false == mIsLooped) && (mNextScan >= getNumberOfScans())) ? ERR_END_OF_STREAM : -1;
+    }
+
+    const Request_t& lRequest = mRequests[mFirstRequest];
+    mFirstRequest = (mFirstRequest + 1) % MAX_PENDING_REQUESTS;
+    mNumberOfRequests--;
+
+    if (0 > lRequest.mScan)
+    {
+        const int32_t lLength = (lRequest.mEchoLength < size) ? lRequest.mEchoLength : size;
+        memcpy(buffer, lRequest.mEcho, lLength);
+        return lLength;
+    }
+
+    const ScanEntry_t& lScan = mScans[lRequest.mScan];
+    if (mIsPaced)
+    {
+        waitForTimestamp(lScan);
+    }
+    const int32_t lLength = (lScan.mLength < size) ? lScan.mLength : size;
+    memcpy(buffer, &mDataPtr[lScan.mOffset], lLength);
+    return lLength;
+}
+
+/*
+ * Assigns the next recorded response to a scan request,
+ * other requests are answered by themselves.
+ */
+int32_t
+ReplayStream::write(void* buffer, int32_t size)
+{
+    if ((0 == mDataPtr) || (0 == buffer) || (COMMAND_ID_SIZE > size))
+    {
+        return -1;
+    }
+    if (MAX_PENDING_REQUESTS <= mNumberOfRequests)
+    {
+        return ERR_BUFFER_OVERFLOW;
+    }
+
+    const char* lCommandID = static_cast<const char*>(buffer);
+    Request_t& lRequest = mRequests[(mFirstRequest + mNumberOfRequests) % MAX_PENDING_REQUESTS];
+
+    if ((0 == memcmp(lCommandID, "GSCN", COMMAND_ID_SIZE)) || (0 == memcmp(lCommandID, "GSC2", COMMAND_ID_SIZE)))
+    {
+        // GSCN n with n > 0 asks for a scan number; the sensor answers with this or a newer scan
+        if ((0 == memcmp(lCommandID, "GSCN", COMMAND_ID_SIZE))
+                && (REPLAY_REQUEST_SCAN_NUMBER + static_cast<int32_t>(sizeof(uint32_t)) <= size))
+        {
+            uint32_t lScanNumber;
+            memcpy(&lScanNumber, &lCommandID[REPLAY_REQUEST_SCAN_NUMBER], sizeof(lScanNumber));
+            lScanNumber = ntohl(lScanNumber);
+            if ((0 < static_cast<int32_t>(lScanNumber)) && ((mNextScan >= getNumberOfScans())
+                    || (getScanNumber(mNextScan) != static_cast<int32_t>(lScanNumber)))
+                    && (ERR_SUCCESS != seekScanNumber(static_cast<int32_t>(lScanNumber))))
+            {
+                // the session ended before this scan; the next one is the first of the next session
+                skipSession();
+            }
+        }
+        // the sensor answers GSC2 with a GSCN response, too
+        lRequest.mScan = findNextScan("GSCN");
+        if (0 > lRequest.mScan)
+        {
+            return ERR_END_OF_STREAM;
+        }
+    }
+    else if ((0 == memcmp(lCommandID, "GVER", COMMAND_ID_SIZE)) || (0 == memcmp(lCommandID, "GPRM", COMMAND_ID_SIZE)))
+    {
+        // the recording holds no firmware version or parameters
+        lRequest.mScan = -1;
+        lRequest.mEchoLength = buildError(lRequest.mEcho, ERR_UNSUPPORTED_FUNCTION);
+    }
+    else
+    {
+        // acknowledge the request; it holds a valid CRC already
+        lRequest.mScan = -1;
+        lRequest.mEchoLength = (MAX_ECHO_SIZE < size) ? static_cast<int32_t>(MAX_ECHO_SIZE) : size;
+        memcpy(lRequest.mEcho, buffer, lRequest.mEchoLength);
+    }
+    mNumberOfRequests++;
+    return size;
+}
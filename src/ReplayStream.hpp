@@ -0,0 +1,333 @@
+#ifndef REPLAYSTREAM_HPP_
+#define REPLAYSTREAM_HPP_
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       ReplayStream.hpp - Replays a recording as a sensor.
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ ****************************************************************************
+ */
+
+#include <vector>
+#include "Global.hpp"
+#include "IDataStream.hpp"
+
+/**
+ * Class ReplayStream - a data stream which answers commands from a recording.
+ * <p>&nbsp;<p>
+ * The recording (see ScanRecorder) is mapped into memory, so a response
+ * is copied once from the page cache into the receiver buffer of the
+ * command, without reading the file piece by piece. The responses are
+ * not handed out in place because the commands convert them in place.
+ * <p>
+ * open() builds an index of the recorded scans. Each GSCN or GSC2 request
+ * written is answered by the next recorded GSCN response, which is the
+ * response to both requests; a GSCN request for a scan number other than 0 seeks the recorded
+ * scan with this number first, within the session being replayed; if the
+ * session has no such scan, the replay goes on with the next session. GVER and
+ * GPRM are answered by an ERR response with ERR_UNSUPPORTED_FUNCTION, since
+ * the recording holds no answer to them. Other requests, e.g. SCAN, are echoed as
+ * acknowledgement. Several requests may be written before the responses
+ * are read, like the pipelined scan loops do.
+ * <p>
+ * The responses are returned as fast as possible, or paced by the
+ * recorded timestamps to replay a session in real time. At the end of
+ * the recording write() and read() return ERR_END_OF_STREAM, so the scan
+ * loops stop, or the replay starts over if the stream loops.
+ * <p>
+ * A recording may hold several sessions, since the ScanRecorder appends
+ * to an existing file. The scan numbers increase within a session; a
+ * scan number lower than the one before starts the next session.
+ */
+class ReplayStream : public IDataStream
+{
+    public:
+
+        /** class constants */
+        enum ReplayStreamConstants_t
+        {
+            /** number of requests which may wait for their response */
+            MAX_PENDING_REQUESTS = 16,
+
+            /** size of the command ID in bytes */
+            COMMAND_ID_SIZE = 4,
+
+            /** size of an echoed request in bytes */
+            MAX_ECHO_SIZE = 64
+        };
+
+    private:
+
+        /**
+         * A recorded response.
+         */
+        struct ScanEntry_t
+        {
+                /** file offset of the response */
+                uint64_t mOffset;
+
+                /** timestamp of the response in us */
+                uint64_t mTimestamp;
+
+                /** number of bytes of the response */
+                int32_t mLength;
+        };
+
+        /**
+         * A request waiting for its response.
+         */
+        struct Request_t
+        {
+                /** index of the recorded response, or -1 to return mEcho */
+                int32_t mScan;
+
+                /** number of bytes in mEcho */
+                int32_t mEchoLength;
+
+                /** the request to be echoed, or an ERR response */
+                char mEcho[MAX_ECHO_SIZE];
+        };
+
+        /** name of the recording */
+        string128_t mFileName;
+
+        /** the mapped recording, or 0 if closed */
+        const char* mDataPtr;
+
+        /** size of the recording in bytes */
+        uint64_t mSize;
+
+        /** the recorded responses */
+        std::vector<ScanEntry_t> mScans;
+
+        /** index of the first response of each session, in ascending order */
+        std::vector<int32_t> mSessionStarts;
+
+        /** index of the next response to be replayed */
+        int32_t mNextScan;
+
+        /** the requests waiting for their response */
+        Request_t mRequests[MAX_PENDING_REQUESTS];
+
+        /** index of the oldest waiting request */
+        int32_t mFirstRequest;
+
+        /** number of waiting requests */
+        int32_t mNumberOfRequests;
+
+        /** true to return the responses at the recorded times */
+        bool mIsPaced;
+
+        /** true to start over at the end of the recording */
+        bool mIsLooped;
+
+        /** true after the first paced response; cleared by seeks */
+        bool mIsTimeBaseSet;
+
+        /** computer time in us of the first paced response */
+        uint64_t mReplayStartTime;
+
+        /** recorded time in us of the first paced response */
+        uint64_t mRecordStartTime;
+
+        /**
+         * Returns the current system time in us.
+         */
+        static uint64_t
+        getMicroseconds();
+
+        /**
+         * Reads an integer in network byte order from the recording.
+         */
+        uint32_t
+        getInteger(uint64_t theOffset) const;
+
+        /**
+         * Returns the sensor scan number of a recorded response, or 0 if it has none.
+         */
+        int32_t
+        getScanNumber(int32_t theScan) const;
+
+        /**
+         * Builds the index of the recorded responses.
+         *
+         * @return
+         *      ERR_SUCCESS if OK, ERR_IO if the file is not a recording.
+         */
+        ErrorID_t
+        buildIndex();
+
+        /**
+         * Finds the next recorded response with a command ID, and starts
+         * over at the end if the stream loops.
+         *
+         * @return
+         *      the index of the response, or -1 if there is none.
+         */
+        int32_t
+        findNextScan(const char* theCommandID);
+
+        /**
+         * Waits until a response is due.
+         */
+        void
+        waitForTimestamp(const ScanEntry_t& theScan);
+
+        /**
+         * Continues the replay with the first response of the next session,
+         * or at the end of the recording after the last session.
+         */
+        void
+        skipSession();
+
+        /**
+         * Builds an ERR response like the sensor sends it.
+         *
+         * @return
+         *      the number of bytes of the response.
+         */
+        static int32_t
+        buildError(char* theFramePtr, ErrorID_t theError);
+
+        /* private assignment constructor to avoid misuse */
+        explicit
+        ReplayStream(const ReplayStream& src);
+
+        /* private assignment operator to avoid misuse */
+        ReplayStream&
+        operator =(const ReplayStream& src);
+
+    public:
+
+        /**
+         * Constructor. Creates a closed replay stream.
+         */
+        ReplayStream();
+
+        /**
+         * Destructor. Closes the stream.
+         */
+        virtual
+        ~ReplayStream();
+
+        /**
+         * Sets the recording to be replayed by the next open().
+         *
+         * @param theFileName
+         *      the recording.
+         */
+        void
+        setFileName(const char* theFileName);
+
+        /**
+         * Selects the replay speed.
+         *
+         * @param theIsPaced
+         *      true to return the responses at the recorded times,
+         *      false to return them as fast as possible.
+         */
+        void
+        setPaced(bool theIsPaced);
+
+        /**
+         * Selects what happens at the end of the recording.
+         *
+         * @param theIsLooped
+         *      true to start over, false to report the end of the stream.
+         */
+        void
+        setLooped(bool theIsLooped);
+
+        /**
+         * Returns the number of recorded responses; 0 before open().
+         */
+        int32_t
+        getNumberOfScans() const
+        {
+            return static_cast<int32_t>(mScans.size());
+        }
+
+        /**
+         * Continues the replay at a recorded response.
+         *
+         * @param theScan
+         *      index of the response, 0 for the first one.
+         * @return
+         *      ERR_SUCCESS if OK, ERR_INVALID_PARAMETER if there is no such response.
+         */
+        ErrorID_t
+        seek(int32_t theScan);
+
+        /**
+         * Continues the replay at the first recorded response with at least
+         * the given sensor scan number. Only the session of the next
+         * response is searched, so the replay never jumps into a session
+         * recorded before or after it.
+         *
+         * @param theScanNumber
+         *      the scan number.
+         * @return
+         *      ERR_SUCCESS if OK, ERR_INVALID_PARAMETER if all scans of the
+         *      session have lower numbers; the replay continues as before.
+         */
+        ErrorID_t
+        seekScanNumber(int32_t theScanNumber);
+
+        /**
+         * Closes the recording.
+         */
+        virtual ErrorID_t
+        close();
+
+        /**
+         * Returns true if the recording is open.
+         */
+        virtual bool
+        isOpen();
+
+        /**
+         * Maps the recording into memory and builds its index.
+         *
+         * @return
+         *      ERR_SUCCESS if OK, ERR_IO if the file cannot be opened or is
+         *      not a recording.
+         */
+        virtual ErrorID_t
+        open();
+
+        /**
+         * Returns the response of the oldest request.
+         *
+         * @return
+         *      the number of bytes, -1 if there is no response, or
+         *      ERR_END_OF_STREAM at the end of a recording which does not loop.
+         */
+        virtual int32_t
+        read(void* buffer, int32_t size);
+
+        /**
+         * Takes a request.
+         *
+         * @return
+         *      the number of bytes, ERR_BUFFER_OVERFLOW if too many
+         *      requests wait for their response, or ERR_END_OF_STREAM if
+         *      a scan is requested at the end of a recording which does not loop.
+         */
+        virtual int32_t
+        write(void* buffer, int32_t size);
+};
+
+#endif /* REPLAYSTREAM_HPP_ */
@@ -18,23 +18,16 @@
  * expressed or implied by its publication or distribution.
  ****************************************************************************
  */
+#include <algorithm>
 #include <ctime>
 #include <cstdio>
-#include <sys/time.h>
+#include <cstring>
 #include "KbhitGetch.h"
 
 #include "IDataStream.hpp"
 #include "Scan2Print.hpp"
-
-#if defined(__WIN32__) || (defined(__CYGWIN__) && !defined(_WIN32))
-	#include <windows.h>
-	#define sleep_msecs(s) Sleep(s)
-#elif defined(__linux__)
-	#include <unistd.h>
-	#define sleep_msecs(s) usleep(s*1000)
-#else
-	#error "This program requires Linux or Win32."
-#endif
+#include "MonotonicClock.hpp"
+#include "ScanAcquisition.hpp"
 
 /*
  * Standard constructor.
@@ -45,12 +38,14 @@ Scan2Print::Scan2Print(IDataStream& theDataStream) :
         mGSC2Command(theDataStream), //
         mNumberOfScans(0), //
         mScan(), //
+        mScanView(), //
         mSCANCommand(theDataStream), //
         mScannerTimeCode(0), //
         mScanNumber(0), //
         mScanPeriod(0), //
         mStartTime(0), //
-        mTerminalLogFile(0)
+        mLog(), //
+        mTiming()
 {
     // check the connection
     if (false == theDataStream.isOpen())
@@ -68,16 +63,12 @@ Scan2Print::~Scan2Print()
 }
 
 /*
- * Returns the current system time in ms.
+ * Returns the time of the monotonic clock in ms.
  */
 unsigned int
 Scan2Print::getMilliseconds()
 {
-    struct timeval tv;
-
-    gettimeofday(&tv, NULL); // get current time
-    const unsigned int milliseconds = tv.tv_sec * 1000LL + tv.tv_usec / 1000; // turn to milliseconds
-    return milliseconds;
+    return MonotonicClock::getMilliseconds();
 }
 
 /*
@@ -102,15 +93,28 @@ Scan2Print::isTerminated()
 	int key;
 
     // not started or expired
-    bool lExpired = ((0 != mScanPeriod) && ((mStartTime + mScanPeriod) < getMilliseconds()));
+    bool lExpired = ((0 != mScanPeriod) && ((getMilliseconds() - mStartTime) > mScanPeriod));
     if ((0 == mStartTime) || lExpired)
     {
         mStartTime = 0; // set to "not started"
         return true;
     }
 
+    if (0 == kbhit())
+    {
+        return false;
+    }
+
+    // show the latency histograms so far on 'h' or 'H'
+    key = getch();
+    if ((key == 'h') || (key == 'H'))
+    {
+        mTiming.log(mLog);
+        return false;
+    }
+
     // check for ESC or 'q' or 'Q'
-    return ((0 != kbhit()) && (((key = getch()) == VK_ESC) || (key == 'q') || (key == 'Q')));
+    return ((key == VK_ESC) || (key == 'q') || (key == 'Q'));
 }
 
 /*
@@ -125,14 +129,8 @@ Scan2Print::logTableHeader()
     sprintf(lTextLine, "\r\n%14s %8s %8s %4s %4s %8s \r\n", //
             "Time", "Scan", "PS Time", "d-S", "d-C", "Lost-S");
 
-    // write to file
-    if (0 != mTerminalLogFile)
-    {
-        fputs(lTextLine, mTerminalLogFile);
-    }
-
-    // write to console
-    puts(lTextLine);
+    // write to the console and the file
+    mLog.write(lTextLine);
     return ERR_SUCCESS;
 }
 
@@ -152,14 +150,8 @@ Scan2Print::logMessage(const char* const theMessage)
         sprintf(lTextLine, "%2d/%02d_%2d:%02d:%02d %s\r\n", lLocalTime.tm_mday, lLocalTime.tm_mon + 1,
                 lLocalTime.tm_hour, lLocalTime.tm_min, lLocalTime.tm_sec, theMessage);
 
-        // write to file
-        if (0 != mTerminalLogFile)
-        {
-            fputs(lTextLine, mTerminalLogFile);
-        }
-
-        // write to console
-        puts(lTextLine);
+        // write to the console and the file
+        mLog.write(lTextLine);
     }
     return ERR_SUCCESS;
 }
@@ -194,10 +186,10 @@ Scan2Print::logScan()
     struct tm lLocalTime = getTime();
 
     // valid scan?
-    if (0 != mScan.mNumberOfParameter)
+    if (0 != mScan.getNumberOfParameter())
     {
-        mScannerTimeCode = mScan.mParameter[GSC2Command::PARAMETER_TIME_STAMP];
-        mScanNumber = mScan.mParameter[GSC2Command::PARAMETER_SCAN_NUMBER];
+        mScannerTimeCode = mScan.getParameter(GSC2Command::PARAMETER_TIME_STAMP);
+        mScanNumber = mScan.getParameter(GSC2Command::PARAMETER_SCAN_NUMBER);
         const int32_t lLostScans = mScanNumber - lLastScanNumber - 1;
 
         // this is the 1st scan.
@@ -211,27 +203,28 @@ Scan2Print::logScan()
         || (0 == (mScanNumber % lLogInterval)) // or regular interval has expired
                 || (0 == lLastScanNumber)) // or 1st scan
         {
-            for (int32_t lPoints = 0; lPoints < mScan.mNumberOfPoints; lPoints++)
+            for (int32_t lPoints = 0; lPoints < mScan.getNumberOfPoints(); lPoints++)
             {
                 // loop for each point through all echos
-                for (int32_t lEchoes = 0; lEchoes < mScan.mNumberOfEchoes; lEchoes++)
+                for (int32_t lEchoes = 0; lEchoes < mScan.getNumberOfEchoes(); lEchoes++)
                 {
-                	int32_t lDistance = mScan.mScanData[lPoints][lEchoes].mDistance;
-                	//int32_t lPulseWidth = mScan.mScanData[lPoints][lEchoes].mPulseWidth;
+                	int32_t lDistance = mScan.getDistances(lEchoes)[lPoints];
+                	//int32_t lPulseWidth = mScan.getPulseWidths(lEchoes)[lPoints];
 
             		if (((uint32_t)lDistance == 0x80000000) || ((uint32_t)lDistance == 0x7FFFFFFF))
                 	{
-               			printf("%4d:%-8s\r\n", lPoints, (uint32_t)lDistance == 0x80000000 ? "Low" : "Noise");
+               			mLog.print(AsyncLog::LOG_CONSOLE, "%4d:%-8s\r\n", lPoints, (uint32_t)lDistance == 0x80000000 ? "Low" : "Noise");
                 	}
                 	else
                 	{
 						//printf("%4d:%8d\r\n", lPoints, lDistanceSum / lSumCnt);
-						printf("%4d:", lPoints);
-						for (int32_t lSpaceCnt = 0; lSpaceCnt < (lDistance - 15000) / 500; lSpaceCnt ++)
-						{
-							printf("-");
-						}
-						printf("|\r\n");
+						// the bar is built in memory and written as one line
+						string1024_t lBar;
+						const int32_t lBarLength = std::min(std::max((lDistance - 15000) / 500, 0),
+								static_cast<int32_t>(sizeof(lBar)) - 1);
+						memset(lBar, '-', lBarLength);
+						lBar[lBarLength] = 0;
+						mLog.print(AsyncLog::LOG_CONSOLE, "%4d:%s|\r\n", lPoints, lBar);
                 	}
                 } // end echos
             } // end points
@@ -246,11 +239,7 @@ Scan2Print::logScan()
     // log on screen and to file
     if (0 != lTextLine[0])
     {
-        printf(lTextLine);
-        if (0 != mTerminalLogFile)
-        {
-            fputs(lTextLine, mTerminalLogFile);
-        }
+        mLog.write(lTextLine);
     }
     return ERR_SUCCESS;
 }
@@ -262,15 +251,15 @@ ErrorID_t
 Scan2Print::processScan()
 {
     // not an empty scan?
-    if (0 != mScan.mNumberOfParameter)
+    if (0 != mScan.getNumberOfParameter())
     {
-        // example code: show some profile infos.
-        printf(
+        // example code: show some profile infos; the console may skip them.
+        mLog.print(AsyncLog::LOG_CONSOLE | AsyncLog::LOG_OPTIONAL,
                 "Scan %d; time %d; Incremental %d; ScanLine %d \\ / \r\n", //
-                mScan.mParameter[GSC2Command::PARAMETER_SCAN_NUMBER],
-                mScan.mParameter[GSC2Command::PARAMETER_TIME_STAMP],
-                mScan.mParameter[GSC2Command::PARAMETER_INCREMENTAL_ENCODER],
-                mScan.mParameter[GSC2Command::PARAMETER_SCAN_LINE]);
+                mScan.getParameter(GSC2Command::PARAMETER_SCAN_NUMBER),
+                mScan.getParameter(GSC2Command::PARAMETER_TIME_STAMP),
+                mScan.getParameter(GSC2Command::PARAMETER_INCREMENTAL_ENCODER),
+                mScan.getParameter(GSC2Command::PARAMETER_SCAN_LINE));
     } // end valid scan
 
     return ERR_SUCCESS;
@@ -284,10 +273,21 @@ Scan2Print::run(char* theDataLogFileName)
 {
     ErrorID_t result = ERR_SUCCESS;
 
+    // receives the scans on the acquisition thread
+    ScanAcquisition lScanAcquisition([&](ScanView& theScanView, ScanTiming::Stamps_t& theStamps) -> ErrorID_t
+    {
+        const ErrorID_t lResult = mGSC2Command.performCommand(mScanAvgNumber, mPointAvgNumber, theScanView,
+                theDataLogFileName);
+        theStamps.mTime[ScanTiming::STAGE_FIRST_BYTE] = mGSC2Command.getFirstByteTime();
+        theStamps.mTime[ScanTiming::STAGE_LAST_BYTE] = mGSC2Command.getLastByteTime();
+        return lResult;
+    });
+
     // reset
     mScanNumber = 0;
     mScannerTimeCode = 0;
     mNumberOfScans = 0;
+    mTiming.reset();
 
     // ask scan average value
     fprintf(stdout, "> Scan Average count : ");
@@ -320,36 +320,99 @@ Scan2Print::run(char* theDataLogFileName)
         // terminal mode change on linux for kbhit of isTerminated().
         changemode(1);
 
+        // write the terminal output on a thread of its own
+        mLog.start();
+
+        // request and receive on the acquisition thread, a scan each SHOW_INTERVAL
+        lScanAcquisition.setRequestInterval(SHOW_INTERVAL);
+        lScanAcquisition.start();
+
         // loop until the scans terminate.
         while (false == isTerminated())
         {
-            // request a scan, measure how long this takes on this machine.
+            // take the next scan, the acquisition measured how long it took on this machine.
+            const ScanAcquisition::Slot_t* const lSlotPtr = lScanAcquisition.getScan(SCAN_WAIT_TIME);
+            if (0 == lSlotPtr)
+            {
+                continue;
+            }
+
             mNumberOfScans++;
-            mComputerSendTimeCode = getMilliseconds();
-            result = mGSC2Command.performCommand(mScanAvgNumber, mPointAvgNumber, mScan, theDataLogFileName);
-            mComputerReceiveTimeCode = getMilliseconds();
+            mComputerSendTimeCode = lSlotPtr->mSendTime;
+            mComputerReceiveTimeCode = lSlotPtr->mReceiveTime;
+            ScanTiming::Stamps_t lStamps = lSlotPtr->mStamps;
+            result = lSlotPtr->mResult;
+            if (ERR_SUCCESS == result)
+            {
+                result = mScanView.attach(lSlotPtr->mFrame, lSlotPtr->mFrameLength);
+            }
+            if (ERR_SUCCESS == result)
+            {
+                result = mScan.assign(mScanView);
+            }
+
+            // hand the slot back to the acquisition, the scan data are copied
+            mScanView.clear();
+            lScanAcquisition.releaseScan();
 
-            // process the scan data and show result
+            // process the scan data and show result; slow output does not delay the acquisition
             if (ERR_SUCCESS == result)
             {
-            	// WARNING "printf()" routine extensively used in this calls causes lost scans
                 result = processScan();
                 logScan();
+
+                // count where the time of the scan went
+                lStamps.mTime[ScanTiming::STAGE_PROCESSED] = MonotonicClock::getNanoseconds();
+                mTiming.record(lStamps);
             }
 
             // or process the error code
-            if (ERR_SUCCESS != result)
+            if (ERR_END_OF_STREAM == result)
+            {
+                logMessage("End of the data stream");
+            }
+            else if (ERR_SUCCESS != result)
             {
                 logError(result);
             }
 
-            // sleep 1000msec
-            sleep_msecs(1000);
+            // hand the output of the scan to the writer
+            mLog.flush();
+
+            // a replayed recording has ended: nothing more to receive
+            if (ERR_END_OF_STREAM == result)
+            {
+                break;
+            }
         } // end while not terminated
 
+        // the connection and the console are ours again
+        lScanAcquisition.stop();
+        mLog.stop();
+
         // terminal mode restore on linux for kbhit of isTerminated().
         changemode(0);
 
+        // scans dropped because processing was too slow
+        if (0 != lScanAcquisition.getOverruns())
+        {
+            string128_t lMessage;
+            sprintf(lMessage, "%u scans dropped, processing too slow",
+                    static_cast<unsigned int>(lScanAcquisition.getOverruns()));
+            logMessage(lMessage);
+        }
+
+        // console lines dropped because the console was too slow
+        if (0 != mLog.getDroppedLines())
+        {
+            string128_t lMessage;
+            sprintf(lMessage, "%u console lines dropped, output too slow", mLog.getDroppedLines());
+            logMessage(lMessage);
+        }
+
+        // where the time of the scans went
+        mTiming.log(mLog);
+
         // SCAN command: end the scan sequence
         logMessage("End Scan... \\ /  \r\n");
         mSCANCommand.setParameter(0);
@@ -386,6 +449,6 @@ Scan2Print::setTerminateCondition()
 void
 Scan2Print::setTerminalLogFile(FILE* theTerminalLogName)
 {
-    mTerminalLogFile = theTerminalLogName;
+    mLog.setLogFile(theTerminalLogName);
 }
 
@@ -29,6 +29,10 @@
 
 #include "Global.hpp"
 #include "GSC2Command.hpp"
+#include "ScanData.hpp"
+#include "AsyncLog.hpp"
+#include "ScanTiming.hpp"
+#include "ScanView.hpp"
 #include "SCANCommand.hpp"
 #include "ErrorID.h"
 class IDataStream;
@@ -66,6 +70,12 @@ class Scan2Print
             /** if this flag is set shows the example lost scans only */
             SHOW_LOST_SCANS_ONLY = 1,
 
+            /** ms to wait for a scan before the terminating condition is checked again */
+            SCAN_WAIT_TIME = 100,
+
+            /** ms between two scans requested and shown on the console */
+            SHOW_INTERVAL = 1000,
+
             /** distance is this value in case of noise/too strong echoes */
             NOISE = INT32_MAX,
 
@@ -94,7 +104,10 @@ class Scan2Print
         int32_t mNumberOfScans;
 
         /** the scan data */
-        GSC2Command::Scan_t mScan;
+        ScanData mScan;
+
+        /** view on the received scan */
+        ScanView mScanView;
 
         /** the SCAN command */
         SCANCommand mSCANCommand;
@@ -111,8 +124,11 @@ class Scan2Print
         /** ms when the sequence was started */
         unsigned int mStartTime;
 
-        /** the terminal log file */
-        FILE* mTerminalLogFile;
+        /** the terminal output and log file */
+        AsyncLog mLog;
+
+        /** latency histograms of the scan stages */
+        ScanTiming mTiming;
 
         /** number of the scan average count */
         int32_t mScanAvgNumber;
@@ -121,11 +137,11 @@ class Scan2Print
         int32_t mPointAvgNumber;
 
         /**
-         * Returns the current system time in ms.
-         * Watch out for timer overflows.
+         * Returns the time of the monotonic clock in ms.
+         * Watch out for timer overflows: compare differences only.
          *
          * @return
-         *      local time in ms.
+         *      time in ms.
          */
         static unsigned int
         getMilliseconds();
@@ -152,6 +168,7 @@ class Scan2Print
         /**
          * Example code: Proofs the terminating condition.
          * Here: check for ESC or if the sequence has expired.
+         * Shows the latency histograms on 'h'.
          * Note: in Eclipse IDE will ESC not work.
          */
         virtual bool
@@ -20,11 +20,12 @@
  */
 #include <ctime>
 #include <cstdio>
-#include <sys/time.h>
 #include "KbhitGetch.h"
 
 #include "Scan2Sequence.hpp"
 #include "IDataStream.hpp"
+#include "MonotonicClock.hpp"
+#include "ScanAcquisition.hpp"
 
 /*
  * Standard constructor.
@@ -40,7 +41,8 @@ Scan2Sequence::Scan2Sequence(IDataStream& theDataStream) :
         mScanNumber(0), //
         mScanPeriod(0), //
         mStartTime(0), //
-        mTerminalLogFile(0)
+        mLog(), //
+        mTiming()
 {
     // check the connection
     if (false == theDataStream.isOpen())
@@ -58,16 +60,12 @@ Scan2Sequence::~Scan2Sequence()
 }
 
 /*
- * Returns the current system time in ms.
+ * Returns the time of the monotonic clock in ms.
  */
 unsigned int
 Scan2Sequence::getMilliseconds()
 {
-    struct timeval tv;
-
-    gettimeofday(&tv, NULL); // get current time
-    const unsigned int milliseconds = tv.tv_sec * 1000LL + tv.tv_usec / 1000; // turn to milliseconds
-    return milliseconds;
+    return MonotonicClock::getMilliseconds();
 }
 
 /*
@@ -92,15 +90,28 @@ Scan2Sequence::isTerminated()
 	int key;
 
     // not started or expired
-    bool lExpired = ((0 != mScanPeriod) && ((mStartTime + mScanPeriod) < getMilliseconds()));
+    bool lExpired = ((0 != mScanPeriod) && ((getMilliseconds() - mStartTime) > mScanPeriod));
     if ((0 == mStartTime) || lExpired)
     {
         mStartTime = 0; // set to "not started"
         return true;
     }
 
+    if (0 == kbhit())
+    {
+        return false;
+    }
+
+    // show the latency histograms so far on 'h' or 'H'
+    key = getch();
+    if ((key == 'h') || (key == 'H'))
+    {
+        mTiming.log(mLog);
+        return false;
+    }
+
     // check for ESC or 'q' or 'Q'
-    return ((0 != kbhit()) && (((key = getch()) == VK_ESC) || (key == 'q') || (key == 'Q')));
+    return ((key == VK_ESC) || (key == 'q') || (key == 'Q'));
 }
 
 /*
@@ -115,14 +126,8 @@ Scan2Sequence::logTableHeader()
     sprintf(lTextLine, "\r\n%14s ; %12s; %12s;  %8s;  %8s; %8s;\r\n", //
             "Time", "Scan", "PS Time", "d Scans", "d Cmds", "Lost scans");
 
-    // write to file
-    if (0 != mTerminalLogFile)
-    {
-        fputs(lTextLine, mTerminalLogFile);
-    }
-
-    // write to console
-    puts(lTextLine);
+    // write to the console and the file
+    mLog.write(lTextLine);
     return ERR_SUCCESS;
 }
 
@@ -142,14 +147,8 @@ Scan2Sequence::logMessage(const char* const theMessage)
         sprintf(lTextLine, "%2d.%02d./%2d:%02d:%02d: %s\r\n", lLocalTime.tm_mday, lLocalTime.tm_mon + 1,
                 lLocalTime.tm_hour, lLocalTime.tm_min, lLocalTime.tm_sec, theMessage);
 
-        // write to file
-        if (0 != mTerminalLogFile)
-        {
-            fputs(lTextLine, mTerminalLogFile);
-        }
-
-        // write to console
-        puts(lTextLine);
+        // write to the console and the file
+        mLog.write(lTextLine);
     }
     return ERR_SUCCESS;
 }
@@ -184,10 +183,10 @@ Scan2Sequence::logScan()
     struct tm lLocalTime = getTime();
 
     // valid scan?
-    if (0 != mScan.mNumberOfParameter)
+    if (0 != mScan.getNumberOfParameter())
     {
-        mScannerTimeCode = mScan.mParameter[GSC2Command::PARAMETER_TIME_STAMP];
-        mScanNumber = mScan.mParameter[GSC2Command::PARAMETER_SCAN_NUMBER];
+        mScannerTimeCode = mScan.getParameter(GSC2Command::PARAMETER_TIME_STAMP);
+        mScanNumber = mScan.getParameter(GSC2Command::PARAMETER_SCAN_NUMBER);
         const int32_t lLostScans = mScanNumber - lLastScanNumber - 1;
 
         // this is the 1st scan.
@@ -222,11 +221,7 @@ Scan2Sequence::logScan()
     // log on screen and to file
     if (0 != lTextLine[0])
     {
-        printf(lTextLine);
-        if (0 != mTerminalLogFile)
-        {
-            fputs(lTextLine, mTerminalLogFile);
-        }
+        mLog.write(lTextLine);
     }
     return ERR_SUCCESS;
 }
@@ -238,15 +233,15 @@ ErrorID_t
 Scan2Sequence::processScan()
 {
     // not an empty scan?
-    if (0 != mScan.mNumberOfParameter)
+    if (0 != mScan.getNumberOfParameter())
     {
-        // example code: show some profile infos.
-        printf(
+        // example code: show some profile infos; the console may skip them.
+        mLog.print(AsyncLog::LOG_CONSOLE | AsyncLog::LOG_OPTIONAL,
                 "Scan %d; time %d; Incremental %d; ScanLine %d\r\r", //
-                mScan.mParameter[GSC2Command::PARAMETER_SCAN_NUMBER],
-                mScan.mParameter[GSC2Command::PARAMETER_TIME_STAMP],
-                mScan.mParameter[GSC2Command::PARAMETER_INCREMENTAL_ENCODER],
-                mScan.mParameter[GSC2Command::PARAMETER_SCAN_LINE]);
+                mScan.getParameter(GSC2Command::PARAMETER_SCAN_NUMBER),
+                mScan.getParameter(GSC2Command::PARAMETER_TIME_STAMP),
+                mScan.getParameter(GSC2Command::PARAMETER_INCREMENTAL_ENCODER),
+                mScan.getParameter(GSC2Command::PARAMETER_SCAN_LINE));
     } // end valid scan
 
     return ERR_SUCCESS;
@@ -260,10 +255,20 @@ Scan2Sequence::run(char* theDataLogFileName)
 {
     ErrorID_t result = ERR_SUCCESS;
 
+    // receives the scans on the acquisition thread
+    ScanAcquisition lScanAcquisition([&](ScanView& theScanView, ScanTiming::Stamps_t& theStamps) -> ErrorID_t
+    {
+        const ErrorID_t lResult = mGSC2Command.performCommand(mScanAvgNumber, 1, theScanView, theDataLogFileName);
+        theStamps.mTime[ScanTiming::STAGE_FIRST_BYTE] = mGSC2Command.getFirstByteTime();
+        theStamps.mTime[ScanTiming::STAGE_LAST_BYTE] = mGSC2Command.getLastByteTime();
+        return lResult;
+    });
+
     // reset
     mScanNumber = 0;
     mScannerTimeCode = 0;
     mNumberOfScans = 0;
+    mTiming.reset();
 
     // ask scan average value
     fprintf(stdout, "> Scan Average count : ");
@@ -288,33 +293,93 @@ Scan2Sequence::run(char* theDataLogFileName)
         // terminal mode change on linux for kbhit of isTerminated().
         changemode(1);
 
+        // write the terminal output on a thread of its own
+        mLog.start();
+
+        // request and receive on the acquisition thread
+        lScanAcquisition.start();
+
        // loop until the scans terminate.
         while (false == isTerminated())
         {
-            // request a scan, measure how long this takes on this machine.
+            // take the next scan, the acquisition measured how long it took on this machine.
+            const ScanAcquisition::Slot_t* const lSlotPtr = lScanAcquisition.getScan(SCAN_WAIT_TIME);
+            if (0 == lSlotPtr)
+            {
+                continue;
+            }
             mNumberOfScans++;
-            mComputerSendTimeCode = getMilliseconds();
-            result = mGSC2Command.performCommand(mScanAvgNumber, 1, mScan, theDataLogFileName);
-            mComputerReceiveTimeCode = getMilliseconds();
+            mComputerSendTimeCode = lSlotPtr->mSendTime;
+            mComputerReceiveTimeCode = lSlotPtr->mReceiveTime;
+            ScanTiming::Stamps_t lStamps = lSlotPtr->mStamps;
+            result = lSlotPtr->mResult;
+            if (ERR_SUCCESS == result)
+            {
+                result = mScan.attach(lSlotPtr->mFrame, lSlotPtr->mFrameLength);
+            }
 
-            // process the scan data and show result
+            // process the scan data and show result; slow output does not delay the acquisition
             if (ERR_SUCCESS == result)
             {
-            	// WARNING "printf()" routine extensively used in this calls causes lost scans
                 result = processScan();
                 logScan();
+
+                // count where the time of the scan went
+                lStamps.mTime[ScanTiming::STAGE_PROCESSED] = MonotonicClock::getNanoseconds();
+                mTiming.record(lStamps);
             }
 
             // or process the error code
-            if (ERR_SUCCESS != result)
+            if (ERR_END_OF_STREAM == result)
+            {
+                logMessage("End of the data stream");
+            }
+            else if (ERR_SUCCESS != result)
             {
                 logError(result);
             }
+
+            // hand the slot back to the acquisition
+            mScan.clear();
+            lScanAcquisition.releaseScan();
+
+            // hand the output of the scan to the writer
+            mLog.flush();
+
+            // a replayed recording has ended: nothing more to receive
+            if (ERR_END_OF_STREAM == result)
+            {
+                break;
+            }
         } // end while not terminated
 
+        // the connection and the console are ours again
+        lScanAcquisition.stop();
+        mLog.stop();
+
         // terminal mode restore on linux for kbhit of isTerminated().
         changemode(0);
 
+        // scans dropped because processing was too slow
+        if (0 != lScanAcquisition.getOverruns())
+        {
+            string128_t lMessage;
+            sprintf(lMessage, "%u scans dropped, processing too slow",
+                    static_cast<unsigned int>(lScanAcquisition.getOverruns()));
+            logMessage(lMessage);
+        }
+
+        // console lines dropped because the console was too slow
+        if (0 != mLog.getDroppedLines())
+        {
+            string128_t lMessage;
+            sprintf(lMessage, "%u console lines dropped, output too slow", mLog.getDroppedLines());
+            logMessage(lMessage);
+        }
+
+        // where the time of the scans went
+        mTiming.log(mLog);
+
         // SCAN command: end the scan sequence
         logMessage("End Scan... \\ /  \r\n");
         mSCANCommand.setParameter(0);
@@ -351,6 +416,6 @@ Scan2Sequence::setTerminateCondition()
 void
 Scan2Sequence::setTerminalLogFile(FILE* theTerminalLogName)
 {
-    mTerminalLogFile = theTerminalLogName;
+    mLog.setLogFile(theTerminalLogName);
 }
 
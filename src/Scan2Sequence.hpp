@@ -29,6 +29,9 @@
 
 #include "Global.hpp"
 #include "GSC2Command.hpp"
+#include "AsyncLog.hpp"
+#include "ScanTiming.hpp"
+#include "ScanView.hpp"
 #include "SCANCommand.hpp"
 #include "ErrorID.h"
 class IDataStream;
@@ -66,6 +69,9 @@ class Scan2Sequence
             /** if this flag is set shows the example lost scans only */
             SHOW_LOST_SCANS_ONLY = 1,
 
+            /** ms to wait for a scan before the terminating condition is checked again */
+            SCAN_WAIT_TIME = 100,
+
             /** distance is this value in case of noise/too strong echoes */
             NOISE = INT32_MAX,
 
@@ -93,8 +99,8 @@ class Scan2Sequence
         /** Number of scans requested by the computer */
         int32_t mNumberOfScans;
 
-        /** the scan data */
-        GSC2Command::Scan_t mScan;
+        /** view on the scan taken from the acquisition; only the parameters are used */
+        ScanView mScan;
 
         /** the SCAN command */
         SCANCommand mSCANCommand;
@@ -111,18 +117,21 @@ class Scan2Sequence
         /** ms when the sequence was started */
         unsigned int mStartTime;
 
-        /** the terminal log file */
-        FILE* mTerminalLogFile;
+        /** the terminal output and log file */
+        AsyncLog mLog;
+
+        /** latency histograms of the scan stages */
+        ScanTiming mTiming;
 
         /** number of the scan average count */
         int32_t mScanAvgNumber;
 
         /**
-         * Returns the current system time in ms.
-         * Watch out for timer overflows.
+         * Returns the time of the monotonic clock in ms.
+         * Watch out for timer overflows: compare differences only.
          *
          * @return
-         *      local time in ms.
+         *      time in ms.
          */
         static unsigned int
         getMilliseconds();
@@ -149,6 +158,7 @@ class Scan2Sequence
         /**
          * Example code: Proofs the terminating condition.
          * Here: check for ESC or if the sequence has expired.
+         * Shows the latency histograms on 'h'.
          * Note: in Eclipse IDE will ESC not work.
          */
         virtual bool
@@ -0,0 +1,169 @@
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       ScanAcquisition.cpp
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ *
+ ****************************************************************************
+ */
+#include <chrono>
+#include <cstring>
+
+#include "ScanAcquisition.hpp"
+#include "MonotonicClock.hpp"
+#include "ScanView.hpp"
+
+/*
+ * Standard constructor.
+ */
+ScanAcquisition::ScanAcquisition(const Receiver_t& theReceiver) :
+        mReceiver(theReceiver), //
+        mRingPtr(new SlotRing_t), //
+        mRequestInterval(0), //
+        mOverruns(0), //
+        mRunning(false), //
+        mThread()
+{
+    // nothing more to do.
+}
+
+/*
+ * Standard destructor.
+ */
+ScanAcquisition::~ScanAcquisition()
+{
+    stop();
+    delete mRingPtr;
+}
+
+/*
+ * Thread function: receives scans until stop() is called.
+ */
+void
+ScanAcquisition::acquire()
+{
+    ScanView lScanView;
+    ScanTiming::Stamps_t lStamps = { { 0 } };
+    bool lIsFirstRequest = true;
+    uint32_t lRequestTime = 0;
+
+    while (mRunning.load(std::memory_order_acquire))
+    {
+        // pace the requests; wake up now and then to see stop()
+        const uint32_t lElapsedTime = MonotonicClock::getMilliseconds() - lRequestTime;
+        if ((false == lIsFirstRequest) && (lElapsedTime < mRequestInterval))
+        {
+            const uint32_t lSleepTime = mRequestInterval - lElapsedTime;
+            std::this_thread::sleep_for(
+                    std::chrono::milliseconds((MAX_SLEEP_TIME < lSleepTime) ? MAX_SLEEP_TIME : lSleepTime));
+            continue;
+        }
+        lIsFirstRequest = false;
+        lRequestTime = MonotonicClock::getMilliseconds();
+
+        const uint64_t lSendTime = MonotonicClock::getNanoseconds();
+        const ErrorID_t lResult = mReceiver(lScanView, lStamps);
+        const uint64_t lParseTime = MonotonicClock::getNanoseconds();
+
+        // the receiver may fail at once: do not spin on its errors
+        if (ERR_SUCCESS != lResult)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(POLL_INTERVAL));
+        }
+
+        // consumer too slow: drop the scan, keep on receiving
+        Slot_t* const lSlotPtr = mRingPtr->getWriteSlot();
+        if (0 == lSlotPtr)
+        {
+            mOverruns.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        lSlotPtr->mResult = lResult;
+        lSlotPtr->mSendTime = static_cast<uint32_t>(lSendTime / 1000000ULL);
+        lSlotPtr->mReceiveTime = static_cast<uint32_t>(lParseTime / 1000000ULL);
+        lSlotPtr->mStamps = lStamps;
+        lSlotPtr->mStamps.mTime[ScanTiming::STAGE_SEND] = lSendTime;
+        lSlotPtr->mStamps.mTime[ScanTiming::STAGE_PARSED] = lParseTime;
+        lSlotPtr->mStamps.mTime[ScanTiming::STAGE_PROCESSED] = lParseTime;
+        lSlotPtr->mFrameLength = 0;
+        if ((ERR_SUCCESS == lResult) && (MAX_FRAME_SIZE >= lScanView.getFrameLength()))
+        {
+            lSlotPtr->mFrameLength = lScanView.getFrameLength();
+            memcpy(lSlotPtr->mFrame, lScanView.getFrame(), lSlotPtr->mFrameLength);
+        }
+        mRingPtr->push();
+    }
+}
+
+/*
+ * Starts the acquisition thread.
+ */
+void
+ScanAcquisition::start()
+{
+    stop();
+
+    // discard scans left from the last run
+    while (0 != mRingPtr->getReadSlot())
+    {
+        mRingPtr->pop();
+    }
+    mOverruns = 0;
+
+    mRunning = true;
+    mThread = std::thread(&ScanAcquisition::acquire, this);
+}
+
+/*
+ * Stops the acquisition thread.
+ */
+void
+ScanAcquisition::stop()
+{
+    mRunning = false;
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+}
+
+/*
+ * Returns the oldest received scan.
+ */
+const ScanAcquisition::Slot_t*
+ScanAcquisition::getScan(uint32_t theTimeout)
+{
+    const uint32_t lStartTime = MonotonicClock::getMilliseconds();
+    const Slot_t* lSlotPtr = mRingPtr->getReadSlot();
+
+    // the ring is empty: poll, the producer is never blocked by a lock
+    while ((0 == lSlotPtr) && ((MonotonicClock::getMilliseconds() - lStartTime) < theTimeout))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(POLL_INTERVAL));
+        lSlotPtr = mRingPtr->getReadSlot();
+    }
+    return lSlotPtr;
+}
+
+/*
+ * Releases the slot returned by getScan().
+ */
+void
+ScanAcquisition::releaseScan()
+{
+    mRingPtr->pop();
+}
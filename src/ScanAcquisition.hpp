@@ -0,0 +1,226 @@
+#ifndef SCANACQUISITION_HPP_
+#define SCANACQUISITION_HPP_
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       ScanAcquisition.hpp - Receives scans on a separate thread.
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ ****************************************************************************
+ */
+
+#include <atomic>
+#include <functional>
+#include <thread>
+extern "C"
+{
+#include "ErrorID.h"
+}
+#include "Global.hpp"
+#include "ScanTiming.hpp"
+#include "SpscRing.hpp"
+
+class ScanView;
+
+/**
+ * Class ScanAcquisition - producer/consumer scan loop.
+ * <p>&nbsp;<p>
+ * When a scan loop receives, processes and logs on one thread, a slow
+ * printf or file write delays the next request and scans are lost.
+ * ScanAcquisition runs the receiver on a thread of its own: it receives
+ * and validates the scans and copies each verified response into a slot
+ * of a pre-allocated lock-free ring. The scan loop takes the slots from
+ * the ring on its thread, so the acquisition does not wait for processing.
+ * <p>
+ * If the consumer falls behind and the ring is full, the acquisition
+ * goes on and drops the new scan; getOverruns() counts these scans.
+ * <p>
+ * While the acquisition runs, the receiver owns the connection: the
+ * consumer must not perform commands before stop().
+ * <p>
+ * Each slot carries the time stamps of the stages up to the parsed scan;
+ * the consumer adds the processed stage and counts them in a ScanTiming.
+ * <p>
+ * By default the scans are requested back to back. A loop which shows a
+ * scan now and then sets a request interval instead, so the sensor does
+ * not measure, and the data log does not record, scans nobody looks at.
+ * <p>
+ * After a failed receive the acquisition waits POLL_INTERVAL ms before
+ * the next try, so a receiver which fails at once, e.g. on a closed
+ * connection, does not spin at full CPU.
+ */
+class ScanAcquisition
+{
+    public:
+
+        /** class constants */
+        enum ScanAcquisitionConstants_t
+        {
+            /** number of slots in the ring; a power of two */
+            NUMBER_OF_SLOTS = 8,
+
+            /** maximum size of a response in bytes */
+            MAX_FRAME_SIZE = 64 * 1024,
+
+            /** time in ms the consumer polls the ring and the acquisition
+             *  waits after a failed receive */
+            POLL_INTERVAL = 1,
+
+            /** maximum time in ms the thread sleeps at once until the next
+             *  request, so stop() is not delayed */
+            MAX_SLEEP_TIME = 10
+        };
+
+        /**
+         * A received scan.
+         */
+        struct Slot_t
+        {
+                /** result of the receiver; the frame is empty on errors */
+                ErrorID_t mResult;
+
+                /** time in ms of the MonotonicClock when the request was started */
+                uint32_t mSendTime;
+
+                /** time in ms of the MonotonicClock when the response was verified */
+                uint32_t mReceiveTime;
+
+                /** time stamps in ns up to STAGE_PARSED */
+                ScanTiming::Stamps_t mStamps;
+
+                /** number of bytes in mFrame, including the CRC */
+                int32_t mFrameLength;
+
+                /** the response in network byte order */
+                uint32_t mFrame[MAX_FRAME_SIZE / sizeof(uint32_t)];
+        };
+
+        /**
+         * Receives one scan: performs the scan command, attaches the
+         * view to the verified response and sets the time stamps of
+         * STAGE_FIRST_BYTE and STAGE_LAST_BYTE.
+         */
+        typedef std::function<ErrorID_t(ScanView&, ScanTiming::Stamps_t&)> Receiver_t;
+
+    private:
+
+        /** the ring of slots */
+        typedef SpscRing<Slot_t, NUMBER_OF_SLOTS> SlotRing_t;
+
+        /** receives a scan on the acquisition thread */
+        Receiver_t mReceiver;
+
+        /** the ring between the threads; allocated once */
+        SlotRing_t* mRingPtr;
+
+        /** minimum time in ms between the starts of two requests; 0 for back to back */
+        uint32_t mRequestInterval;
+
+        /** number of scans dropped because the ring was full */
+        std::atomic<uint32_t> mOverruns;
+
+        /** cleared to stop the acquisition thread */
+        std::atomic<bool> mRunning;
+
+        /** the acquisition thread */
+        std::thread mThread;
+
+        /**
+         * Thread function: receives scans until stop() is called.
+         */
+        void
+        acquire();
+
+        /* private assignment constructor to avoid misuse */
+        explicit
+        ScanAcquisition(const ScanAcquisition& src);
+
+        /* private assignment operator to avoid misuse */
+        ScanAcquisition&
+        operator =(const ScanAcquisition& src);
+
+    public:
+
+        /**
+         * Constructor.
+         *
+         * @param theReceiver
+         *      receives one scan; called on the acquisition thread only.
+         */
+        explicit
+        ScanAcquisition(const Receiver_t& theReceiver);
+
+        /**
+         * Destructor. Stops the acquisition.
+         */
+        virtual
+        ~ScanAcquisition();
+
+        /**
+         * Sets the minimum time between the starts of two requests.
+         * Takes effect with the next start().
+         *
+         * @param theRequestInterval
+         *      time in ms; 0 (default) requests the scans back to back.
+         */
+        void
+        setRequestInterval(uint32_t theRequestInterval)
+        {
+            mRequestInterval = theRequestInterval;
+        }
+
+        /**
+         * Discards the scans in the ring, resets the overrun counter and
+         * starts the acquisition thread.
+         */
+        void
+        start();
+
+        /**
+         * Stops the acquisition thread. Waits for the scan being received,
+         * which takes up to the timeout of the connection.
+         */
+        void
+        stop();
+
+        /**
+         * Consumer: returns the oldest received scan.
+         * The slot is valid until releaseScan().
+         *
+         * @param theTimeout
+         *      ms to wait if the ring is empty.
+         * @return
+         *      the slot, or 0 if no scan arrived in time.
+         */
+        const Slot_t*
+        getScan(uint32_t theTimeout);
+
+        /**
+         * Consumer: releases the slot returned by getScan().
+         */
+        void
+        releaseScan();
+
+        /**
+         * Returns the number of scans dropped because the ring was full.
+         */
+        uint32_t
+        getOverruns() const
+        {
+            return mOverruns.load(std::memory_order_relaxed);
+        }
+};
+
+#endif /* SCANACQUISITION_HPP_ */
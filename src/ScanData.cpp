@@ -0,0 +1,103 @@
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       ScanData.cpp
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ *
+ ****************************************************************************
+ */
+
+#include "ScanData.hpp"
+#include "ScanView.hpp"
+
+/*
+ * Standard constructor.
+ */
+ScanData::ScanData() :
+        mNumberOfParameter(0), //
+        mParameter(), //
+        mNumberOfPoints(0), //
+        mNumberOfEchoes(0), //
+        mHasPulseWidth(false), //
+        mStorage()
+{
+    // nothing more to do; the storage grows with the first scan.
+}
+
+/*
+ * Makes the scan empty. The storage is kept.
+ */
+void
+ScanData::clear()
+{
+    mNumberOfParameter = 0;
+    mNumberOfPoints = 0;
+    mNumberOfEchoes = 0;
+    mHasPulseWidth = false;
+    mStorage.clear();
+
+    for (int32_t l = 0; l < GSCNCommand::NUMBER_OF_SCAN_PARAMETER; l++)
+    {
+        mParameter[l] = 0;
+    }
+}
+
+/*
+ * Copies a received scan: the interleaved echoes of the response are
+ * distributed to one array per echo and value.
+ */
+ErrorID_t
+ScanData::assign(const ScanView& theScanView)
+{
+    clear();
+
+    // copy known parameter; skip extended ones
+    mNumberOfParameter = theScanView.getNumberOfParameter();
+    if (mNumberOfParameter > GSCNCommand::NUMBER_OF_SCAN_PARAMETER)
+    {
+        mNumberOfParameter = GSCNCommand::NUMBER_OF_SCAN_PARAMETER;
+    }
+    for (int32_t l = 0; l < mNumberOfParameter; l++)
+    {
+        mParameter[l] = theScanView.getParameter(l);
+    }
+
+    mNumberOfEchoes = theScanView.getNumberOfEchoes();
+    if (false == theScanView.hasData())
+    {
+        return ERR_SUCCESS;
+    }
+    mNumberOfPoints = theScanView.getNumberOfPoints();
+    mHasPulseWidth = theScanView.hasPulseWidth();
+    mStorage.resize(mNumberOfPoints * mNumberOfEchoes * (mHasPulseWidth ? 2 : 1));
+
+    int32_t* const lDataPtr = mStorage.data();
+    int32_t lPoints = 0;
+    for (ScanView::Point lPoint : theScanView)
+    {
+        for (int32_t lEchoes = 0; lEchoes < mNumberOfEchoes; lEchoes++)
+        {
+            const ScanView::Echo lEcho = lPoint[lEchoes];
+            lDataPtr[lEchoes * mNumberOfPoints + lPoints] = lEcho.getDistance();
+            if (mHasPulseWidth)
+            {
+                lDataPtr[(mNumberOfEchoes + lEchoes) * mNumberOfPoints + lPoints] = lEcho.getPulseWidth();
+            }
+        } // end echos
+        lPoints++;
+    } // end points
+    return ERR_SUCCESS;
+}
@@ -0,0 +1,165 @@
+#ifndef SCANDATA_HPP_
+#define SCANDATA_HPP_
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       ScanData.hpp - Scan stored as structure of arrays.
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ ****************************************************************************
+ */
+
+#include <vector>
+extern "C"
+{
+#include "ErrorID.h"
+}
+#include "Global.hpp"
+#include "GSCNCommand.hpp"
+
+class ScanView;
+
+/**
+ * Class ScanData - a scan in host byte order, stored as structure of arrays.
+ * <p>&nbsp;<p>
+ * The distances of each echo are stored in one contiguous array, followed
+ * by the pulse widths of each echo if the sensor sent them. The storage
+ * is sized to the actual number of points and echoes: a scan of 4000
+ * single echo distances occupies 16 KB. The storage is kept from scan to
+ * scan, so it is allocated only when a scan is larger than all before.
+ * <p>
+ * Loops over the distances of an echo access consecutive integers and
+ * can be vectorised by the compiler.
+ */
+class ScanData
+{
+        /** number of known parameters in the parameter array */
+        int32_t mNumberOfParameter;
+
+        /** scan parameter array */
+        int32_t mParameter[GSCNCommand::NUMBER_OF_SCAN_PARAMETER];
+
+        /** number of points in the scan */
+        int32_t mNumberOfPoints;
+
+        /** number of echoes in the scan */
+        int32_t mNumberOfEchoes;
+
+        /** true if the scan contains pulse widths */
+        bool mHasPulseWidth;
+
+        /** distances of all echoes, then pulse widths of all echoes */
+        std::vector<int32_t> mStorage;
+
+    public:
+
+        /**
+         * Constructor. Creates an empty scan.
+         */
+        ScanData();
+
+        /**
+         * Makes the scan empty. The storage is kept.
+         */
+        void
+        clear();
+
+        /**
+         * Copies a received scan and converts it to host byte order.
+         *
+         * @param theScanView
+         *      the view on the received scan.
+         * @return
+         *      ERR_SUCCESS on success, otherwise a negative error code.
+         */
+        ErrorID_t
+        assign(const ScanView& theScanView);
+
+        /**
+         * Returns the number of known parameters; 0 for an empty scan.
+         */
+        int32_t
+        getNumberOfParameter() const
+        {
+            return mNumberOfParameter;
+        }
+
+        /**
+         * Returns a scan parameter, or 0 if the sensor did not send it.
+         *
+         * @param theParameterID
+         *      one of GSCNCommand::GSCNParameterID_t.
+         */
+        int32_t
+        getParameter(int32_t theParameterID) const
+        {
+            return ((0 <= theParameterID) && (theParameterID < mNumberOfParameter)) ?
+                    mParameter[theParameterID] : 0;
+        }
+
+        /**
+         * Returns the number of points; 0 if the scan has no data block.
+         */
+        int32_t
+        getNumberOfPoints() const
+        {
+            return mNumberOfPoints;
+        }
+
+        /**
+         * Returns the number of echoes per point.
+         */
+        int32_t
+        getNumberOfEchoes() const
+        {
+            return mNumberOfEchoes;
+        }
+
+        /**
+         * Returns true if the scan contains pulse widths.
+         */
+        bool
+        hasPulseWidth() const
+        {
+            return mHasPulseWidth;
+        }
+
+        /**
+         * Returns the distances of an echo, getNumberOfPoints() integers.
+         *
+         * @param theEcho
+         *      the echo; must be less than getNumberOfEchoes().
+         */
+        const int32_t*
+        getDistances(int32_t theEcho) const
+        {
+            return mStorage.data() + theEcho * mNumberOfPoints;
+        }
+
+        /**
+         * Returns the pulse widths of an echo, getNumberOfPoints() integers,
+         * or 0 if the scan contains no pulse widths.
+         *
+         * @param theEcho
+         *      the echo; must be less than getNumberOfEchoes().
+         */
+        const int32_t*
+        getPulseWidths(int32_t theEcho) const
+        {
+            return mHasPulseWidth ? mStorage.data() + (mNumberOfEchoes + theEcho) * mNumberOfPoints : 0;
+        }
+};
+
+#endif /* SCANDATA_HPP_ */
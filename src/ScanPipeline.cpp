@@ -0,0 +1,143 @@
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       ScanPipeline.cpp
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ *
+ ****************************************************************************
+ */
+
+#include "ScanPipeline.hpp"
+#include "GSCNCommand.hpp"
+#include "ScanView.hpp"
+
+/*
+ * Standard constructor.
+ */
+ScanPipeline::ScanPipeline(GSCNCommand& theGSCNCommand, int32_t theDepth) :
+        mGSCNCommand(theGSCNCommand), //
+        mDepth((1 > theDepth) ? 1 : ((MAX_DEPTH < theDepth) ? static_cast<int32_t>(MAX_DEPTH) : theDepth)), //
+        mNextRequest(0), //
+        mNextScan(0)
+{
+    // nothing more to do.
+}
+
+/*
+ * Standard destructor.
+ */
+ScanPipeline::~ScanPipeline()
+{
+    // nothing to be done.
+}
+
+/*
+ * Gives up the outstanding requests.
+ */
+void
+ScanPipeline::reset()
+{
+    mNextRequest = 0;
+    mNextScan = 0;
+}
+
+/*
+ * Sends requests until mDepth requests are outstanding.
+ * A request which could not be sent is not outstanding.
+ */
+ErrorID_t
+ScanPipeline::fill()
+{
+    ErrorID_t result = ERR_SUCCESS;
+
+    while ((ERR_SUCCESS == result) && ((mNextRequest - mNextScan) < mDepth))
+    {
+        result = mGSCNCommand.sendRequest(mNextRequest);
+        if (ERR_SUCCESS == result)
+        {
+            mNextRequest++;
+        }
+    }
+    return result;
+}
+
+/*
+ * Receives the responses of the outstanding requests.
+ */
+void
+ScanPipeline::drain()
+{
+    ScanView lScanView;
+
+    for (int32_t l = mNextScan; l < mNextRequest; l++)
+    {
+        if (ERR_SUCCESS != mGSCNCommand.receiveScan(lScanView, 0))
+        {
+            break;
+        }
+    }
+    reset();
+}
+
+/*
+ * Returns the next scan and requests the following ones.
+ */
+ErrorID_t
+ScanPipeline::getScan(ScanView& theScanView, char* theDataLogFileName)
+{
+    ErrorID_t result = ERR_SUCCESS;
+
+    // not started: request the latest scan to learn the scan number
+    if (0 == mNextRequest)
+    {
+        result = mGSCNCommand.sendRequest(0);
+    }
+    else
+    {
+        result = fill();
+    }
+
+    // receive until a scan arrives which was not handed out before
+    while (ERR_SUCCESS == result)
+    {
+        result = mGSCNCommand.receiveScan(theScanView, theDataLogFileName);
+        if (ERR_SUCCESS != result)
+        {
+            break;
+        }
+
+        const int32_t lScanNumber = theScanView.getParameter(GSCNCommand::PARAMETER_SCAN_NUMBER);
+        if ((0 == mNextRequest) || (lScanNumber >= mNextScan))
+        {
+            // the requests for older scans are answered by this one
+            mNextScan = lScanNumber + 1;
+            if (mNextRequest < mNextScan)
+            {
+                mNextRequest = mNextScan;
+            }
+
+            // a request which cannot be sent is repeated with the next call
+            fill();
+            return ERR_SUCCESS;
+        }
+
+        // late or duplicate response
+    }
+
+    // lost response or error: start over
+    reset();
+    return result;
+}
@@ -0,0 +1,145 @@
+#ifndef SCANPIPELINE_HPP_
+#define SCANPIPELINE_HPP_
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       ScanPipeline.hpp - Keeps several GSCN requests in flight.
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ ****************************************************************************
+ */
+
+extern "C"
+{
+#include "ErrorID.h"
+}
+#include "Global.hpp"
+
+class GSCNCommand;
+class ScanView;
+
+/**
+ * Class ScanPipeline - pipelined scan acquisition.
+ * <p>&nbsp;<p>
+ * A strict request/response loop leaves the sensor idle for the round
+ * trip and the processing time of each scan. The pipeline keeps up to
+ * a given number of GSCN requests outstanding: it requests the latest
+ * scan once, then the following scan numbers in advance. The sensor
+ * answers a request for a scan number as soon as the scan is measured.
+ * <p>
+ * Responses are matched to the requests by their scan number and are
+ * handed out in ascending order. A response older than the last one
+ * handed out (late datagram, duplicate) is dropped; scans which never
+ * arrive show up as gap in the scan numbers, as with single requests.
+ * <p>
+ * If a response times out, the outstanding requests are given up and
+ * the pipeline starts over with the latest scan.
+ * <p>
+ * The depth is limited to MAX_DEPTH, so a typo at the console cannot
+ * flood the sensor with requests. Only requests which were sent count
+ * as outstanding.
+ */
+class ScanPipeline
+{
+    public:
+
+        /** class constants */
+        enum ScanPipelineConstants_t
+        {
+            /** maximum number of outstanding requests; as many as a
+             *  ReplayStream keeps waiting */
+            MAX_DEPTH = 16
+        };
+
+    private:
+
+        /** the GSCN command used to request and receive */
+        GSCNCommand& mGSCNCommand;
+
+        /** maximum number of outstanding requests */
+        int32_t mDepth;
+
+        /** next scan number to request; 0 if the pipeline is not started */
+        int32_t mNextRequest;
+
+        /** lowest scan number which may be handed out next */
+        int32_t mNextScan;
+
+        /**
+         * Sends requests until mDepth requests are outstanding.
+         *
+         * @return
+         *      ERR_SUCCESS on success, otherwise a negative error code.
+         */
+        ErrorID_t
+        fill();
+
+        /* private assignment constructor to avoid misuse */
+        explicit
+        ScanPipeline(const ScanPipeline& src);
+
+        /* private assignment operator to avoid misuse */
+        ScanPipeline&
+        operator =(const ScanPipeline& src);
+
+    public:
+
+        /**
+         * Constructor.
+         *
+         * @param theGSCNCommand
+         *      the GSCN command to be used; its connection must be open.
+         * @param theDepth
+         *      maximum number of outstanding requests; 1 means no pipelining.
+         *      Limited to 1 ... MAX_DEPTH.
+         */
+        ScanPipeline(GSCNCommand& theGSCNCommand, int32_t theDepth);
+
+        /**
+         * Destructor.
+         */
+        virtual
+        ~ScanPipeline();
+
+        /**
+         * Gives up the outstanding requests. The next getScan() starts over
+         * with the latest scan.
+         */
+        void
+        reset();
+
+        /**
+         * Receives the responses of the outstanding requests, so they are
+         * not taken for the response of the next command.
+         * Waits until the requested scans are measured or the connection times out.
+         */
+        void
+        drain();
+
+        /**
+         * Returns the next scan and requests the following ones.
+         *
+         * @param theScanView
+         *      the view on the received scan; valid until the next call.
+         * @param theDataLogFileName
+         *      file to store the response, or 0.
+         * @return
+         *      ERR_SUCCESS on success, otherwise a negative error code.
+         */
+        ErrorID_t
+        getScan(ScanView& theScanView, char* theDataLogFileName);
+};
+
+#endif /* SCANPIPELINE_HPP_ */
@@ -18,23 +18,17 @@
  * expressed or implied by its publication or distribution.
  ****************************************************************************
  */
+#include <algorithm>
 #include <ctime>
 #include <cstdio>
-#include <sys/time.h>
+#include <cstring>
 #include "KbhitGetch.h"
 
 #include "IDataStream.hpp"
+#include "PointAvg.hpp"
 #include "ScanPrint.hpp"
-
-#if defined(__WIN32__) || (defined(__CYGWIN__) && !defined(_WIN32))
-	#include <windows.h>
-	#define sleep_msecs(s) Sleep(s)
-#elif defined(__linux__)
-	#include <unistd.h>
-	#define sleep_msecs(s) usleep(s*1000)
-#else
-	#error "This program requires Linux or Win32."
-#endif
+#include "MonotonicClock.hpp"
+#include "ScanAcquisition.hpp"
 
 /*
  * Standard constructor.
@@ -45,12 +39,17 @@ ScanPrint::ScanPrint(IDataStream& theDataStream) :
         mGSCNCommand(theDataStream), //
         mNumberOfScans(0), //
         mScan(), //
+        mScanView(), //
         mSCANCommand(theDataStream), //
         mScannerTimeCode(0), //
         mScanNumber(0), //
         mScanPeriod(0), //
         mStartTime(0), //
-        mTerminalLogFile(0)
+        mLog(), //
+        mTiming(), //
+        mDistances(), //
+        mAverages(), //
+        mCounts()
 {
     // check the connection
     if (false == theDataStream.isOpen())
@@ -68,16 +67,12 @@ ScanPrint::~ScanPrint()
 }
 
 /*
- * Returns the current system time in ms.
+ * Returns the time of the monotonic clock in ms.
  */
 unsigned int
 ScanPrint::getMilliseconds()
 {
-    struct timeval tv;
-
-    gettimeofday(&tv, NULL); // get current time
-    const unsigned int milliseconds = tv.tv_sec * 1000LL + tv.tv_usec / 1000; // turn to milliseconds
-    return milliseconds;
+    return MonotonicClock::getMilliseconds();
 }
 
 /*
@@ -102,15 +97,28 @@ ScanPrint::isTerminated()
 	int key;
 
     // not started or expired
-    bool lExpired = ((0 != mScanPeriod) && ((mStartTime + mScanPeriod) < getMilliseconds()));
+    bool lExpired = ((0 != mScanPeriod) && ((getMilliseconds() - mStartTime) > mScanPeriod));
     if ((0 == mStartTime) || lExpired)
     {
         mStartTime = 0; // set to "not started"
         return true;
     }
 
+    if (0 == kbhit())
+    {
+        return false;
+    }
+
+    // show the latency histograms so far on 'h' or 'H'
+    key = getch();
+    if ((key == 'h') || (key == 'H'))
+    {
+        mTiming.log(mLog);
+        return false;
+    }
+
     // check for ESC or 'q' or 'Q'
-    return ((0 != kbhit()) && (((key = getch()) == VK_ESC) || (key == 'q') || (key == 'Q')));
+    return ((key == VK_ESC) || (key == 'q') || (key == 'Q'));
 }
 
 /*
@@ -125,14 +133,8 @@ ScanPrint::logTableHeader()
     sprintf(lTextLine, "\r\n%14s %8s %8s %4s %4s %8s \r\n", //
             "Time", "Scan", "PS Time", "d-S", "d-C", "Lost-S");
 
-    // write to file
-    if (0 != mTerminalLogFile)
-    {
-        fputs(lTextLine, mTerminalLogFile);
-    }
-
-    // write to console
-    puts(lTextLine);
+    // write to the console and the file
+    mLog.write(lTextLine);
     return ERR_SUCCESS;
 }
 
@@ -152,14 +154,8 @@ ScanPrint::logMessage(const char* const theMessage)
         sprintf(lTextLine, "%2d/%02d_%2d:%02d:%02d %s\r\n", lLocalTime.tm_mday, lLocalTime.tm_mon + 1,
                 lLocalTime.tm_hour, lLocalTime.tm_min, lLocalTime.tm_sec, theMessage);
 
-        // write to file
-        if (0 != mTerminalLogFile)
-        {
-            fputs(lTextLine, mTerminalLogFile);
-        }
-
-        // write to console
-        puts(lTextLine);
+        // write to the console and the file
+        mLog.write(lTextLine);
     }
     return ERR_SUCCESS;
 }
@@ -194,10 +190,10 @@ ScanPrint::logScan()
     struct tm lLocalTime = getTime();
 
     // valid scan?
-    if (0 != mScan.mNumberOfParameter)
+    if (0 != mScan.getNumberOfParameter())
     {
-        mScannerTimeCode = mScan.mParameter[GSCNCommand::PARAMETER_TIME_STAMP];
-        mScanNumber = mScan.mParameter[GSCNCommand::PARAMETER_SCAN_NUMBER];
+        mScannerTimeCode = mScan.getParameter(GSCNCommand::PARAMETER_TIME_STAMP);
+        mScanNumber = mScan.getParameter(GSCNCommand::PARAMETER_SCAN_NUMBER);
         const int32_t lLostScans = mScanNumber - lLastScanNumber - 1;
 
         // this is the 1st scan.
@@ -211,86 +207,57 @@ ScanPrint::logScan()
         || (0 == (mScanNumber % lLogInterval)) // or regular interval has expired
                 || (0 == lLastScanNumber)) // or 1st scan
         {
-        	int32_t lCnt = 0;
-        	int32_t lDistanceSum = 0;
-        	int32_t lSumCnt = 0;
+            const int32_t lNumberOfPoints = mScan.getNumberOfPoints();
+            const int32_t lNumberOfEchoes = mScan.getNumberOfEchoes();
+            const int32_t lNumberOfValues = lNumberOfPoints * lNumberOfEchoes;
+            const int32_t* lDistancePtr = mScan.getDistances(0);
 
-            for (int32_t lPoints = 0; lPoints < mScan.mNumberOfPoints; lPoints++)
+            // the echoes of a point are averaged with their neighbours
+            if (1 < lNumberOfEchoes)
             {
-                // loop for each point through all echos
-                for (int32_t lEchoes = 0; lEchoes < mScan.mNumberOfEchoes; lEchoes++)
+                mDistances.resize(lNumberOfValues);
+                for (int32_t lEchoes = 0; lEchoes < lNumberOfEchoes; lEchoes++)
                 {
-                	int32_t lDistance = mScan.mScanData[lPoints][lEchoes].mDistance;
-                	//int32_t lPulseWidth = mScan.mScanData[lPoints][lEchoes].mPulseWidth;
-
-            		lCnt ++;
-
-            		if ((uint32_t)lDistance == 0x80000000)
-                	{
-                		if (lSumCnt == 0)
-                		{
-                			lDistanceSum = lDistance;
-                		}
-                	}
-                	else if ((uint32_t)lDistance == 0x7FFFFFFF)
-                	{
-                		if (lSumCnt == 0)
-                		{
-                			lDistanceSum = lDistance;
-                		}
-                	}
-                	else
-                	{
-                		if (lSumCnt == 0)
-                		{
-                			lDistanceSum = 0;
-                		}
-                		lSumCnt ++;
-                		lDistanceSum += lDistance;
-                	}
-
-                	if (lCnt == mPointAvgNumber)
-                	{
-                		if (lSumCnt > 0)
-                		{
-                			//printf("%4d:%2d:%8d\r\n", lPoints, lSumCnt, lDistanceSum / lSumCnt);
-                			printf("%4d:%2d:", lPoints, lSumCnt);
-                			for (int32_t lSpaceCnt = 0; lSpaceCnt < ((lDistanceSum / lSumCnt) - 15000) / 500; lSpaceCnt ++)
-                			{
-                				printf("-");
-                			}
-            				printf("|\r\n");
-                		}
-                		else
-                		{
-                			printf("%4d:%2d:%-8s\r\n", lPoints, lSumCnt, (uint32_t)lDistanceSum == 0x80000000 ? "Low" : "Noise");
-
-                		}
-                		lCnt = 0;
-                		lDistanceSum = 0;
-                		lSumCnt = 0;
-                	}
-                } // end echos
-
-                if ((lPoints == (mScan.mNumberOfPoints - 1)) && (lCnt != 0))
-            	{
-            		if (lSumCnt > 0)
-            		{
-            			//printf("%4d:%2d:%8d\r\n", lPoints, lSumCnt, lDistanceSum / lSumCnt);
-            			printf("%4d:%2d:", lPoints, lSumCnt);
-            			for (int32_t lSpaceCnt = 0; lSpaceCnt < ((lDistanceSum / lSumCnt) - 15000) / 500; lSpaceCnt ++)
-            			{
-            				printf("-");
-            			}
-        				printf("|\r\n");
-            		}
-            		else
-            		{
-            			printf("%4d:%2d:%-8s\r\n", lPoints, lSumCnt, (uint32_t)lDistanceSum == 0x80000000 ? "Low" : "Noise");
-
-            		}
-            	}
-            } // end points
+                    const int32_t* lEchoPtr = mScan.getDistances(lEchoes);
+                    for (int32_t lPoints = 0; lPoints < lNumberOfPoints; lPoints++)
+                    {
+                        mDistances[lPoints * lNumberOfEchoes + lEchoes] = lEchoPtr[lPoints];
+                    }
+                }
+                lDistancePtr = mDistances.data();
+            }
+
+            mAverages.resize(PointAvg::getNumberOfGroups(lNumberOfValues, mPointAvgNumber));
+            mCounts.resize(mAverages.size());
+            const int32_t lNumberOfGroups = PointAvg::average(lDistancePtr, lNumberOfValues, mPointAvgNumber,
+                    mAverages.data(), mCounts.data());
+
+            for (int32_t lGroup = 0; lGroup < lNumberOfGroups; lGroup++)
+            {
+                // the point of the last distance in the group
+                int32_t lPoints = ((lGroup + 1) * mPointAvgNumber - 1) / lNumberOfEchoes;
+                if (lPoints >= lNumberOfPoints)
+                {
+                    lPoints = lNumberOfPoints - 1;
+                }
+
+                if (mCounts[lGroup] > 0)
+                {
+                    //printf("%4d:%2d:%8d\r\n", lPoints, mCounts[lGroup], mAverages[lGroup]);
+                    // the bar is built in memory and written as one line
+                    string1024_t lBar;
+                    const int32_t lBarLength = std::min(std::max((mAverages[lGroup] - 15000) / 500, 0),
+                            static_cast<int32_t>(sizeof(lBar)) - 1);
+                    memset(lBar, '-', lBarLength);
+                    lBar[lBarLength] = 0;
+                    mLog.print(AsyncLog::LOG_CONSOLE, "%4d:%2d:%s|\r\n", lPoints, mCounts[lGroup], lBar);
+                }
+                else
+                {
+                    mLog.print(AsyncLog::LOG_CONSOLE, "%4d:%2d:%-8s\r\n", lPoints, mCounts[lGroup],
+                            (uint32_t)mAverages[lGroup] == 0x80000000 ? "Low" : "Noise");
+                }
+            } // end groups
         }
     } // end valid scan
 
@@ -302,11 +269,7 @@ ScanPrint::logScan()
     // log on screen and to file
     if (0 != lTextLine[0])
     {
-        printf(lTextLine);
-        if (0 != mTerminalLogFile)
-        {
-            fputs(lTextLine, mTerminalLogFile);
-        }
+        mLog.write(lTextLine);
     }
     return ERR_SUCCESS;
 }
@@ -318,15 +281,15 @@ ErrorID_t
 ScanPrint::processScan()
 {
     // not an empty scan?
-    if (0 != mScan.mNumberOfParameter)
+    if (0 != mScan.getNumberOfParameter())
     {
-        // example code: show some profile infos.
-        printf(
+        // example code: show some profile infos; the console may skip them.
+        mLog.print(AsyncLog::LOG_CONSOLE | AsyncLog::LOG_OPTIONAL,
                 "Scan %d; time %d; Incremental %d; ScanLine %d \\ / \r\n", //
-                mScan.mParameter[GSCNCommand::PARAMETER_SCAN_NUMBER],
-                mScan.mParameter[GSCNCommand::PARAMETER_TIME_STAMP],
-                mScan.mParameter[GSCNCommand::PARAMETER_INCREMENTAL_ENCODER],
-                mScan.mParameter[GSCNCommand::PARAMETER_SCAN_LINE]);
+                mScan.getParameter(GSCNCommand::PARAMETER_SCAN_NUMBER),
+                mScan.getParameter(GSCNCommand::PARAMETER_TIME_STAMP),
+                mScan.getParameter(GSCNCommand::PARAMETER_INCREMENTAL_ENCODER),
+                mScan.getParameter(GSCNCommand::PARAMETER_SCAN_LINE));
     } // end valid scan
 
     return ERR_SUCCESS;
@@ -340,10 +303,20 @@ ScanPrint::run(char* theDataLogFileName)
 {
     ErrorID_t result = ERR_SUCCESS;
 
+    // receives the scans on the acquisition thread
+    ScanAcquisition lScanAcquisition([&](ScanView& theScanView, ScanTiming::Stamps_t& theStamps) -> ErrorID_t
+    {
+        const ErrorID_t lResult = mGSCNCommand.performCommand(0, theScanView, theDataLogFileName);
+        theStamps.mTime[ScanTiming::STAGE_FIRST_BYTE] = mGSCNCommand.getFirstByteTime();
+        theStamps.mTime[ScanTiming::STAGE_LAST_BYTE] = mGSCNCommand.getLastByteTime();
+        return lResult;
+    });
+
     // reset
     mScanNumber = 0;
     mScannerTimeCode = 0;
     mNumberOfScans = 0;
+    mTiming.reset();
 
     // ask average value
     fprintf(stdout, "> Point Average count : ");
@@ -368,36 +341,99 @@ ScanPrint::run(char* theDataLogFileName)
         // terminal mode change on linux for kbhit of isTerminated().
         changemode(1);
 
+        // write the terminal output on a thread of its own
+        mLog.start();
+
+        // request and receive on the acquisition thread, a scan each SHOW_INTERVAL
+        lScanAcquisition.setRequestInterval(SHOW_INTERVAL);
+        lScanAcquisition.start();
+
         // loop until the scans terminate.
         while (false == isTerminated())
         {
-            // request a scan, measure how long this takes on this machine.
+            // take the next scan, the acquisition measured how long it took on this machine.
+            const ScanAcquisition::Slot_t* const lSlotPtr = lScanAcquisition.getScan(SCAN_WAIT_TIME);
+            if (0 == lSlotPtr)
+            {
+                continue;
+            }
+
             mNumberOfScans++;
-            mComputerSendTimeCode = getMilliseconds();
-            result = mGSCNCommand.performCommand(0, mScan, theDataLogFileName);
-            mComputerReceiveTimeCode = getMilliseconds();
+            mComputerSendTimeCode = lSlotPtr->mSendTime;
+            mComputerReceiveTimeCode = lSlotPtr->mReceiveTime;
+            ScanTiming::Stamps_t lStamps = lSlotPtr->mStamps;
+            result = lSlotPtr->mResult;
+            if (ERR_SUCCESS == result)
+            {
+                result = mScanView.attach(lSlotPtr->mFrame, lSlotPtr->mFrameLength);
+            }
+            if (ERR_SUCCESS == result)
+            {
+                result = mScan.assign(mScanView);
+            }
+
+            // hand the slot back to the acquisition, the scan data are copied
+            mScanView.clear();
+            lScanAcquisition.releaseScan();
 
-            // process the scan data and show result
+            // process the scan data and show result; slow output does not delay the acquisition
             if (ERR_SUCCESS == result)
             {
-            	// WARNING "printf()" routine extensively used in this calls causes lost scans
                 result = processScan();
                 logScan();
+
+                // count where the time of the scan went
+                lStamps.mTime[ScanTiming::STAGE_PROCESSED] = MonotonicClock::getNanoseconds();
+                mTiming.record(lStamps);
             }
 
             // or process the error code
-            if (ERR_SUCCESS != result)
+            if (ERR_END_OF_STREAM == result)
+            {
+                logMessage("End of the data stream");
+            }
+            else if (ERR_SUCCESS != result)
             {
                 logError(result);
             }
 
-            // sleep 1000msec
-            sleep_msecs(1000);
+            // hand the output of the scan to the writer
+            mLog.flush();
+
+            // a replayed recording has ended: nothing more to receive
+            if (ERR_END_OF_STREAM == result)
+            {
+                break;
+            }
         } // end while not terminated
 
+        // the connection and the console are ours again
+        lScanAcquisition.stop();
+        mLog.stop();
+
         // terminal mode restore on linux for kbhit of isTerminated().
         changemode(0);
 
+        // scans dropped because processing was too slow
+        if (0 != lScanAcquisition.getOverruns())
+        {
+            string128_t lMessage;
+            sprintf(lMessage, "%u scans dropped, processing too slow",
+                    static_cast<unsigned int>(lScanAcquisition.getOverruns()));
+            logMessage(lMessage);
+        }
+
+        // console lines dropped because the console was too slow
+        if (0 != mLog.getDroppedLines())
+        {
+            string128_t lMessage;
+            sprintf(lMessage, "%u console lines dropped, output too slow", mLog.getDroppedLines());
+            logMessage(lMessage);
+        }
+
+        // where the time of the scans went
+        mTiming.log(mLog);
+
         // SCAN command: end the scan sequence
         logMessage("End Scan... \\ /  \r\n");
         mSCANCommand.setParameter(0);
@@ -434,6 +470,6 @@ ScanPrint::setTerminateCondition()
 void
 ScanPrint::setTerminalLogFile(FILE* theTerminalLogName)
 {
-    mTerminalLogFile = theTerminalLogName;
+    mLog.setLogFile(theTerminalLogName);
 }
 
@@ -0,0 +1,292 @@
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       ScanRecorder.cpp
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ *
+ ****************************************************************************
+ */
+
+// recordings of some hours exceed 2 GB, also on 32 bit boards
+#define _FILE_OFFSET_BITS 64
+
+#include <cstring>
+#include <sys/time.h>
+
+#include "ScanRecorder.hpp"
+
+// needed for htonl
+#if defined(__WIN32__) || (defined(__CYGWIN__) && !defined(_WIN32))
+	#include <winsock2.h>
+	#define fseeko _fseeki64
+	#define ftello _ftelli64
+#elif defined(__linux__)
+	#include <arpa/inet.h>
+#else
+	#error "This program requires Linux or Win32."
+#endif
+
+/*
+ * Standard constructor.
+ */
+ScanRecorder::ScanRecorder() :
+        mFile(0), //
+        mFileName(), //
+        mBufferPtr(0), //
+        mOffset(0), //
+        mIndexOffset(0), //
+        mIndex(), //
+        mNumberOfIndexEntries(0), //
+        mNumberOfScans(0)
+{
+    // nothing more to do.
+}
+
+/*
+ * Standard destructor.
+ */
+ScanRecorder::~ScanRecorder()
+{
+    close();
+}
+
+/*
+ * Returns the current system time in us.
+ */
+uint64_t
+ScanRecorder::getMicroseconds()
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL); // get current time
+    return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+
+/*
+ * Writes integers in network byte order.
+ */
+ErrorID_t
+ScanRecorder::writeIntegers(const uint32_t* theIntegerPtr, int32_t theNumberOfIntegers)
+{
+    uint32_t lIntegers[8];
+
+    for (int32_t l = 0; l < theNumberOfIntegers; l += 8)
+    {
+        const int32_t lCount = (theNumberOfIntegers - l < 8) ? theNumberOfIntegers - l : 8;
+        for (int32_t i = 0; i < lCount; i++)
+        {
+            lIntegers[i] = htonl(theIntegerPtr[l + i]);
+        }
+        if (1 != fwrite(lIntegers, lCount * sizeof(uint32_t), 1, mFile))
+        {
+            return ERR_IO;
+        }
+    }
+    return ERR_SUCCESS;
+}
+
+/*
+ * Writes an index record of the scans since the last one.
+ */
+ErrorID_t
+ScanRecorder::writeIndex()
+{
+    if (0 == mNumberOfIndexEntries)
+    {
+        return ERR_SUCCESS;
+    }
+
+    const uint32_t lPayloadSize = 2 * sizeof(uint32_t) + sizeof(uint32_t)
+            + mNumberOfIndexEntries * 4 * sizeof(uint32_t);
+    const uint32_t lHeader[] = { TAG_INDEX, lPayloadSize, //
+            static_cast<uint32_t>(mIndexOffset >> 32), static_cast<uint32_t>(mIndexOffset), //
+            static_cast<uint32_t>(mNumberOfIndexEntries) };
+    ErrorID_t result = writeIntegers(lHeader, sizeof(lHeader) / sizeof(lHeader[0]));
+
+    for (int32_t l = 0; (ERR_SUCCESS == result) && (l < mNumberOfIndexEntries); l++)
+    {
+        const uint32_t lEntry[] = { //
+                static_cast<uint32_t>(mIndex[l].mOffset >> 32), static_cast<uint32_t>(mIndex[l].mOffset), //
+                static_cast<uint32_t>(mIndex[l].mTimestamp >> 32), static_cast<uint32_t>(mIndex[l].mTimestamp) };
+        result = writeIntegers(lEntry, 4);
+    }
+
+    mIndexOffset = mOffset;
+    mOffset += RECORD_HEADER_SIZE + lPayloadSize;
+    mNumberOfIndexEntries = 0;
+    return result;
+}
+
+/*
+ * Checks the file header of an existing recording, or writes it into a new file.
+ */
+ErrorID_t
+ScanRecorder::prepareFile()
+{
+    if (0 != fseeko(mFile, 0, SEEK_END))
+    {
+        return ERR_IO;
+    }
+    mOffset = ftello(mFile);
+
+    // new file
+    if (0 == mOffset)
+    {
+        const uint32_t lHeader[] = { FILE_MAGIC, FORMAT_VERSION, FILE_HEADER_SIZE, 0 };
+        mOffset = FILE_HEADER_SIZE;
+        return writeIntegers(lHeader, sizeof(lHeader) / sizeof(lHeader[0]));
+    }
+
+    // existing recording: append, never overwrite something else
+    uint32_t lHeader[4] = { 0 };
+    if ((0 != fseeko(mFile, 0, SEEK_SET)) || (1 != fread(lHeader, sizeof(lHeader), 1, mFile))
+            || (FILE_MAGIC != ntohl(lHeader[0])) || (FORMAT_VERSION != ntohl(lHeader[1])))
+    {
+        return ERR_IO;
+    }
+
+    // a write must follow a positioning after a read
+    return (0 == fseeko(mFile, 0, SEEK_END)) ? ERR_SUCCESS : ERR_IO;
+}
+
+/*
+ * Opens a recording.
+ */
+ErrorID_t
+ScanRecorder::open(const char* theFileName)
+{
+    close();
+
+    strncpy(mFileName, theFileName, sizeof(mFileName) - 1);
+    mFileName[sizeof(mFileName) - 1] = 0;
+    mIndexOffset = 0;
+    mNumberOfIndexEntries = 0;
+    mNumberOfScans = 0;
+
+    mFile = fopen(mFileName, "a+b");
+    if (0 == mFile)
+    {
+        return ERR_IO;
+    }
+
+    // the buffer must be set before the first access
+    mBufferPtr = new char[BUFFER_SIZE];
+    setvbuf(mFile, mBufferPtr, _IOFBF, BUFFER_SIZE);
+
+    const ErrorID_t result = prepareFile();
+    if (ERR_SUCCESS != result)
+    {
+        fclose(mFile);
+        mFile = 0;
+        delete[] mBufferPtr;
+        mBufferPtr = 0;
+    }
+    return result;
+}
+
+/*
+ * Writes the last index record and closes the recording.
+ */
+ErrorID_t
+ScanRecorder::close()
+{
+    ErrorID_t result = ERR_SUCCESS;
+
+    if (0 != mFile)
+    {
+        result = writeIndex();
+        if ((0 != fclose(mFile)) && (ERR_SUCCESS == result))
+        {
+            result = ERR_IO;
+        }
+        mFile = 0;
+    }
+    delete[] mBufferPtr;
+    mBufferPtr = 0;
+    return result;
+}
+
+/*
+ * Records a response with the current time.
+ */
+ErrorID_t
+ScanRecorder::writeScan(const void* theFramePtr, int32_t theLength)
+{
+    return writeScan(theFramePtr, theLength, getMicroseconds());
+}
+
+/*
+ * Records a response.
+ */
+ErrorID_t
+ScanRecorder::writeScan(const void* theFramePtr, int32_t theLength, uint64_t theTimestamp)
+{
+    static const char sPadding[sizeof(uint32_t)] = { 0 };
+
+    if (0 == mFile)
+    {
+        return ERR_IO;
+    }
+    if (0 > theLength)
+    {
+        return ERR_INVALID_PARAMETER;
+    }
+
+    // the records stay aligned to integers
+    const uint32_t lPadding = (sizeof(uint32_t) - (theLength % sizeof(uint32_t))) % sizeof(uint32_t);
+    const uint32_t lPayloadSize = 2 * sizeof(uint32_t) + theLength + lPadding;
+    const uint32_t lHeader[] = { TAG_SCAN, lPayloadSize, //
+            static_cast<uint32_t>(theTimestamp >> 32), static_cast<uint32_t>(theTimestamp) };
+
+    ErrorID_t result = writeIntegers(lHeader, sizeof(lHeader) / sizeof(lHeader[0]));
+    if ((ERR_SUCCESS == result) && (0 < theLength) && (1 != fwrite(theFramePtr, theLength, 1, mFile)))
+    {
+        result = ERR_IO;
+    }
+    if ((ERR_SUCCESS == result) && (0 < lPadding) && (1 != fwrite(sPadding, lPadding, 1, mFile)))
+    {
+        result = ERR_IO;
+    }
+    if (ERR_SUCCESS != result)
+    {
+        return result;
+    }
+
+    mIndex[mNumberOfIndexEntries].mOffset = mOffset;
+    mIndex[mNumberOfIndexEntries].mTimestamp = theTimestamp;
+    mNumberOfIndexEntries++;
+    mOffset += RECORD_HEADER_SIZE + lPayloadSize;
+    mNumberOfScans++;
+
+    if (INDEX_INTERVAL <= mNumberOfIndexEntries)
+    {
+        result = writeIndex();
+    }
+    return result;
+}
+
+/*
+ * Writes the buffered records to the file.
+ */
+ErrorID_t
+ScanRecorder::flush()
+{
+    if (0 == mFile)
+    {
+        return ERR_IO;
+    }
+    return (0 == fflush(mFile)) ? ERR_SUCCESS : ERR_IO;
+}
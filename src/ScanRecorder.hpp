@@ -0,0 +1,271 @@
+#ifndef SCANRECORDER_HPP_
+#define SCANRECORDER_HPP_
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       ScanRecorder.hpp - Records received scans in a file.
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ ****************************************************************************
+ */
+
+#include <cstdio>
+extern "C"
+{
+#include "ErrorID.h"
+}
+#include "Global.hpp"
+
+/**
+ * Class ScanRecorder - append-only recording of the received responses.
+ * <p>&nbsp;<p>
+ * The file is opened once and written through a large buffer, so a
+ * recording costs no file open and close per scan and the SD card of a
+ * board is written in large blocks. Recordings are appended: a file which
+ * already holds a recording is continued, a new file gets the file header.
+ * <p>
+ * File format; all integers in network byte order, like the responses:
+ * <pre>
+ * file header:   'PSRC', format version, size of the file header, 0
+ * scan record:   'SCAN', size of the payload,
+ *                timestamp in us since 1970 (high, low 32 bits),
+ *                the response as received, padded to a multiple of 4 bytes
+ * index record:  'INDX', size of the payload,
+ *                file offset of the previous index record (high, low), or 0,
+ *                number of entries,
+ *                per entry: file offset of a scan record (high, low),
+ *                           timestamp of the scan (high, low)
+ * </pre>
+ * A record is the tag, the payload size and the payload, so a reader can
+ * skip records it does not know. An index record follows every
+ * INDEX_INTERVAL scans and the last scans of a session; it lists the
+ * scans since the previous index record. A reader may search the
+ * recording by the index records, or read the scan records one after
+ * the other if the recording was cut off.
+ * <p>
+ * Not thread safe: record from one thread only.
+ */
+class ScanRecorder
+{
+    public:
+
+        /** class constants */
+        enum ScanRecorderConstants_t
+        {
+            /** 'PSRC': first integer of a recording */
+            FILE_MAGIC = 0x50535243,
+
+            /** version of the file format */
+            FORMAT_VERSION = 1,
+
+            /** size of the file header in bytes */
+            FILE_HEADER_SIZE = 4 * sizeof(uint32_t),
+
+            /** 'SCAN': tag of a scan record */
+            TAG_SCAN = 0x5343414E,
+
+            /** 'INDX': tag of an index record */
+            TAG_INDEX = 0x494E4458,
+
+            /** size of the tag and the payload size of a record in bytes */
+            RECORD_HEADER_SIZE = 2 * sizeof(uint32_t),
+
+            /** number of scans between two index records */
+            INDEX_INTERVAL = 256,
+
+            /** size of the file buffer in bytes */
+            BUFFER_SIZE = 256 * 1024
+        };
+
+    private:
+
+        /**
+         * An entry of an index record.
+         */
+        struct IndexEntry_t
+        {
+                /** file offset of the scan record */
+                uint64_t mOffset;
+
+                /** timestamp of the scan in us */
+                uint64_t mTimestamp;
+        };
+
+        /** the file, or 0 if closed */
+        FILE* mFile;
+
+        /** name of the file; kept after a failed open() */
+        string128_t mFileName;
+
+        /** the file buffer, allocated by open() */
+        char* mBufferPtr;
+
+        /** file offset of the next record */
+        uint64_t mOffset;
+
+        /** file offset of the last index record, or 0 */
+        uint64_t mIndexOffset;
+
+        /** the scans since the last index record */
+        IndexEntry_t mIndex[INDEX_INTERVAL];
+
+        /** number of entries in mIndex */
+        int32_t mNumberOfIndexEntries;
+
+        /** number of scans recorded since open() */
+        uint32_t mNumberOfScans;
+
+        /**
+         * Returns the current system time in us.
+         */
+        static uint64_t
+        getMicroseconds();
+
+        /**
+         * Writes integers in network byte order.
+         *
+         * @return
+         *      ERR_SUCCESS if OK, ERR_IO if the file cannot be written.
+         */
+        ErrorID_t
+        writeIntegers(const uint32_t* theIntegerPtr, int32_t theNumberOfIntegers);
+
+        /**
+         * Writes an index record of the scans since the last one.
+         *
+         * @return
+         *      ERR_SUCCESS if OK, ERR_IO if the file cannot be written.
+         */
+        ErrorID_t
+        writeIndex();
+
+        /**
+         * Checks the file header of an existing recording, or writes it
+         * into a new file.
+         *
+         * @return
+         *      ERR_SUCCESS if OK, ERR_IO if the file holds something else.
+         */
+        ErrorID_t
+        prepareFile();
+
+        /* private assignment constructor to avoid misuse */
+        explicit
+        ScanRecorder(const ScanRecorder& src);
+
+        /* private assignment operator to avoid misuse */
+        ScanRecorder&
+        operator =(const ScanRecorder& src);
+
+    public:
+
+        /**
+         * Constructor. Creates a closed recorder.
+         */
+        ScanRecorder();
+
+        /**
+         * Destructor. Closes the recording.
+         */
+        virtual
+        ~ScanRecorder();
+
+        /**
+         * Opens a recording. An open recording is closed before.
+         *
+         * @param theFileName
+         *      the file; created if it does not exist, appended otherwise.
+         * @return
+         *      ERR_SUCCESS if OK, ERR_IO if the file cannot be opened or
+         *      holds something else than a recording.
+         */
+        ErrorID_t
+        open(const char* theFileName);
+
+        /**
+         * Writes the last index record and closes the recording.
+         *
+         * @return
+         *      ERR_SUCCESS if OK, ERR_IO if the file cannot be written.
+         */
+        ErrorID_t
+        close();
+
+        /**
+         * Returns true if the recording is open.
+         */
+        bool
+        isOpen() const
+        {
+            return (0 != mFile);
+        }
+
+        /**
+         * Returns the name given to the last open(), or an empty string.
+         */
+        const char*
+        getFileName() const
+        {
+            return mFileName;
+        }
+
+        /**
+         * Returns the number of scans recorded since open().
+         */
+        uint32_t
+        getNumberOfScans() const
+        {
+            return mNumberOfScans;
+        }
+
+        /**
+         * Records a response with the current time.
+         *
+         * @param theFramePtr
+         *      the response as received, in network byte order.
+         * @param theLength
+         *      number of bytes of the response.
+         * @return
+         *      ERR_SUCCESS if OK, ERR_IO if the file cannot be written.
+         */
+        ErrorID_t
+        writeScan(const void* theFramePtr, int32_t theLength);
+
+        /**
+         * Records a response.
+         *
+         * @param theFramePtr
+         *      the response as received, in network byte order.
+         * @param theLength
+         *      number of bytes of the response.
+         * @param theTimestamp
+         *      time of reception in us since 1970.
+         * @return
+         *      ERR_SUCCESS if OK, ERR_IO if the file cannot be written.
+         */
+        ErrorID_t
+        writeScan(const void* theFramePtr, int32_t theLength, uint64_t theTimestamp);
+
+        /**
+         * Writes the buffered records to the file.
+         *
+         * @return
+         *      ERR_SUCCESS if OK, ERR_IO if the file cannot be written.
+         */
+        ErrorID_t
+        flush();
+};
+
+#endif /* SCANRECORDER_HPP_ */
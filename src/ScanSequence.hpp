@@ -29,6 +29,9 @@
 
 #include "Global.hpp"
 #include "GSCNCommand.hpp"
+#include "AsyncLog.hpp"
+#include "ScanTiming.hpp"
+#include "ScanView.hpp"
 #include "SCANCommand.hpp"
 #include "ErrorID.h"
 class IDataStream;
@@ -66,6 +69,9 @@ class ScanSequence
             /** if this flag is set shows the example lost scans only */
             SHOW_LOST_SCANS_ONLY = 1,
 
+            /** ms to wait for a scan before the terminating condition is checked again */
+            SCAN_WAIT_TIME = 100,
+
             /** distance is this value in case of noise/too strong echoes */
             NOISE = INT32_MAX,
 
@@ -93,8 +99,11 @@ class ScanSequence
         /** Number of scans requested by the computer */
         int32_t mNumberOfScans;
 
-        /** the scan data */
-        GSCNCommand::Scan_t mScan;
+        /** number of GSCN requests kept in flight; 1 for request/response */
+        int32_t mPipelineDepth;
+
+        /** view on the scan taken from the acquisition; only the parameters are used */
+        ScanView mScan;
 
         /** the SCAN command */
         SCANCommand mSCANCommand;
@@ -111,15 +120,18 @@ class ScanSequence
         /** ms when the sequence was started */
         unsigned int mStartTime;
 
-        /** the terminal log file */
-        FILE* mTerminalLogFile;
+        /** the terminal output and log file */
+        AsyncLog mLog;
+
+        /** latency histograms of the scan stages */
+        ScanTiming mTiming;
 
         /**
-         * Returns the current system time in ms.
-         * Watch out for timer overflows.
+         * Returns the time of the monotonic clock in ms.
+         * Watch out for timer overflows: compare differences only.
          *
          * @return
-         *      local time in ms.
+         *      time in ms.
          */
         static unsigned int
         getMilliseconds();
@@ -146,6 +158,7 @@ class ScanSequence
         /**
          * Example code: Proofs the terminating condition.
          * Here: check for ESC or if the sequence has expired.
+         * Shows the latency histograms on 'h'.
          * Note: in Eclipse IDE will ESC not work.
          */
         virtual bool
@@ -250,6 +263,18 @@ class ScanSequence
          */
         void
         setTerminalLogFile(FILE* theTerminalLogName);
+
+        /**
+         * Defines the number of GSCN requests kept in flight.
+         * With more than one, the scans are requested in advance by a
+         * ScanPipeline; the sensor does not wait for the computer then.
+         *
+         * @param thePipelineDepth
+         *      number of outstanding requests; 1 (default) waits for each response.
+         *      Limited to 1 ... ScanPipeline::MAX_DEPTH.
+         */
+        void
+        setPipelineDepth(int32_t thePipelineDepth);
 };
 
 #endif /* SCANSEQUENCE_HPP_ */
@@ -0,0 +1,106 @@
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       ScanTiming.cpp
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ *
+ ****************************************************************************
+ */
+
+#include "ScanTiming.hpp"
+#include "AsyncLog.hpp"
+
+/* ns to us */
+#define NS_TO_US(t) (0.001 * (t))
+
+/*
+ * Returns the duration between two stages, 0 if they are out of order.
+ */
+static inline uint64_t
+getDuration(uint64_t theStart, uint64_t theEnd)
+{
+    return (theEnd > theStart) ? (theEnd - theStart) : 0;
+}
+
+/*
+ * Standard constructor.
+ */
+ScanTiming::ScanTiming() :
+        mHistograms()
+{
+    // nothing more to do.
+}
+
+/*
+ * Standard destructor.
+ */
+ScanTiming::~ScanTiming()
+{
+    // nothing to be done.
+}
+
+/*
+ * Counts the durations of a scan.
+ */
+void
+ScanTiming::record(const Stamps_t& theStamps)
+{
+    const uint64_t* const lTime = theStamps.mTime;
+
+    mHistograms[INTERVAL_RESPONSE].record(getDuration(lTime[STAGE_SEND], lTime[STAGE_FIRST_BYTE]));
+    mHistograms[INTERVAL_TRANSFER].record(getDuration(lTime[STAGE_FIRST_BYTE], lTime[STAGE_LAST_BYTE]));
+    mHistograms[INTERVAL_PARSE].record(getDuration(lTime[STAGE_LAST_BYTE], lTime[STAGE_PARSED]));
+    mHistograms[INTERVAL_PROCESS].record(getDuration(lTime[STAGE_PARSED], lTime[STAGE_PROCESSED]));
+    mHistograms[INTERVAL_TOTAL].record(getDuration(lTime[STAGE_SEND], lTime[STAGE_PROCESSED]));
+}
+
+/*
+ * Removes all durations.
+ */
+void
+ScanTiming::reset()
+{
+    for (int32_t l = 0; l < NUMBER_OF_INTERVALS; l++)
+    {
+        mHistograms[l].reset();
+    }
+}
+
+/*
+ * Writes a table of the percentiles in us.
+ */
+void
+ScanTiming::log(AsyncLog& theLog) const
+{
+    static const char* const sNames[NUMBER_OF_INTERVALS] =
+    { "send-first byte", "first-last byte", "last byte-parsed", "parsed-processed", "total" };
+
+    theLog.print(AsyncLog::LOG_ALL, "\r\n%-16s; %8s; %9s; %9s; %9s; %9s; %9s; %9s; %9s;\r\n", //
+            "Latency [us]", "Scans", "Min", "Mean", "50%", "90%", "99%", "99.9%", "Max");
+
+    for (int32_t l = 0; l < NUMBER_OF_INTERVALS; l++)
+    {
+        const LatencyHistogram& lHistogram = mHistograms[l];
+
+        theLog.print(AsyncLog::LOG_ALL, "%-16s; %8u; %9.1f; %9.1f; %9.1f; %9.1f; %9.1f; %9.1f; %9.1f;\r\n", //
+                sNames[l], static_cast<unsigned int>(lHistogram.getTotalCount()), //
+                NS_TO_US(lHistogram.getMin()), NS_TO_US(lHistogram.getMean()),
+                NS_TO_US(lHistogram.getValueAtPercentile(50.0)), NS_TO_US(lHistogram.getValueAtPercentile(90.0)),
+                NS_TO_US(lHistogram.getValueAtPercentile(99.0)), NS_TO_US(lHistogram.getValueAtPercentile(99.9)),
+                NS_TO_US(lHistogram.getMax()));
+    }
+    theLog.flush();
+}
@@ -0,0 +1,152 @@
+#ifndef SCANTIMING_HPP_
+#define SCANTIMING_HPP_
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       ScanTiming.hpp - Where the time of each scan goes.
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ ****************************************************************************
+ */
+
+#include "Global.hpp"
+#include "LatencyHistogram.hpp"
+
+class AsyncLog;
+
+/**
+ * Class ScanTiming - latency histograms of the stages of the scan loops.
+ * <p>&nbsp;<p>
+ * Each scan is stamped with the monotonic clock in ns at five stages:
+ * <ul>
+ * <li>send: the acquisition requests the scan. With a pipeline the
+ * request was sent in advance, so this is the start of the wait.
+ * <li>first byte: the first byte of the response arrived. The streams
+ * which receive a frame at once (sockets) do not tell, then it is the
+ * last byte.
+ * <li>last byte: the response is complete.
+ * <li>parsed: the CRC is verified and the scan is parsed and recorded.
+ * <li>processed: the scan loop has processed and logged the scan.
+ * </ul>
+ * The durations between the stages and the total are counted in a
+ * LatencyHistogram each, so the percentiles show where the time of a
+ * scan actually goes, e.g. waiting for the sensor, transferring the
+ * frame on a UART, or queuing behind a slow console.
+ */
+class ScanTiming
+{
+    public:
+
+        /** the stages of a scan */
+        enum Stage_t
+        {
+            STAGE_SEND, //
+            STAGE_FIRST_BYTE, //
+            STAGE_LAST_BYTE, //
+            STAGE_PARSED, //
+            STAGE_PROCESSED, //
+            NUMBER_OF_STAGES
+        };
+
+        /** the durations counted */
+        enum Interval_t
+        {
+            /** send to first byte: request and wait for the sensor */
+            INTERVAL_RESPONSE, //
+
+            /** first byte to last byte: transfer of the frame */
+            INTERVAL_TRANSFER, //
+
+            /** last byte to parsed: CRC, parsing and recording */
+            INTERVAL_PARSE, //
+
+            /** parsed to processed: queuing and processing */
+            INTERVAL_PROCESS, //
+
+            /** send to processed */
+            INTERVAL_TOTAL, //
+
+            NUMBER_OF_INTERVALS
+        };
+
+        /** the time stamps of a scan in ns of the MonotonicClock */
+        struct Stamps_t
+        {
+                uint64_t mTime[NUMBER_OF_STAGES];
+        };
+
+    private:
+
+        /** a histogram per interval */
+        LatencyHistogram mHistograms[NUMBER_OF_INTERVALS];
+
+        /* private assignment constructor to avoid misuse */
+        explicit
+        ScanTiming(const ScanTiming& src);
+
+        /* private assignment operator to avoid misuse */
+        ScanTiming&
+        operator =(const ScanTiming& src);
+
+    public:
+
+        /**
+         * Standard constructor. The histograms are empty.
+         */
+        ScanTiming();
+
+        /**
+         * Destructor.
+         */
+        virtual
+        ~ScanTiming();
+
+        /**
+         * Counts the durations of a scan.
+         *
+         * @param theStamps
+         *      the time stamps of all stages; a stage before the previous
+         *      one counts as 0.
+         */
+        void
+        record(const Stamps_t& theStamps);
+
+        /**
+         * Removes all durations.
+         */
+        void
+        reset();
+
+        /**
+         * Returns the histogram of an interval.
+         */
+        const LatencyHistogram&
+        getHistogram(Interval_t theInterval) const
+        {
+            return mHistograms[theInterval];
+        }
+
+        /**
+         * Writes a table of the percentiles in us to the console and
+         * the log file.
+         *
+         * @param theLog
+         *      the terminal output.
+         */
+        void
+        log(AsyncLog& theLog) const;
+};
+
+#endif /* SCANTIMING_HPP_ */
@@ -0,0 +1,136 @@
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       ScanView.cpp
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ *
+ ****************************************************************************
+ */
+
+#include "ScanView.hpp"
+#include "GSCNCommand.hpp"
+
+/*
+ * Standard constructor.
+ */
+ScanView::ScanView() :
+        mFramePtr(0), //
+        mFrameLength(0), //
+        mParameterPtr(0), //
+        mNumberOfParameter(0), //
+        mDataPtr(0), //
+        mNumberOfPoints(0), //
+        mNumberOfEchoes(0), //
+        mIntegersPerEcho(0)
+{
+    // nothing more to do.
+}
+
+/*
+ * Makes the view empty.
+ */
+void
+ScanView::clear()
+{
+    mFramePtr = 0;
+    mFrameLength = 0;
+    mParameterPtr = 0;
+    mNumberOfParameter = 0;
+    mDataPtr = 0;
+    mNumberOfPoints = 0;
+    mNumberOfEchoes = 0;
+    mIntegersPerEcho = 0;
+}
+
+/*
+ * Attaches the view to a received response. GSCN and GSC2 responses share
+ * the layout: command ID, length, number of parameters, parameters,
+ * number of points, data block and CRC.
+ */
+ErrorID_t
+ScanView::attach(const void* theBuffer, int32_t theBufferLength)
+{
+    const uint32_t* const lBufferPtr = static_cast<const uint32_t*>(theBuffer);
+    const int32_t lIntegers = theBufferLength / sizeof(uint32_t) - 1; // without CRC
+    int32_t lIndex = 2; // skip command ID and length
+
+    clear();
+
+    // number of parameters; the number of points must follow
+    if ((0 == theBuffer) || (lIndex >= lIntegers))
+    {
+        return ERR_BUFFER_OVERFLOW;
+    }
+    const int32_t lNumberOfParameter = toHost(lBufferPtr[lIndex++]);
+    if ((0 > lNumberOfParameter) || ((lIntegers - lIndex) <= lNumberOfParameter))
+    {
+        return ERR_BUFFER_OVERFLOW;
+    }
+    const uint32_t* const lParameterPtr = &lBufferPtr[lIndex];
+    lIndex += lNumberOfParameter;
+
+    // number of echoes. If 0, then the master echo is transfered instead of the number
+    int32_t lNumberOfEchoes = 0;
+    if (GSCNCommand::PARAMETER_NUMBER_OF_ECHOES < lNumberOfParameter)
+    {
+        lNumberOfEchoes = toHost(lParameterPtr[GSCNCommand::PARAMETER_NUMBER_OF_ECHOES]);
+    }
+    if (0 == lNumberOfEchoes)
+    {
+        lNumberOfEchoes = 1;
+    }
+
+    // number of points, check limits
+    const int32_t lNumberOfPoints = toHost(lBufferPtr[lIndex++]);
+    if ((GSCNCommand::MAX_NUMBER_OF_ECHOS < lNumberOfEchoes) || (GSCNCommand::MAX_POINTS_PER_SCAN < lNumberOfPoints)
+            || (0 > lNumberOfEchoes) || (0 > lNumberOfPoints))
+    {
+        return ERR_BUFFER_OVERFLOW;
+    }
+
+    // integers per echo according to the data content
+    int32_t lIntegersPerEcho = 0;
+    int32_t lDataContent = 0;
+    if (GSCNCommand::PARAMETER_DATA_CONTENT < lNumberOfParameter)
+    {
+        lDataContent = toHost(lParameterPtr[GSCNCommand::PARAMETER_DATA_CONTENT]);
+    }
+    switch (lDataContent)
+    {
+        case GSCNCommand::NO_DATABLOCK:
+            break;
+        case GSCNCommand::DATABLOCK_WITH_DISTANCES:
+            lIntegersPerEcho = 1;
+            break;
+        default:
+            lIntegersPerEcho = 2;
+            break;
+    }
+    if ((lIntegers - lIndex) < (lIntegersPerEcho * lNumberOfEchoes * lNumberOfPoints))
+    {
+        return ERR_BUFFER_OVERFLOW;
+    }
+
+    mFramePtr = theBuffer;
+    mFrameLength = theBufferLength;
+    mParameterPtr = lParameterPtr;
+    mNumberOfParameter = lNumberOfParameter;
+    mDataPtr = &lBufferPtr[lIndex];
+    mNumberOfPoints = lNumberOfPoints;
+    mNumberOfEchoes = lNumberOfEchoes;
+    mIntegersPerEcho = lIntegersPerEcho;
+    return ERR_SUCCESS;
+}
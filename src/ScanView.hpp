@@ -0,0 +1,391 @@
+#ifndef SCANVIEW_HPP_
+#define SCANVIEW_HPP_
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       ScanView.hpp - Read-only view on a received scan.
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ ****************************************************************************
+ */
+
+extern "C"
+{
+#include "ErrorID.h"
+}
+#include "Global.hpp"
+
+/**
+ * Class ScanView - read-only view on a GSCN or GSC2 response.
+ * <p>&nbsp;<p>
+ * The view indexes into the receiver buffer of the command and converts
+ * a value from network byte order only when it is read. Nothing is copied,
+ * so a consumer which needs the scan parameters only does not pay for the
+ * points.
+ * <p>
+ * The view is valid until the next command is performed on the buffer.
+ * <p>
+ * Example:
+ * <pre>
+ * for (ScanView::Point lPoint : lScanView)
+ * {
+ *     for (ScanView::Echo lEcho : lPoint)
+ *     {
+ *         lSum += lEcho.getDistance();
+ *     }
+ * }
+ * </pre>
+ */
+class ScanView
+{
+    public:
+
+        /**
+         * Iterates over points or echoes, which are stored with a fixed stride.
+         */
+        template<class Value_t>
+        class Iterator_t
+        {
+                /** the current element in the receiver buffer */
+                const uint32_t* mDataPtr;
+
+                /** number of echoes of a point */
+                int32_t mNumberOfEchoes;
+
+                /** number of integers of an echo */
+                int32_t mIntegersPerEcho;
+
+            public:
+
+                /** Constructor. */
+                Iterator_t(const uint32_t* theDataPtr, int32_t theNumberOfEchoes, int32_t theIntegersPerEcho) :
+                        mDataPtr(theDataPtr), //
+                        mNumberOfEchoes(theNumberOfEchoes), //
+                        mIntegersPerEcho(theIntegersPerEcho)
+                {
+                }
+
+                /** Returns the current element. */
+                Value_t
+                operator *() const
+                {
+                    return Value_t(mDataPtr, mNumberOfEchoes, mIntegersPerEcho);
+                }
+
+                /** Moves to the next element. */
+                Iterator_t&
+                operator ++()
+                {
+                    mDataPtr += Value_t::getStride(mNumberOfEchoes, mIntegersPerEcho);
+                    return *this;
+                }
+
+                /** Compares the position. */
+                bool
+                operator ==(const Iterator_t& theOther) const
+                {
+                    return (mDataPtr == theOther.mDataPtr);
+                }
+
+                /** Compares the position. */
+                bool
+                operator !=(const Iterator_t& theOther) const
+                {
+                    return (mDataPtr != theOther.mDataPtr);
+                }
+        };
+
+        /**
+         * A single echo of a point.
+         */
+        class Echo
+        {
+                /** distance and pulse width in the receiver buffer */
+                const uint32_t* mDataPtr;
+
+                /** number of integers of an echo: 1 (distance) or 2 (and pulse width) */
+                int32_t mIntegersPerEcho;
+
+            public:
+
+                /** Constructor. The number of echoes is not needed. */
+                Echo(const uint32_t* theDataPtr, int32_t, int32_t theIntegersPerEcho) :
+                        mDataPtr(theDataPtr), //
+                        mIntegersPerEcho(theIntegersPerEcho)
+                {
+                }
+
+                /** Returns the distance between two echoes in integers. */
+                static int32_t
+                getStride(int32_t, int32_t theIntegersPerEcho)
+                {
+                    return theIntegersPerEcho;
+                }
+
+                /** Returns the raw distance. */
+                int32_t
+                getDistance() const
+                {
+                    return toHost(mDataPtr[0]);
+                }
+
+                /** Returns the pulse width, or 0 if not transmitted. */
+                int32_t
+                getPulseWidth() const
+                {
+                    return (1 < mIntegersPerEcho) ? toHost(mDataPtr[1]) : 0;
+                }
+        };
+
+        /**
+         * A point with its echoes.
+         */
+        class Point
+        {
+                /** first echo in the receiver buffer */
+                const uint32_t* mDataPtr;
+
+                /** number of echoes of the point */
+                int32_t mNumberOfEchoes;
+
+                /** number of integers of an echo */
+                int32_t mIntegersPerEcho;
+
+            public:
+
+                /** Constructor. */
+                Point(const uint32_t* theDataPtr, int32_t theNumberOfEchoes, int32_t theIntegersPerEcho) :
+                        mDataPtr(theDataPtr), //
+                        mNumberOfEchoes(theNumberOfEchoes), //
+                        mIntegersPerEcho(theIntegersPerEcho)
+                {
+                }
+
+                /** Returns the distance between two points in integers. */
+                static int32_t
+                getStride(int32_t theNumberOfEchoes, int32_t theIntegersPerEcho)
+                {
+                    return theNumberOfEchoes * theIntegersPerEcho;
+                }
+
+                /** Returns the number of echoes. */
+                int32_t
+                getNumberOfEchoes() const
+                {
+                    return mNumberOfEchoes;
+                }
+
+                /** Returns an echo; theEcho must be less than getNumberOfEchoes(). */
+                Echo
+                operator [](int32_t theEcho) const
+                {
+                    return Echo(&mDataPtr[theEcho * mIntegersPerEcho], mNumberOfEchoes, mIntegersPerEcho);
+                }
+
+                /** Returns an iterator at the first echo. */
+                Iterator_t<Echo>
+                begin() const
+                {
+                    return Iterator_t<Echo>(mDataPtr, mNumberOfEchoes, mIntegersPerEcho);
+                }
+
+                /** Returns an iterator behind the last echo. */
+                Iterator_t<Echo>
+                end() const
+                {
+                    return Iterator_t<Echo>(&mDataPtr[mNumberOfEchoes * mIntegersPerEcho], mNumberOfEchoes,
+                            mIntegersPerEcho);
+                }
+        };
+
+    private:
+
+        /** the response in the receiver buffer */
+        const void* mFramePtr;
+
+        /** number of bytes of the response, including the CRC */
+        int32_t mFrameLength;
+
+        /** the parameters in the receiver buffer */
+        const uint32_t* mParameterPtr;
+
+        /** number of parameters sent by the sensor */
+        int32_t mNumberOfParameter;
+
+        /** the first point in the receiver buffer */
+        const uint32_t* mDataPtr;
+
+        /** number of points in the scan */
+        int32_t mNumberOfPoints;
+
+        /** number of echoes per point */
+        int32_t mNumberOfEchoes;
+
+        /** number of integers per echo; 0 if the scan has no data block */
+        int32_t mIntegersPerEcho;
+
+        /**
+         * Converts an integer from network byte order to host byte order.
+         */
+        static inline int32_t
+        toHost(uint32_t theValue)
+        {
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+            return theValue;
+#else
+            return __builtin_bswap32(theValue);
+#endif
+        }
+
+    public:
+
+        /**
+         * Constructor. Creates an empty view.
+         */
+        ScanView();
+
+        /**
+         * Makes the view empty.
+         */
+        void
+        clear();
+
+        /**
+         * Attaches the view to a received GSCN or GSC2 response.
+         * Checks the sizes against the length of the response; the CRC
+         * must have been checked before.
+         *
+         * @param theBuffer
+         *      the response in network byte order.
+         * @param theBufferLength
+         *      number of bytes received, including the CRC.
+         * @return
+         *      ERR_SUCCESS on success, otherwise a negative error code.
+         * @retval ERR_BUFFER_OVERFLOW
+         *      if the response is truncated or exceeds the limits of a scan.
+         *      The view is empty then.
+         */
+        ErrorID_t
+        attach(const void* theBuffer, int32_t theBufferLength);
+
+        /**
+         * Returns the response the view is attached to, or 0 for an empty view.
+         */
+        const void*
+        getFrame() const
+        {
+            return mFramePtr;
+        }
+
+        /**
+         * Returns the number of bytes of the response, including the CRC.
+         */
+        int32_t
+        getFrameLength() const
+        {
+            return mFrameLength;
+        }
+
+        /**
+         * Returns the number of parameters sent by the sensor; 0 for an empty view.
+         */
+        int32_t
+        getNumberOfParameter() const
+        {
+            return mNumberOfParameter;
+        }
+
+        /**
+         * Returns a scan parameter, or 0 if the sensor did not send it.
+         *
+         * @param theParameterID
+         *      one of GSCNCommand::GSCNParameterID_t.
+         */
+        int32_t
+        getParameter(int32_t theParameterID) const
+        {
+            return ((0 <= theParameterID) && (theParameterID < mNumberOfParameter)) ?
+                    toHost(mParameterPtr[theParameterID]) : 0;
+        }
+
+        /**
+         * Returns the number of points.
+         */
+        int32_t
+        getNumberOfPoints() const
+        {
+            return mNumberOfPoints;
+        }
+
+        /**
+         * Returns the number of echoes per point.
+         */
+        int32_t
+        getNumberOfEchoes() const
+        {
+            return mNumberOfEchoes;
+        }
+
+        /**
+         * Returns true if the scan contains a data block.
+         */
+        bool
+        hasData() const
+        {
+            return (0 != mIntegersPerEcho);
+        }
+
+        /**
+         * Returns true if the scan contains pulse widths.
+         */
+        bool
+        hasPulseWidth() const
+        {
+            return (1 < mIntegersPerEcho);
+        }
+
+        /**
+         * Returns a point; thePoint must be less than getNumberOfPoints()
+         * and the scan must contain a data block.
+         */
+        Point
+        operator [](int32_t thePoint) const
+        {
+            return Point(&mDataPtr[thePoint * mNumberOfEchoes * mIntegersPerEcho], mNumberOfEchoes,
+                    mIntegersPerEcho);
+        }
+
+        /**
+         * Returns an iterator at the first point.
+         * Scans without data block have no points to iterate.
+         */
+        Iterator_t<Point>
+        begin() const
+        {
+            return Iterator_t<Point>(mDataPtr, mNumberOfEchoes, mIntegersPerEcho);
+        }
+
+        /**
+         * Returns an iterator behind the last point.
+         */
+        Iterator_t<Point>
+        end() const
+        {
+            return Iterator_t<Point>(&mDataPtr[mNumberOfPoints * mNumberOfEchoes * mIntegersPerEcho],
+                    mNumberOfEchoes, mIntegersPerEcho);
+        }
+};
+
+#endif /* SCANVIEW_HPP_ */
@@ -0,0 +1,476 @@
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       SensorSimulator.cpp
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ *
+ ****************************************************************************
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include "SensorSimulator.hpp"
+#include "CRC32.hpp"
+#include "PointAvg.hpp"
+#include "ProgramVersion.hpp"
+
+// needed for htonl
+#if defined(__WIN32__) || (defined(__CYGWIN__) && !defined(_WIN32))
+	#include <winsock2.h>
+#elif defined(__linux__)
+	#include <arpa/inet.h>
+#else
+	#error "This program requires Linux or Win32."
+#endif
+
+/* size of the command ID, the length and the CRC of a frame */
+#define SIMULATOR_FRAME_OVERHEAD 12
+
+/* size of a GSC2 request: the frame with the scan and the point average number */
+#define SIMULATOR_GSC2_REQUEST_SIZE (SIMULATOR_FRAME_OVERHEAD + 8)
+
+/*
+ * Standard constructor.
+ */
+SensorSimulator::SensorSimulator() :
+        mNumberOfPoints(1000), //
+        mNumberOfEchoes(1), //
+        mDataContent(8), //
+        mNoEchoPercent(0), //
+        mNoisePercent(0), //
+        mScanRate(25), //
+        mLossPercent(0), //
+        mDelay(0), //
+        mSeed(1), //
+        mStartTime(0), //
+        mLastScanNumber(0), //
+        mParameters(), //
+        mSession(), //
+        mNumberOfRequests(0), //
+        mNumberOfLosses(0), //
+        mNumberOfScans(0)
+{
+    // nothing more to do.
+}
+
+/*
+ * Standard destructor.
+ */
+SensorSimulator::~SensorSimulator()
+{
+    // nothing to be done.
+}
+
+/*
+ * Scrambles a number (the finalizer of MurmurHash3).
+ */
+uint32_t
+SensorSimulator::mix(uint32_t theValue)
+{
+    theValue ^= theValue >> 16;
+    theValue *= 0x85EBCA6BU;
+    theValue ^= theValue >> 13;
+    theValue *= 0xC2B2AE35U;
+    theValue ^= theValue >> 16;
+    return theValue;
+}
+
+/*
+ * Writes the length and the CRC of a response.
+ */
+int32_t
+SensorSimulator::finishFrame(char* theFramePtr, int32_t theDataLength)
+{
+    CRC32 lCRC;
+    cast_ptr_t lFramePtr = { theFramePtr };
+    const int32_t lFrameLength = theDataLength + SIMULATOR_FRAME_OVERHEAD;
+
+    lFramePtr.asIntegerPtr[1] = htonl(theDataLength);
+    lFramePtr.asIntegerPtr[lFrameLength / sizeof(int32_t) - 1] = htonl(lCRC.get(theFramePtr, lFrameLength - 4));
+    return lFrameLength;
+}
+
+/*
+ * Builds an ERR response.
+ */
+int32_t
+SensorSimulator::buildError(char* theFramePtr, ErrorID_t theError)
+{
+    cast_ptr_t lFramePtr = { theFramePtr };
+
+    memcpy(theFramePtr, "ERR\0", 4);
+    lFramePtr.asIntegerPtr[2] = htonl(theError);
+    return finishFrame(theFramePtr, sizeof(int32_t));
+}
+
+/*
+ * Returns the size of a GSCN response: distances only with content 4,
+ * otherwise distances and pulse widths.
+ */
+int32_t
+SensorSimulator::getFrameSize(int32_t theNumberOfPoints, int32_t theNumberOfEchoes, int32_t theDataContent)
+{
+    const int32_t lBytesPerEcho = (0 == theDataContent) ? 0 : ((4 == theDataContent) ? 4 : 8);
+
+    return SIMULATOR_FRAME_OVERHEAD + 4 + 4 * NUMBER_OF_SCAN_PARAMETERS + 4
+            + lBytesPerEcho * theNumberOfEchoes * theNumberOfPoints;
+}
+
+/*
+ * Defines the format of the scans.
+ */
+ErrorID_t
+SensorSimulator::setScanFormat(int32_t theNumberOfPoints, int32_t theNumberOfEchoes, int32_t theDataContent)
+{
+    if ((1 > theNumberOfPoints) || (MAX_POINTS_PER_SCAN < theNumberOfPoints) || (1 > theNumberOfEchoes)
+            || (MAX_NUMBER_OF_ECHOES < theNumberOfEchoes)
+            || ((0 != theDataContent) && (4 != theDataContent) && (7 != theDataContent) && (8 != theDataContent)))
+    {
+        return ERR_INVALID_PARAMETER;
+    }
+
+    if (MAX_FRAME_SIZE < getFrameSize(theNumberOfPoints, theNumberOfEchoes, theDataContent))
+    {
+        return ERR_INVALID_PARAMETER;
+    }
+
+    mNumberOfPoints = theNumberOfPoints;
+    mNumberOfEchoes = theNumberOfEchoes;
+    mDataContent = theDataContent;
+    return ERR_SUCCESS;
+}
+
+/*
+ * Defines the percentage of invalid echoes.
+ */
+ErrorID_t
+SensorSimulator::setInvalidEchoes(int32_t theNoEchoPercent, int32_t theNoisePercent)
+{
+    if ((0 > theNoEchoPercent) || (0 > theNoisePercent) || (100 < theNoEchoPercent + theNoisePercent))
+    {
+        return ERR_INVALID_PARAMETER;
+    }
+    mNoEchoPercent = theNoEchoPercent;
+    mNoisePercent = theNoisePercent;
+    return ERR_SUCCESS;
+}
+
+/*
+ * Defines the scan rate.
+ */
+ErrorID_t
+SensorSimulator::setScanRate(int32_t theScanRate)
+{
+    if (0 > theScanRate)
+    {
+        return ERR_INVALID_PARAMETER;
+    }
+    mScanRate = theScanRate;
+    return ERR_SUCCESS;
+}
+
+/*
+ * Defines the faults of the connection.
+ */
+ErrorID_t
+SensorSimulator::setFaults(int32_t theLossPercent, int32_t theDelay)
+{
+    if ((0 > theLossPercent) || (100 < theLossPercent) || (0 > theDelay))
+    {
+        return ERR_INVALID_PARAMETER;
+    }
+    mLossPercent = theLossPercent;
+    mDelay = theDelay * 1000ULL;
+    return ERR_SUCCESS;
+}
+
+/*
+ * Defines the seed of the jitter, the invalid echoes and the losses.
+ */
+void
+SensorSimulator::setSeed(uint32_t theSeed)
+{
+    mSeed = theSeed;
+}
+
+/*
+ * Starts measuring.
+ */
+void
+SensorSimulator::start(uint64_t theTime)
+{
+    mStartTime = theTime;
+    mLastScanNumber = 0;
+    mSession.reset();
+}
+
+/*
+ * Returns the format of the scans for a log line.
+ */
+void
+SensorSimulator::getDescription(string128_t theText) const
+{
+    snprintf(theText, sizeof(string128_t), "%d points, %d echoes, content %d, %d scans/s, %d%% no echo, "
+            "%d%% noise, %d%% loss, %d ms delay", mNumberOfPoints, mNumberOfEchoes, mDataContent, mScanRate,
+            mNoEchoPercent, mNoisePercent, mLossPercent, static_cast<int32_t>(mDelay / 1000));
+}
+
+/*
+ * Selects the scan to answer a scan request with.
+ * Scan 1 is measured at start(), the next ones at the scan rate.
+ */
+int32_t
+SensorSimulator::selectScan(int32_t theScanNumber, uint64_t theTime, uint64_t& theDueTime)
+{
+    int32_t lScanNumber;
+
+    theDueTime = theTime;
+    if (0 == mScanRate)
+    {
+        // a new scan for each request
+        lScanNumber = (theScanNumber > mLastScanNumber) ? theScanNumber : mLastScanNumber + 1;
+    }
+    else
+    {
+        const uint64_t lPeriod = 1000000ULL / mScanRate;
+        const int32_t lLatest = static_cast<int32_t>((theTime - mStartTime) / lPeriod) + 1;
+
+        // a scan in the future is sent as soon as it is measured
+        lScanNumber = (theScanNumber > lLatest) ? theScanNumber : lLatest;
+        theDueTime = mStartTime + (lScanNumber - 1) * lPeriod;
+        if (theDueTime < theTime)
+        {
+            theDueTime = theTime;
+        }
+    }
+    mLastScanNumber = lScanNumber;
+    return lScanNumber;
+}
+
+/*
+ * Builds a GSCN response.
+ * The profile is a saw tooth of walls between 2 m and 7 m; each further
+ * echo is 1.5 m behind the one before.
+ */
+int32_t
+SensorSimulator::buildScan(int32_t theScanNumber, uint64_t theMeasureTime, char* theFramePtr, int32_t theSize)
+{
+    const int32_t lIntegersPerEcho = (0 == mDataContent) ? 0 : ((4 == mDataContent) ? 1 : 2);
+    const int32_t lDataLength = 4 + 4 * NUMBER_OF_SCAN_PARAMETERS + 4
+            + 4 * lIntegersPerEcho * mNumberOfEchoes * mNumberOfPoints;
+    cast_ptr_t lFramePtr = { theFramePtr };
+
+    if (theSize < lDataLength + SIMULATOR_FRAME_OVERHEAD)
+    {
+        return ERR_BUFFER_OVERFLOW;
+    }
+
+    const int32_t lParameters[NUMBER_OF_SCAN_PARAMETERS] = { //
+            theScanNumber, // scan number
+            static_cast<int32_t>((theMeasureTime - mStartTime) / 1000), // time stamp in ms
+            0, // scan start direction
+            mNumberOfPoints * 25, // scan angle
+            mNumberOfEchoes, // number of echoes
+            theScanNumber * 4, // incremental encoder
+            35, // temperature
+            0, // system status
+            mDataContent, // data content
+            theScanNumber // scan line
+            };
+
+    memcpy(theFramePtr, "GSCN", 4);
+    int32_t* lIntegerPtr = &lFramePtr.asIntegerPtr[2];
+    *lIntegerPtr++ = htonl(NUMBER_OF_SCAN_PARAMETERS);
+    for (int32_t l = 0; l < NUMBER_OF_SCAN_PARAMETERS; l++)
+    {
+        *lIntegerPtr++ = htonl(lParameters[l]);
+    }
+    *lIntegerPtr++ = htonl(mNumberOfPoints);
+
+    for (int32_t lPoint = 0; (0 < lIntegersPerEcho) && (lPoint < mNumberOfPoints); lPoint++)
+    {
+        const int32_t lTooth = lPoint % 400;
+        const int32_t lWall = 2000 + 25 * ((200 > lTooth) ? lTooth : 400 - lTooth);
+
+        for (int32_t lEcho = 0; lEcho < mNumberOfEchoes; lEcho++)
+        {
+            const uint32_t lRandom = mix(mSeed ^ mix(theScanNumber * 0x9E3779B9U + lPoint * MAX_NUMBER_OF_ECHOES + lEcho));
+            const int32_t lPercent = lRandom % 100;
+            int32_t lDistance = lWall + 1500 * lEcho + static_cast<int32_t>((lRandom >> 8) % 41) - 20;
+
+            if (lPercent < mNoEchoPercent)
+            {
+                lDistance = PointAvg::NO_ECHO;
+            }
+            else if (lPercent < mNoEchoPercent + mNoisePercent)
+            {
+                lDistance = PointAvg::NOISE;
+            }
+            *lIntegerPtr++ = htonl(lDistance);
+            if (2 == lIntegersPerEcho)
+            {
+                *lIntegerPtr++ = htonl(static_cast<int32_t>(1000 + (lRandom >> 16) % 500)); // pulse width
+            }
+        }
+    }
+    mNumberOfScans++;
+    return finishFrame(theFramePtr, lDataLength);
+}
+
+/*
+ * Answers GSC2 with the averaged scans. The session asks for the next
+ * scan until its window is full, so a response may have to wait for
+ * scans still to be measured.
+ */
+int32_t
+SensorSimulator::handleGSC2(const char* theRequestPtr, int32_t theLength, uint64_t theTime, char* theFramePtr,
+        int32_t theSize, uint64_t& theDueTime)
+{
+    char lRequest[SIMULATOR_GSC2_REQUEST_SIZE];
+    int32_t lLength = 0;
+
+    if (SIMULATOR_GSC2_REQUEST_SIZE != theLength)
+    {
+        return buildError(theFramePtr, ERR_INVALID_PARAMETER);
+    }
+    memcpy(lRequest, theRequestPtr, sizeof(lRequest));
+    const ErrorID_t lResult = mSession.convertRequest(lRequest, sizeof(lRequest), &lLength);
+    if (ERR_SUCCESS != lResult)
+    {
+        return buildError(theFramePtr, lResult);
+    }
+
+    // the session needs up to a window of new scans, and one more if the window was reset
+    theDueTime = theTime;
+    for (int32_t l = 0; l <= GSC2Session::MAX_SCAN_AVG_NUMBER + 1; l++)
+    {
+        uint64_t lMeasureTime;
+        const int32_t lScanNumber = selectScan((0 == l) ? 0 : mLastScanNumber + 1, theTime, lMeasureTime);
+        const int32_t lFrameLength = buildScan(lScanNumber, lMeasureTime, theFramePtr, theSize);
+
+        if (0 > lFrameLength)
+        {
+            break;
+        }
+        theDueTime = (lMeasureTime > theDueTime) ? lMeasureTime : theDueTime;
+        if (mSession.convertResponse(theFramePtr, lFrameLength, &lLength))
+        {
+            return lLength;
+        }
+    }
+
+    // the scans do not fit into the session
+    mSession.reset();
+    return buildError(theFramePtr, ERR_BUFFER_OVERFLOW);
+}
+
+/*
+ * Builds the response to a request.
+ */
+int32_t
+SensorSimulator::handleRequest(const void* theRequestPtr, int32_t theLength, uint64_t theTime,
+        void* theResponsePtr, int32_t theSize, uint64_t& theDueTime)
+{
+    CRC32 lCRC;
+    const cast_ptr_t lRequestPtr = { const_cast<void*>(theRequestPtr) };
+    const cast_ptr_t lResponsePtr = { theResponsePtr };
+    char* lFramePtr = lResponsePtr.asCharPtr;
+    int32_t lLength;
+
+    mNumberOfRequests++;
+    theDueTime = theTime;
+
+    if (64 > theSize)
+    {
+        return 0;
+    }
+
+    // a frame as checked by CommandBase, with a multiple of 4 bytes
+    if ((SIMULATOR_FRAME_OVERHEAD > theLength) || (0 != (theLength % sizeof(int32_t)))
+            || (static_cast<int32_t>(ntohl(lRequestPtr.asIntegerPtr[1])) + SIMULATOR_FRAME_OVERHEAD != theLength))
+    {
+        lLength = buildError(lFramePtr, ERR_INVALID_PARAMETER);
+    }
+    else if (ntohl(lRequestPtr.asIntegerPtr[theLength / sizeof(int32_t) - 1])
+            != lCRC.get(theRequestPtr, theLength - 4))
+    {
+        lLength = buildError(lFramePtr, ERR_CRC);
+    }
+    else if (0 == memcmp(lRequestPtr.asCharPtr, "GSCN", 4))
+    {
+        const int32_t lRequested = (16 <= theLength) ? static_cast<int32_t>(ntohl(lRequestPtr.asIntegerPtr[2])) : 0;
+        const int32_t lScanNumber = selectScan(lRequested, theTime, theDueTime);
+        lLength = buildScan(lScanNumber, theDueTime, lFramePtr, theSize);
+        if (0 > lLength)
+        {
+            lLength = buildError(lFramePtr, static_cast<ErrorID_t>(lLength));
+        }
+    }
+    else if (0 == memcmp(lRequestPtr.asCharPtr, "GSC2", 4))
+    {
+        lLength = handleGSC2(lRequestPtr.asCharPtr, theLength, theTime, lFramePtr, theSize, theDueTime);
+    }
+    else if (0 == memcmp(lRequestPtr.asCharPtr, "GVER", 4))
+    {
+        memcpy(lFramePtr, "GVER", 4);
+        memset(&lFramePtr[8], 0, 48);
+        snprintf(&lFramePtr[8], 48, "PS sensor simulator %s%s; %s", PROGRAM_MAJOR_VERSION, PROGRAM_MINOR_VERSION,
+                PROGRAM_REVISION);
+        lLength = finishFrame(lFramePtr, 48);
+    }
+    else if ((0 == memcmp(lRequestPtr.asCharPtr, "GPRM", 4)) || (0 == memcmp(lRequestPtr.asCharPtr, "SPRM", 4)))
+    {
+        const bool lIsSet = (0 == memcmp(lRequestPtr.asCharPtr, "SPRM", 4));
+        const int32_t lID = (16 <= theLength) ? static_cast<int32_t>(ntohl(lRequestPtr.asIntegerPtr[2])) : -1;
+
+        if ((0 > lID) || (NUMBER_OF_PARAMETERS <= lID) || (lIsSet && (20 > theLength)))
+        {
+            lLength = buildError(lFramePtr, ERR_INVALID_PARAMETER);
+        }
+        else
+        {
+            if (lIsSet)
+            {
+                mParameters[lID] = ntohl(lRequestPtr.asIntegerPtr[3]);
+            }
+            memcpy(lFramePtr, lRequestPtr.asCharPtr, 4);
+            lResponsePtr.asIntegerPtr[2] = htonl(lID);
+            lResponsePtr.asIntegerPtr[3] = htonl(mParameters[lID]);
+            lLength = finishFrame(lFramePtr, 2 * sizeof(int32_t));
+        }
+    }
+    else if (0 == memcmp(lRequestPtr.asCharPtr, "SCAN", 4))
+    {
+        // acknowledged; the simulator measures all the time
+        memcpy(lFramePtr, "SCAN", 4);
+        lResponsePtr.asIntegerPtr[2] = (16 <= theLength) ? lRequestPtr.asIntegerPtr[2] : 0;
+        lLength = finishFrame(lFramePtr, sizeof(int32_t));
+    }
+    else
+    {
+        lLength = buildError(lFramePtr, ERR_UNKNOWN_COMMAND);
+    }
+
+    // the connection loses and delays responses
+    if ((0 < mLossPercent) && (static_cast<int32_t>(mix(mSeed ^ mix(mNumberOfRequests)) % 100) < mLossPercent))
+    {
+        mNumberOfLosses++;
+        return 0;
+    }
+    theDueTime += mDelay;
+    return lLength;
+}
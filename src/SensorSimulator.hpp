@@ -0,0 +1,375 @@
+#ifndef SENSORSIMULATOR_HPP_
+#define SENSORSIMULATOR_HPP_
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       SensorSimulator.hpp - Answers requests like a PS sensor.
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ ****************************************************************************
+ */
+
+extern "C"
+{
+#include "ErrorID.h"
+}
+#include "Global.hpp"
+#include "GSC2Session.hpp"
+
+/**
+ * Class SensorSimulator - the protocol of a PS sensor with synthetic scans.
+ * <p>&nbsp;<p>
+ * handleRequest() takes a request frame as received by a sensor and
+ * builds the response frame, in the framing checked by CommandBase:
+ * command ID, length, data, CRC. It knows GVER, GPRM, SPRM, SCAN, GSCN
+ * and GSC2; other requests and requests with CRC errors are answered by
+ * an ERR response. The class has no I/O, so the same simulator serves
+ * UDP, a pseudo terminal (see SimulatorServer) or a test in the same
+ * process.
+ * <p>
+ * The sensor measures a scan every 1/scan rate seconds from start().
+ * GSCN 0 is answered by the latest scan, GSCN n by scan n as soon as it
+ * is measured. A scan rate of 0 measures a new scan for each request, to
+ * find the throughput of the clients. GSC2 averages the scans with a
+ * GSC2Session, like the relays do.
+ * <p>
+ * The scans are a fixed profile with some jitter; a given percentage of
+ * the echoes has the no echo or noise distance. The jitter, the invalid
+ * echoes and the lost responses depend on the seed only, so a test run
+ * can be reproduced.
+ * <p>
+ * Not thread safe.
+ */
+class SensorSimulator
+{
+    public:
+
+        /** class constants */
+        enum SensorSimulatorConstants_t
+        {
+            /** maximum size of a response; the payload of a UDP datagram */
+            MAX_FRAME_SIZE = 65507,
+
+            /** number of parameters of GPRM and SPRM */
+            NUMBER_OF_PARAMETERS = 64,
+
+            /** maximum number of points per scan */
+            MAX_POINTS_PER_SCAN = 4000,
+
+            /** maximum number of echoes per point */
+            MAX_NUMBER_OF_ECHOES = 4,
+
+            /** number of GSCN parameters sent with a scan */
+            NUMBER_OF_SCAN_PARAMETERS = 10
+        };
+
+    private:
+
+        /** number of points per scan */
+        int32_t mNumberOfPoints;
+
+        /** number of echoes per point */
+        int32_t mNumberOfEchoes;
+
+        /** data content: 0, 4 (distances) or 7, 8 (distances and pulse widths) */
+        int32_t mDataContent;
+
+        /** percentage of the echoes without echo */
+        int32_t mNoEchoPercent;
+
+        /** percentage of the echoes with noise */
+        int32_t mNoisePercent;
+
+        /** scans per second; 0 for a new scan per request */
+        int32_t mScanRate;
+
+        /** percentage of the responses lost */
+        int32_t mLossPercent;
+
+        /** delay of the responses in us */
+        uint64_t mDelay;
+
+        /** seed of the jitter, the invalid echoes and the losses */
+        uint32_t mSeed;
+
+        /** time in us when the first scan was measured */
+        uint64_t mStartTime;
+
+        /** number of the last scan sent; 0 if none */
+        int32_t mLastScanNumber;
+
+        /** the parameters of GPRM and SPRM */
+        int32_t mParameters[NUMBER_OF_PARAMETERS];
+
+        /** the averaging of GSC2 */
+        GSC2Session mSession;
+
+        /** number of requests handled */
+        uint32_t mNumberOfRequests;
+
+        /** number of responses lost on purpose */
+        uint32_t mNumberOfLosses;
+
+        /** number of scans sent */
+        uint32_t mNumberOfScans;
+
+        /**
+         * Returns the size of a GSCN response in bytes.
+         */
+        static int32_t
+        getFrameSize(int32_t theNumberOfPoints, int32_t theNumberOfEchoes, int32_t theDataContent);
+
+        /**
+         * Scrambles a number; the source of all randomness.
+         */
+        static uint32_t
+        mix(uint32_t theValue);
+
+        /**
+         * Writes the length and the CRC of a response.
+         *
+         * @param theFramePtr
+         *      the response; command ID and data are set.
+         * @param theDataLength
+         *      number of bytes between the length and the CRC.
+         * @return
+         *      the number of bytes of the response.
+         */
+        static int32_t
+        finishFrame(char* theFramePtr, int32_t theDataLength);
+
+        /**
+         * Builds an ERR response.
+         */
+        static int32_t
+        buildError(char* theFramePtr, ErrorID_t theError);
+
+        /**
+         * Selects the scan to answer a scan request with.
+         *
+         * @param theScanNumber
+         *      the requested scan number, 0 for the latest one.
+         * @param theTime
+         *      time of the request in us.
+         * @param theDueTime
+         *      returns the time in us when the scan is measured.
+         * @return
+         *      the scan number.
+         */
+        int32_t
+        selectScan(int32_t theScanNumber, uint64_t theTime, uint64_t& theDueTime);
+
+        /**
+         * Builds a GSCN response.
+         *
+         * @return
+         *      the number of bytes, or a negative error code if it does not fit.
+         */
+        int32_t
+        buildScan(int32_t theScanNumber, uint64_t theMeasureTime, char* theFramePtr, int32_t theSize);
+
+        /**
+         * Answers GSC2 with the averaged scans.
+         */
+        int32_t
+        handleGSC2(const char* theRequestPtr, int32_t theLength, uint64_t theTime, char* theFramePtr, int32_t theSize,
+                uint64_t& theDueTime);
+
+        /* private assignment constructor to avoid misuse */
+        explicit
+        SensorSimulator(const SensorSimulator& src);
+
+        /* private assignment operator to avoid misuse */
+        SensorSimulator&
+        operator =(const SensorSimulator& src);
+
+    public:
+
+        /**
+         * Constructor. 1000 points with one echo and pulse width at 25 scans/s,
+         * all echoes valid, no losses and no delay.
+         */
+        SensorSimulator();
+
+        /**
+         * Destructor.
+         */
+        virtual
+        ~SensorSimulator();
+
+        /**
+         * Defines the format of the scans.
+         *
+         * @param theNumberOfPoints
+         *      points per scan, 1 to MAX_POINTS_PER_SCAN.
+         * @param theNumberOfEchoes
+         *      echoes per point, 1 to MAX_NUMBER_OF_ECHOES.
+         * @param theDataContent
+         *      0 (no data), 4 (distances), 7 or 8 (distances and pulse widths).
+         * @return
+         *      ERR_SUCCESS if OK, ERR_INVALID_PARAMETER if a value is out of
+         *      range or the scan does not fit into MAX_FRAME_SIZE.
+         */
+        ErrorID_t
+        setScanFormat(int32_t theNumberOfPoints, int32_t theNumberOfEchoes, int32_t theDataContent);
+
+        /**
+         * Defines the percentage of invalid echoes.
+         *
+         * @param theNoEchoPercent
+         *      percentage of echoes with the no echo distance.
+         * @param theNoisePercent
+         *      percentage of echoes with the noise distance.
+         * @return
+         *      ERR_SUCCESS if OK, ERR_INVALID_PARAMETER if the sum is not 0 to 100.
+         */
+        ErrorID_t
+        setInvalidEchoes(int32_t theNoEchoPercent, int32_t theNoisePercent);
+
+        /**
+         * Defines the scan rate.
+         *
+         * @param theScanRate
+         *      scans per second, 0 for a new scan per request.
+         * @return
+         *      ERR_SUCCESS if OK, ERR_INVALID_PARAMETER if negative.
+         */
+        ErrorID_t
+        setScanRate(int32_t theScanRate);
+
+        /**
+         * Defines the faults of the connection.
+         *
+         * @param theLossPercent
+         *      percentage of the responses which are not sent.
+         * @param theDelay
+         *      ms the responses are delayed.
+         * @return
+         *      ERR_SUCCESS if OK, ERR_INVALID_PARAMETER if a value is out of range.
+         */
+        ErrorID_t
+        setFaults(int32_t theLossPercent, int32_t theDelay);
+
+        /**
+         * Defines the seed of the jitter, the invalid echoes and the losses.
+         */
+        void
+        setSeed(uint32_t theSeed);
+
+        /**
+         * Starts measuring: the first scan is measured now.
+         *
+         * @param theTime
+         *      the current time in us.
+         */
+        void
+        start(uint64_t theTime);
+
+        /**
+         * Builds the response to a request.
+         *
+         * @param theRequestPtr
+         *      the request as received.
+         * @param theLength
+         *      number of bytes of the request.
+         * @param theTime
+         *      time of reception in us.
+         * @param theResponsePtr
+         *      returns the response; MAX_FRAME_SIZE bytes are enough.
+         * @param theSize
+         *      size of the response buffer.
+         * @param theDueTime
+         *      returns the time in us when the response is to be sent.
+         * @return
+         *      the number of bytes of the response, 0 if the response is lost.
+         */
+        int32_t
+        handleRequest(const void* theRequestPtr, int32_t theLength, uint64_t theTime, void* theResponsePtr,
+                int32_t theSize, uint64_t& theDueTime);
+
+        /**
+         * Returns the number of points per scan.
+         */
+        int32_t
+        getNumberOfPoints() const
+        {
+            return mNumberOfPoints;
+        }
+
+        /**
+         * Returns the number of echoes per point.
+         */
+        int32_t
+        getNumberOfEchoes() const
+        {
+            return mNumberOfEchoes;
+        }
+
+        /**
+         * Returns the data content of the scans.
+         */
+        int32_t
+        getDataContent() const
+        {
+            return mDataContent;
+        }
+
+        /**
+         * Returns the size of a GSCN response in bytes.
+         */
+        int32_t
+        getScanFrameSize() const
+        {
+            return getFrameSize(mNumberOfPoints, mNumberOfEchoes, mDataContent);
+        }
+
+        /**
+         * Returns the number of requests handled.
+         */
+        uint32_t
+        getNumberOfRequests() const
+        {
+            return mNumberOfRequests;
+        }
+
+        /**
+         * Returns the number of responses lost on purpose.
+         */
+        uint32_t
+        getNumberOfLosses() const
+        {
+            return mNumberOfLosses;
+        }
+
+        /**
+         * Returns the number of scans sent by GSCN and GSC2.
+         */
+        uint32_t
+        getNumberOfScans() const
+        {
+            return mNumberOfScans;
+        }
+
+        /**
+         * Returns the format of the scans for a log line.
+         *
+         * @param theText
+         *      returns the text.
+         */
+        void
+        getDescription(string128_t theText) const;
+};
+
+#endif /* SENSORSIMULATOR_HPP_ */
@@ -0,0 +1,326 @@
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       SimulatorServer.cpp
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ *
+ ****************************************************************************
+ */
+
+#if __linux__
+
+#include <cctype>
+#include <cstring>
+#include <arpa/inet.h>
+#include <sys/time.h>
+#include "KbhitGetch.h"
+
+#include "SimulatorServer.hpp"
+#include "EventLoop.hpp"
+#include "LinuxPseudoTerminal.hpp"
+#include "LinuxServerSocket.hpp"
+
+/* size of the command ID, the length and the CRC of a frame */
+#define SIMULATOR_FRAME_OVERHEAD 12
+
+/*
+ * Standard constructor.
+ */
+SimulatorServer::SimulatorServer(ServerSocket& theServerSocket, SensorSimulator& theSimulator) :
+        mServerSocket(theServerSocket), //
+        mTerminalPtr(0), //
+        mSimulator(theSimulator), //
+        mResponses(), //
+        mUARTLength(0), //
+        mNumberOfSkippedBytes(0), //
+        mNumberOfOverruns(0), //
+        mTerminalLogFile(0)
+{
+    mResponses.reserve(MAX_PENDING_RESPONSES);
+}
+
+/*
+ * Standard destructor.
+ */
+SimulatorServer::~SimulatorServer()
+{
+    // nothing to be done.
+}
+
+/*
+ * Returns the current system time in us.
+ */
+uint64_t
+SimulatorServer::getMicroseconds()
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL); // get current time
+    return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+
+/*
+ * Defines the pseudo terminal which stands in for the UART.
+ */
+void
+SimulatorServer::setTerminal(PseudoTerminal* theTerminalPtr)
+{
+    mTerminalPtr = theTerminalPtr;
+}
+
+/*
+ * Defines a text file to log the terminal output.
+ */
+void
+SimulatorServer::setTerminalLogFile(FILE* theTerminalLogFile)
+{
+    mTerminalLogFile = theTerminalLogFile;
+}
+
+/*
+ * Logs a message on the console and in the terminal log file.
+ */
+void
+SimulatorServer::logMessage(const char* theMessage)
+{
+    string1024_t lTextLine;
+
+    snprintf(lTextLine, sizeof(lTextLine), "SIM: %s\r\n", theMessage);
+
+    // write to file
+    if (0 != mTerminalLogFile)
+    {
+        fputs(lTextLine, mTerminalLogFile);
+    }
+
+    // write to console
+    printf("%s", lTextLine);
+}
+
+/*
+ * Lets the simulator answer a request and queues the response
+ * behind the responses due earlier or at the same time.
+ */
+void
+SimulatorServer::handleRequest(const char* theRequestPtr, int32_t theLength, uint64_t theTime, bool theIsUART,
+        const sockaddr_in* theAddress)
+{
+    uint64_t lDueTime;
+    const int32_t lLength = mSimulator.handleRequest(theRequestPtr, theLength, theTime, mResponseBuffer,
+            sizeof(mResponseBuffer), lDueTime);
+
+    if (0 >= lLength)
+    {
+        return; // lost
+    }
+    if (MAX_PENDING_RESPONSES <= static_cast<int32_t>(mResponses.size()))
+    {
+        mNumberOfOverruns++;
+        return;
+    }
+
+    std::vector<Response_t>::iterator lPosition = mResponses.end();
+    while ((lPosition != mResponses.begin()) && ((lPosition - 1)->mDueTime > lDueTime))
+    {
+        --lPosition;
+    }
+    lPosition = mResponses.insert(lPosition, Response_t());
+    lPosition->mDueTime = lDueTime;
+    lPosition->mIsUART = theIsUART;
+    if (0 != theAddress)
+    {
+        lPosition->mAddress = *theAddress;
+    }
+    lPosition->mFrame.assign(mResponseBuffer, mResponseBuffer + lLength);
+}
+
+/*
+ * Receives and handles a datagram.
+ */
+void
+SimulatorServer::handleSocket(uint64_t theTime)
+{
+    sockaddr_in lAddress;
+    const int32_t lLength = mServerSocket.readFrom(mReceiveBuffer, sizeof(mReceiveBuffer), lAddress);
+
+    if (0 < lLength)
+    {
+        handleRequest(mReceiveBuffer, lLength, theTime, false, &lAddress);
+    }
+}
+
+/*
+ * Receives bytes from the pseudo terminal and handles the complete frames.
+ */
+void
+SimulatorServer::handleTerminal(uint64_t theTime)
+{
+    const int32_t lReceived = mTerminalPtr->read(&mUARTBuffer[mUARTLength], sizeof(mUARTBuffer) - mUARTLength);
+    if (0 >= lReceived)
+    {
+        return;
+    }
+    mUARTLength += lReceived;
+
+    int32_t lStart = 0;
+    while (lStart + 8 <= mUARTLength)
+    {
+        uint32_t lDataLength;
+        memcpy(&lDataLength, &mUARTBuffer[lStart + 4], sizeof(lDataLength));
+        lDataLength = ntohl(lDataLength);
+
+        // a request fits into the buffer and has a 4 letter command ID
+        if ((sizeof(mUARTBuffer) - SIMULATOR_FRAME_OVERHEAD < lDataLength) || (0 != (lDataLength % 4))
+                || (0 == isalpha(static_cast<unsigned char>(mUARTBuffer[lStart]))))
+        {
+            lStart++;
+            mNumberOfSkippedBytes++;
+            continue;
+        }
+
+        const int32_t lFrameLength = static_cast<int32_t>(lDataLength) + SIMULATOR_FRAME_OVERHEAD;
+        if (lStart + lFrameLength > mUARTLength)
+        {
+            break; // wait for the rest
+        }
+        handleRequest(&mUARTBuffer[lStart], lFrameLength, theTime, true, 0);
+        lStart += lFrameLength;
+    }
+
+    // keep the incomplete frame
+    mUARTLength -= lStart;
+    memmove(mUARTBuffer, &mUARTBuffer[lStart], mUARTLength);
+}
+
+/*
+ * Sends the responses which are due.
+ */
+int32_t
+SimulatorServer::sendResponses(uint64_t theTime)
+{
+    std::vector<Response_t>::iterator lResponse = mResponses.begin();
+
+    for (; (lResponse != mResponses.end()) && (lResponse->mDueTime <= theTime); ++lResponse)
+    {
+        if (lResponse->mIsUART)
+        {
+            if (0 != mTerminalPtr)
+            {
+                mTerminalPtr->write(&lResponse->mFrame[0], static_cast<int32_t>(lResponse->mFrame.size()));
+            }
+        }
+        else
+        {
+            mServerSocket.writeTo(&lResponse->mFrame[0], static_cast<int32_t>(lResponse->mFrame.size()),
+                    lResponse->mAddress);
+        }
+    }
+    mResponses.erase(mResponses.begin(), lResponse);
+
+    if (mResponses.empty())
+    {
+        return WAIT_TIME;
+    }
+    const uint64_t lWait = (mResponses.front().mDueTime - theTime + 999) / 1000;
+    return (WAIT_TIME < lWait) ? static_cast<int32_t>(WAIT_TIME) : static_cast<int32_t>(lWait);
+}
+
+/*
+ * Waits for requests, handles them and sends the responses which are due.
+ */
+int32_t
+SimulatorServer::handleEvents(EventLoop& theEventLoop, int32_t theServer, int32_t theTerminal, int32_t theWaitTime)
+{
+    const ErrorID_t result = theEventLoop.wait(theWaitTime);
+    const uint64_t lTime = getMicroseconds();
+
+    if (ERR_SUCCESS == result)
+    {
+        if (theEventLoop.isReadable(theServer))
+        {
+            handleSocket(lTime);
+        }
+        if ((0 <= theTerminal) && theEventLoop.isReadable(theTerminal))
+        {
+            handleTerminal(lTime);
+        }
+    }
+    return sendResponses(getMicroseconds());
+}
+
+/*
+ * Serves the clients until the flag is cleared.
+ */
+ErrorID_t
+SimulatorServer::serve(const std::atomic<bool>& theIsRunning)
+{
+    EventLoop lEventLoop;
+    const int32_t lServer = lEventLoop.addStream(mServerSocket);
+    const int32_t lTerminal = (0 != mTerminalPtr) ? lEventLoop.addStream(*mTerminalPtr) : -1;
+    int32_t lWaitTime = WAIT_TIME;
+
+    mSimulator.start(getMicroseconds());
+    while (theIsRunning.load())
+    {
+        lWaitTime = handleEvents(lEventLoop, lServer, lTerminal, lWaitTime);
+    }
+    return ERR_SUCCESS;
+}
+
+/*
+ * Serves the clients.
+ */
+ErrorID_t
+SimulatorServer::run()
+{
+    EventLoop lEventLoop;
+    const int32_t lServer = lEventLoop.addStream(mServerSocket);
+    const int32_t lTerminal = (0 != mTerminalPtr) ? lEventLoop.addStream(*mTerminalPtr) : -1;
+    const int32_t lKeyboard = lEventLoop.addKeyboard();
+    int32_t lWaitTime = WAIT_TIME;
+    int c = 0;
+    string128_t lMessage;
+
+    mSimulator.getDescription(lMessage);
+    logMessage(lMessage);
+    if (0 != mTerminalPtr)
+    {
+        snprintf(lMessage, sizeof(lMessage), "UART: %.100s", mTerminalPtr->getDeviceName());
+        logMessage(lMessage);
+    }
+    logMessage("sensor simulator started");
+    mSimulator.start(getMicroseconds());
+
+    // terminal mode change on linux for kbhit.
+    changemode(1);
+
+    do
+    {
+        lWaitTime = handleEvents(lEventLoop, lServer, lTerminal, lWaitTime);
+    } while ((false == lEventLoop.isReadable(lKeyboard)) || (kbhit() == 0)
+            || (((c = getch()) != 'q') && (c != 'Q') && (c != VK_ESC)));
+
+    // terminal mode restore on linux for kbhit.
+    changemode(0);
+
+    snprintf(lMessage, sizeof(lMessage), "%u requests, %u scans sent, %u responses lost, %u overruns, "
+            "%u UART bytes skipped", mSimulator.getNumberOfRequests(), mSimulator.getNumberOfScans(),
+            mSimulator.getNumberOfLosses(), mNumberOfOverruns, mNumberOfSkippedBytes);
+    logMessage(lMessage);
+    return ERR_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,256 @@
+#ifndef SIMULATORSERVER_HPP_
+#define SIMULATORSERVER_HPP_
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       SimulatorServer.hpp - Serves a simulated sensor by UDP and UART.
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ ****************************************************************************
+ */
+
+#if defined(__linux__)
+
+#include <atomic>
+#include <cstdio>
+#include <vector>
+#include <netinet/in.h>
+extern "C"
+{
+#include "ErrorID.h"
+}
+#include "Global.hpp"
+#include "SensorSimulator.hpp"
+
+class EventLoop;
+class PseudoTerminal;
+class ServerSocket;
+
+/**
+ * Class SimulatorServer - connects a SensorSimulator to its clients.
+ * <p>&nbsp;<p>
+ * Requests are received as UDP datagrams from any client, and from a
+ * pseudo terminal which stands in for the UART. On the pseudo terminal
+ * the frames follow each other without gaps and are separated by their
+ * length field; a byte stream which does not start with a plausible
+ * length is skipped byte by byte until it does.
+ * <p>
+ * The responses are queued until they are due: the simulated sensor
+ * sends a scan when it is measured, and the simulated connection may
+ * delay the responses.
+ */
+class SimulatorServer
+{
+    public:
+
+        /** class constants */
+        enum SimulatorServerConstants_t
+        {
+            /** maximum number of responses waiting to be sent */
+            MAX_PENDING_RESPONSES = 64,
+
+            /** size of a frame */
+            FRAME_SIZE = SensorSimulator::MAX_FRAME_SIZE,
+
+            /** size of the buffer collecting the bytes of the pseudo terminal */
+            UART_BUFFER_SIZE = 2 * 1024,
+
+            /** ms the event loop waits at most */
+            WAIT_TIME = 100,
+
+            /**
+             * ESC key
+             */
+            VK_ESC = 27
+        };
+
+    private:
+
+        /**
+         * A response waiting to be sent.
+         */
+        struct Response_t
+        {
+                /** time in us when the response is sent */
+                uint64_t mDueTime;
+
+                /** true to send to the pseudo terminal, false to send to mAddress */
+                bool mIsUART;
+
+                /** the client of a UDP request */
+                sockaddr_in mAddress;
+
+                /** the response */
+                std::vector<char> mFrame;
+        };
+
+        /** the socket the clients send to */
+        ServerSocket& mServerSocket;
+
+        /** the pseudo terminal, or 0 */
+        PseudoTerminal* mTerminalPtr;
+
+        /** the simulated sensor */
+        SensorSimulator& mSimulator;
+
+        /** the responses in the order they are due */
+        std::vector<Response_t> mResponses;
+
+        /** received datagram */
+        char mReceiveBuffer[FRAME_SIZE];
+
+        /** the response built by the simulator */
+        char mResponseBuffer[FRAME_SIZE];
+
+        /** bytes received from the pseudo terminal */
+        char mUARTBuffer[UART_BUFFER_SIZE];
+
+        /** number of bytes in mUARTBuffer */
+        int32_t mUARTLength;
+
+        /** number of bytes skipped on the pseudo terminal */
+        uint32_t mNumberOfSkippedBytes;
+
+        /** number of responses dropped because the queue was full */
+        uint32_t mNumberOfOverruns;
+
+        /** the terminal log file */
+        FILE* mTerminalLogFile;
+
+        /**
+         * Returns the current system time in us.
+         */
+        static uint64_t
+        getMicroseconds();
+
+        /**
+         * Lets the simulator answer a request and queues the response.
+         */
+        void
+        handleRequest(const char* theRequestPtr, int32_t theLength, uint64_t theTime, bool theIsUART,
+                const sockaddr_in* theAddress);
+
+        /**
+         * Receives and handles a datagram.
+         */
+        void
+        handleSocket(uint64_t theTime);
+
+        /**
+         * Receives bytes from the pseudo terminal and handles the complete frames.
+         */
+        void
+        handleTerminal(uint64_t theTime);
+
+        /**
+         * Sends the responses which are due.
+         *
+         * @return
+         *      ms until the next response is due, at most WAIT_TIME.
+         */
+        int32_t
+        sendResponses(uint64_t theTime);
+
+        /**
+         * Waits for requests, handles them and sends the responses which are due.
+         *
+         * @param theEventLoop
+         *      the event loop with the socket and the pseudo terminal.
+         * @param theServer
+         *      the index of the socket in the event loop.
+         * @param theTerminal
+         *      the index of the pseudo terminal in the event loop, or -1.
+         * @param theWaitTime
+         *      ms to wait for requests.
+         * @return
+         *      ms until the next response is due, at most WAIT_TIME.
+         */
+        int32_t
+        handleEvents(EventLoop& theEventLoop, int32_t theServer, int32_t theTerminal, int32_t theWaitTime);
+
+        /**
+         * Logs a message on the console and in the terminal log file.
+         */
+        void
+        logMessage(const char* theMessage);
+
+        /* private assignment constructor to avoid misuse */
+        explicit
+        SimulatorServer(const SimulatorServer& src);
+
+        /* private assignment operator to avoid misuse */
+        SimulatorServer&
+        operator =(const SimulatorServer& src);
+
+    public:
+
+        /**
+         * Constructor.
+         *
+         * @param theServerSocket
+         *      the socket the clients send to; must be open.
+         * @param theSimulator
+         *      the simulated sensor.
+         */
+        SimulatorServer(ServerSocket& theServerSocket, SensorSimulator& theSimulator);
+
+        /**
+         * Destructor.
+         */
+        virtual
+        ~SimulatorServer();
+
+        /**
+         * Defines the pseudo terminal which stands in for the UART.
+         *
+         * @param theTerminalPtr
+         *      the pseudo terminal, open; or 0 for UDP only.
+         */
+        void
+        setTerminal(PseudoTerminal* theTerminalPtr);
+
+        /**
+         * Defines a text file to log the terminal output.
+         *
+         * @param theTerminalLogFile
+         *      the log file, or 0.
+         */
+        void
+        setTerminalLogFile(FILE* theTerminalLogFile);
+
+        /**
+         * Serves the clients until the user presses ESC or 'q'.
+         *
+         * @return
+         *      ERR_SUCCESS on success, otherwise a negative error code.
+         */
+        ErrorID_t
+        run();
+
+        /**
+         * Serves the clients without console until the flag is cleared,
+         * e.g. on a thread of its own for the end-to-end benchmark.
+         *
+         * @param theIsRunning
+         *      cleared by another thread to stop; checked every WAIT_TIME ms.
+         * @return
+         *      ERR_SUCCESS on success, otherwise a negative error code.
+         */
+        ErrorID_t
+        serve(const std::atomic<bool>& theIsRunning);
+};
+
+#endif /* Linux */
+#endif /* SIMULATORSERVER_HPP_ */
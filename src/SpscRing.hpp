@@ -0,0 +1,148 @@
+#ifndef SPSCRING_HPP_
+#define SPSCRING_HPP_
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       SpscRing.hpp - Lock-free single producer/single consumer ring.
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ ****************************************************************************
+ */
+
+#include <atomic>
+#include "Global.hpp"
+
+/**
+ * Class SpscRing - lock-free ring of pre-allocated elements.
+ * <p>&nbsp;<p>
+ * One thread writes, one other thread reads. The elements are written and
+ * read in place: the producer fills the slot returned by getWriteSlot()
+ * and publishes it by push(), the consumer reads the slot returned by
+ * getReadSlot() and hands it back by pop(). Nothing is copied or allocated.
+ * <p>
+ * Each index is written by one thread only, so two atomic counters suffice.
+ * They are kept on separate cache lines to avoid false sharing.
+ *
+ * @param Element_t
+ *      type of the elements.
+ * @param SIZE
+ *      number of elements; must be a power of two.
+ */
+template<class Element_t, uint32_t SIZE>
+class SpscRing
+{
+        static_assert((0 < SIZE) && (0 == (SIZE & (SIZE - 1))), "SIZE must be a power of two");
+
+        /** class constants */
+        enum SpscRingConstants_t
+        {
+            /** size of a cache line in bytes */
+            CACHE_LINE_SIZE = 64
+        };
+
+        /** number of elements pushed; written by the producer only */
+        std::atomic<uint32_t> mHead;
+
+        /** keeps mHead and mTail on different cache lines */
+        char mHeadPadding[CACHE_LINE_SIZE - sizeof(std::atomic<uint32_t>)];
+
+        /** number of elements popped; written by the consumer only */
+        std::atomic<uint32_t> mTail;
+
+        /** keeps mTail and the elements on different cache lines */
+        char mTailPadding[CACHE_LINE_SIZE - sizeof(std::atomic<uint32_t>)];
+
+        /** the elements */
+        Element_t mElements[SIZE];
+
+        /* private assignment constructor to avoid misuse */
+        explicit
+        SpscRing(const SpscRing& src);
+
+        /* private assignment operator to avoid misuse */
+        SpscRing&
+        operator =(const SpscRing& src);
+
+    public:
+
+        /**
+         * Constructor. Creates an empty ring.
+         */
+        SpscRing() :
+                mHead(0), //
+                mTail(0)
+        {
+        }
+
+        /**
+         * Producer: returns the next free element, or 0 if the ring is full.
+         * The element is not visible to the consumer before push().
+         */
+        Element_t*
+        getWriteSlot()
+        {
+            const uint32_t lHead = mHead.load(std::memory_order_relaxed);
+            if ((lHead - mTail.load(std::memory_order_acquire)) >= SIZE)
+            {
+                return 0;
+            }
+            return &mElements[lHead & (SIZE - 1)];
+        }
+
+        /**
+         * Producer: publishes the element returned by getWriteSlot().
+         */
+        void
+        push()
+        {
+            mHead.store(mHead.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        /**
+         * Consumer: returns the oldest element, or 0 if the ring is empty.
+         * The element stays valid until pop().
+         */
+        Element_t*
+        getReadSlot()
+        {
+            const uint32_t lTail = mTail.load(std::memory_order_relaxed);
+            if (lTail == mHead.load(std::memory_order_acquire))
+            {
+                return 0;
+            }
+            return &mElements[lTail & (SIZE - 1)];
+        }
+
+        /**
+         * Consumer: hands the element returned by getReadSlot() back to the producer.
+         */
+        void
+        pop()
+        {
+            mTail.store(mTail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        /**
+         * Returns the number of elements in the ring. Exact for the consumer;
+         * other threads may see an outdated value.
+         */
+        uint32_t
+        getCount() const
+        {
+            return mHead.load(std::memory_order_acquire) - mTail.load(std::memory_order_acquire);
+        }
+};
+
+#endif /* SPSCRING_HPP_ */
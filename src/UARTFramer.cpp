@@ -0,0 +1,267 @@
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       UARTFramer.cpp
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ *
+ ****************************************************************************
+ */
+
+#include <cstring>
+
+extern "C"
+{
+#include "ErrorID.h"
+}
+#include "CRC32.hpp"
+#include "UARTFramer.hpp"
+
+/** the command IDs of the requests and responses */
+static const char sKnownCommandIDs[][4] =
+{
+    { 'G', 'V', 'E', 'R' }, //
+    { 'G', 'P', 'R', 'M' }, //
+    { 'S', 'P', 'R', 'M' }, //
+    { 'S', 'C', 'A', 'N' }, //
+    { 'G', 'S', 'C', 'N' }, //
+    { 'G', 'S', 'C', '2' }, //
+    { 'G', 'P', 'I', 'N' }, //
+    { 'S', 'Y', 'N', 'C' }, //
+    { 'E', 'R', 'R', '\0' }
+};
+
+/*
+ * Reads a big endian integer.
+ */
+static inline uint32_t
+getBigEndian(const byte_t* theDataPtr)
+{
+    return (static_cast<uint32_t>(theDataPtr[0]) << 24) | (static_cast<uint32_t>(theDataPtr[1]) << 16)
+            | (static_cast<uint32_t>(theDataPtr[2]) << 8) | static_cast<uint32_t>(theDataPtr[3]);
+}
+
+/*
+ * Standard constructor.
+ */
+UARTFramer::UARTFramer() :
+        mBufferPtr(new byte_t[BUFFER_SIZE]), //
+        mStart(0), //
+        mLength(0), //
+        mFrameLength(0), //
+        mBufferTime(0), //
+        mReceiveTime(0), //
+        mFirstByteTime(0), //
+        mLastByteTime(0), //
+        mNumberOfFrames(0), //
+        mNumberOfSkippedBytes(0), //
+        mNumberOfCRCErrors(0)
+{
+    // nothing more to do.
+}
+
+/*
+ * Standard destructor.
+ */
+UARTFramer::~UARTFramer()
+{
+    delete[] mBufferPtr;
+}
+
+/*
+ * Discards the buffered bytes and resets the counters.
+ */
+void
+UARTFramer::reset()
+{
+    mStart = 0;
+    mLength = 0;
+    mFrameLength = 0;
+    mFirstByteTime = 0;
+    mLastByteTime = 0;
+    mNumberOfFrames = 0;
+    mNumberOfSkippedBytes = 0;
+    mNumberOfCRCErrors = 0;
+}
+
+/*
+ * Returns true if a command ID is known.
+ */
+bool
+UARTFramer::isKnownCommandID(const byte_t* theIDPtr)
+{
+    for (uint32_t l = 0; l < sizeof(sKnownCommandIDs) / sizeof(sKnownCommandIDs[0]); l++)
+    {
+        if (0 == memcmp(theIDPtr, sKnownCommandIDs[l], sizeof(sKnownCommandIDs[l])))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Checks whether a valid frame starts at the position.
+ */
+int32_t
+UARTFramer::checkFrame(int32_t thePosition)
+{
+    const byte_t* lFramePtr = &mBufferPtr[mStart + thePosition];
+
+    if (false == isKnownCommandID(lFramePtr))
+    {
+        return -1;
+    }
+
+    const uint32_t lDataLength = getBigEndian(&lFramePtr[4]);
+    if ((MAX_FRAME_SIZE - FRAME_OVERHEAD) < lDataLength)
+    {
+        return -1;
+    }
+
+    const int32_t lFrameLength = static_cast<int32_t>(lDataLength) + FRAME_OVERHEAD;
+    if (thePosition + lFrameLength > mLength)
+    {
+        return 0; // wait for the rest
+    }
+
+    CRC32 lCRC;
+    if (getBigEndian(&lFramePtr[lFrameLength - 4]) != lCRC.get(lFramePtr, lFrameLength - 4))
+    {
+        mNumberOfCRCErrors++;
+        return -1;
+    }
+    return lFrameLength;
+}
+
+/*
+ * Removes bytes from the start of the buffer.
+ */
+void
+UARTFramer::remove(int32_t theLength)
+{
+    if (0 < theLength)
+    {
+        mLength -= theLength;
+        mStart = (0 == mLength) ? 0 : mStart + theLength;
+        mFrameLength = 0;
+    }
+}
+
+/*
+ * Moves the bytes to the start of the buffer if needed.
+ */
+void
+UARTFramer::compact()
+{
+    if ((0 != mStart) && (MAX_FRAME_SIZE > BUFFER_SIZE - mStart - mLength))
+    {
+        memmove(mBufferPtr, &mBufferPtr[mStart], mLength);
+        mStart = 0;
+    }
+}
+
+/*
+ * Adds the bytes stored at getWritePtr().
+ */
+void
+UARTFramer::commit(int32_t theLength, uint64_t theTime)
+{
+    if (0 >= theLength)
+    {
+        return;
+    }
+    if (0 == mLength)
+    {
+        mBufferTime = theTime;
+    }
+    mLength += theLength;
+    mReceiveTime = theTime;
+}
+
+/*
+ * Skips the bytes which do not start a frame.
+ */
+int32_t
+UARTFramer::findFrame()
+{
+    int32_t lStart = 0;
+
+    // a frame has at least command ID and length before it can be checked
+    while ((0 == mFrameLength) && (lStart + 8 <= mLength))
+    {
+        const int32_t lFrameLength = checkFrame(lStart);
+        if (0 > lFrameLength)
+        {
+            lStart++;
+            mNumberOfSkippedBytes++;
+            continue;
+        }
+        if (0 == lFrameLength)
+        {
+            break; // wait for the rest
+        }
+        remove(lStart);
+        lStart = 0;
+        mFrameLength = lFrameLength;
+    }
+
+    // keep the incomplete frame
+    remove(lStart);
+    compact();
+    return mFrameLength;
+}
+
+/*
+ * Returns the next complete and valid frame.
+ */
+int32_t
+UARTFramer::getFrame(void* theBuffer, int32_t theSize)
+{
+    const int32_t lFrameLength = findFrame();
+    if (0 == lFrameLength)
+    {
+        return 0;
+    }
+
+    // the last byte arrived with the last bytes committed, since the
+    // frames are taken out after each commit
+    int32_t result = ERR_BUFFER_OVERFLOW;
+    mFirstByteTime = mBufferTime;
+    mLastByteTime = mReceiveTime;
+    if (theSize >= lFrameLength)
+    {
+        memcpy(theBuffer, &mBufferPtr[mStart], lFrameLength);
+        mNumberOfFrames++;
+        result = lFrameLength;
+    }
+    remove(lFrameLength);
+    compact();
+    mBufferTime = mReceiveTime;
+    return result;
+}
+
+/*
+ * Gives up the frame which is incomplete.
+ */
+void
+UARTFramer::skipFrame()
+{
+    if (0 != mLength)
+    {
+        remove(1);
+        mNumberOfSkippedBytes++;
+    }
+}
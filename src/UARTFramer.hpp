@@ -0,0 +1,291 @@
+#ifndef UARTFRAMER_HPP_
+#define UARTFRAMER_HPP_
+/**
+ ****************************************************************************
+ *
+ * Project:     Triple-IN PS Demo Program
+ *
+ * @file:       UARTFramer.hpp - Cuts the byte stream of a UART into frames.
+ *
+ * @author:     CBruelle
+ *
+ * Date:        $Date: 2015/10/23 12:23:10 $
+ * SDK:         GNU gcc 4
+ *
+ * (c) 2014 Triple-IN GmbH Hamburg, Germany
+ *
+ * This software is placed into the public domain
+ * and may be used for any purpose.  However, this
+ * notice must not be changed or removed and no warranty is either
+ * expressed or implied by its publication or distribution.
+ ****************************************************************************
+ */
+
+#include "Global.hpp"
+
+/**
+ * Class UARTFramer - reassembles frames from the bytes of a serial line.
+ * <p>&nbsp;<p>
+ * A UDP datagram holds exactly one frame, a UART delivers a frame in
+ * pieces of any size. The framer collects the received bytes in a buffer
+ * which is kept between the reads, and returns a frame when it is
+ * complete: command ID (4 bytes), data length (4 bytes), data and CRC
+ * (4 bytes), in network byte order.
+ * <p>
+ * A frame is only accepted if it starts with a known command ID, its
+ * length is plausible and its CRC is right. Otherwise the first byte is
+ * skipped and the next known command ID is searched, so a lost or
+ * corrupted byte costs one frame instead of the rest of the stream.
+ * <p>
+ * The framer remembers when the first and the last byte of each frame
+ * arrived, so the transfer time of a frame over the line can be measured.
+ * It does no I/O: the owner reads the bytes into getWritePtr() and calls
+ * commit().
+ * <p>
+ * A frame is copied once, into the buffer of the caller. The bytes behind
+ * it stay where they are; they are moved to the start of the buffer only
+ * when the free space at its end gets smaller than a frame.
+ */
+class UARTFramer
+{
+    public:
+
+        /** class constants */
+        enum UARTFramerConstants_t
+        {
+            /** maximum size of a frame */
+            MAX_FRAME_SIZE = 64 * 1024,
+
+            /** command ID, data length and CRC */
+            FRAME_OVERHEAD = 12,
+
+            /** size of the receive buffer; a complete frame and the next part */
+            BUFFER_SIZE = 2 * MAX_FRAME_SIZE
+        };
+
+    private:
+
+        /** the received bytes not yet returned or skipped */
+        byte_t* mBufferPtr;
+
+        /** position of the first byte not yet returned or skipped */
+        int32_t mStart;
+
+        /** number of bytes in the buffer from mStart on */
+        int32_t mLength;
+
+        /** length of the valid frame at the start of the buffer, or 0 */
+        int32_t mFrameLength;
+
+        /** time in ns when the first byte in the buffer arrived */
+        uint64_t mBufferTime;
+
+        /** time in ns when the last bytes were committed */
+        uint64_t mReceiveTime;
+
+        /** time in ns when the first byte of the last frame arrived */
+        uint64_t mFirstByteTime;
+
+        /** time in ns when the last byte of the last frame arrived */
+        uint64_t mLastByteTime;
+
+        /** number of frames returned */
+        uint32_t mNumberOfFrames;
+
+        /** number of bytes skipped to find the start of a frame */
+        uint32_t mNumberOfSkippedBytes;
+
+        /** number of frames with a wrong CRC */
+        uint32_t mNumberOfCRCErrors;
+
+        /**
+         * Returns true if a command ID is known.
+         */
+        static bool
+        isKnownCommandID(const byte_t* theIDPtr);
+
+        /**
+         * Returns the frame length if a valid frame starts at the position,
+         * 0 if it may be one which is not yet complete, or -1 if none starts.
+         */
+        int32_t
+        checkFrame(int32_t thePosition);
+
+        /**
+         * Skips the bytes which do not start a frame. Returns the length
+         * of the complete and valid frame at the start of the buffer, or 0.
+         */
+        int32_t
+        findFrame();
+
+        /**
+         * Removes bytes from the start of the buffer.
+         */
+        void
+        remove(int32_t theLength);
+
+        /**
+         * Moves the bytes to the start of the buffer if the space behind
+         * them may not take a frame.
+         */
+        void
+        compact();
+
+        /* private assignment constructor to avoid misuse */
+        explicit
+        UARTFramer(const UARTFramer& src);
+
+        /* private assignment operator to avoid misuse */
+        UARTFramer&
+        operator =(const UARTFramer& src);
+
+    public:
+
+        /**
+         * Standard constructor. The buffer is empty.
+         */
+        UARTFramer();
+
+        /**
+         * Destructor.
+         */
+        virtual
+        ~UARTFramer();
+
+        /**
+         * Discards the buffered bytes and resets the counters.
+         */
+        void
+        reset();
+
+        /**
+         * Returns where the next received bytes are to be stored.
+         */
+        byte_t*
+        getWritePtr()
+        {
+            return &mBufferPtr[mStart + mLength];
+        }
+
+        /**
+         * Returns the number of bytes which can be stored at getWritePtr().
+         * Is never 0 after getFrame(), since a complete frame is returned.
+         */
+        int32_t
+        getFreeSize() const
+        {
+            return BUFFER_SIZE - mStart - mLength;
+        }
+
+        /**
+         * Adds the bytes stored at getWritePtr().
+         *
+         * @param theLength
+         *      number of bytes received.
+         * @param theTime
+         *      time in ns of the MonotonicClock when they were received.
+         */
+        void
+        commit(int32_t theLength, uint64_t theTime);
+
+        /**
+         * Returns true if a complete and valid frame is buffered, so
+         * getFrame() returns it. Bytes before it which do not start a
+         * frame are skipped.
+         */
+        bool
+        hasFrame()
+        {
+            return 0 < findFrame();
+        }
+
+        /**
+         * Returns the next complete and valid frame. Bytes before it which
+         * do not start a frame are skipped.
+         *
+         * @param theBuffer
+         *      the buffer for the frame.
+         * @param theSize
+         *      size of the buffer in bytes.
+         * @return
+         *      the size of the frame, 0 if no frame is complete, or
+         *      ERR_BUFFER_OVERFLOW if the frame did not fit into the buffer
+         *      and was discarded.
+         */
+        int32_t
+        getFrame(void* theBuffer, int32_t theSize);
+
+        /**
+         * Gives up the frame which is incomplete, e.g. after a timeout:
+         * its first byte is skipped, so the next getFrame() searches for
+         * the next frame in the bytes received after it.
+         */
+        void
+        skipFrame();
+
+        /**
+         * Returns true if the buffer holds bytes not yet returned or skipped,
+         * e.g. the start of an incomplete frame.
+         */
+        bool
+        hasBufferedBytes() const
+        {
+            return 0 != mLength;
+        }
+
+        /**
+         * Returns the time in ns when the last bytes were received.
+         */
+        uint64_t
+        getReceiveTime() const
+        {
+            return mReceiveTime;
+        }
+
+        /**
+         * Returns the time in ns when the first byte of the last frame arrived.
+         */
+        uint64_t
+        getFirstByteTime() const
+        {
+            return mFirstByteTime;
+        }
+
+        /**
+         * Returns the time in ns when the last byte of the last frame arrived.
+         */
+        uint64_t
+        getLastByteTime() const
+        {
+            return mLastByteTime;
+        }
+
+        /**
+         * Returns the number of frames returned since reset().
+         */
+        uint32_t
+        getNumberOfFrames() const
+        {
+            return mNumberOfFrames;
+        }
+
+        /**
+         * Returns the number of bytes skipped since reset().
+         */
+        uint32_t
+        getNumberOfSkippedBytes() const
+        {
+            return mNumberOfSkippedBytes;
+        }
+
+        /**
+         * Returns the number of CRC errors since reset().
+         */
+        uint32_t
+        getNumberOfCRCErrors() const
+        {
+            return mNumberOfCRCErrors;
+        }
+};
+
+#endif /* UARTFRAMER_HPP_ */
@@ -8,6 +8,7 @@
 #if defined(__WIN32__) || (defined(__CYGWIN__) && !defined(_WIN32))
 
 #include "WinClientUART.hpp"
+#include "MonotonicClock.hpp"
 // needed for ntohl
 #include <winsock2.h>
 #include <ctype.h>
@@ -25,7 +26,8 @@ ClientUART::ClientUART() :
 		mPort("\0"), //
 		hComm(0), //
         mLogFile(0), //
-        mTimeout(0)
+        mTimeout(0), //
+        mFirstByteTime(0)
 {
 }
 
@@ -291,6 +293,11 @@ int32_t ClientUART::read(void* buffer, int32_t size)
 
 		loop = 0;
 
+		if (total == 0) // the first byte of the frame
+		{
+			mFirstByteTime = MonotonicClock::getNanoseconds();
+		}
+
 		total += (int32_t)NoBytesRead;
 #if DEBUG_READ
 		//printf("Read total %d bytes!\r\n", total);
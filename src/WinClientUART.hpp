@@ -31,6 +31,9 @@ class ClientUART : public IDataStream
 		/** timeout in ms. */
 		int mTimeout;
 
+		/** time in ns when the first byte of the last frame arrived. */
+		uint64_t mFirstByteTime;
+
         /** private assignment constructor to avoid misuse */
         explicit
 		ClientUART(const ClientUART& src);
@@ -55,6 +58,12 @@ class ClientUART : public IDataStream
 
 		ErrorID_t close();
 
+		/** Returns the time in ns when the first byte of the last frame arrived. */
+		virtual uint64_t getFirstByteTime()
+		{
+			return mFirstByteTime;
+		}
+
 		int32_t read(void* buffer, int32_t size);
 
 		int32_t write(void* buffer, int32_t size);